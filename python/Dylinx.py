@@ -12,6 +12,10 @@ import ctypes
 import glob
 import re
 import ctypes
+import socket
+import time
+import json
+import struct
 from enum import Enum
 import matplotlib.pyplot as plt
 import matplotlib as mpl
@@ -19,29 +23,242 @@ import numpy as np
 import pickle
 
 # ALLOWED_LOCK_TYPE = ["PTHREADMTX", "ADAPTIVEMTX", "TTAS", "BACKOFF", "MCS"]
-ALLOWED_LOCK_TYPE = ["PTHREADMTX", "ADAPTIVEMTX", "TTAS", "BACKOFF"]
+# TAS and TICKET16 are compact, a lock word of 1 and 4 bytes without a
+# backend, for sites with very many locks.
+ALLOWED_LOCK_TYPE = ["PTHREADMTX", "ADAPTIVEMTX", "TTAS", "BACKOFF", "TICKET", "QSPINLOCK", "TAS", "TICKET16"]
+ALLOWED_RWLOCK_TYPE = ["PTHREADRW", "WPREFRW", "BIGREADERRW", "BRAVORW"]
+ALLOWED_SPINLOCK_TYPE = ["TTAS", "BACKOFF", "TICKET", "MCS", "QSPINLOCK", "TAS", "TICKET16"]
+ALLOWED_BARRIER_TYPE = ["PTHREADBARRIER", "SENSEBARRIER", "TREEBARRIER", "TOURNBARRIER", "DISSEMBARRIER"]
+ALLOWED_SEM_TYPE = ["POSIXSEM", "SPINPARKSEM", "BATCHSEM", "PERCPUSEM"]
 
-def var_macro_handler(i, id2type, entities, content):
+# Candidates and fallback type of every pluggable primitive, keyed by the
+# "lock_kind" the rewriter records for each site.
+LOCK_FAMILY = {
+    "MUTEX": ALLOWED_LOCK_TYPE,
+    "RWLOCK": ALLOWED_RWLOCK_TYPE,
+    "SPINLOCK": ALLOWED_SPINLOCK_TYPE,
+    "BARRIER": ALLOWED_BARRIER_TYPE,
+    "SEM": ALLOWED_SEM_TYPE
+}
+DEFAULT_LOCK_TYPE = {
+    "MUTEX": "PTHREADMTX",
+    "RWLOCK": "PTHREADRW",
+    "SPINLOCK": "TTAS",
+    "BARRIER": "PTHREADBARRIER",
+    "SEM": "POSIXSEM"
+}
+
+# Waiting policies that may be appended to a lock type, as in "MCS+PARK"
+# or "TTAS+BACKOFF(64,4096)". BACKOFF takes (min, max) pauses, YIELD and
+# PARK take a spin budget in rounds and TSC takes one in cycles. Only the
+# types below honour the policy.
+WAIT_POLICY = ["SPIN", "BACKOFF", "YIELD", "PARK", "TSC"]
+WAIT_AWARE_TYPE = ["TTAS", "BACKOFF", "MCS", "TICKET"]
+WAIT_ARGS = {"SPIN": (), "BACKOFF": ("min", "max"), "YIELD": ("budget",), "PARK": ("budget",), "TSC": ("budget",)}
+
+# Tunables a lock type declares, as in "BACKOFF(min=64,max=4096)". The
+# order gives the slot index of the *_PARAM_* enum in the lock header and
+# each entry carries its inclusive range. Left out, a tunable keeps the
+# default of the lock type.
+LOCK_PARAM_MAX = 4 # DLX_LOCK_PARAM_MAX in dylinx-conf.h
+LOCK_PARAM = {
+    "BACKOFF": [("min", 1, 1 << 20), ("max", 1, 1 << 24)],
+    "TICKET": [("base", 1, 1 << 16)],
+    "ADAPTIVEMTX": [("spin", 0, 1 << 16)]
+}
+
+# Arguments are either all positional or given as name=value.
+def parse_args(owner, args, names):
+    values = {}
+    items = [a.strip() for a in args.split(",") if a.strip()] if args else []
+    if len(items) > len(names):
+        raise ValueError(f"{owner} takes at most {len(names)} arguments")
+    for i, item in enumerate(items):
+        name, eq, value = item.partition("=")
+        if not eq:
+            name, value = names[i], item
+        name = name.strip().lower()
+        if name not in names:
+            raise ValueError(f"{owner} has no argument {name}")
+        values[name] = int(value)
+    return values
+
+# Where the lock backends of a site live, as in "MCS@NODE1". LOCAL puts
+# each backend on the node of the thread initializing it, INTERLEAVE
+# spreads the instances over all nodes. FOLLOW starts like LOCAL and, on a
+# hot swap build, moves each backend to the node acquiring it most. Only
+# the types in PLACE_AWARE_TYPE allocate their backend through the
+# placement arena.
+PLACE_KIND = ["LOCAL", "INTERLEAVE", "NODE", "FOLLOW"]
+PLACE_AWARE_TYPE = ["TTAS", "BACKOFF", "PTHREADMTX", "ADAPTIVEMTX", "MCS", "TICKET", "QSPINLOCK"]
+
+# How the lock sits among the subject's data, as in "MCS@LOCAL/ISOLATE" or
+# "TTAS/COLOCATE". ISOLATE gives the lock a prefetch pair of its own,
+# COLOCATE aligns a struct field to one so that the fields after it share
+# the lock's pair. Both change the subject's layout and need a rebuild.
+LAYOUT_KIND = ["ISOLATE", "COLOCATE"]
+
+def parse_arrangement(ltype):
+    m = re.fullmatch(
+        r"\s*(\w+)\s*(?:\(([\w=,\s]*)\))?\s*(?:\+\s*(\w+)\s*(?:\(([\w=,\s]*)\))?)?\s*(?:@\s*([A-Za-z]+)(\d*))?\s*(?:/\s*([A-Za-z]+))?\s*",
+        ltype
+    )
+    if m == None:
+        raise ValueError(f"Malformed arrangement {ltype}")
+    base, params, policy, args = m.group(1).upper(), m.group(2), m.group(3), m.group(4)
+    place, node, layout = m.group(5), m.group(6), m.group(7)
+    if params == None and policy == None and place == None and layout == None:
+        return base, None
+    conf = {"wait": None, "params": {}, "place": None, "layout": None}
+    if layout != None:
+        layout = layout.upper()
+        if layout not in LAYOUT_KIND:
+            raise ValueError(f"Unknown layout {layout} in {ltype}")
+        conf["layout"] = layout
+    if place != None:
+        place = place.upper()
+        if place not in PLACE_KIND or (place == "NODE") != (node != ""):
+            raise ValueError(f"Unknown placement {place}{node} in {ltype}")
+        if base not in PLACE_AWARE_TYPE:
+            logging.warning(f"{base} ignores placement {place}")
+        conf["place"] = {"kind": place, "node": int(node) if node else 0}
+    if params != None:
+        spec = LOCK_PARAM.get(base, [])
+        values = parse_args(base, params, [name for name, _, _ in spec])
+        for slot, (name, lo, hi) in enumerate(spec):
+            if name not in values:
+                continue
+            if not lo <= values[name] <= hi:
+                raise ValueError(f"{base} {name}={values[name]} is out of [{lo}, {hi}]")
+            conf["params"][slot] = values[name]
+    if policy != None:
+        policy = policy.upper()
+        if policy not in WAIT_POLICY:
+            raise ValueError(f"Unknown waiting policy {policy} in {ltype}")
+        if base not in WAIT_AWARE_TYPE:
+            logging.warning(f"{base} ignores waiting policy {policy}")
+        conf["wait"] = parse_args(policy, args, WAIT_ARGS[policy])
+        conf["wait"]["kind"] = policy
+    return base, conf
+
+def conf_code(site_id, conf):
+    code = ""
+    wait = conf["wait"]
+    if wait != None:
+        code = code + (
+            f"\tdlx_set_site_wait({site_id}, DLX_WAIT_{wait['kind']}, "
+            f"{wait.get('min', 0)}, {wait.get('max', 0)}, {wait.get('budget', 0)});\n"
+        )
+    for slot, value in sorted(conf["params"].items()):
+        code = code + f"\tdlx_set_site_param({site_id}, {slot}, {value});\n"
+    place = conf["place"]
+    if place != None:
+        code = code + f"\tdlx_set_site_place({site_id}, DLX_PLACE_{place['kind']}, {place['node']});\n"
+    if conf.get("layout") != None:
+        code = code + f"\tdlx_set_site_layout({site_id}, DLX_LAYOUT_{conf['layout']});\n"
+    return code
+
+# Exported to the subject so that dylinx-runtime-init.c starts the control
+# socket, see dylinx-control.c.
+CONTROL_SOCKET_ENV = "DYLINX_CONTROL_SOCKET"
+
+# Warm-up spec "<ms>[:<round ms>]" and log path of the online autotuner, see
+# dylinx-autotune.c. Both are read by the subject at startup.
+AUTOTUNE_ENV = "DYLINX_AUTOTUNE"
+AUTOTUNE_LOG_ENV = "DYLINX_AUTOTUNE_LOG"
+
+# Experiment spec "<ms>[:<total ms>]" and log path of the causal profiler,
+# see dylinx-causal.c.
+CAUSAL_ENV = "DYLINX_CAUSAL"
+CAUSAL_LOG_ENV = "DYLINX_CAUSAL_LOG"
+
+# Path the subject writes its lock memory footprint to when it exits.
+FOOTPRINT_LOG_ENV = "DYLINX_FOOTPRINT_LOG"
+
+# Path the subject writes its lock contention counters to when it exits.
+STATS_LOG_ENV = "DYLINX_STATS_LOG"
+STATS_INSTANCES_ENV = "DYLINX_STATS_INSTANCES"
+STATS_COUNTERS_ENV = "DYLINX_STATS_COUNTERS"
+# Shared memory segment for dylinx-top, /dylinx.<pid> unless named.
+SHM_ENV = "DYLINX_SHM"
+
+# Binary lock event trace written by dlx_trace_start, see dylinx-glue.c for
+# the layout. The header is rewritten when the subject exits, events start
+# at TRACE_HEADER_SIZE either way.
+TRACE_ENV = "DYLINX_TRACE"
+TRACE_SAMPLE_ENV = "DYLINX_TRACE_SAMPLE"
+TRACE_MAGIC = b"DLXTRACE"
+TRACE_HEADER = "<8sIIQQQQQQIIQQQQIII"
+TRACE_HEADER_SIZE = 128
+TRACE_EVENT = np.dtype([
+    ("tsc", "<u8"), ("site_id", "<i4"), ("ins_id", "<u4"), ("delta", "<u4"),
+    ("thread", "<u2"), ("op", "u1"), ("cpu", "u1")
+])
+TRACE_ACQUIRE, TRACE_RELEASE, TRACE_TRYFAIL, TRACE_REACQUIRE, TRACE_TIMEOUT, TRACE_RATE = range(6)
+
+# A mutex or spinlock site may also be arranged per instance, where an
+# instance is the ins_id the subject gave the lock, i.e. its creation order
+# within the site. Elements of one array are consecutive, so for a site
+# whose only lock array is initialized first they are the element indices.
+# hot_instances gives ids in the same numbering.
+#   {"type": "TTAS", "instances": {"3": "TICKET+PARK", "8-15": "QSPINLOCK"}}
+# Ranges are inclusive. Instances not listed keep the type of the site.
+INSTANCE_AWARE_KIND = ["MUTEX", "SPINLOCK"]
+
+def parse_instances(kind, instances):
+    rules = []
+    for key, ltype in instances.items():
+        lo, _, hi = str(key).partition("-")
+        lo = int(lo)
+        hi = int(hi) if hi else lo
+        if hi < lo:
+            raise ValueError(f"Empty instance range {key}")
+        base, conf = parse_arrangement(ltype)
+        if base not in LOCK_FAMILY[kind]:
+            raise ValueError(f"{base} cannot serve instances of a {kind} site")
+        if conf != None and conf["layout"] != None:
+            logging.warning(f"Instances {key} share the layout of their site, {conf['layout']} is ignored")
+            conf["layout"] = None
+        rules.append((lo, hi + 1, base, conf))
+    return rules
+
+# Hot instances, e.g. from DylinxRuntimeReport.hot_instances, get hot and
+# the rest of the site keeps rest.
+def hot_set_arrangement(rest, hot, hot_ins):
+    instances = {}
+    ins = sorted(set(hot_ins))
+    while ins:
+        lo = hi = ins.pop(0)
+        while ins and ins[0] == hi + 1:
+            hi = ins.pop(0)
+        instances[f"{lo}-{hi}" if hi > lo else f"{lo}"] = hot
+    return {"type": rest, "instances": instances}
+
+# Lock type a site is declared with, the padded one for isolated sites.
+def lock_typename(ltype, layout):
+    return f"dlx_{ltype.lower()}_iso_t" if layout == "ISOLATE" else f"dlx_{ltype.lower()}_t"
+
+def var_macro_handler(i, id2type, entities, content, layouts):
     ltype = id2type[i]
     entity = entities[i]
-    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
+    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} {lock_typename(ltype, layouts.get(i))}")
     if entity.get("define_init", False):
         content.append(
             f"#define DYLINX_LOCK_INIT_{entity['id']} "
-            f"{{ malloc(sizeof(dlx_{ltype.lower()}_t)), 0x32CB00B5, {{ {entity['id']}, 100 }}, &dlx_{ltype.lower()}_methods_collection, {{0}} }}"
+            f"{{ malloc(sizeof(dlx_{ltype.lower()}_t)), 0x32CB00B5, {{ {entity['id']}, 100 }}, &dlx_{ltype.lower()}_methods_collection, 0, 0, {{0}} }}"
         )
     if entity.get("extra_init", False):
         content.append(
             f"#define DYLINX_VAR_DECL_{entity['fentry_uid']}_{entity['line']} {entity['id']}"
         )
 
-def arr_macro_handler(i, id2type, entities, content):
+def arr_macro_handler(i, id2type, entities, content, layouts):
     ltype = id2type[i]
     entity = entities[i]
-    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
+    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} {lock_typename(ltype, layouts.get(i))}")
     content.append(f"#define DYLINX_ARRAY_DECL_{entity['fentry_uid']}_{entity['line']} {entity['id']}")
 
-def mtx_alloc_handler(i, id2type, entities, content):
+def mtx_alloc_handler(i, id2type, entities, content, layouts):
     ltype = id2type[i]
     entity = entities[i]
     content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
@@ -53,14 +270,18 @@ def locate_field_decl(name, f_uid, line, entities):
         if (e["modification_type"] == "FIELD_INSERT" or e["modification_type"] == "FIELD_ARRAY") and e["field_name"] == name and e["fentry_uid"] == f_uid and e["line"] == line:
             return e
 
-def field_decl_handler(i, id2type, entities, content):
+def field_decl_handler(i, id2type, entities, content, layouts):
     ltype = id2type[i]
     entity = entities[i]
-    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
+    layout = layouts.get(i)
+    content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} {lock_typename(ltype, layout)}")
+    if not entity.get("is_pointer", False):
+        align = "_Alignas(DLX_PREFETCH_PAIR)" if layout == "COLOCATE" else ""
+        content.append(f"#define DYLINX_LOCK_ALIGN_{entity['id']} {align}")
     content.append(f"#define DYLINX_FIELD_DECL_{entity['fentry_uid']}_{entity['line']} {entity['id']}")
 
 
-def struct_alloc_handler(i, id2type, entities, content):
+def struct_alloc_handler(i, id2type, entities, content, layouts):
     entity = entities[i]
     content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} user_def_struct_t")
     init_methods = []
@@ -76,7 +297,7 @@ def struct_alloc_handler(i, id2type, entities, content):
     content.append(f"#define DYLINX_LOCK_INIT_{entity['id']} {init_methods}")
     content.append(f"#define DYLINX_LOCK_OBJ_INDICATOR_{entity['id']} {id_str}")
 
-def extern_symbol_handler(i, id2type, entities, content):
+def extern_symbol_handler(i, id2type, entities, content, layouts):
     def locate_var_decl(name):
         for i, e in entities.items():
             if (e["modification_type"] == "VARIABLE" or e["modification_type"] == "ARRAY") and e["name"] == name:
@@ -87,9 +308,10 @@ def extern_symbol_handler(i, id2type, entities, content):
     valid = locate_var_decl(entity["name"])
     if valid != None:
         ltype = id2type[valid["id"]]
-        content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
+        content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} {lock_typename(ltype, layouts.get(valid['id']))}")
     else:
-        content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_pthreadmtx_t")
+        ltype = DEFAULT_LOCK_TYPE[entity.get("lock_kind", "MUTEX")]
+        content.append(f"#define DYLINX_LOCK_TYPE_{entity['id']} dlx_{ltype.lower()}_t")
 
 class BaseSubject(metaclass=abc.ABCMeta):
     def __init__(self, cc_path, out_dir=None, verbose=logging.DEBUG):
@@ -124,8 +346,10 @@ class BaseSubject(metaclass=abc.ABCMeta):
         self.permutation = []
         slots = list(self.filter_valid(meta["LockEntity"]))
         self.pluggable_sites = {}
+        self.site_kinds = {}
         for m in slots:
             self.pluggable_sites[m['id']] = m["lock_combination"] if m.get("lock_combination", None) else []
+            self.site_kinds[m['id']] = m.get("lock_kind", "MUTEX")
 
         # Generate content for dylinx-runtime-init.c
         init_cu = set()
@@ -134,15 +358,58 @@ class BaseSubject(metaclass=abc.ABCMeta):
                 init_cu.add(m["fentry_uid"])
         self.extra_init_cu = init_cu
         self.entities = { e["id"]: e for e in meta["LockEntity"] }
+        self.emit_runtime_init({})
+
+    # dylinx-runtime-init.c carries everything that has to happen before the
+    # first lock is initialized, so it is rebuilt whenever the per-site
+    # waiting policies, tunables or per-instance arrangements change.
+    # Instance rules get their configuration registered under ids past
+    # the last site.
+    def emit_runtime_init(self, site_confs, instance_rules=[]):
+        n_site = max(self.entities.keys(), default=-1) + 1
         with open(f"{self.glue_dir}/glue/dylinx-runtime-init.c", "w") as rt_code:
             code = "#include \"dylinx-glue.h\"\n"
             code = code + "extern void retrieve_native_symbol();\n"
-            for cu in init_cu:
+            for cu in self.extra_init_cu:
                 code = code + f"extern void __dylinx_cu_init_{cu}_();\n"
             code = code + "void __dylinx_global_mtx_init_() {\n"
             code = code + "\tretrieve_native_symbol();\n"
+            code = code + "\tdlx_topology_init();\n"
             code = code + "\tassert(sizeof(dlx_generic_lock_t) == sizeof(pthread_mutex_t));\n"
-            for cu in init_cu:
+            code = code + "\tassert(sizeof(dlx_generic_rwlock_t) == sizeof(pthread_rwlock_t));\n"
+            code = code + "\tassert(sizeof(dlx_generic_barrier_t) == sizeof(pthread_barrier_t));\n"
+            code = code + "\tassert(sizeof(dlx_generic_sem_t) == sizeof(sem_t));\n"
+            code = code + f"\tdlx_reserve_sites({n_site});\n"
+            for site_id, conf in sorted(site_confs.items()):
+                code = code + conf_code(site_id, conf)
+            for n, (site_id, lo, hi, ltype, conf) in enumerate(instance_rules):
+                conf_id = -1
+                if conf != None:
+                    conf_id = n_site + n
+                    code = code + conf_code(conf_id, conf)
+                code = code + (
+                    f"\tdlx_set_instance_type({site_id}, {lo}, {hi}, "
+                    f"&dlx_{ltype.lower()}_methods_collection, {conf_id});\n"
+                )
+            code = code + f"\tdlx_control_start(getenv(\"{CONTROL_SOCKET_ENV}\"));\n"
+            for site_id in sorted(self.pluggable_sites):
+                if self.site_kinds[site_id] not in INSTANCE_AWARE_KIND:
+                    continue
+                arms = dict.fromkeys(c.split("+")[0].split("(")[0] for c in self.get_candidates(site_id))
+                code = code + f"\tdlx_autotune_site({site_id}, \"{','.join(arms)}\");\n"
+            code = code + f"\tdlx_autotune_start(getenv(\"{AUTOTUNE_ENV}\"), getenv(\"{AUTOTUNE_LOG_ENV}\"));\n"
+            for site_id in sorted(self.pluggable_sites):
+                if self.site_kinds[site_id] in INSTANCE_AWARE_KIND:
+                    code = code + f"\tdlx_causal_site({site_id});\n"
+            code = code + f"\tdlx_causal_start(getenv(\"{CAUSAL_ENV}\"), getenv(\"{CAUSAL_LOG_ENV}\"));\n"
+            code = code + f"\tdlx_footprint_log(getenv(\"{FOOTPRINT_LOG_ENV}\"));\n"
+            code = code + f"\tdlx_stats_instances(getenv(\"{STATS_INSTANCES_ENV}\"));\n"
+            code = code + f"\tdlx_stats_counters(getenv(\"{STATS_COUNTERS_ENV}\"));\n"
+            code = code + f"\tdlx_stats_log(getenv(\"{STATS_LOG_ENV}\"));\n"
+            code = code + f"\tdlx_stats_publish(getenv(\"{SHM_ENV}\"));\n"
+            code = code + f"\tdlx_trace_sample(getenv(\"{TRACE_SAMPLE_ENV}\"));\n"
+            code = code + f"\tdlx_trace_start(getenv(\"{TRACE_ENV}\"));\n"
+            for cu in self.extra_init_cu:
                 code = code + "\t__dylinx_cu_init_{}_();\n".format(cu)
             code = code + "}\n"
             rt_code.write(code)
@@ -176,11 +443,267 @@ class BaseSubject(metaclass=abc.ABCMeta):
     def get_pluggable(self):
         return self.pluggable_sites
 
+    def get_candidates(self, site_id, with_wait=False):
+        # Sites without a comment combination may use any type of their family.
+        candidates = self.pluggable_sites[site_id] or LOCK_FAMILY[self.site_kinds[site_id]]
+        if not with_wait:
+            return candidates
+        return candidates + [
+            f"{c}+{w}" for c in candidates if c.split("(")[0] in WAIT_AWARE_TYPE and "+" not in c
+            for w in WAIT_POLICY
+        ]
+
+    # Hot swap lets arrangement trials run back-to-back in one warm process.
+    # It needs the glue built with `xmake f --hotswap=y` and the subject
+    # started after enable_control, which exports the socket path to it.
+    def enable_control(self, path=None):
+        self.control_path = path if path else f"{self.glue_dir}/control.sock"
+        os.environ[CONTROL_SOCKET_ENV] = self.control_path
+
+    def control(self, commands, timeout=10):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                conn.connect(self.control_path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                conn.close()
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+        replies = []
+        with conn, conn.makefile("rw") as stream:
+            for cmd in commands:
+                stream.write(cmd + "\n")
+                stream.flush()
+                reply = stream.readline().split()
+                if not reply or reply[0] != "ok":
+                    raise RuntimeError(f"Control command '{cmd}' failed: {' '.join(reply)}")
+                replies.append(reply[1:])
+        return replies
+
+    # Moves every instance of the given mutex sites to a new arrangement.
+    # Instances migrate lazily once they are quiescent, swap_progress tells
+    # how many already did.
+    def hot_swap(self, id2type, timeout=10):
+        commands = []
+        for k, v in id2type.items():
+            k = int(k)
+            kind = self.site_kinds.get(k, "MUTEX")
+            if kind not in INSTANCE_AWARE_KIND or isinstance(v, dict):
+                raise ValueError(f"Site {k} cannot be swapped to {v}")
+            base, conf = parse_arrangement(v)
+            if base not in LOCK_FAMILY[kind]:
+                raise ValueError(f"{base} cannot serve a {kind} site")
+            wait = conf["wait"] if conf != None and conf["wait"] != None else {"kind": "DEFAULT"}
+            params = conf["params"] if conf != None else {}
+            place = conf["place"] if conf != None and conf["place"] != None else {"kind": "DEFAULT", "node": 0}
+            if conf != None and conf["layout"] != None:
+                logging.warning(f"Site {k} needs a rebuild for layout {conf['layout']}")
+            commands.append(f"place {k} {place['kind']} {place['node']}")
+            commands.append(
+                f"wait {k} {wait['kind']} {wait.get('min', 0)} {wait.get('max', 0)} {wait.get('budget', 0)}"
+            )
+            commands += [f"param {k} {slot} {params.get(slot, 0)}" for slot in range(LOCK_PARAM_MAX)]
+            commands.append(f"type {k} {base.lower()}")
+        self.control(commands, timeout)
+
+    def swap_progress(self, site_id):
+        epoch, migrated, instances = self.control([f"query {site_id}"])[0]
+        return int(epoch), int(migrated), int(instances)
+
+    # The autotuner lets the subject pick each mutex site's lock by itself
+    # during warm-up, on a hot swap build as well. The committed arrangement
+    # lands in log_path and load_autotune_log turns it into an id2type for
+    # configure_type, so later builds start from the winners.
+    def enable_autotune(self, warmup_ms, interval_ms=50, log_path=None):
+        self.autotune_log = log_path if log_path else f"{self.glue_dir}/autotune.json"
+        os.environ[AUTOTUNE_ENV] = f"{warmup_ms}:{interval_ms}"
+        os.environ[AUTOTUNE_LOG_ENV] = self.autotune_log
+
+    def load_autotune_log(self, log_path=None):
+        with open(log_path if log_path else self.autotune_log, "r") as stream:
+            return {int(k): v for k, v in json.load(stream).items()}
+
+    # Causal profiling of the mutex and spinlock sites. The subject counts
+    # its progress with DLX_PROGRESS() from dylinx-glue.h, or passes a
+    # callback to dlx_causal_progress. load_causal returns the predicted
+    # throughput change per site when its critical sections run 25 to 100
+    # percent faster, e.g. {3: {25: 0.04, 50: 0.09, 75: 0.15, 100: 0.22}},
+    # most promising site first. With min_gain, only sites predicted to gain
+    # that much at some speedup are kept, as candidates for the search.
+    def enable_causal(self, experiment_ms=100, total_ms=0, log_path=None):
+        self.causal_log = log_path if log_path else f"{self.glue_dir}/causal.json"
+        os.environ[CAUSAL_ENV] = f"{experiment_ms}:{total_ms}"
+        os.environ[CAUSAL_LOG_ENV] = self.causal_log
+
+    def load_causal(self, min_gain=None, log_path=None):
+        with open(log_path if log_path else self.causal_log, "r") as stream:
+            sites = json.load(stream)["sites"]
+        report = {
+            int(site): {int(k): v[0] for k, v in points.items() if k != "sections" and v[1]}
+            for site, points in sites.items()
+        }
+        if min_gain is not None:
+            report = {k: v for k, v in report.items() if v and max(v.values()) >= min_gain}
+        return dict(sorted(report.items(), key=lambda kv: -max(kv[1].values(), default=0)))
+
+    # Bytes the mutex and spinlock sites held at their peak, headers and
+    # backends, so that an arrangement search can weigh memory against
+    # speed. load_footprint reads what the last run wrote, keyed by site id
+    # with -1 for untracked locks, or by lock type with by_type.
+    def enable_footprint(self, log_path=None):
+        self.footprint_log = log_path if log_path else f"{self.glue_dir}/footprint.json"
+        os.environ[FOOTPRINT_LOG_ENV] = self.footprint_log
+
+    def load_footprint(self, by_type=False, log_path=None):
+        with open(log_path if log_path else self.footprint_log, "r") as stream:
+            footprint = json.load(stream)
+        if by_type:
+            return {k: v["peak"] for k, v in footprint["types"].items()}
+        return {int(k): v["peak"] for k, v in footprint["sites"].items()}
+
+    # Locks the subject freed along with their object without destroying
+    # them, which the runtime destroyed instead. A non-zero count points at
+    # a leak in the subject.
+    def load_reclaimed(self, by_type=False, log_path=None):
+        with open(log_path if log_path else self.footprint_log, "r") as stream:
+            footprint = json.load(stream)
+        entries = footprint["types" if by_type else "sites"]
+        return {
+            (k if by_type else int(k)): v.get("reclaimed", 0)
+            for k, v in entries.items() if v.get("reclaimed", 0)
+        }
+
+    # Contention counters of every mutex and spinlock site, without XRay.
+    # load_stats returns them keyed by site id, the ids of
+    # dylinx-insertion.yaml, with -1 for untracked locks. hold_cyc is
+    # estimated from a sample of the acquisitions, "hot" lists the most
+    # waited for instances as [instance, contended, wait_cyc]. "wait_pct"
+    # and "hold_pct" are the p50, p99 and p99.9 in cycles. With instances
+    # the hot entries carry the p50, p99 and p99.9 of their waits as well.
+    # counters=True counts cycles, instructions, LLC misses and HITM loads
+    # inside critical sections, a string such as "cycles,instructions,r04d2"
+    # picks the counters.
+    def enable_stats(self, log_path=None, instances=False, counters=None):
+        self.stats_log = log_path if log_path else f"{self.glue_dir}/stats.json"
+        os.environ[STATS_LOG_ENV] = self.stats_log
+        if instances:
+            os.environ[STATS_INSTANCES_ENV] = "1"
+        else:
+            os.environ.pop(STATS_INSTANCES_ENV, None)
+        if counters:
+            os.environ[STATS_COUNTERS_ENV] = counters if isinstance(counters, str) else "1"
+        else:
+            os.environ.pop(STATS_COUNTERS_ENV, None)
+
+    # Watch the running subject with build/bin/dylinx-top <pid>, or
+    # dylinx-top <name> when name starts with '/'.
+    def enable_live_stats(self, name=None):
+        os.environ[SHM_ENV] = name if name else "1"
+
+    def load_stats(self, log_path=None):
+        with open(log_path if log_path else self.stats_log, "r") as stream:
+            return {int(k): v for k, v in json.load(stream)["sites"].items()}
+
+    # Hardware counters per critical section of each site, e.g.
+    # load_counters()[3] == {"cycles": 812.0, ..., "ipc": 0.4, "bound": "data"}.
+    def load_counters(self, log_path=None):
+        report = {}
+        for site, stats in self.load_stats(log_path).items():
+            counters = dict(stats.get("counters", {}))
+            n_section = counters.pop("sections", 0)
+            if not n_section:
+                continue
+            report[site] = {
+                k: v / n_section if isinstance(v, int) else v for k, v in counters.items()
+            }
+        return report
+
+    # Wait and hold percentiles per lock type over every site, for tail
+    # latency objectives, e.g. load_latency()["MCS"]["wait"][0.99].
+    def load_latency(self, log_path=None):
+        with open(log_path if log_path else self.stats_log, "r") as stream:
+            types = json.load(stream).get("types", {})
+        quantiles = [0.5, 0.99, 0.999]
+        return {
+            ltype.upper(): {
+                "acq": entry["acq"],
+                "wait": dict(zip(quantiles, entry["wait_pct"])),
+                "hold": dict(zip(quantiles, entry["hold_pct"]))
+            }
+            for ltype, entry in types.items()
+        }
+
+    # Binary trace of every mutex and spinlock event, a replacement for
+    # XRay runs. DylinxRuntimeReport reads the file. sample, e.g. "256" or
+    # "256:100/1000", traces at most one acquisition in 256 per site, the
+    # second form only in the first 100ms of every second.
+    def enable_trace(self, trace_path=None, sample=None):
+        self.trace_path = trace_path if trace_path else f"{self.glue_dir}/trace.bin"
+        os.environ[TRACE_ENV] = self.trace_path
+        if sample:
+            os.environ[TRACE_SAMPLE_ENV] = str(sample)
+        else:
+            os.environ.pop(TRACE_SAMPLE_ENV, None)
+
+    def get_params(self, ltype):
+        return LOCK_PARAM.get(ltype.upper(), [])
+
+    # Layouts the rewritten declarations can honour. Fields of structs the
+    # subject mallocs are initialized at offsets taken from the original
+    # layout, and heap or pointer sites do not declare the lock themselves,
+    # so those keep the default layout.
+    def site_layouts(self, site_confs):
+        heap_fields = set()
+        for e in self.entities.values():
+            if e["modification_type"] == "STRUCT_MEM_ALLOCATION":
+                heap_fields |= {(m["field_name"], m["fentry_uid"], m["line"]) for m in e["member_info"]}
+        layouts = {}
+        for k, conf in site_confs.items():
+            layout = conf["layout"]
+            if layout == None:
+                continue
+            e = self.entities[k]
+            m_type = e["modification_type"]
+            is_field = m_type in ["FIELD_INSERT", "FIELD_ARRAY"]
+            if self.site_kinds.get(k, "MUTEX") not in INSTANCE_AWARE_KIND:
+                reason = f"a {self.site_kinds[k]} site"
+            elif m_type not in ["VARIABLE", "ARRAY", "FIELD_INSERT", "FIELD_ARRAY"]:
+                reason = f"a {m_type} site"
+            elif is_field and e.get("is_pointer", False):
+                reason = "a pointer field"
+            elif is_field and (e["field_name"], e["fentry_uid"], e["line"]) in heap_fields:
+                reason = "a field of a malloc'd struct"
+            elif layout == "COLOCATE" and not is_field:
+                reason = "not a struct field"
+            else:
+                layouts[k] = layout
+                continue
+            logging.warning(f"Site {k} is {reason}, layout {layout} is ignored")
+            conf["layout"] = None
+        return layouts
+
     def configure_type(self, id2type):
         with subprocess.Popen("clang -dumpversion", stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=True) as proc:
             clang_version = proc.stdout.read().decode("utf-8")
             proc.stderr.read().decode("utf-8")
         id2type = {int(k): v for k,v in id2type.items()}
+        site_confs = {}
+        instance_rules = []
+        for k, v in id2type.items():
+            if isinstance(v, dict):
+                kind = self.site_kinds.get(k, "MUTEX")
+                if kind not in INSTANCE_AWARE_KIND:
+                    raise ValueError(f"Site {k} of kind {kind} cannot be arranged per instance")
+                instance_rules += [(k, *rule) for rule in parse_instances(kind, v.get("instances", {}))]
+                v = v["type"]
+            id2type[k], conf = parse_arrangement(v)
+            if conf != None:
+                site_confs[k] = conf
+        layouts = self.site_layouts(site_confs)
+        self.emit_runtime_init(site_confs, instance_rules)
         header_start = (
             "#ifndef __DYLINX_ITERATE_LOCK_COMB__\n"
             "#define __DYLINX_ITERATE_LOCK_COMB__\n"
@@ -191,7 +714,7 @@ class BaseSubject(metaclass=abc.ABCMeta):
         for cu_id in self.extra_init_cu:
             macro_defs.append(f"void __dylinx_cu_init_{cu_id}_(void);")
         for i, e in self.entities.items():
-            self.init_mapping.get(e["modification_type"], lambda i, i2t, e, m: None)(i, id2type, self.entities, macro_defs)
+            self.init_mapping.get(e["modification_type"], lambda i, i2t, e, m, l: None)(i, id2type, self.entities, macro_defs, layouts)
         with open(f"{self.glue_dir}/glue/dylinx-runtime-config.h", "w") as rt_config:
             content = '\n'.join(macro_defs)
             rt_config.write(f"{header_start}\n{content}\n{header_end}")
@@ -274,6 +797,21 @@ class _LockOp:
     def __str__(self):
         return f"(site, ins) = {self.site_id, self.ins_id}, op: {self.op}, tid: {self.tid}, enter_ts: {self.enter_tsc}, exit_ts: {self.exit_tsc}"
 
+# An acquisition or release read from a binary trace, shaped like _LockOp.
+# tid is the thread index the trace assigned, not the kernel's.
+class _TracedLockOp:
+    def __init__(self, op, event, pid, weight=1):
+        self.op = op
+        self.weight = weight
+        self.affined_cpu = int(event["cpu"])
+        self.tid = int(event["thread"])
+        self.pid = pid
+        self.site_id = int(event["site_id"])
+        self.ins_id = int(event["ins_id"])
+        self.exit_tsc = int(event["tsc"])
+        self.enter_tsc = self.exit_tsc - int(event["delta"]) if op == OpKind.ENABLE else self.exit_tsc
+        self.duration = self.exit_tsc - self.enter_tsc
+
 class DylinxLockCycle:
     def __init__(self, enable, disable):
         assert(enable.site_id == disable.site_id)
@@ -292,6 +830,8 @@ class DylinxLockCycle:
         self.attempt = enable.enter_tsc
         self.acquire = enable.exit_tsc
         self.release = disable.enter_tsc
+        # Acquisitions this cycle stands for in a sampled trace.
+        self.weight = getattr(enable, "weight", 1)
 
     def serialize(self):
         pass
@@ -317,7 +857,7 @@ class SiteFluctuation:
         timeline_len = self.e_tick - self.s_tick + 1
         y = np.zeros(timeline_len)
         for cycle in self.involve_cycles:
-            y[cycle.attempt - self.s_tick: cycle.release - self.s_tick] += 1
+            y[cycle.attempt - self.s_tick: cycle.release - self.s_tick] += cycle.weight
         self.y_raw = np.copy(y)
         if not get_stable:
             return
@@ -338,7 +878,58 @@ def pair_first(operations):
     return front, None
 
 class DylinxRuntimeReport:
-    def __init__(self, xray_path, drop_useless=False):
+    # trace_path is either a binary trace from enable_trace or the YAML of
+    # llvm-xray convert.
+    def __init__(self, trace_path, drop_useless=False):
+        self.overhead = None
+        with open(trace_path, "rb") as trace_file:
+            is_binary = trace_file.read(len(TRACE_MAGIC)) == TRACE_MAGIC
+        if is_binary:
+            self.cycles, self.site2ins = self.load_binary_trace(trace_path)
+        else:
+            self.cycles, self.site2ins = self.load_xray_trace(trace_path, drop_useless)
+        self.s_tick = min(self.cycles, key=lambda c: c.attempt).attempt
+        self.e_tick = max(self.cycles, key=lambda c: c.release).release
+        self.timeline_len = self.e_tick - self.s_tick + 1
+        self.site2fluc = None
+
+    # Sampled cycles are weighed by their period, and a windowed trace is
+    # scaled by the share of acquisitions its windows saw. overhead is what
+    # sampling cost per acquisition in cycles, None for a full trace.
+    def load_binary_trace(self, trace_path):
+        with open(trace_path, "rb") as trace_file:
+            header = struct.unpack(TRACE_HEADER, trace_file.read(struct.calcsize(TRACE_HEADER)))
+        n_dropped, pid = header[4], header[9]
+        n_seen, n_seen_open, overhead_cyc = header[11], header[12], header[13]
+        if n_dropped:
+            logging.warning(f"trace {trace_path} dropped {n_dropped} events, cycles may be missing")
+        scale = n_seen / n_seen_open if n_seen_open else 1
+        self.overhead = overhead_cyc / n_seen if n_seen else None
+        # A subject that died leaves the header unfinished, so the events are
+        # counted from the file size.
+        n_event = (os.path.getsize(trace_path) - TRACE_HEADER_SIZE) // TRACE_EVENT.itemsize
+        events = np.memmap(trace_path, dtype=TRACE_EVENT, mode="r", offset=TRACE_HEADER_SIZE, shape=(n_event,))
+        cycles, site2ins, held = [], {}, {}
+        # Period in force at the last sample and the latest one, per thread
+        # and site.
+        period, pending = {}, {}
+        for event in events:
+            key = (int(event["thread"]), int(event["site_id"]), int(event["ins_id"]))
+            op = int(event["op"])
+            if op == TRACE_RATE:
+                pending[key[:2]] = int(event["delta"])
+                continue
+            if op != TRACE_RELEASE:
+                weight = period.get(key[:2], 1) * scale
+                period[key[:2]] = pending.get(key[:2], period.get(key[:2], 1))
+            if op in [TRACE_ACQUIRE, TRACE_REACQUIRE]:
+                held[key] = _TracedLockOp(OpKind.ENABLE, event, pid, weight)
+                site2ins.setdefault(key[1], set()).add(key[2])
+            elif op == TRACE_RELEASE and key in held:
+                cycles.append(DylinxLockCycle(held.pop(key), _TracedLockOp(OpKind.DISABLE, event, pid)))
+        return cycles, site2ins
+
+    def load_xray_trace(self, xray_path, drop_useless):
         pattern = re.compile(r"- { type: 0, func-id: \d+, function: dlx_forward_(enable|disable),(?: args: \[ (\d+) \],)? cpu: (\d*), thread: (\d*). process: (\d*), kind: function-(enter\-arg|exit), tsc: (\d*), data: '' }")
         with open(xray_path) as xray_file:
             xray_log = xray_file.read()
@@ -348,24 +939,31 @@ class DylinxRuntimeReport:
         assert(len(pid) == 1) # xray log should contain only single main thread.
         main_tid = list(pid)[0]
         threads = {t.tid for t in traces}
-        self.cycles = []
+        cycles = []
         for tid in threads:
             traces_by_tid = list(filter(lambda trace: trace.tid == tid, traces))
-            self.cycles = self.cycles + self.pair_thread_traces(traces_by_tid, drop_useless)
+            cycles = cycles + self.pair_thread_traces(traces_by_tid, drop_useless)
 
-        self.site2ins = {}
+        site2ins = {}
         for trace in filter(lambda t: isinstance(t, _HeadTrace), traces):
             site_id = trace.site_id
             ins_id = trace.ins_id
-            if site_id not in self.site2ins.keys():
-                self.site2ins[site_id] = {ins_id}
+            if site_id not in site2ins.keys():
+                site2ins[site_id] = {ins_id}
             else:
-                self.site2ins[site_id].add(ins_id)
+                site2ins[site_id].add(ins_id)
+        return cycles, site2ins
 
-        self.s_tick = min(self.cycles, key=lambda c: c.attempt).attempt
-        self.e_tick = max(self.cycles, key=lambda c: c.release).release
-        self.timeline_len = self.e_tick - self.s_tick + 1
-        self.site2fluc = None
+    # Total time spent waiting per instance of a site.
+    def instance_contention(self, site_id):
+        wait = {}
+        for cycle in filter(lambda c: c.site_id == site_id, self.cycles):
+            wait[cycle.ins_id] = wait.get(cycle.ins_id, 0) + cycle.rel_wait * cycle.weight
+        return wait
+
+    def hot_instances(self, site_id, top_n):
+        wait = self.instance_contention(site_id)
+        return sorted(wait.keys(), key=lambda i: -wait[i])[:top_n]
 
     def pair_thread_traces(self, traces, drop_useless):
         sorted_traces = sorted(traces, key=lambda t: t.tsc)
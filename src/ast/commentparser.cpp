@@ -1,6 +1,5 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/AST/ASTConsumer.h"
-#include "clang/AST/RecordLayout.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/Expr.h"
@@ -67,6 +66,48 @@ using namespace clang::tooling;
 using namespace clang::ast_matchers;
 namespace fs = std::filesystem;
 
+namespace clang {
+namespace ast_matchers {
+// Spelling based matchers covering every primitive in getPluggableKinds().
+AST_MATCHER(QualType, isPluggableType) {
+  std::string type_name = Node.getAsString();
+  return lookupPluggableKind(type_name) && type_name.back() != '*';
+}
+
+AST_MATCHER(QualType, isPluggablePtrType) {
+  std::string type_name = Node.getAsString();
+  return lookupPluggableKind(type_name) && type_name.back() == '*';
+}
+} // namespace ast_matchers
+} // namespace clang
+
+// Resolve the pluggable kind of a declared type while looking through
+// user aliases of the native pthread types. Declarations only matched by
+// the __pthread_mutex_s layout fall back to the mutex kind.
+const PluggableKind *kind_of_type(QualType type) {
+  QualType cur = type.getUnqualifiedType();
+  while (true) {
+    if (const PluggableKind *kind = lookupPluggableKind(cur.getAsString()))
+      return kind;
+    const TypedefType *alias = cur->getAs<TypedefType>();
+    if (!alias)
+      break;
+    cur = alias->getDecl()->getUnderlyingType().getUnqualifiedType();
+  }
+  if (const PluggableKind *kind = lookupPluggableKind(type.getCanonicalType().getUnqualifiedType().getAsString()))
+    return kind;
+  return lookupPluggableKind(MUTEX_NATIVE_TYPE);
+}
+
+// Matches "<native type> [<size>]" for every pluggable kind. The size
+// expression is captured by the second group.
+std::regex pluggable_array_pattern() {
+  std::string alternatives;
+  for (const PluggableKind& kind: getPluggableKinds())
+    alternatives += (alternatives.empty()? "": "|") + kind.native_type;
+  return std::regex("(" + alternatives + ") \\[(.+)\\]");
+}
+
 // Use tuple with four elements as unique ID
 // 1. file path
 // 2. line number
@@ -112,36 +153,44 @@ const Token *move2n_token(SourceLocation loc, uint32_t n, SourceManager& sm, con
   return token;
 }
 
+// Collects the lock fields of recr, nested structs included, each with
+// the designator offsetof takes to find it, e.g. "inner.mtx". The offsets
+// are left to the compiler since the rewritten struct is laid out anew:
+// a spinlock becomes a Dylinx header far larger than pthread_spinlock_t,
+// so ASTRecordLayout of the original struct misplaces every field after it.
 void traverse_init_fields_with_offset(
   const RecordDecl *recr,
-  std::vector<std::tuple<uint64_t, uint32_t, std::string, uint32_t, uint32_t>>& init_params,
-  uint64_t cur_offset,
+  std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t, uint32_t>>& init_params,
+  std::string prefix,
   ASTContext& ctx)
 {
   if (recr->isInvalidDecl())
 	return;
-  const ASTRecordLayout& layout = ctx.getASTRecordLayout(recr);
   SourceManager& sm = ctx.getSourceManager();
-  std::regex array_ptn("pthread_mutex_t \\[(.+)\\]");
+  std::regex array_ptn = pluggable_array_pattern();
   std::smatch match_result;
   for (auto iter = recr->field_begin(); iter != recr->field_end(); iter++) {
     const clang::Type *t = iter->getType().getTypePtr();
     std::string type_name = t->getCanonicalTypeInternal().getAsString();
+    // Members of an anonymous struct are named as members of recr.
+    std::string designator = prefix;
+    if (!iter->getNameAsString().empty())
+      designator = prefix.empty()? iter->getNameAsString(): prefix + "." + iter->getNameAsString();
     std::regex_match(type_name, match_result, array_ptn);
-    if (t->isStructureType() && type_name != "pthread_mutex_t") {
+    if (t->isStructureType() && !lookupPluggableKind(type_name)) {
       traverse_init_fields_with_offset(
         t->getAsStructureType()->getDecl(),
         init_params,
-        cur_offset + layout.getFieldOffset(iter->getFieldIndex()),
+        designator,
         ctx
       );
     }
-    else if (type_name == "pthread_mutex_t") {
+    else if (lookupPluggableKind(type_name)) {
       SourceLocation begin_loc = sm.getFileLoc(iter->getBeginLoc());
       const FileEntry *fentry = sm.getFileEntryForID(sm.getFileID(begin_loc));
       init_params.push_back(
         std::make_tuple(
-          cur_offset + layout.getFieldOffset(iter->getFieldIndex()),
+          designator,
           1,
           iter->getNameAsString(),
           fentry->getUID(),
@@ -154,8 +203,8 @@ void traverse_init_fields_with_offset(
 
       init_params.push_back(
         std::make_tuple(
-          cur_offset + layout.getFieldOffset(iter->getFieldIndex()),
-          std::stoi(match_result.str(1)),
+          designator,
+          std::stoi(match_result.str(2)),
           iter->getNameAsString(),
           fentry->getUID(),
           sm.getSpellingLineNumber(begin_loc)
@@ -176,11 +225,11 @@ void traverse_init_fields_with_name(
   for (auto iter = recr->field_begin(); iter != recr->field_end(); iter++) {
     const clang::Type *t = iter->getType().getTypePtr();
     std::string type_name = t->getCanonicalTypeInternal().getAsString();
-    if (t->isStructureType() && type_name != "pthread_mutex_t") {
+    if (t->isStructureType() && !lookupPluggableKind(type_name)) {
       field_seq.push_back(iter->getNameAsString());
       traverse_init_fields_with_name(t->getAsStructureType()->getDecl(), init_params, field_seq, sm);
     }
-    else if (type_name == "pthread_mutex_t") {
+    else if (lookupPluggableKind(type_name)) {
       std::string prefix = "";
       SourceLocation begin_loc = sm.getFileLoc(iter->getBeginLoc());
       const FileEntry *fentry = sm.getFileEntryForID(sm.getFileID(begin_loc));
@@ -345,7 +394,9 @@ public:
     );
 
     // Decouple type replacement
-    if (vd && vd->getType().getAsString() == "pthread_mutex_t *") {
+    const PluggableKind *ptr_kind = vd? lookupPluggableKind(vd->getType().getAsString()): nullptr;
+    if (vd && vd->getType()->isPointerType() && ptr_kind) {
+      std::string generic_ptr = ptr_kind->generic_type + " *";
       SourceLocation type_start = vd->getTypeSpecStartLoc();
       SourceLocation type_end = vd->getTypeSpecEndLoc();
       if (RawComment *comment = result.Context->getRawCommentForDeclNoCache(vd))
@@ -353,19 +404,19 @@ public:
       if (type_start.isValid() && type_start.isMacroID() && sm.isAtStartOfImmediateMacroExpansion(type_start)) {
         Dylinx::Instance().rw_ptr->ReplaceText(
           sm.getImmediateExpansionRange(type_start).getAsRange(),
-          "dlx_generic_lock_t *"
+          generic_ptr
         );
       } else {
         Dylinx::Instance().rw_ptr->ReplaceText(
           SourceRange(type_start, type_end),
-          "dlx_generic_lock_t *"
+          generic_ptr
         );
       }
     }
 
     if (const UnaryExprOrTypeTraitExpr *sizeof_expr = result.Nodes.getNodeAs<UnaryExprOrTypeTraitExpr>("sizeofExpr")) {
-      std::vector<std::tuple<uint64_t, uint32_t, std::string, uint32_t, uint32_t>> init_params;
-      if (arg_type.getAsString() == "pthread_mutex_t") {
+      std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t, uint32_t>> init_params;
+      if (const PluggableKind *kind = lookupPluggableKind(arg_type.getAsString())) {
 #ifdef __DYLINX_DEBUG__
       DEBUG_LOG(MallocMutex, vd, sm);
 #endif
@@ -376,17 +427,17 @@ public:
             ),
             sizeof_expr->getRParenLoc().getLocWithOffset(-1)
           ),
-          "dlx_generic_lock_t"
+          kind->generic_type
         );
         meta["modification_type"] = MUTEX_MEM_ALLOCATION;
+        meta["lock_kind"] = kind->name;
       } else {
 #ifdef __DYLINX_DEBUG__
       DEBUG_LOG(MallocStruct, vd, sm);
 #endif
-        uint64_t cur_offset = 0; // offset unit is bit instead of byte.
         traverse_init_fields_with_offset(
           arg_type->getUnqualifiedDesugaredType()->getAsRecordDecl(),
-          init_params, cur_offset, *result.Context
+          init_params, std::string(), *result.Context
         );
         if (!init_params.size())
           return;
@@ -397,9 +448,8 @@ public:
         // Deal with compound literal (3rd argument)
         std::string comp_liter = "((uint32_t []) {";
         for (auto it = init_params.begin(); it != init_params.end(); it++) {
-          char format[100];
-          sprintf(format, " %lu, %u%s", std::get<0>(*it) / 8, std::get<1>(*it), it == init_params.end() - 1? " ": ",");
-          comp_liter = comp_liter + std::string(format);
+          comp_liter = comp_liter + " offsetof(" + arg_type.getAsString() + ", " + std::get<0>(*it) + "), " +
+            std::to_string(std::get<1>(*it)) + (it == init_params.end() - 1? " ": ",");
           YAML::Node member_info;
           member_info["field_name"] = std::get<2>(*it);
           member_info["fentry_uid"] = std::get<3>(*it);
@@ -446,18 +496,19 @@ public:
           );
         }
 
-        // Aggregate whole init function call
-        char replace_expr[300];
+        // Aggregate whole init function call, the compound literal has no
+        // bound on its length.
+        char init_args[300];
         sprintf(
-          replace_expr,
-          "__dylinx_object_init_(%s, %s, %lu, ((DYLINX_LOCK_TYPE_%d *)0), DYLINX_LOCK_INIT_%d, DYLINX_LOCK_OBJ_INDICATOR_%d);",
-          bites_args,
-          init_params.size()? comp_liter.c_str(): "NULL",
+          init_args,
+          ", %lu, ((DYLINX_LOCK_TYPE_%d *)0), DYLINX_LOCK_INIT_%d, DYLINX_LOCK_OBJ_INDICATOR_%d);",
           init_params.size(),
           Dylinx::Instance().lock_i,
           Dylinx::Instance().lock_i,
           Dylinx::Instance().lock_i
         );
+        std::string replace_expr = std::string("__dylinx_object_init_(") + bites_args + ", " +
+          (init_params.size()? comp_liter: std::string("NULL")) + init_args;
         Dylinx::Instance().rw_ptr->ReplaceText(
           SourceRange(
             call_expr->getBeginLoc(),
@@ -472,6 +523,42 @@ public:
   }
 };
 
+// Objects from __dylinx_object_init_ go back through the glue, which
+// destroys the locks left in them. Only pointers to a lock or to a struct
+// holding locks can be such objects, every other free stays the subject's.
+class FreeMatchHandler: public MatchFinder::MatchCallback {
+public:
+  FreeMatchHandler() {}
+  virtual void run(const MatchFinder::MatchResult &result) {
+    const CallExpr *call_expr = result.Nodes.getNodeAs<CallExpr>("release_call");
+    if (!call_expr)
+      return;
+    SourceManager& sm = result.Context->getSourceManager();
+    const Expr *callee = call_expr->getCallee();
+    if (callee->getBeginLoc().isMacroID() || sm.isInSystemHeader(callee->getBeginLoc()))
+      return;
+#ifdef __DYLINX_DEBUG__
+    DEBUG_LOG(FreeObject, call_expr, sm);
+#endif
+    QualType pointee = call_expr->getArg(0)->IgnoreParenImpCasts()->getType()->getPointeeType();
+    if (!lookupPluggableKind(pointee.getAsString())) {
+      const RecordDecl *recr = pointee->getUnqualifiedDesugaredType()->getAsRecordDecl();
+      std::vector<std::tuple<std::string, uint32_t, std::string, uint32_t, uint32_t>> init_params;
+      if (!recr)
+        return;
+      traverse_init_fields_with_offset(recr, init_params, std::string(), *result.Context);
+      if (!init_params.size())
+        return;
+    }
+    std::string name = call_expr->getDirectCallee()->getNameInfo().getAsString();
+    Dylinx::Instance().rw_ptr->ReplaceText(
+      callee->getSourceRange(),
+      name == std::string("free")? "dlx_obj_free": "dlx_obj_realloc"
+    );
+    save2altered_list(sm.getFileID(sm.getFileLoc(callee->getBeginLoc())), sm);
+  }
+};
+
 //! TODO
 // buggy for global array handling.
 // 1. Assume there is no consecutive declaration as following.
@@ -523,8 +610,10 @@ public:
       char type_macro[50];
       sprintf(type_macro, "DYLINX_LOCK_TYPE_%d", Dylinx::Instance().lock_i);
       SourceLocation type_start = d->getTypeSpecStartLoc();
-      Dylinx::Instance().rw_ptr->ReplaceText(type_start, 15, type_macro);
+      const PluggableKind *kind = kind_of_type(d->getType()->getAsArrayTypeUnsafe()->getElementType());
+      Dylinx::Instance().rw_ptr->ReplaceText(type_start, kind->native_type.length(), type_macro);
       alloca["name"] = d->getNameAsString();
+      alloca["lock_kind"] = kind->name;
 
       if (d->getStorageClass() == StorageClass::SC_Extern) {
         alloca["modification_type"] = EXTERN_ARR_SYMBOL;
@@ -581,11 +670,11 @@ public:
       SourceLocation begin_loc = d->getBeginLoc();
       const Token *token = move2n_token(begin_loc, 1, sm, result.Context->getLangOpts());
       FileID src_id = sm.getFileID(begin_loc);
-      char format[100];
+      const PluggableKind *kind = lookupPluggableKind(d->getUnderlyingType().getAsString());
       Dylinx::Instance().rw_ptr->ReplaceText(
         token->getLocation(),
         token->getLength(),
-        "dlx_generic_lock_t *"
+        kind->generic_type + " *"
       );
       save2altered_list(src_id, sm);
     }
@@ -637,9 +726,22 @@ public:
         decl_loc["record_name"] = recr_name;
       std::string field_name = fd->getNameAsString();
       decl_loc["field_name"] = field_name;
-      char format[50];
-      sprintf(format, "DYLINX_LOCK_TYPE_%d", Dylinx::Instance().lock_i);
+      // Fields holding a lock also get an alignment hook, which the runtime
+      // config fills in for sites that co-locate the lock with its data.
+      char format[100];
+      if (fd->getType()->isPointerType())
+        sprintf(format, "DYLINX_LOCK_TYPE_%d", Dylinx::Instance().lock_i);
+      else
+        sprintf(format, "DYLINX_LOCK_ALIGN_%d DYLINX_LOCK_TYPE_%d", Dylinx::Instance().lock_i, Dylinx::Instance().lock_i);
       const SourceLocation type_start = fd->getTypeSpecStartLoc();
+      QualType field_type = fd->getType();
+      decl_loc["is_pointer"] = field_type->isPointerType();
+      if (field_type->isArrayType())
+        field_type = field_type->getAsArrayTypeUnsafe()->getElementType();
+      else if (field_type->isPointerType())
+        field_type = field_type->getPointeeType();
+      const PluggableKind *kind = kind_of_type(field_type);
+      decl_loc["lock_kind"] = kind->name;
       if (type_start.isMacroID()) {
         Dylinx::Instance().rw_ptr->ReplaceText(
           sm.getImmediateExpansionRange(type_start).getAsRange(),
@@ -650,15 +752,15 @@ public:
       else {
         if (fd->getType()->isArrayType()) {
           std::smatch sm;
-          std::regex ptn("pthread_mutex_t \\[(.+)\\]");
+          std::regex ptn = pluggable_array_pattern();
           std::string type_str = fd->getType().getAsString();
           std::regex_match(type_str, sm, ptn);
           Dylinx::Instance().rw_ptr->ReplaceText(
-            type_start, 15, format
+            type_start, kind->native_type.length(), format
           );
-          printf("matched size is %d %s\n", sm.size(), sm.str(1).c_str());
+          printf("matched size is %d %s\n", sm.size(), sm.str(2).c_str());
           decl_loc["modification_type"] = FIELD_ARRAY;
-          decl_loc["size"] = sm.str(1).c_str();
+          decl_loc["size"] = sm.str(2).c_str();
         } else {
           decl_loc["modification_type"] = FIELD_INSERT;
           Dylinx::Instance().rw_ptr->ReplaceText(
@@ -690,7 +792,7 @@ public:
       SourceLocation begin_loc = sm.getFileLoc(vd->getBeginLoc());
       FileID src_id = sm.getFileID(begin_loc);
       const FileEntry *fentry = sm.getFileEntryForID(src_id);
-      if (sm.isInSystemHeader(begin_loc) || recr_name == "pthread_mutex_t")
+      if (sm.isInSystemHeader(begin_loc) || lookupPluggableKind(recr_name))
         return;
       fs::path src_path = fentry->getName().str();
       EntityID uid = std::make_tuple(
@@ -823,7 +925,9 @@ private:
     "pthread_mutex_init",
     "pthread_mutex_lock",
     "pthread_mutex_unlock",
-    "pthread_mutex_destroy"
+    "pthread_mutex_destroy",
+    "pthread_mutex_trylock",
+    "pthread_mutex_timedlock"
   };
 };
 
@@ -892,6 +996,7 @@ public:
       if (RawComment *comment = result.Context->getRawCommentForDeclNoCache(d))
         meta["lock_combination"] = parse_comment(comment->getBriefText(*result.Context));
       meta["modification_type"] = VAR_ALLOCA_TYPE;
+      meta["lock_kind"] = kind_of_type(d->getType())->name;
       Dylinx::Instance().cu_gvars[var_name] = std::make_tuple(
         sm.getFileEntryForID(src_id)->getUID(),
         sm.getSpellingLineNumber(type_loc)
@@ -953,13 +1058,14 @@ public:
 #endif
       SourceLocation begin_loc = cast_expr->getLParenLoc();
       SourceLocation end_loc = cast_expr->getRParenLoc();
+      std::string generic_ptr = lookupPluggableKind(cast_expr->getType().getAsString())->generic_type + " *";
       if (begin_loc.isMacroID()) {
         Dylinx::Instance().rw_ptr->ReplaceText(
           SourceRange(
             sm.getSpellingLoc(begin_loc).getLocWithOffset(1),
             sm.getSpellingLoc(end_loc).getLocWithOffset(-1)
           ),
-          "dlx_generic_lock_t *"
+          generic_ptr
         );
         begin_loc = sm.getSpellingLoc(begin_loc);
       }
@@ -969,7 +1075,7 @@ public:
             cast_expr->getLParenLoc().getLocWithOffset(1),
             cast_expr->getRParenLoc().getLocWithOffset(-1)
           ),
-          "dlx_generic_lock_t *"
+          generic_ptr
         );
       }
       FileID src_id = sm.getFileID(begin_loc);
@@ -1015,20 +1121,69 @@ public:
           "#define pthread_mutex_unlock pthread_mutex_unlock_original\n"
           "#define pthread_mutex_destroy pthread_mutex_destroy_original\n"
           "#define pthread_mutex_trylock pthread_mutex_trylock_original\n"
+          "#define pthread_mutex_timedlock pthread_mutex_timedlock_original\n"
           "#define pthread_cond_wait pthread_cond_wait_original\n"
           "#define pthread_cond_timedwait pthread_cond_timedwait_original\n"
+          "#define pthread_rwlock_init pthread_rwlock_init_original\n"
+          "#define pthread_rwlock_rdlock pthread_rwlock_rdlock_original\n"
+          "#define pthread_rwlock_wrlock pthread_rwlock_wrlock_original\n"
+          "#define pthread_rwlock_tryrdlock pthread_rwlock_tryrdlock_original\n"
+          "#define pthread_rwlock_trywrlock pthread_rwlock_trywrlock_original\n"
+          "#define pthread_rwlock_unlock pthread_rwlock_unlock_original\n"
+          "#define pthread_rwlock_destroy pthread_rwlock_destroy_original\n"
+          "#define pthread_spin_init pthread_spin_init_original\n"
+          "#define pthread_spin_lock pthread_spin_lock_original\n"
+          "#define pthread_spin_trylock pthread_spin_trylock_original\n"
+          "#define pthread_spin_unlock pthread_spin_unlock_original\n"
+          "#define pthread_spin_destroy pthread_spin_destroy_original\n"
+          "#define pthread_barrier_init pthread_barrier_init_original\n"
+          "#define pthread_barrier_wait pthread_barrier_wait_original\n"
+          "#define pthread_barrier_destroy pthread_barrier_destroy_original\n"
+          "#define sem_init sem_init_original\n"
+          "#define sem_wait sem_wait_original\n"
+          "#define sem_trywait sem_trywait_original\n"
+          "#define sem_timedwait sem_timedwait_original\n"
+          "#define sem_post sem_post_original\n"
+          "#define sem_getvalue sem_getvalue_original\n"
+          "#define sem_destroy sem_destroy_original\n"
         );
         Dylinx::Instance().rw_ptr->InsertText(
           header.getLocWithOffset(std::string("<pthread.h>").length() + 1),
+          "#include <semaphore.h>\n"
           "#undef pthread_mutex_init\n"
           "#undef pthread_mutex_lock\n"
           "#undef pthread_mutex_unlock\n"
           "#undef pthread_mutex_destroy\n"
           "#undef pthread_mutex_trylock\n"
+          "#undef pthread_mutex_timedlock\n"
           "#undef pthread_cond_wait\n"
           "#undef pthread_cond_timedwait\n"
+          "#undef pthread_rwlock_init\n"
+          "#undef pthread_rwlock_rdlock\n"
+          "#undef pthread_rwlock_wrlock\n"
+          "#undef pthread_rwlock_tryrdlock\n"
+          "#undef pthread_rwlock_trywrlock\n"
+          "#undef pthread_rwlock_unlock\n"
+          "#undef pthread_rwlock_destroy\n"
+          "#undef pthread_spin_init\n"
+          "#undef pthread_spin_lock\n"
+          "#undef pthread_spin_trylock\n"
+          "#undef pthread_spin_unlock\n"
+          "#undef pthread_spin_destroy\n"
+          "#undef pthread_barrier_init\n"
+          "#undef pthread_barrier_wait\n"
+          "#undef pthread_barrier_destroy\n"
+          "#undef sem_init\n"
+          "#undef sem_wait\n"
+          "#undef sem_trywait\n"
+          "#undef sem_timedwait\n"
+          "#undef sem_post\n"
+          "#undef sem_getvalue\n"
+          "#undef sem_destroy\n"
           "#undef PTHREAD_MUTEX_INITIALIZER\n"
           "#define PTHREAD_MUTEX_INITIALIZER {NULL, 0, {0XABADBABE, 0xFEE1DEAD}, NULL, {0}}\n"
+          "#undef PTHREAD_RWLOCK_INITIALIZER\n"
+          "#define PTHREAD_RWLOCK_INITIALIZER {NULL, 0, {0XABADBABE, 0xFEE1DEAD}, NULL, {0}}\n"
           "#include \"dylinx-glue.h\"\n"
           "#include \"dylinx-runtime-config.h\"\n"
           "#endif //__DYLINX_REPLACE_PTHREAD_NATIVE__\n"
@@ -1041,6 +1196,10 @@ public:
     //
     //    a. pthread_mutex_t mutex;
     //    b. pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    //    c. pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+    //    d. pthread_spinlock_t spin;
+    //    e. pthread_barrier_t barrier;
+    //    f. sem_t sem;
     //
     // and handle all the matched pattern into two ways. If the
     // instance locates in local scope(able to conduct expression
@@ -1056,11 +1215,14 @@ public:
 #endif
     matcher.addMatcher(
       varDecl(
-        hasType(hasUnqualifiedDesugaredType(recordType(
-          hasDeclaration(recordDecl(has(fieldDecl(hasType(asString("struct __pthread_mutex_s"))))))
-        ))),
+        anyOf(
+          hasType(hasUnqualifiedDesugaredType(recordType(
+            hasDeclaration(recordDecl(has(fieldDecl(hasType(asString("struct __pthread_mutex_s"))))))
+          ))),
+          hasType(isPluggableType())
+        ),
         optionally(has(
-          initListExpr(hasSyntacticForm(hasType(asString("pthread_mutex_t")))).bind("init_macro")
+          initListExpr(hasSyntacticForm(hasType(isPluggableType()))).bind("init_macro")
         ))).bind("vars"),
       &handler_for_vars
     );
@@ -1070,7 +1232,7 @@ public:
     // and convert them to
     //    DYLINX_LOCK_TYPE_1 locks[NUM_LOCK]; __dylinx_array_init_(locks, NUM_LOCK);
     matcher.addMatcher(
-      varDecl(hasType(arrayType(hasElementType(qualType(asString("pthread_mutex_t")))))).bind("array_decls"),
+      varDecl(hasType(arrayType(hasElementType(qualType(isPluggableType()))))).bind("array_decls"),
       &handler_for_array
     );
 
@@ -1082,7 +1244,7 @@ public:
     //    typedef generic_interface_t *MyLock
     matcher.addMatcher(
       typedefDecl(
-        hasType(asString("pthread_mutex_t *"))
+        hasType(isPluggablePtrType())
       ).bind("typedefs"),
       &handler_for_typedef
     );
@@ -1096,7 +1258,7 @@ public:
     matcher.addMatcher(
       varDecl(
         anyOf(
-          hasType(asString("pthread_mutex_t *")),
+          hasType(isPluggablePtrType()),
           hasType(pointerType(pointee(hasUnqualifiedDesugaredType(recordType()))))
         ),
         optionally(anyOf(
@@ -1104,7 +1266,7 @@ public:
             callExpr(
               callee(functionDecl(hasName("malloc"))),
               anyOf(
-                hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(asString("pthread_mutex_t")))).bind("sizeofExpr")),
+                hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(isPluggableType()))).bind("sizeofExpr")),
                 hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(
                   hasUnqualifiedDesugaredType(recordType(hasDeclaration(recordDecl(has(fieldDecl())))))
                 )).bind("sizeofExpr"))
@@ -1115,7 +1277,7 @@ public:
             callExpr(
               callee(functionDecl(hasName("calloc"))),
               anyOf(
-                hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(asString("pthread_mutex_t")))).bind("sizeofExpr")),
+                hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(isPluggableType()))).bind("sizeofExpr")),
                 hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(
                   hasUnqualifiedDesugaredType(recordType(hasDeclaration(recordDecl(has(fieldDecl())))))
                 )).bind("sizeofExpr"))
@@ -1135,7 +1297,7 @@ public:
            callExpr(
             callee(functionDecl(hasName("malloc"))),
             anyOf(
-              hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(asString("pthread_mutex_t")))).bind("sizeofExpr")),
+              hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(isPluggableType()))).bind("sizeofExpr")),
               hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(
                 hasUnqualifiedDesugaredType(recordType(hasDeclaration(recordDecl(has(fieldDecl())))))
               )).bind("sizeofExpr"))
@@ -1144,7 +1306,7 @@ public:
           hasRHS(hasDescendant(
             callExpr(callee( functionDecl(hasName("calloc"))),
             anyOf(
-              hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(asString("pthread_mutex_t")))).bind("sizeofExpr")),
+              hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(qualType(isPluggableType()))).bind("sizeofExpr")),
               hasDescendant(unaryExprOrTypeTraitExpr(hasArgumentOfType(
                 hasUnqualifiedDesugaredType(recordType(hasDeclaration(recordDecl(has(fieldDecl())))))
               )).bind("sizeofExpr"))
@@ -1155,6 +1317,24 @@ public:
       &handler_for_malloc
     );
 
+    // Match all
+    //    free(obj);
+    //    obj = realloc(obj, n);
+    // where obj points to a lock or to a struct holding locks, and
+    // convert them to
+    //    dlx_obj_free(obj);
+    //    obj = dlx_obj_realloc(obj, n);
+    matcher.addMatcher(
+      callExpr(
+        callee(functionDecl(hasAnyName("free", "realloc"))),
+        hasArgument(0, ignoringParenImpCasts(expr(anyOf(
+          hasType(isPluggablePtrType()),
+          hasType(pointerType(pointee(hasUnqualifiedDesugaredType(recordType()))))
+        ))))
+      ).bind("release_call"),
+      &handler_for_free
+    );
+
     // Match all struct with pthred_mutex_t or pthread_mutex_t *
     // member
     //
@@ -1171,14 +1351,14 @@ public:
     //    };
     matcher.addMatcher(
       fieldDecl(eachOf(
-        hasType(asString("pthread_mutex_t")),
-        hasType(asString("pthread_mutex_t *")),
+        hasType(isPluggableType()),
+        hasType(isPluggablePtrType()),
         hasType(hasUnqualifiedDesugaredType(recordType(
           hasDeclaration(recordDecl(
             has(fieldDecl(hasType(asString("struct __pthread_mutex_s"))))
           ))
         ))),
-        hasType(arrayType(hasElementType(asString("pthread_mutex_t"))))
+        hasType(arrayType(hasElementType(isPluggableType())))
       )).bind("struct_members"),
       &handler_for_struct
     );
@@ -1213,7 +1393,7 @@ public:
         optionally(
         forEachDescendant(
           initListExpr(hasSyntacticForm(
-            hasType(asString("pthread_mutex_t"))
+            hasType(isPluggableType())
           )).bind("struct_member_init")
         ))
       ).bind("struct_instance"),
@@ -1243,7 +1423,7 @@ public:
     );
 
     matcher.addMatcher(
-      cStyleCastExpr(hasDestinationType(asString("pthread_mutex_t *")))
+      cStyleCastExpr(hasDestinationType(isPluggablePtrType()))
       .bind("casting"),
       &handler_for_casting
     );
@@ -1261,6 +1441,7 @@ private:
   MatchFinder matcher;
   VarsMatchHandler handler_for_vars;
   MallocMatchHandler handler_for_malloc;
+  FreeMatchHandler handler_for_free;
   ArrayMatchHandler handler_for_array;
   TypedefMatchHandler handler_for_typedef;
   PtrRefMatchHandler handler_for_ref;
@@ -1,17 +1,70 @@
 #include <string>
 #include <vector>
 
-#define LOCK_LIST "TTAS", "PTHREADMTX", "BACKOFF", "ADAPTIVEMTX", "MCS", "CBOMCS"
+#define LOCK_LIST "TTAS", "PTHREADMTX", "BACKOFF", "ADAPTIVEMTX", "MCS", "CBOMCS", \
+  "TICKET", "QSPINLOCK", "PTHREADRW", "WPREFRW", "BIGREADERRW", "BRAVORW", \
+  "PTHREADBARRIER", "SENSEBARRIER", "TREEBARRIER", "TOURNBARRIER", "DISSEMBARRIER", \
+  "POSIXSEM", "SPINPARKSEM", "BATCHSEM", "PERCPUSEM"
+
+// Waiting policies that may follow a lock type, as in MCS+PARK or
+// TTAS+BACKOFF(64,4096). See dylinx-conf.h for their meaning.
+#define WAIT_LIST "SPIN", "BACKOFF", "YIELD", "PARK", "TSC"
+
+#define MUTEX_KIND "MUTEX"
+#define RWLOCK_KIND "RWLOCK"
+#define SPINLOCK_KIND "SPINLOCK"
+#define BARRIER_KIND "BARRIER"
+#define SEM_KIND "SEM"
+#define MUTEX_NATIVE_TYPE "pthread_mutex_t"
+
+// Every pthread primitive Dylinx is able to rewrite. native_type is the
+// spelling matched in the AST and generic_type is the replacement used
+// wherever no site id is known, such as pointers, casts and typedefs.
+// Spinlocks have no header of their own and borrow the mutex one.
+struct PluggableKind {
+  std::string name;
+  std::string native_type;
+  std::string generic_type;
+};
+
+const std::vector<PluggableKind>& getPluggableKinds() {
+  static const std::vector<PluggableKind> kinds {
+    { MUTEX_KIND, MUTEX_NATIVE_TYPE, "dlx_generic_lock_t" },
+    { RWLOCK_KIND, "pthread_rwlock_t", "dlx_generic_rwlock_t" },
+    { SPINLOCK_KIND, "pthread_spinlock_t", "dlx_generic_lock_t" },
+    { BARRIER_KIND, "pthread_barrier_t", "dlx_generic_barrier_t" },
+    { SEM_KIND, "sem_t", "dlx_generic_sem_t" }
+  };
+  return kinds;
+}
+
+// Accept both "pthread_mutex_t" and "pthread_mutex_t *" spellings.
+const PluggableKind *lookupPluggableKind(std::string type_name) {
+  if (type_name.size() > 2 && type_name.compare(type_name.size() - 2, 2, " *") == 0)
+    type_name.erase(type_name.size() - 2);
+  for (const PluggableKind& kind: getPluggableKinds()) {
+    if (kind.native_type == type_name)
+      return &kind;
+  }
+  return nullptr;
+}
 
 std::string getLockPattern() {
   std::vector<std::string> locks { LOCK_LIST };
-  std::string pattern("[^\\w]*(");
+  std::vector<std::string> waits { WAIT_LIST };
+  std::string pattern("[^\\w]*((?:");
   for (auto l: locks) {
     pattern += l;
     pattern += "|";
   }
   pattern.erase(pattern.end() - 1);
-  pattern += ")";
+  pattern += ")(?:\\([\\w=, ]*\\))?(?:\\+(?:";
+  for (auto w: waits) {
+    pattern += w;
+    pattern += "|";
+  }
+  pattern.erase(pattern.end() - 1);
+  pattern += ")(?:\\([\\w=, ]*\\))?)?)";
   return pattern;
 }
 
@@ -0,0 +1,203 @@
+#include "dylinx-glue.h"
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+
+// Online autotuner
+// ----------------------------------------------------------------------------
+// During the warm-up window every registered site runs its own UCB1 bandit
+// over its candidate lock types. Each round plays one arm per site through
+// the hot swap, and scores it by acquisitions per cycle spent waiting for
+// or holding the site's locks, or by the application's progress when
+// dlx_autotune_reward was given. Rewards are scaled by the best round the
+// site has seen so far. When the window closes every site commits to the
+// arm with the best mean and the arrangement is logged as JSON, which
+// Dylinx.py reads back as an id2type for later builds.
+// Sites are tuned at the same time, so with a progress callback one site's
+// choice does blur another site's reward. The window should leave every
+// arm a few rounds.
+
+#define DLX_TUNE_MAX_ARM 8
+#define DLX_TUNE_NAME_LEN 16
+#define DLX_TUNE_INTERVAL_MS 50
+
+typedef struct dlx_tune_site {
+  int32_t site_id;
+  uint32_t n_arm;
+  char arm[DLX_TUNE_MAX_ARM][DLX_TUNE_NAME_LEN];
+  uint32_t plays[DLX_TUNE_MAX_ARM];
+  double reward[DLX_TUNE_MAX_ARM];
+  double peak;
+  uint32_t current;
+} dlx_tune_site_t;
+
+static dlx_tune_site_t *g_tune_site = NULL;
+static uint32_t g_n_tune_site = 0;
+static uint64_t (*g_tune_progress)(void) = NULL;
+static uint32_t g_tune_warmup_ms = 0;
+static uint32_t g_tune_interval_ms = DLX_TUNE_INTERVAL_MS;
+static char *g_tune_log = NULL;
+
+int dlx_autotune_site(int32_t site_id, const char *ltypes) {
+  if (site_id < 0 || !ltypes)
+    return EINVAL;
+  dlx_tune_site_t *sites = realloc(g_tune_site, (g_n_tune_site + 1) * sizeof(dlx_tune_site_t));
+  if (!sites)
+    return ENOMEM;
+  g_tune_site = sites;
+  dlx_tune_site_t *site = &g_tune_site[g_n_tune_site];
+  *site = (dlx_tune_site_t){ .site_id = site_id };
+  const char *cur = ltypes;
+  while (*cur && site->n_arm < DLX_TUNE_MAX_ARM) {
+    size_t len = strcspn(cur, ",");
+    if (len && len < DLX_TUNE_NAME_LEN) {
+      memcpy(site->arm[site->n_arm], cur, len);
+      site->arm[site->n_arm++][len] = '\0';
+    }
+    cur += len + (cur[len] == ',');
+  }
+  // A single candidate leaves nothing to choose.
+  if (site->n_arm > 1)
+    g_n_tune_site++;
+  return 0;
+}
+
+int dlx_autotune_reward(uint64_t (*progress)(void)) {
+  g_tune_progress = progress;
+  return 0;
+}
+
+// UCB1 exploration bonus sqrt(2 ln(round) / plays). Subjects do not link
+// libm, and a log rounded down to a power of two is plenty for a bonus.
+static double __dlx_tune_bonus(uint32_t round, uint32_t plays) {
+  double x = 2.0 * 0.6931 * (31 - __builtin_clz(round | 1)) / plays;
+  double r = x > 1.0? x: 1.0;
+  for (int i = 0; i < 16; i++)
+    r = 0.5 * (r + x / r);
+  return r;
+}
+
+static uint32_t __dlx_tune_pick(dlx_tune_site_t *site, uint32_t round) {
+  double best = -1.0;
+  uint32_t pick = 0;
+  for (uint32_t i = 0; i < site->n_arm; i++) {
+    if (!site->plays[i])
+      return i;
+    double mean = site->reward[i] / site->plays[i] / (site->peak > 0? site->peak: 1.0);
+    double score = mean + __dlx_tune_bonus(round, site->plays[i]);
+    if (score > best) {
+      best = score;
+      pick = i;
+    }
+  }
+  return pick;
+}
+
+static uint32_t __dlx_tune_winner(dlx_tune_site_t *site) {
+  double best = -1.0;
+  uint32_t pick = 0;
+  for (uint32_t i = 0; i < site->n_arm; i++) {
+    double mean = site->plays[i]? site->reward[i] / site->plays[i]: -1.0;
+    if (mean > best) {
+      best = mean;
+      pick = i;
+    }
+  }
+  return pick;
+}
+
+static double __dlx_tune_elapsed(struct timespec *since) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - since->tv_sec) + (now.tv_nsec - since->tv_nsec) * 1e-9;
+}
+
+static void __dlx_tune_log(void) {
+  FILE *fp = g_tune_log? fopen(g_tune_log, "w"): NULL;
+  if (fp)
+    fprintf(fp, "{");
+  for (uint32_t i = 0; i < g_n_tune_site; i++) {
+    dlx_tune_site_t *site = &g_tune_site[i];
+    const char *winner = site->arm[site->current];
+    printf("[Dylinx] autotune site %d -> %s (", site->site_id, winner);
+    for (uint32_t j = 0; j < site->n_arm; j++)
+      printf("%s%s:%u", j? " ": "", site->arm[j], site->plays[j]);
+    printf(")\n");
+    if (fp)
+      fprintf(fp, "%s\n  \"%d\": \"%s\"", i? ",": "", site->site_id, winner);
+  }
+  if (fp) {
+    fprintf(fp, "\n}\n");
+    fclose(fp);
+  }
+}
+
+static void *__dlx_autotune_loop(void *arg) {
+  struct timespec begin, round_begin;
+  struct timespec interval = {
+    .tv_sec = g_tune_interval_ms / 1000,
+    .tv_nsec = (g_tune_interval_ms % 1000) * 1000000L
+  };
+  dlx_site_stats_t stats;
+  for (uint32_t i = 0; i < g_n_tune_site; i++)
+    dlx_set_site_type(g_tune_site[i].site_id, g_tune_site[i].arm[0]);
+  dlx_tune_measure(1);
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  for (uint32_t round = 1; __dlx_tune_elapsed(&begin) * 1000 < g_tune_warmup_ms; round++) {
+    for (uint32_t i = 0; i < g_n_tune_site; i++)
+      dlx_site_take_stats(g_tune_site[i].site_id, &stats);
+    uint64_t progress = g_tune_progress? g_tune_progress(): 0;
+    clock_gettime(CLOCK_MONOTONIC, &round_begin);
+    nanosleep(&interval, NULL);
+    double seconds = __dlx_tune_elapsed(&round_begin);
+    if (g_tune_progress)
+      progress = g_tune_progress() - progress;
+    for (uint32_t i = 0; i < g_n_tune_site; i++) {
+      dlx_tune_site_t *site = &g_tune_site[i];
+      dlx_site_take_stats(site->site_id, &stats);
+      // An idle round says nothing about the arm, play it again.
+      if (!stats.n_acq)
+        continue;
+      double reward = g_tune_progress?
+        progress / seconds:
+        (double)stats.n_acq / (stats.wait_cyc + stats.hold_cyc + 1);
+      site->reward[site->current] += reward;
+      site->plays[site->current]++;
+      if (reward > site->peak)
+        site->peak = reward;
+      uint32_t next = __dlx_tune_pick(site, round);
+      if (next != site->current && !dlx_set_site_type(site->site_id, site->arm[next]))
+        site->current = next;
+    }
+  }
+  dlx_tune_measure(0);
+  for (uint32_t i = 0; i < g_n_tune_site; i++) {
+    dlx_tune_site_t *site = &g_tune_site[i];
+    uint32_t winner = __dlx_tune_winner(site);
+    if (winner != site->current && !dlx_set_site_type(site->site_id, site->arm[winner]))
+      site->current = winner;
+  }
+  __dlx_tune_log();
+  return NULL;
+}
+
+int dlx_autotune_start(const char *spec, const char *log_path) {
+  if (!spec || !*spec || !g_n_tune_site)
+    return 0;
+  if (sscanf(spec, "%u:%u", &g_tune_warmup_ms, &g_tune_interval_ms) < 1 || !g_tune_interval_ms)
+    return EINVAL;
+  // Probe the hot swap before spending a thread on it.
+  int ret = dlx_tune_measure(0);
+  if (ret)
+    return ret;
+  if (log_path && *log_path)
+    g_tune_log = strdup(log_path);
+  pthread_t tid;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  ret = pthread_create(&tid, &attr, __dlx_autotune_loop, NULL);
+  pthread_attr_destroy(&attr);
+  return ret;
+}
@@ -0,0 +1,229 @@
+#include "dylinx-glue.h"
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+
+// Causal profiler
+// ----------------------------------------------------------------------------
+// A thread runs one experiment after another, each DLX_CAUSAL_MS long by
+// default. Half of them are baselines, the others virtually speed up the
+// sections of a random site by a random step of DLX_CAUSAL_SPEEDUP, see
+// the causal profiling part of dylinx-glue.c. The inserted delay is taken
+// off the experiment's length, so progress over what is left tells the
+// throughput the application would reach with those sections that much
+// shorter. A site whose sections did not run during its experiment is
+// left out until every site is. At exit the predicted change against the
+// baselines is printed per site and speedup, largest first, and logged as
+// JSON for Dylinx.py. Experiments only stay apart from the application's
+// phases with enough of them, a run should leave each point ten or more.
+
+#define DLX_CAUSAL_MS 100
+#define DLX_CAUSAL_N_SPEEDUP 4
+
+static const uint32_t g_causal_speedup[DLX_CAUSAL_N_SPEEDUP] = { 25, 50, 75, 100 };
+
+typedef struct dlx_causal_point {
+  uint64_t progress;
+  double seconds;
+  uint32_t n;
+} dlx_causal_point_t;
+
+typedef struct dlx_causal_site {
+  int32_t site_id;
+  int idle;
+  uint64_t n_section;
+  dlx_causal_point_t point[DLX_CAUSAL_N_SPEEDUP];
+} dlx_causal_site_t;
+
+volatile uint64_t g_dlx_progress = 0;
+static uint64_t (*g_causal_progress)(void) = NULL;
+static int32_t *g_causal_site_id = NULL;
+static uint32_t g_n_causal_site_id = 0;
+static dlx_causal_site_t *g_causal_sites = NULL;
+static uint32_t g_n_causal_sites = 0;
+static dlx_causal_point_t g_causal_base;
+static uint32_t g_causal_ms = DLX_CAUSAL_MS;
+static uint32_t g_causal_total_ms = 0;
+static char *g_causal_log = NULL;
+
+int dlx_causal_site(int32_t site_id) {
+  if (site_id < 0)
+    return EINVAL;
+  int32_t *ids = realloc(g_causal_site_id, (g_n_causal_site_id + 1) * sizeof(int32_t));
+  if (!ids)
+    return ENOMEM;
+  g_causal_site_id = ids;
+  g_causal_site_id[g_n_causal_site_id++] = site_id;
+  return 0;
+}
+
+int dlx_causal_progress(uint64_t (*progress)(void)) {
+  g_causal_progress = progress;
+  return 0;
+}
+
+static uint64_t __dlx_causal_progress(void) {
+  return g_causal_progress? g_causal_progress(): __atomic_load_n(&g_dlx_progress, __ATOMIC_RELAXED);
+}
+
+static uint64_t __dlx_causal_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uint64_t __dlx_causal_rand(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static dlx_causal_site_t *__dlx_causal_pick(uint64_t *rng) {
+  uint32_t n_busy = 0;
+  for (uint32_t i = 0; i < g_n_causal_sites; i++)
+    n_busy += !g_causal_sites[i].idle;
+  if (!n_busy) {
+    for (uint32_t i = 0; i < g_n_causal_sites; i++)
+      g_causal_sites[i].idle = 0;
+    n_busy = g_n_causal_sites;
+  }
+  uint32_t pick = __dlx_causal_rand(rng) % n_busy;
+  for (uint32_t i = 0; i < g_n_causal_sites; i++) {
+    if (!g_causal_sites[i].idle && !pick--)
+      return &g_causal_sites[i];
+  }
+  return &g_causal_sites[0];
+}
+
+// Relative change of the progress rate at point against the baselines.
+static double __dlx_causal_gain(const dlx_causal_point_t *point) {
+  if (!point->n || point->seconds <= 0 || !g_causal_base.progress)
+    return 0;
+  double base = g_causal_base.progress / g_causal_base.seconds;
+  return point->progress / point->seconds / base - 1;
+}
+
+static double __dlx_causal_best(const dlx_causal_site_t *site) {
+  double best = -1;
+  for (uint32_t i = 0; i < DLX_CAUSAL_N_SPEEDUP; i++) {
+    if (site->point[i].n && __dlx_causal_gain(&site->point[i]) > best)
+      best = __dlx_causal_gain(&site->point[i]);
+  }
+  return best;
+}
+
+static int __dlx_causal_cmp(const void *a, const void *b) {
+  double x = __dlx_causal_best(a), y = __dlx_causal_best(b);
+  return x < y? 1: x > y? -1: 0;
+}
+
+static void __dlx_causal_report(void) {
+  dlx_causal_speedup(-2, 0, 0);
+  dlx_causal_site_t *sites = malloc(g_n_causal_sites * sizeof(dlx_causal_site_t));
+  if (!sites)
+    return;
+  memcpy(sites, g_causal_sites, g_n_causal_sites * sizeof(dlx_causal_site_t));
+  qsort(sites, g_n_causal_sites, sizeof(dlx_causal_site_t), __dlx_causal_cmp);
+  if (!g_causal_base.progress) {
+    fprintf(stderr, "[Dylinx] causal profile: no progress, count it with DLX_PROGRESS() or dlx_causal_progress\n");
+  } else {
+    fprintf(
+      stderr, "[Dylinx] causal profile (%u baselines, %.1f progress/s), throughput change per site "
+      "when its sections run faster:\n  site", g_causal_base.n, g_causal_base.progress / g_causal_base.seconds
+    );
+    for (uint32_t i = 0; i < DLX_CAUSAL_N_SPEEDUP; i++)
+      fprintf(stderr, "     %3u%% (n)", g_causal_speedup[i]);
+    fprintf(stderr, "\n");
+    for (uint32_t i = 0; i < g_n_causal_sites; i++) {
+      if (!sites[i].n_section)
+        continue;
+      fprintf(stderr, "  %4d", sites[i].site_id);
+      for (uint32_t j = 0; j < DLX_CAUSAL_N_SPEEDUP; j++)
+        fprintf(stderr, " %+7.1f%% (%u)", 100 * __dlx_causal_gain(&sites[i].point[j]), sites[i].point[j].n);
+      fprintf(stderr, "\n");
+    }
+  }
+  FILE *fp = g_causal_log? fopen(g_causal_log, "w"): NULL;
+  if (fp) {
+    fprintf(
+      fp, "{\n  \"baseline\": { \"experiments\": %u, \"progress\": %lu, \"seconds\": %.6f },\n  \"sites\": {",
+      g_causal_base.n, (unsigned long)g_causal_base.progress, g_causal_base.seconds
+    );
+    const char *sep = "";
+    for (uint32_t i = 0; i < g_n_causal_sites; i++) {
+      if (!sites[i].n_section)
+        continue;
+      fprintf(fp, "%s\n    \"%d\": { \"sections\": %lu", sep, sites[i].site_id, (unsigned long)sites[i].n_section);
+      for (uint32_t j = 0; j < DLX_CAUSAL_N_SPEEDUP; j++) {
+        fprintf(
+          fp, ", \"%u\": [%.4f, %u]", g_causal_speedup[j], __dlx_causal_gain(&sites[i].point[j]), sites[i].point[j].n
+        );
+      }
+      fprintf(fp, " }");
+      sep = ",";
+    }
+    fprintf(fp, "\n  }\n}\n");
+    fclose(fp);
+  }
+  free(sites);
+}
+
+static void *__dlx_causal_loop(void *arg) {
+  uint64_t rng = __dlx_causal_now_ns() | 1;
+  struct timespec length = { g_causal_ms / 1000, (g_causal_ms % 1000) * 1000000L };
+  uint64_t begin_ns = __dlx_causal_now_ns(), begin_tsc = rdtsc_u64();
+  double cyc_per_ns = 1.0;
+  while (!g_causal_total_ms || (__dlx_causal_now_ns() - begin_ns) / 1000000 < g_causal_total_ms) {
+    dlx_causal_site_t *site = __dlx_causal_pick(&rng);
+    uint64_t draw = __dlx_causal_rand(&rng);
+    uint32_t step = draw & 1? (draw >> 1) % DLX_CAUSAL_N_SPEEDUP: DLX_CAUSAL_N_SPEEDUP;
+    uint64_t n_section, progress = __dlx_causal_progress(), start = __dlx_causal_now_ns();
+    dlx_causal_speedup(site->site_id, step < DLX_CAUSAL_N_SPEEDUP? g_causal_speedup[step]: 0, cyc_per_ns);
+    nanosleep(&length, NULL);
+    uint64_t delay = dlx_causal_take(&n_section);
+    uint64_t now = __dlx_causal_now_ns();
+    progress = __dlx_causal_progress() - progress;
+    cyc_per_ns = (double)(rdtsc_u64() - begin_tsc) / (now - begin_ns);
+    double seconds = ((now - start) - delay / cyc_per_ns) * 1e-9;
+    if (step == DLX_CAUSAL_N_SPEEDUP) {
+      g_causal_base.progress += progress;
+      g_causal_base.seconds += seconds;
+      g_causal_base.n++;
+    } else if (!n_section || seconds <= 0) {
+      site->idle = 1;
+    } else {
+      site->n_section += n_section;
+      site->point[step].progress += progress;
+      site->point[step].seconds += seconds;
+      site->point[step].n++;
+    }
+  }
+  dlx_causal_speedup(-2, 0, 0);
+  return NULL;
+}
+
+int dlx_causal_start(const char *spec, const char *log_path) {
+  if (!spec || !*spec)
+    return 0;
+  if (sscanf(spec, "%u:%u", &g_causal_ms, &g_causal_total_ms) < 1 || !g_causal_ms)
+    return EINVAL;
+  g_n_causal_sites = g_n_causal_site_id? g_n_causal_site_id: (uint32_t)dlx_n_sites();
+  if (!g_n_causal_sites)
+    return EINVAL;
+  g_causal_sites = calloc(g_n_causal_sites, sizeof(dlx_causal_site_t));
+  if (!g_causal_sites)
+    return ENOMEM;
+  for (uint32_t i = 0; i < g_n_causal_sites; i++)
+    g_causal_sites[i].site_id = g_n_causal_site_id? g_causal_site_id[i]: (int32_t)i;
+  if (log_path && *log_path)
+    g_causal_log = strdup(log_path);
+  pthread_t tid;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int ret = pthread_create(&tid, &attr, __dlx_causal_loop, NULL);
+  pthread_attr_destroy(&attr);
+  return ret? ret: atexit(__dlx_causal_report);
+}
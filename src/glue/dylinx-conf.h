@@ -0,0 +1,80 @@
+#include <stdint.h>
+
+#ifndef __DYLINX_CONF__
+#define __DYLINX_CONF__
+
+// Per-site configuration handed to a lock when it is initialized. The
+// lock type of an arrangement decides who gets the lock next, the waiting
+// policy decides how a waiter spends its time until then, so that an
+// arrangement such as MCS+PARK or TTAS+BACKOFF(64,4096) needs no extra
+// lock type.
+typedef enum {
+  DLX_WAIT_DEFAULT = 0,   // whatever the lock type does on its own
+  DLX_WAIT_SPIN,          // pause and re-check
+  DLX_WAIT_BACKOFF,       // exponential backoff between min and max pauses
+  DLX_WAIT_YIELD,         // spin budget rounds, then sched_yield
+  DLX_WAIT_PARK,          // spin budget rounds, then sleep on a futex
+  DLX_WAIT_TSC            // spin until budget TSC cycles elapse, then sleep
+} dlx_wait_kind_t;
+
+#define DLX_WAIT_BACKOFF_MIN (1 << 9)
+#define DLX_WAIT_BACKOFF_MAX ((1 << 20) - 1)
+#define DLX_WAIT_YIELD_BUDGET 128
+#define DLX_WAIT_PARK_BUDGET 2048
+#define DLX_WAIT_TSC_BUDGET 20000
+
+typedef struct dlx_wait_policy {
+  uint32_t kind;
+  uint32_t min;
+  uint32_t max;
+  uint32_t budget;
+} dlx_wait_policy_t;
+
+// Lock types may also declare tunables, written as BACKOFF(min=64,max=4096)
+// in an arrangement. Each lock header names its slots with an enum, and
+// LOCK_PARAM in Dylinx.py holds the names and ranges. A zero slot asks
+// for the default of the lock type.
+#define DLX_LOCK_PARAM_MAX 4
+
+// Where the backend of a lock lives, see dylinx-numa.c.
+typedef enum {
+  DLX_PLACE_DEFAULT = 0,  // wherever malloc puts it
+  DLX_PLACE_LOCAL,        // node of the thread that initializes the lock
+  DLX_PLACE_INTERLEAVE,   // instances take turns over the nodes
+  DLX_PLACE_NODE,         // the given node, as the kernel numbers it
+  DLX_PLACE_FOLLOW        // like LOCAL, then moves to its busiest node
+} dlx_place_kind_t;
+
+typedef struct dlx_place {
+  uint32_t kind;
+  int32_t node;
+} dlx_place_t;
+
+// How a lock sits among the application's data. The rewriter gives ISOLATE
+// sites a lock type padded to a whole prefetch pair, and aligns COLOCATE
+// struct fields to one so that the fields declared after the lock, usually
+// the data it guards, arrive with it. At runtime ISOLATE also pads the
+// backend. DLX_PREFETCH_PAIR is the 128 bytes the adjacent-line prefetcher
+// of Intel cores fetches together.
+typedef enum {
+  DLX_LAYOUT_DEFAULT = 0, // in place, sharing lines with its neighbours
+  DLX_LAYOUT_ISOLATE,
+  DLX_LAYOUT_COLOCATE
+} dlx_layout_kind_t;
+
+#define DLX_PREFETCH_PAIR 128
+
+typedef struct dlx_lock_conf {
+  dlx_wait_policy_t wait;
+  uint32_t params[DLX_LOCK_PARAM_MAX];
+  dlx_place_t place;
+  uint32_t layout;
+} dlx_lock_conf_t;
+
+static inline uint32_t dlx_conf_param(const dlx_lock_conf_t *conf, uint32_t slot, uint32_t fallback) {
+  if (!conf || slot >= DLX_LOCK_PARAM_MAX || !conf->params[slot])
+    return fallback;
+  return conf->params[slot];
+}
+
+#endif // __DYLINX_CONF__
@@ -0,0 +1,161 @@
+#include "dylinx-glue.h"
+#include <errno.h>
+#include <stdint.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Control socket
+// ----------------------------------------------------------------------------
+// One client at a time, one command per line, one reply per line. Site
+// conf changes only reach instances that are initialized or migrated
+// afterwards, so a client sends wait, param and place before type.
+//   type  <site> <ltype>                     -> ok <epoch>
+//   wait  <site> <kind> <min> <max> <budget>  -> ok
+//   param <site> <slot> <value>              -> ok
+//   place <site> <kind> <node>               -> ok
+//   query <site>                             -> ok <epoch> <migrated> <instances>
+//   stats <site>                             -> ok <acq> <contended> <try failed>
+//                                               <cond waits> <wait cyc> <held> <hold cyc>
+//   latency <site>                           -> ok <wait p50> <p99> <p99.9>
+//                                               <hold p50> <p99> <p99.9>
+// Failures reply "error <errno>".
+
+static const char *g_wait_name[] = { "DEFAULT", "SPIN", "BACKOFF", "YIELD", "PARK", "TSC" };
+
+static int __dlx_wait_kind(const char *name, uint32_t *kind) {
+  for (uint32_t i = 0; i < sizeof(g_wait_name) / sizeof(g_wait_name[0]); i++) {
+    if (!strcasecmp(g_wait_name[i], name)) {
+      *kind = i;
+      return 0;
+    }
+  }
+  return EINVAL;
+}
+
+static const char *g_place_name[] = { "DEFAULT", "LOCAL", "INTERLEAVE", "NODE", "FOLLOW" };
+
+static int __dlx_place_kind(const char *name, uint32_t *kind) {
+  for (uint32_t i = 0; i < sizeof(g_place_name) / sizeof(g_place_name[0]); i++) {
+    if (!strcasecmp(g_place_name[i], name)) {
+      *kind = i;
+      return 0;
+    }
+  }
+  return EINVAL;
+}
+
+static void __dlx_control_exec(char *cmd, char *reply, size_t len) {
+  char op[16], arg[64];
+  int site, node;
+  uint32_t a, b, c, kind, epoch, n_migrated, n_ins;
+  dlx_lock_stats_t stats;
+  // One client at a time, and too large for the stack.
+  static dlx_lock_hist_t hist;
+  int ret = EINVAL;
+  // Only sites reserved at startup are reachable, the tables must not grow.
+  if (sscanf(cmd, "%15s %d", op, &site) != 2 || dlx_site_swap_state(site, &epoch, &n_migrated, &n_ins)) {
+    snprintf(reply, len, "error %d\n", EINVAL);
+    return;
+  }
+  if (!strcmp(op, "type") && sscanf(cmd, "%*s %*d %63s", arg) == 1) {
+    if ((ret = dlx_set_site_type(site, arg)) == 0)
+      dlx_site_swap_state(site, &epoch, &n_migrated, &n_ins);
+  } else if (!strcmp(op, "wait") && sscanf(cmd, "%*s %*d %63s %u %u %u", arg, &a, &b, &c) == 4) {
+    if ((ret = __dlx_wait_kind(arg, &kind)) == 0)
+      ret = dlx_set_site_wait(site, kind, a, b, c);
+  } else if (!strcmp(op, "param") && sscanf(cmd, "%*s %*d %u %u", &a, &b) == 2) {
+    ret = dlx_set_site_param(site, a, b);
+  } else if (!strcmp(op, "place") && sscanf(cmd, "%*s %*d %63s %d", arg, &node) == 2) {
+    if ((ret = __dlx_place_kind(arg, &kind)) == 0)
+      ret = dlx_set_site_place(site, kind, node);
+  } else if (!strcmp(op, "query")) {
+    ret = 0;
+  } else if (!strcmp(op, "stats")) {
+    ret = dlx_stats_site(site, &stats);
+  } else if (!strcmp(op, "latency")) {
+    ret = dlx_stats_hist(site, &hist);
+  }
+  if (ret)
+    snprintf(reply, len, "error %d\n", ret);
+  else if (!strcmp(op, "type"))
+    snprintf(reply, len, "ok %u\n", epoch);
+  else if (!strcmp(op, "query"))
+    snprintf(reply, len, "ok %u %u %u\n", epoch, n_migrated, n_ins);
+  else if (!strcmp(op, "stats"))
+    snprintf(
+      reply, len, "ok %lu %lu %lu %lu %lu %lu %lu\n",
+      (unsigned long)stats.n_acq, (unsigned long)stats.n_contended, (unsigned long)stats.n_try_fail,
+      (unsigned long)stats.n_cond_wait, (unsigned long)stats.wait_cyc, (unsigned long)stats.n_hold,
+      (unsigned long)stats.hold_cyc
+    );
+  else if (!strcmp(op, "latency"))
+    snprintf(
+      reply, len, "ok %lu %lu %lu %lu %lu %lu\n",
+      (unsigned long)dlx_hist_quantile(hist.wait, 0.5), (unsigned long)dlx_hist_quantile(hist.wait, 0.99),
+      (unsigned long)dlx_hist_quantile(hist.wait, 0.999), (unsigned long)dlx_hist_quantile(hist.hold, 0.5),
+      (unsigned long)dlx_hist_quantile(hist.hold, 0.99), (unsigned long)dlx_hist_quantile(hist.hold, 0.999)
+    );
+  else
+    snprintf(reply, len, "ok\n");
+}
+
+static void *__dlx_control_loop(void *arg) {
+  int server = (int)(intptr_t)arg;
+  while (1) {
+    int conn = accept(server, NULL, NULL);
+    if (conn < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    FILE *io = fdopen(conn, "r+");
+    if (!io) {
+      close(conn);
+      continue;
+    }
+    char line[256], reply[192];
+    while (fgets(line, sizeof(line), io)) {
+      __dlx_control_exec(line, reply, sizeof(reply));
+      fputs(reply, io);
+      fflush(io);
+    }
+    fclose(io);
+  }
+  close(server);
+  return NULL;
+}
+
+int dlx_control_start(const char *path) {
+  if (!path || !*path)
+    return 0;
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  if (strlen(path) >= sizeof(addr.sun_path))
+    return ENAMETOOLONG;
+  strcpy(addr.sun_path, path);
+  int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (server < 0)
+    return errno;
+  unlink(path);
+  // Anyone who can connect can swap locks, so only the owner may. Nobody
+  // can connect before listen, the mode is in place by then.
+  if (bind(server, (struct sockaddr *)&addr, sizeof(addr)) || chmod(path, S_IRUSR | S_IWUSR) ||
+      listen(server, 1)) {
+    int err = errno;
+    close(server);
+    return err;
+  }
+  // The control thread never touches a Dylinx lock, so it may start before
+  // or after the application threads, and leaves the fast path on.
+  pthread_t tid;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int ret = dlx_quiet_thread(&tid, &attr, __dlx_control_loop, (void *)(intptr_t)server);
+  pthread_attr_destroy(&attr);
+  if (ret)
+    close(server);
+  return ret;
+}
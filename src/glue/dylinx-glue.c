@@ -5,13 +5,36 @@
 #include "lock/pthreadmtx-lock.h"
 #include "lock/adaptivemtx-lock.h"
 #include "lock/mcs-lock.h"
+#include "lock/ticket-lock.h"
+#include "lock/qspinlock-lock.h"
+#include "lock/tas-lock.h"
+#include "lock/ticket16-lock.h"
+#include "lock/pshared-lock.h"
+#include "lock/pthreadrw-lock.h"
+#include "lock/wprefrw-lock.h"
+#include "lock/bigreaderrw-lock.h"
+#include "lock/bravorw-lock.h"
+#include "lock/pthreadbarrier-lock.h"
+#include "lock/sensebarrier-lock.h"
+#include "lock/treebarrier-lock.h"
+#include "lock/tournbarrier-lock.h"
+#include "lock/dissembarrier-lock.h"
+#include "lock/posixsem-lock.h"
+#include "lock/spinparksem-lock.h"
+#include "lock/batchsem-lock.h"
+#include "lock/percpusem-lock.h"
 #include <errno.h>
+#include <stddef.h>
 #include <string.h>
+#include <strings.h>
 #include <syscall.h>
+#include <fcntl.h>
 
 #ifndef __DYLINX_GLUE__
 #define __DYLINX_GLUE__
+#ifdef __clang__
 #pragma clang diagnostic ignored "-Waddress-of-packed-member"
+#endif
 
 #define COUNT_DOWN()                                                        \
   11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
@@ -19,10 +42,11 @@
 #define AVAILABLE_LOCK_TYPE_NUM(...)                                        \
   GET_MACRO(__VA_ARGS__)
 
-#if AVAILABLE_LOCK_TYPE_NUM(ALLOWED_LOCK_TYPE, COUNT_DOWN()) > LOCK_TYPE_LIMIT
-#error                                                                                                      \
-Current number of available lock types isn't enough. Please reset                                           \
-LOCK_TYPE_CNT macro and corresponding macro definition.
+#if AVAILABLE_LOCK_TYPE_NUM(ALLOWED_LOCK_TYPE, COUNT_DOWN()) > LOCK_TYPE_LIMIT ||                           \
+    AVAILABLE_LOCK_TYPE_NUM(ALLOWED_RWLOCK_TYPE, COUNT_DOWN()) > LOCK_TYPE_LIMIT ||                         \
+    AVAILABLE_LOCK_TYPE_NUM(ALLOWED_BARRIER_TYPE, COUNT_DOWN()) > LOCK_TYPE_LIMIT ||                        \
+    AVAILABLE_LOCK_TYPE_NUM(ALLOWED_SEM_TYPE, COUNT_DOWN()) > LOCK_TYPE_LIMIT
+#error "Current number of available lock types is not enough. Please reset LOCK_TYPE_CNT macro and corresponding macro definition."
 #endif
 
 #define CHECK_LOCATE_SYMBOL(fptr, symbol) do {                                                              \
@@ -34,207 +58,3364 @@ LOCK_TYPE_CNT macro and corresponding macro definition.
 
 uint32_t g_ins_id = 0;
 
-// linked order should be concern
-void retrieve_native_symbol() {
-  native_mutex_init = (int (*)(pthread_mutex_t *, pthread_mutexattr_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_init");
-  CHECK_LOCATE_SYMBOL(native_mutex_init, pthread_mutex_init);
-  native_mutex_lock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_lock");
-  CHECK_LOCATE_SYMBOL(native_mutex_lock, pthread_mutex_lock);
-  native_mutex_unlock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_unlock");
-  CHECK_LOCATE_SYMBOL(native_mutex_unlock, pthread_mutex_unlock);
-  native_mutex_destroy = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_destroy");
-  CHECK_LOCATE_SYMBOL(native_mutex_destroy, pthread_mutex_destroy);
-  native_mutex_trylock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_trylock");
-  CHECK_LOCATE_SYMBOL(native_mutex_trylock, pthread_mutex_trylock);
-  native_cond_wait = (int (*)(pthread_cond_t *, pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_cond_wait");
-  CHECK_LOCATE_SYMBOL(native_cond_wait, pthread_cond_wait);
-  native_cond_timedwait = (int (*)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *))dlsym(RTLD_DEFAULT, "pthread_cond_timedwait");
-  CHECK_LOCATE_SYMBOL(native_cond_timedwait, pthread_cond_timedwait);
+// Features that hook the forward functions of mutexes. With no bit set a
+// lock operation goes straight to its backend, past the pshared check and
+// the user count of the hot swap, see test/bench-forward.c. A feature sets its
+// bit when first turned on and never clears it, so the release side still
+// finds what the acquisition recorded. DLX_HOOK_FAST is on only while the
+// process runs a single thread, and DLX_HOOK_ALONE while the thread count
+// of the glue says so but the kernel has yet to agree.
+enum {
+  DLX_HOOK_STATS = 1 << 0,
+  DLX_HOOK_TRACE = 1 << 1,
+  DLX_HOOK_CAUSAL = 1 << 2,
+  DLX_HOOK_TUNE = 1 << 3,
+  DLX_HOOK_FAST = 1 << 4,
+  DLX_HOOK_ALONE = 1 << 5,
+};
+
+#ifdef __DYLINX_SINGLE_FAST__
+static volatile uint32_t g_dlx_hooks = DLX_HOOK_FAST;
+#else
+static volatile uint32_t g_dlx_hooks = 0;
+#endif
+
+static inline void __dlx_hook(uint32_t hook) {
+  __atomic_or_fetch(&g_dlx_hooks, hook, __ATOMIC_SEQ_CST);
 }
 
-// {{{ forwarding function call to native interface
-int pthread_mutex_init_original(pthread_mutex_t *mtx, const pthread_mutexattr_t *attr) {
-    return native_mutex_init(mtx, attr);
+// {{{ site configuration
+// Indexed by site id. Registration happens in __dylinx_global_mtx_init_
+// before other threads exist. Afterwards only the control thread writes
+// entries, and the tables never grow again.
+// Sites without an entry, and untracked locks (-1), share g_default_conf.
+static const dlx_lock_conf_t g_default_conf = {
+  { DLX_WAIT_DEFAULT, 0, 0, 0 }, { 0 }, { DLX_PLACE_DEFAULT, 0 }, DLX_LAYOUT_DEFAULT
+};
+static dlx_lock_conf_t *g_site_conf = NULL;
+static int32_t g_n_site_conf = 0;
+
+// Live locks and the bytes they hold, see the footprint section below.
+typedef struct dlx_footprint {
+  volatile uint64_t n_live;
+  volatile uint64_t bytes;
+  volatile uint64_t peak;
+  // Locks whose object was freed without destroying them first.
+  volatile uint64_t n_reclaimed;
+} dlx_footprint_t;
+
+typedef struct dlx_site_state {
+  uint32_t n_ins;
+  // Bumped by dlx_set_site_type, methods is the backend of that epoch.
+  volatile uint32_t epoch;
+  volatile uint32_t n_migrated;
+  const dlx_injected_interface_t *volatile methods;
+  // Lock statistics gathered while dlx_tune_measure is on.
+  volatile uint64_t n_acq;
+  volatile uint64_t wait_cyc;
+  volatile uint64_t hold_cyc;
+  // Backends rebuilt on another node for DLX_PLACE_FOLLOW.
+  volatile uint32_t n_rehomed;
+  dlx_footprint_t footprint;
+  // Type of the latest lock initialized at the site.
+  const dlx_injected_interface_t *volatile built;
+} dlx_site_state_t;
+
+static dlx_site_state_t *g_site_state = NULL;
+
+static dlx_lock_conf_t *__dlx_site_conf_slot(int32_t site_id) {
+  if (site_id < 0)
+    return NULL;
+  if (site_id >= g_n_site_conf) {
+    int32_t n = site_id + 1;
+    dlx_site_state_t *state = realloc(g_site_state, n * sizeof(dlx_site_state_t));
+    if (!state)
+      return NULL;
+    g_site_state = state;
+    for (int32_t i = g_n_site_conf; i < n; i++)
+      state[i] = (dlx_site_state_t){ 0 };
+    dlx_lock_conf_t *table = realloc(g_site_conf, n * sizeof(dlx_lock_conf_t));
+    if (!table)
+      return NULL;
+    for (int32_t i = g_n_site_conf; i < n; i++)
+      table[i] = g_default_conf;
+    g_site_conf = table;
+    g_n_site_conf = n;
+  }
+  return &g_site_conf[site_id];
 }
 
-int pthread_mutex_lock_original(pthread_mutex_t *mtx) {
-    return native_mutex_lock(mtx);
+// Zero bounds pick the defaults of the policy.
+int dlx_set_site_wait(int32_t site_id, uint32_t kind, uint32_t min, uint32_t max, uint32_t budget) {
+  dlx_lock_conf_t *conf = __dlx_site_conf_slot(site_id);
+  if (!conf || kind > DLX_WAIT_TSC)
+    return EINVAL;
+  if (kind == DLX_WAIT_BACKOFF) {
+    min = min? min: DLX_WAIT_BACKOFF_MIN;
+    max = max >= min? max: (min > DLX_WAIT_BACKOFF_MAX? min: DLX_WAIT_BACKOFF_MAX);
+  }
+  if (!budget && kind == DLX_WAIT_YIELD)
+    budget = DLX_WAIT_YIELD_BUDGET;
+  if (!budget && kind == DLX_WAIT_PARK)
+    budget = DLX_WAIT_PARK_BUDGET;
+  if (!budget && kind == DLX_WAIT_TSC)
+    budget = DLX_WAIT_TSC_BUDGET;
+  conf->wait = (dlx_wait_policy_t){ kind, min, max, budget };
+  return 0;
 }
 
-int pthread_mutex_unlock_original(pthread_mutex_t *mtx) {
-    return native_mutex_unlock(mtx);
+int dlx_set_site_param(int32_t site_id, uint32_t slot, uint32_t value) {
+  dlx_lock_conf_t *conf = __dlx_site_conf_slot(site_id);
+  if (!conf || slot >= DLX_LOCK_PARAM_MAX)
+    return EINVAL;
+  conf->params[slot] = value;
+  return 0;
 }
 
-int pthread_mutex_destroy_original(pthread_mutex_t *mtx) {
-    return native_mutex_destroy(mtx);
+static void __dlx_place_report(void) {
+  dlx_place_report(stderr);
+  for (int32_t i = 0; i < g_n_site_conf; i++) {
+    if (g_site_state[i].n_rehomed)
+      fprintf(stderr, "  site %d: %u backends re-homed\n", i, g_site_state[i].n_rehomed);
+  }
 }
 
-int pthread_mutex_trylock_original(pthread_mutex_t *mtx) {
-    return native_mutex_trylock(mtx);
+// Placement only applies to backends initialized afterwards. The first
+// placed site schedules a report of where the backends ended up.
+int dlx_set_site_place(int32_t site_id, uint32_t kind, int32_t node) {
+  static int reported = 0;
+  dlx_lock_conf_t *conf = __dlx_site_conf_slot(site_id);
+  if (!conf || kind > DLX_PLACE_FOLLOW || (kind == DLX_PLACE_NODE && node < 0))
+    return EINVAL;
+  conf->place = (dlx_place_t){ kind, kind == DLX_PLACE_NODE? node: 0 };
+  if (kind != DLX_PLACE_DEFAULT && !__atomic_exchange_n(&reported, 1, __ATOMIC_RELAXED))
+    atexit(__dlx_place_report);
+  return 0;
 }
 
-int pthread_cond_wait_original(pthread_cond_t *cond, pthread_mutex_t *mtx) {
-    return native_cond_wait(cond, mtx);
+int dlx_set_site_layout(int32_t site_id, uint32_t layout) {
+  dlx_lock_conf_t *conf = __dlx_site_conf_slot(site_id);
+  if (!conf || layout > DLX_LAYOUT_COLOCATE)
+    return EINVAL;
+  conf->layout = layout;
+  return 0;
 }
 
-int pthread_cond_timedwait_original(pthread_cond_t *cond, pthread_mutex_t *mtx, const struct timespec *time) {
-    return native_cond_timedwait(cond, mtx, time);
+const dlx_lock_conf_t *dlx_site_conf(int32_t site_id) {
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return &g_default_conf;
+  return &g_site_conf[site_id];
+}
+
+// Makes sure every site below n_site numbers its own instances.
+int dlx_reserve_sites(int32_t n_site) {
+  return (n_site > 0 && !__dlx_site_conf_slot(n_site - 1))? ENOMEM: 0;
+}
+
+// Sites outside the table, and untracked locks, draw from g_ins_id.
+uint32_t dlx_next_instances(int32_t site_id, uint32_t n) {
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return __sync_fetch_and_add(&g_ins_id, n);
+  return __sync_fetch_and_add(&g_site_state[site_id].n_ins, n);
+}
+
+uint32_t dlx_next_instance(int32_t site_id) {
+  return dlx_next_instances(site_id, 1);
+}
+
+typedef struct dlx_instance_rule {
+  int32_t site_id;
+  uint32_t lo;
+  uint32_t hi;
+  int32_t conf_id;
+  const dlx_injected_interface_t *methods;
+} dlx_instance_rule_t;
+
+static dlx_instance_rule_t *g_ins_rule = NULL;
+static uint32_t g_n_ins_rule = 0;
+
+// Rules cover instances [lo, hi). When they overlap the later one wins.
+int dlx_set_instance_type(
+  int32_t site_id, uint32_t lo, uint32_t hi, const dlx_injected_interface_t *methods, int32_t conf_id
+) {
+  if (site_id < 0 || lo >= hi || !methods)
+    return EINVAL;
+  dlx_instance_rule_t *rules = realloc(g_ins_rule, (g_n_ins_rule + 1) * sizeof(dlx_instance_rule_t));
+  if (!rules)
+    return ENOMEM;
+  rules[g_n_ins_rule] = (dlx_instance_rule_t){ site_id, lo, hi, conf_id, methods };
+  g_ins_rule = rules;
+  g_n_ins_rule++;
+  return 0;
+}
+
+// Rebinds methods when a rule covers the instance and returns the
+// configuration its lock should be initialized with.
+const dlx_lock_conf_t *dlx_instance_bind(const dlx_injected_interface_t **methods, int32_t site_id, uint32_t ins_id) {
+  for (uint32_t i = g_n_ins_rule; i-- > 0;) {
+    dlx_instance_rule_t *rule = &g_ins_rule[i];
+    if (rule->site_id != site_id || ins_id < rule->lo || ins_id >= rule->hi)
+      continue;
+    if (methods)
+      *methods = rule->methods;
+    return dlx_site_conf(rule->conf_id);
+  }
+  return dlx_site_conf(site_id);
 }
 // }}}
 
-void *dlx_error_obj_init(uint32_t cnt, uint32_t unit, uint32_t *offsets, uint32_t n_offset, void **init_funcs, int *type_ids, char *file, int line) {
-  char error_msg[1000];
-  sprintf(
-    error_msg,
-    "Untrackable memory object lock are trying to init. Possible\n"
-    "cause is _Generic function falls into \'default\' option.\n"
-    "According to source code, it happens near %s L%d",
-    file, line
-  );
-  HANDLING_ERROR(error_msg);
+// {{{ hot swap
+// dlx_set_site_type only bumps the site epoch. Each instance notices the
+// new epoch when it is entered next and rebuilds itself once users drops
+// to zero, i.e. nobody holds it, waits for it or sleeps on a condition
+// variable with it. DLX_SWAP_BUSY in users keeps entrants out meanwhile.
+// Idle instances keep their old backend until they are touched again.
+// An instance initialized with a recursive, error checking, robust or
+// priority protocol attribute carries DLX_SWAP_PINNED in users and keeps
+// its backend, since the other types ignore those attributes. users is
+// then never 0, so neither a swap nor a re-homing rebuilds it.
+#define DLX_SWAP_BUSY 0x80000000u
+#define DLX_SWAP_PINNED 0x40000000u
+
+static inline uint32_t __dlx_swap_pin(const pthread_mutexattr_t *attr) {
+  int type = PTHREAD_MUTEX_DEFAULT, protocol = PTHREAD_PRIO_NONE, robust = PTHREAD_MUTEX_STALLED;
+  if (!attr)
+    return 0;
+  pthread_mutexattr_gettype(attr, &type);
+  pthread_mutexattr_getprotocol(attr, &protocol);
+  pthread_mutexattr_getrobust(attr, &robust);
+  return type != PTHREAD_MUTEX_DEFAULT || protocol != PTHREAD_PRIO_NONE || robust != PTHREAD_MUTEX_STALLED?
+    DLX_SWAP_PINNED: 0;
+}
+
+#define DLX_LOCK_COLLECTION_ENTRY(ltype) { #ltype, &dlx_ ## ltype ## _methods_collection },
+static const struct {
+  const char *name;
+  const dlx_injected_interface_t *methods;
+} g_lock_collection[] = {
+  FOR_EACH(DLX_LOCK_COLLECTION_ENTRY, ALLOWED_LOCK_TYPE)
+};
+#define DLX_N_LOCK_COLLECTION (sizeof(g_lock_collection) / sizeof(g_lock_collection[0]))
+
+int dlx_set_site_type(int32_t site_id, const char *ltype) {
+#ifdef __DYLINX_HOTSWAP__
+  if (site_id < 0 || site_id >= g_n_site_conf || !ltype)
+    return EINVAL;
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION; i++) {
+    if (strcasecmp(g_lock_collection[i].name, ltype))
+      continue;
+    dlx_site_state_t *site = &g_site_state[site_id];
+    __atomic_store_n(&site->methods, g_lock_collection[i].methods, __ATOMIC_RELEASE);
+    __atomic_store_n(&site->n_migrated, 0, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&site->epoch, 1, __ATOMIC_RELEASE);
+    return 0;
+  }
+  return EINVAL;
+#else
+  return ENOTSUP;
+#endif
+}
+
+int32_t dlx_n_sites(void) {
+  return g_n_site_conf;
+}
+
+// A swapped site names its target, instances may still be migrating.
+const char *dlx_site_type(int32_t site_id) {
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return NULL;
+  const dlx_injected_interface_t *methods = __atomic_load_n(&g_site_state[site_id].methods, __ATOMIC_ACQUIRE);
+  if (!methods)
+    methods = __atomic_load_n(&g_site_state[site_id].built, __ATOMIC_RELAXED);
+  for (uint32_t i = 0; methods && i < DLX_N_LOCK_COLLECTION; i++) {
+    if (g_lock_collection[i].methods == methods)
+      return g_lock_collection[i].name;
+  }
   return NULL;
 }
 
-// The third argument property represent two meanings.
-// 1. offset collection (even index)
-// 2. occupied volume unit (odd index) normal variable = 1; array = length
-void *dlx_struct_obj_init(uint32_t cnt, uint32_t unit, uint32_t *properties, uint32_t n_offset, void **init_funcs, int *type_ids, char *file, int line) {
-  char *object = calloc(cnt, unit);
-  if (object) {
-    for (uint32_t c = 0; c < cnt; c++) {
-      for (uint32_t n = 0; n < n_offset; n++) {
-        uint64_t offset = properties[2*n];
-        uint32_t vol = properties[2*n + 1];
-        dlx_generic_lock_t *lock = object + c * unit + offset;
-        int (*init_fptr)(dlx_generic_lock_t *, pthread_mutexattr_t *, int32_t, char *, char *, int);
-        init_fptr = init_funcs[n];
-        for (int i = 0; i < vol; i++) {
-            init_fptr(lock, NULL, type_ids[n], "forward_from_obj_init", file, line);
-            lock++;
-        }
-      }
+int dlx_site_swap_state(int32_t site_id, uint32_t *epoch, uint32_t *n_migrated, uint32_t *n_ins) {
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return EINVAL;
+  dlx_site_state_t *site = &g_site_state[site_id];
+  *epoch = __atomic_load_n(&site->epoch, __ATOMIC_ACQUIRE);
+  *n_migrated = __atomic_load_n(&site->n_migrated, __ATOMIC_RELAXED);
+  *n_ins = __atomic_load_n(&site->n_ins, __ATOMIC_RELAXED);
+  return 0;
+}
+
+#ifdef __DYLINX_HOTSWAP__
+static void __dlx_migrate(dlx_generic_lock_t *mtx, dlx_site_state_t *site) {
+  uint32_t idle = 0;
+  if (__atomic_load_n(&mtx->users, __ATOMIC_RELAXED) & DLX_SWAP_PINNED)
+    return;
+  if (!__atomic_compare_exchange_n(&mtx->users, &idle, DLX_SWAP_BUSY, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return;
+  uint32_t epoch = __atomic_load_n(&site->epoch, __ATOMIC_ACQUIRE);
+  const dlx_injected_interface_t *next = __atomic_load_n(&site->methods, __ATOMIC_ACQUIRE);
+  if (mtx->epoch != epoch && next) {
+    // Build the new backend first so that a failure leaves the old one.
+    void *obj = NULL;
+    if (next->init_fptr(&obj, NULL, dlx_site_conf(mtx->ind.pair.type_id)) == 0) {
+      mtx->methods->destroy_fptr(mtx->lock_obj);
+      dlx_account_lock(mtx->ind.pair.type_id, mtx->methods, -1);
+      dlx_account_lock(mtx->ind.pair.type_id, next, 1);
+      mtx->methods = next;
+      mtx->lock_obj = obj;
+      mtx->epoch = epoch;
+      mtx->home = 0;
+      __atomic_add_fetch(&site->n_migrated, 1, __ATOMIC_RELAXED);
     }
-    return object;
+  }
+  __atomic_fetch_and(&mtx->users, ~DLX_SWAP_BUSY, __ATOMIC_RELEASE);
+}
+
+// NUMA re-homing. On DLX_PLACE_FOLLOW sites about one in DLX_HOME_SAMPLE
+// entries of a thread votes for its node in the home word of the instance.
+// The gaps are randomized so that a thread cycling over a few locks does
+// not always sample the same one. The vote is a majority vote, samples
+// from other nodes cancel the leader's lead. When a node other than the
+// backend's leads by DLX_HOME_LEAD, the backend is rebuilt on that node
+// the same way a hot swap rebuilds it, once the instance is idle.
+// Acquirers spread evenly over nodes never build up a lead, so a shared
+// lock stays put.
+#define DLX_HOME_SAMPLE 64
+#define DLX_HOME_LEAD 32
+#define DLX_HOME_NODE(home) ((home) & 0xff)
+#define DLX_HOME_CAND(home) (((home) >> 8) & 0xff)
+#define DLX_HOME_VOTE(home) ((home) >> 16)
+
+static __thread uint32_t t_home_gap = DLX_HOME_SAMPLE;
+static __thread uint32_t t_home_seed = 0;
+
+static inline int __dlx_home_due(void) {
+  if (--t_home_gap)
+    return 0;
+  uint32_t x = t_home_seed? t_home_seed: (uint32_t)(uintptr_t)&t_home_seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  t_home_seed = x;
+  t_home_gap = 1 + x % (2 * DLX_HOME_SAMPLE);
+  return 1;
+}
+
+static void __dlx_rehome(dlx_generic_lock_t *mtx, dlx_site_state_t *site, uint32_t node) {
+  uint32_t idle = 0;
+  if (!__atomic_compare_exchange_n(&mtx->users, &idle, DLX_SWAP_BUSY, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return;
+  dlx_lock_conf_t conf = *dlx_site_conf(mtx->ind.pair.type_id);
+  conf.place = (dlx_place_t){ DLX_PLACE_NODE, dlx_topology()->node_os[node] };
+  void *obj = NULL;
+  if (mtx->methods->init_fptr(&obj, NULL, &conf) == 0) {
+    mtx->methods->destroy_fptr(mtx->lock_obj);
+    mtx->lock_obj = obj;
+    __atomic_add_fetch(&site->n_rehomed, 1, __ATOMIC_RELAXED);
+  }
+  // Either way the vote starts over, a failed rebuild retries later.
+  mtx->home = node + 1;
+  __atomic_fetch_and(&mtx->users, ~DLX_SWAP_BUSY, __ATOMIC_RELEASE);
+}
+
+static void __dlx_home_sample(dlx_generic_lock_t *mtx, dlx_site_state_t *site) {
+  if (g_site_conf[mtx->ind.pair.type_id].place.kind != DLX_PLACE_FOLLOW || dlx_topology()->n_node < 2)
+    return;
+  uint32_t node = dlx_current_node();
+  uint32_t home = mtx->home;
+  if (node >= 0xff)
+    return;
+  if (!DLX_HOME_NODE(home)) {
+    int32_t at = dlx_lock_node(mtx->lock_obj);
+    home = at >= 0 && at < 0xff? (uint32_t)at + 1: node + 1;
+  }
+  uint32_t cand = DLX_HOME_CAND(home), vote = DLX_HOME_VOTE(home);
+  if (cand == node)
+    vote += vote < 0xffff;
+  else if (vote)
+    vote--;
+  else
+    cand = node, vote = 1;
+  // Racing samples may overwrite each other, losing a vote is harmless.
+  mtx->home = DLX_HOME_NODE(home) | cand << 8 | vote << 16;
+  if (cand + 1 != DLX_HOME_NODE(home) && vote >= DLX_HOME_LEAD)
+    __dlx_rehome(mtx, site, cand);
+}
+
+static inline void __dlx_enter(dlx_generic_lock_t *mtx) {
+  int32_t site_id = mtx->ind.pair.type_id;
+  if (site_id >= 0 && site_id < g_n_site_conf) {
+    dlx_site_state_t *site = &g_site_state[site_id];
+    if (__atomic_load_n(&site->epoch, __ATOMIC_ACQUIRE) != mtx->epoch)
+      __dlx_migrate(mtx, site);
+    else if (__dlx_home_due())
+      __dlx_home_sample(mtx, site);
+  }
+  if (__atomic_fetch_add(&mtx->users, 1, __ATOMIC_ACQUIRE) & DLX_SWAP_BUSY) {
+    while (__atomic_load_n(&mtx->users, __ATOMIC_ACQUIRE) & DLX_SWAP_BUSY)
+      CPU_PAUSE();
+  }
+}
+
+static inline void __dlx_leave(dlx_generic_lock_t *mtx) {
+  __atomic_fetch_sub(&mtx->users, 1, __ATOMIC_RELEASE);
+}
+
+// Lock statistics for dylinx-autotune.c. Only instances that already run
+// the current backend of their site are counted. Hold time is measured
+// against a small per-thread stack of held locks, deeper nesting is not
+// measured.
+#define DLX_TUNE_DEPTH 8
+
+static volatile int g_tune_measure = 0;
+static __thread struct { void *lock; uint64_t since; } t_held[DLX_TUNE_DEPTH];
+static __thread uint32_t t_n_held = 0;
+
+static inline uint64_t __dlx_tune_begin(void) {
+  return __atomic_load_n(&g_tune_measure, __ATOMIC_RELAXED)? rdtsc_u64(): 0;
+}
+
+static inline dlx_site_state_t *__dlx_tune_site(dlx_generic_lock_t *mtx) {
+  int32_t site_id = mtx->ind.pair.type_id;
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return NULL;
+  dlx_site_state_t *site = &g_site_state[site_id];
+  return __atomic_load_n(&site->epoch, __ATOMIC_RELAXED) == mtx->epoch? site: NULL;
+}
+
+static inline void __dlx_tune_hold(dlx_generic_lock_t *mtx, uint64_t now) {
+  if (t_n_held < DLX_TUNE_DEPTH) {
+    t_held[t_n_held].lock = mtx;
+    t_held[t_n_held++].since = now;
+  }
+}
+
+static inline void __dlx_tune_acquired(dlx_generic_lock_t *mtx, uint64_t begin) {
+  dlx_site_state_t *site;
+  if (!begin || !(site = __dlx_tune_site(mtx)))
+    return;
+  uint64_t now = rdtsc_u64();
+  __atomic_add_fetch(&site->n_acq, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&site->wait_cyc, now - begin, __ATOMIC_RELAXED);
+  __dlx_tune_hold(mtx, now);
+}
+
+static inline void __dlx_tune_released(dlx_generic_lock_t *mtx) {
+  for (uint32_t i = t_n_held; i-- > 0;) {
+    if (t_held[i].lock != mtx)
+      continue;
+    dlx_site_state_t *site = __dlx_tune_site(mtx);
+    if (site)
+      __atomic_add_fetch(&site->hold_cyc, rdtsc_u64() - t_held[i].since, __ATOMIC_RELAXED);
+    t_held[i] = t_held[--t_n_held];
+    return;
+  }
+}
+
+// A cond-waiter gives the lock up while it sleeps, so only the time after
+// it got the lock back counts as hold.
+static inline void __dlx_tune_rehold(dlx_generic_lock_t *mtx) {
+  if (__atomic_load_n(&g_tune_measure, __ATOMIC_RELAXED) && __dlx_tune_site(mtx))
+    __dlx_tune_hold(mtx, rdtsc_u64());
+}
+
+int dlx_tune_measure(int on) {
+  if (on)
+    __dlx_hook(DLX_HOOK_TUNE);
+  __atomic_store_n(&g_tune_measure, on, __ATOMIC_RELAXED);
+  return 0;
+}
+#else
+static inline void __dlx_enter(dlx_generic_lock_t *mtx) {}
+static inline void __dlx_leave(dlx_generic_lock_t *mtx) {}
+static inline uint64_t __dlx_tune_begin(void) { return 0; }
+static inline void __dlx_tune_acquired(dlx_generic_lock_t *mtx, uint64_t begin) {}
+static inline void __dlx_tune_released(dlx_generic_lock_t *mtx) {}
+static inline void __dlx_tune_rehold(dlx_generic_lock_t *mtx) {}
+
+int dlx_tune_measure(int on) {
+  return ENOTSUP;
+}
+#endif // __DYLINX_HOTSWAP__
+
+int dlx_site_take_stats(int32_t site_id, dlx_site_stats_t *stats) {
+  if (site_id < 0 || site_id >= g_n_site_conf)
+    return EINVAL;
+  dlx_site_state_t *site = &g_site_state[site_id];
+  stats->n_acq = __atomic_exchange_n(&site->n_acq, 0, __ATOMIC_RELAXED);
+  stats->wait_cyc = __atomic_exchange_n(&site->wait_cyc, 0, __ATOMIC_RELAXED);
+  stats->hold_cyc = __atomic_exchange_n(&site->hold_cyc, 0, __ATOMIC_RELAXED);
+  return 0;
+}
+// }}}
+
+// {{{ footprint
+// A lock costs its header, as declared by the subject, plus its backend at
+// the size of the backend type. Arena and allocator rounding is left out.
+// Untracked locks and sites that were never registered share one entry.
+static dlx_footprint_t g_type_footprint[DLX_N_LOCK_COLLECTION];
+static dlx_footprint_t g_untracked_footprint;
+static char *g_footprint_log = NULL;
+
+static void __dlx_footprint_add(dlx_footprint_t *fp, int64_t n, int64_t bytes) {
+  __atomic_add_fetch(&fp->n_live, n, __ATOMIC_RELAXED);
+  uint64_t now = __atomic_add_fetch(&fp->bytes, bytes, __ATOMIC_RELAXED);
+  uint64_t peak = __atomic_load_n(&fp->peak, __ATOMIC_RELAXED);
+  while (now > peak && !__atomic_compare_exchange_n(&fp->peak, &peak, now, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static dlx_footprint_t *__dlx_site_footprint(int32_t site_id) {
+  return site_id >= 0 && site_id < g_n_site_conf? &g_site_state[site_id].footprint: &g_untracked_footprint;
+}
+
+static dlx_footprint_t *__dlx_type_footprint(const dlx_injected_interface_t *methods) {
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION; i++) {
+    if (methods == g_lock_collection[i].methods)
+      return &g_type_footprint[i];
   }
   return NULL;
 }
 
-int dlx_error_var_init(void *lock, const pthread_mutexattr_t *attr, int type_id, char *file, char *var_name, int line) {
-  char error_msg[1000];
-  sprintf(
-    error_msg,
-    "Untrackable variable of locks are trying to init. Possible\n"
-    "cause is _Generic function falls into \'default\' option.\n"
-    "According to source code, it happens near %s L%d [%s]",
-    file, line, var_name
+void dlx_account_lock(int32_t site_id, const dlx_injected_interface_t *methods, int32_t n) {
+  size_t header = dlx_site_conf(site_id)->layout == DLX_LAYOUT_ISOLATE?
+    DLX_PREFETCH_PAIR: sizeof(dlx_generic_lock_t);
+  // Process-shared locks have no methods and no backend.
+  int64_t bytes = (int64_t)n * (int64_t)(header + (methods? methods->backend_size: 0));
+  __dlx_footprint_add(__dlx_site_footprint(site_id), n, bytes);
+  if (n > 0 && methods && site_id >= 0 && site_id < g_n_site_conf)
+    __atomic_store_n(&g_site_state[site_id].built, methods, __ATOMIC_RELAXED);
+  dlx_footprint_t *type = __dlx_type_footprint(methods);
+  if (type)
+    __dlx_footprint_add(type, n, bytes);
+}
+
+static void __dlx_footprint_entry(FILE *fp, const char *sep, const char *key, dlx_footprint_t *entry) {
+  fprintf(
+    fp, "%s\n    \"%s\": { \"locks\": %lu, \"bytes\": %lu, \"peak\": %lu, \"reclaimed\": %lu }", sep, key,
+    (unsigned long)entry->n_live, (unsigned long)entry->bytes, (unsigned long)entry->peak,
+    (unsigned long)entry->n_reclaimed
   );
-  HANDLING_ERROR(error_msg);
-  return -1;
 }
 
-int dlx_untrack_var_init(dlx_generic_lock_t *lock, const pthread_mutexattr_t *attr, int type_id, char *var_name, char *file, int line) {
-  if (lock && lock->check_code == 0x32CB00B5)
-    return 0;
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
-  char log_msg[300];
-  printf("Untracked lock variable located in %s %s L%4d is initialized\n", file, var_name, line);
-#endif
-  // The untracked lock instance is initialized with pthreadmtx
-  // by default.
-  lock->methods = calloc(1, sizeof(dlx_injected_interface_t));
-  lock->methods->init_fptr = pthreadmtx_init;
-  lock->methods->lock_fptr = pthreadmtx_lock;
-  lock->methods->trylock_fptr = pthreadmtx_trylock;
-  lock->methods->unlock_fptr = pthreadmtx_unlock;
-  lock->methods->destroy_fptr = pthreadmtx_destroy;
-  lock->methods->cond_timedwait_fptr = pthreadmtx_cond_timedwait;
-  lock->check_code = 0x32CB00B5;
-  lock->ind.pair.type_id = -1;
-  lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
-  return (!lock->methods || lock->methods->init_fptr(&lock->lock_obj, NULL))? -1: 0;
+static void __dlx_footprint_line(const char *key, dlx_footprint_t *entry) {
+  if (entry->peak) {
+    fprintf(
+      stderr, "  %-16s %8lu %12lu %12lu %8lu\n", key,
+      (unsigned long)entry->n_live, (unsigned long)entry->bytes, (unsigned long)entry->peak,
+      (unsigned long)entry->n_reclaimed
+    );
+  }
 }
 
-int dlx_error_check_init(void *object, const pthread_mutexattr_t *attr, char *var_name, char *file, int line) {
-  dlx_generic_lock_t *lock = (dlx_generic_lock_t *)object;
-  if (lock && lock->check_code == 0x32CB00B5)
-    return 0;
-  char error_msg[1000];
-  sprintf(
-    error_msg,
-    "Untrackable checking initialization is conducted. Possible\n"
-    "cause is _Generic function falls into \'default\' option.\n"
-    "According to source code, error of checking %s happens near %s L%d.",
-    var_name, file, line
-  );
-  HANDLING_ERROR(error_msg);
-  return -1;
+static void __dlx_footprint_report(void) {
+  char key[32];
+  fprintf(stderr, "[Dylinx] lock footprint (live locks, live bytes, peak bytes, reclaimed):\n");
+  for (int32_t i = 0; i < g_n_site_conf; i++) {
+    snprintf(key, sizeof(key), "site %d", i);
+    __dlx_footprint_line(key, &g_site_state[i].footprint);
+  }
+  __dlx_footprint_line("untracked", &g_untracked_footprint);
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION; i++) {
+    snprintf(key, sizeof(key), "type %s", g_lock_collection[i].name);
+    __dlx_footprint_line(key, &g_type_footprint[i]);
+  }
+  FILE *fp = fopen(g_footprint_log, "w");
+  if (!fp)
+    return;
+  const char *sep = "";
+  fprintf(fp, "{\n  \"sites\": {");
+  for (int32_t i = 0; i < g_n_site_conf; i++) {
+    if (!g_site_state[i].footprint.peak)
+      continue;
+    snprintf(key, sizeof(key), "%d", i);
+    __dlx_footprint_entry(fp, sep, key, &g_site_state[i].footprint);
+    sep = ",";
+  }
+  if (g_untracked_footprint.peak)
+    __dlx_footprint_entry(fp, sep, "-1", &g_untracked_footprint);
+  fprintf(fp, "\n  },\n  \"types\": {");
+  sep = "";
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION; i++) {
+    if (!g_type_footprint[i].peak)
+      continue;
+    __dlx_footprint_entry(fp, sep, g_lock_collection[i].name, &g_type_footprint[i]);
+    sep = ",";
+  }
+  fprintf(fp, "\n  }\n}\n");
+  fclose(fp);
 }
 
-int dlx_untrack_check_init(dlx_generic_lock_t *lock, const pthread_mutexattr_t *attr, char *var_name, char *file, int line) {
-  if (lock && lock->check_code == 0x32CB00B5)
+int dlx_footprint_log(const char *path) {
+  if (!path || !*path)
     return 0;
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
-  char log_msg[300];
-  printf("Untracked lock variable located in %s %s L%4d is checked\n", file, var_name, line);
-#endif
-  lock->methods = calloc(1, sizeof(dlx_injected_interface_t));
-  lock->methods->init_fptr = pthreadmtx_init;
-  lock->methods->lock_fptr = pthreadmtx_lock;
-  lock->methods->trylock_fptr = pthreadmtx_trylock;
-  lock->methods->unlock_fptr = pthreadmtx_unlock;
-  lock->methods->destroy_fptr = pthreadmtx_destroy;
-  lock->methods->cond_timedwait_fptr = pthreadmtx_cond_timedwait;
-  lock->check_code = 0x32CB00B5;
-  lock->ind.pair.type_id = -1;
-  lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
-  return (!lock->methods || lock->methods->init_fptr(&lock->lock_obj, NULL))? -1: 0;
+  g_footprint_log = strdup(path);
+  return g_footprint_log? atexit(__dlx_footprint_report): ENOMEM;
 }
+// }}}
 
-int dlx_error_arr_init(void *lock, uint32_t size, int type_id, char *var_name, char *file, int line) {
-  char error_msg[1000];
-  sprintf(
-    error_msg,
-    "Untrackable array of locks are trying to init. Possible\n"
+// {{{ contention statistics
+// Per-site mutex statistics, off until dlx_stats_log. Every thread counts
+// into a shard of its own, merged when the report is written at exit or
+// asked for, so counting takes no atomic instruction. An acquisition tries
+// the lock first. Only a failed try counts as contended, and only then is
+// the wait timed. Hold time is timed on one acquisition in
+// DLX_STAT_HOLD_SAMPLE and scaled up in the report. Instances are told
+// apart only once contended: a shard keeps the contended acquisitions and
+// wait of up to DLX_STAT_INS instances, the report lists the DLX_STAT_TOP
+// worst of each site. Shards of finished threads stay until exit.
+// Histograms are kept per site and lock type, so that a hot-swapped site
+// reports each of its types apart. A shard chains the histograms of a
+// site newest type first and never reorders them, readers merging on
+// demand walk the chains while their owner records. Bucket counts are 32
+// bits per thread, 64 bits once merged.
+// With dlx_stats_counters, the sampled holds also read the hardware
+// counters of their thread when the lock is taken and when it is given
+// up, so the deltas cost nothing on the other acquisitions. A section
+// that misses the LLC or pulls a modified line from another core at
+// least once on average, or retires under DLX_STAT_LOW_IPC instructions
+// a cycle, is reported bound by data movement, which a lock moving fewer
+// lines between cores helps. Other sections are bound by compute, where
+// shortening them or taking the lock less often pays.
+#define DLX_STAT_HOLD_SAMPLE 16
+#define DLX_STAT_INS 64
+#define DLX_STAT_PROBE 4
+#define DLX_STAT_TOP 3
+#define DLX_STAT_LOW_IPC 0.5
+
+typedef struct dlx_ins_stats {
+  int64_t long_id;
+  uint64_t n_contended;
+  uint64_t wait_cyc;
+  // DLX_HIST_BUCKETS waits with dlx_stats_instances, NULL otherwise.
+  uint32_t *wait_hist;
+} dlx_ins_stats_t;
+
+typedef struct dlx_stat_hist {
+  struct dlx_stat_hist *next;
+  const dlx_injected_interface_t *methods;
+  uint64_t n_acq;
+  uint32_t wait[DLX_HIST_BUCKETS];
+  uint32_t hold[DLX_HIST_BUCKETS];
+} dlx_stat_hist_t;
+
+typedef struct dlx_stat_shard {
+  struct dlx_stat_shard *next;
+  int32_t n_site;
+  // n_site + 1 entries each, the last one for untracked locks.
+  dlx_lock_stats_t *site;
+  dlx_stat_hist_t **hist;
+  // With dlx_stats_counters, NULL otherwise.
+  dlx_lock_counters_t *counters;
+  dlx_ins_stats_t ins[DLX_STAT_INS];
+} dlx_stat_shard_t;
+
+static volatile int g_stats_on = 0;
+static int g_stats_instances = 0;
+static int g_stats_counters = 0;
+static char *g_stats_log = NULL;
+static dlx_stat_shard_t *g_stat_shards = NULL;
+static __thread dlx_stat_shard_t *t_stat_shard = NULL;
+static __thread uint32_t t_stat_gap = 0;
+static __thread struct {
+  void *lock;
+  uint64_t since;
+  int counted;
+  uint64_t count[DLX_PERF_MAX];
+} t_stat_hold;
+
+static dlx_stat_shard_t *__dlx_stat_shard_new(void) {
+  dlx_stat_shard_t *shard = calloc(1, sizeof(dlx_stat_shard_t));
+  dlx_lock_stats_t *site = calloc(g_n_site_conf + 1, sizeof(dlx_lock_stats_t));
+  dlx_stat_hist_t **hist = calloc(g_n_site_conf + 1, sizeof(dlx_stat_hist_t *));
+  dlx_lock_counters_t *counters = g_stats_counters? calloc(g_n_site_conf + 1, sizeof(dlx_lock_counters_t)): NULL;
+  if (!shard || !site || !hist || (g_stats_counters && !counters)) {
+    free(shard);
+    free(site);
+    free(hist);
+    free(counters);
+    return NULL;
+  }
+  shard->n_site = g_n_site_conf;
+  shard->site = site;
+  shard->hist = hist;
+  shard->counters = counters;
+  shard->next = __atomic_load_n(&g_stat_shards, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&g_stat_shards, &shard->next, shard, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  t_stat_shard = shard;
+  return shard;
+}
+
+// Counters of the calling thread for the site of mtx, NULL while off.
+static inline dlx_lock_stats_t *__dlx_stat_of(dlx_generic_lock_t *mtx) {
+  if (!g_stats_on)
+    return NULL;
+  dlx_stat_shard_t *shard = t_stat_shard? t_stat_shard: __dlx_stat_shard_new();
+  if (!shard)
+    return NULL;
+  int32_t site_id = mtx->ind.pair.type_id;
+  return &shard->site[site_id >= 0 && site_id < shard->n_site? site_id: shard->n_site];
+}
+
+static dlx_stat_hist_t *__dlx_stat_hist_new(dlx_stat_hist_t **head, const dlx_injected_interface_t *methods) {
+  dlx_stat_hist_t *hist = calloc(1, sizeof(dlx_stat_hist_t));
+  if (!hist)
+    return NULL;
+  hist->methods = methods;
+  hist->next = *head;
+  __atomic_store_n(head, hist, __ATOMIC_RELEASE);
+  return hist;
+}
+
+// Histograms of the calling thread for the site and type of mtx.
+static inline dlx_stat_hist_t *__dlx_stat_hist(dlx_generic_lock_t *mtx) {
+  dlx_stat_shard_t *shard = t_stat_shard;
+  int32_t site_id = mtx->ind.pair.type_id;
+  dlx_stat_hist_t **head = &shard->hist[site_id >= 0 && site_id < shard->n_site? site_id: shard->n_site];
+  for (dlx_stat_hist_t *hist = *head; hist; hist = hist->next) {
+    if (hist->methods == mtx->methods)
+      return hist;
+  }
+  return __dlx_stat_hist_new(head, mtx->methods);
+}
+
+static void __dlx_stat_instance(dlx_generic_lock_t *mtx, uint64_t wait) {
+  dlx_ins_stats_t *ins = t_stat_shard->ins;
+  int64_t long_id = mtx->ind.long_id;
+  uint32_t at = (uint64_t)long_id * 0x9E3779B97F4A7C15ull >> 58;
+  for (uint32_t i = 0; i < DLX_STAT_PROBE; i++, at = (at + 1) % DLX_STAT_INS) {
+    if (ins[at].n_contended && ins[at].long_id != long_id)
+      continue;
+    ins[at].long_id = long_id;
+    if (g_stats_instances && !ins[at].wait_hist)
+      ins[at].wait_hist = calloc(DLX_HIST_BUCKETS, sizeof(uint32_t));
+    if (ins[at].wait_hist)
+      ins[at].wait_hist[dlx_hist_bucket(wait)]++;
+    __atomic_store_n(&ins[at].n_contended, ins[at].n_contended + 1, __ATOMIC_RELEASE);
+    ins[at].wait_cyc += wait;
+    return;
+  }
+}
+
+// wait is 0 unless the acquisition was contended.
+static inline void __dlx_stat_acquired(dlx_generic_lock_t *mtx, dlx_lock_stats_t *stats, uint64_t wait) {
+  stats->n_acq++;
+  dlx_stat_hist_t *hist = __dlx_stat_hist(mtx);
+  if (hist) {
+    hist->n_acq++;
+    if (wait)
+      hist->wait[dlx_hist_bucket(wait)]++;
+  }
+  if (t_stat_gap--)
+    return;
+  t_stat_gap = DLX_STAT_HOLD_SAMPLE - 1;
+  if (!t_stat_hold.lock) {
+    t_stat_hold.lock = mtx;
+    t_stat_hold.counted = g_stats_counters && !dlx_perf_read(t_stat_hold.count);
+    t_stat_hold.since = rdtsc_u64();
+  }
+}
+
+// Adds the counter deltas of the sampled section of mtx that ends here.
+static void __dlx_stat_count(dlx_generic_lock_t *mtx) {
+  uint64_t now[DLX_PERF_MAX];
+  if (dlx_perf_read(now))
+    return;
+  dlx_stat_shard_t *shard = t_stat_shard;
+  int32_t site_id = mtx->ind.pair.type_id;
+  dlx_lock_counters_t *counters = &shard->counters[site_id >= 0 && site_id < shard->n_site? site_id: shard->n_site];
+  counters->n_section++;
+  for (uint32_t i = 0; i < g_dlx_perf_n; i++)
+    counters->count[i] += now[i] - t_stat_hold.count[i];
+}
+
+// Also called before a condition wait, which gives the lock up.
+static inline void __dlx_stat_released(dlx_generic_lock_t *mtx) {
+  if (t_stat_hold.lock != mtx)
+    return;
+  t_stat_hold.lock = NULL;
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  if (stats) {
+    uint64_t hold = rdtsc_u64() - t_stat_hold.since;
+    if (t_stat_hold.counted)
+      __dlx_stat_count(mtx);
+    dlx_stat_hist_t *hist = __dlx_stat_hist(mtx);
+    stats->n_hold++;
+    stats->hold_cyc += hold;
+    if (hist)
+      hist->hold[dlx_hist_bucket(hold)]++;
+  }
+}
+
+// lock_fptr, or timedlock_fptr with a deadline, timed. A trylock first
+// would jump the queue of a fair lock, so an acquisition counts as
+// contended once it took DLX_STAT_CONTENDED_CYC, longer than a free lock
+// takes even with its line in another core's cache.
+#define DLX_STAT_CONTENDED_CYC 2048
+
+static int __dlx_stat_lock(dlx_generic_lock_t *mtx, dlx_lock_stats_t *stats, const struct timespec *time) {
+  uint64_t begin = rdtsc_u64();
+  int ret = time? mtx->methods->timedlock_fptr(mtx->lock_obj, time): mtx->methods->lock_fptr(mtx->lock_obj);
+  uint64_t wait = rdtsc_u64() - begin;
+  if (wait < DLX_STAT_CONTENDED_CYC && !ret) {
+    wait = 0;
+  } else {
+    stats->n_contended++;
+    stats->wait_cyc += wait;
+    __dlx_stat_instance(mtx, wait);
+  }
+  if (!ret)
+    __dlx_stat_acquired(mtx, stats, wait);
+  return ret;
+}
+
+int dlx_stats_site(int32_t site_id, dlx_lock_stats_t *stats) {
+  if (site_id < -1 || site_id >= g_n_site_conf)
+    return EINVAL;
+  memset(stats, 0, sizeof(dlx_lock_stats_t));
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    if (site_id >= shard->n_site)
+      continue;
+    dlx_lock_stats_t *part = &shard->site[site_id < 0? shard->n_site: site_id];
+    stats->n_acq += part->n_acq;
+    stats->n_contended += part->n_contended;
+    stats->n_try_fail += part->n_try_fail;
+    stats->n_cond_wait += part->n_cond_wait;
+    stats->wait_cyc += part->wait_cyc;
+    stats->n_hold += part->n_hold;
+    stats->hold_cyc += part->hold_cyc;
+  }
+  return 0;
+}
+
+static void __dlx_stat_merge(dlx_lock_hist_t *hist, const dlx_stat_hist_t *part) {
+  uint64_t n_wait = 0;
+  hist->n_acq += part->n_acq;
+  for (uint32_t i = 0; i < DLX_HIST_BUCKETS; i++) {
+    hist->wait[i] += part->wait[i];
+    hist->hold[i] += part->hold[i];
+    n_wait += part->wait[i];
+  }
+  // The owner may be counting meanwhile, so the two can be a little apart.
+  hist->wait[0] += part->n_acq > n_wait? part->n_acq - n_wait: 0;
+}
+
+int dlx_stats_hist(int32_t site_id, dlx_lock_hist_t *hist) {
+  if (site_id < -1 || site_id >= g_n_site_conf)
+    return EINVAL;
+  memset(hist, 0, sizeof(dlx_lock_hist_t));
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    if (site_id >= shard->n_site)
+      continue;
+    dlx_stat_hist_t **head = &shard->hist[site_id < 0? shard->n_site: site_id];
+    for (dlx_stat_hist_t *part = __atomic_load_n(head, __ATOMIC_ACQUIRE); part; part = part->next)
+      __dlx_stat_merge(hist, part);
+  }
+  return 0;
+}
+
+int dlx_stats_type_hist(const char *ltype, dlx_lock_hist_t *hist) {
+  const dlx_injected_interface_t *methods = NULL;
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION && ltype; i++) {
+    if (!strcasecmp(g_lock_collection[i].name, ltype))
+      methods = g_lock_collection[i].methods;
+  }
+  if (!methods)
+    return EINVAL;
+  memset(hist, 0, sizeof(dlx_lock_hist_t));
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    for (int32_t i = 0; i <= shard->n_site; i++) {
+      for (dlx_stat_hist_t *part = __atomic_load_n(&shard->hist[i], __ATOMIC_ACQUIRE); part; part = part->next) {
+        if (part->methods == methods)
+          __dlx_stat_merge(hist, part);
+      }
+    }
+  }
+  return 0;
+}
+
+int dlx_stats_instances(const char *on) {
+  g_stats_instances = on && *on;
+  return 0;
+}
+
+int dlx_stats_counters(const char *events) {
+  if (!events || !*events)
+    return 0;
+  int ret = dlx_perf_init(events);
+  g_stats_counters = !ret;
+  return ret;
+}
+
+int dlx_stats_site_counters(int32_t site_id, dlx_lock_counters_t *counters) {
+  if (site_id < -1 || site_id >= g_n_site_conf)
+    return EINVAL;
+  memset(counters, 0, sizeof(dlx_lock_counters_t));
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    if (site_id >= shard->n_site || !shard->counters)
+      continue;
+    dlx_lock_counters_t *part = &shard->counters[site_id < 0? shard->n_site: site_id];
+    counters->n_section += part->n_section;
+    for (uint32_t i = 0; i < DLX_PERF_MAX; i++)
+      counters->count[i] += part->count[i];
+  }
+  return 0;
+}
+
+// Per section average of the counter called name, -1 if it is not counted.
+static double __dlx_stat_per_section(const dlx_lock_counters_t *counters, const char *name) {
+  for (uint32_t i = 0; dlx_perf_name(i); i++) {
+    if (!strcmp(dlx_perf_name(i), name))
+      return (double)counters->count[i] / counters->n_section;
+  }
+  return -1;
+}
+
+// Instructions per cycle into ipc, -1 without both counters, and what
+// bounds the sections, NULL when nothing tells.
+static const char *__dlx_stat_bound(const dlx_lock_counters_t *counters, double *ipc) {
+  double cycles = __dlx_stat_per_section(counters, "cycles");
+  double insts = __dlx_stat_per_section(counters, "instructions");
+  double misses = __dlx_stat_per_section(counters, "llc-misses");
+  double hitm = __dlx_stat_per_section(counters, "hitm");
+  *ipc = cycles > 0 && insts >= 0? insts / cycles: -1;
+  if ((misses >= 0? misses: 0) + (hitm >= 0? hitm: 0) >= 1 || (*ipc >= 0 && *ipc < DLX_STAT_LOW_IPC))
+    return "data";
+  return misses >= 0 || hitm >= 0 || *ipc >= 0? "compute": NULL;
+}
+
+// Wait histogram of one instance over every shard, 0 if none kept one.
+static uint64_t __dlx_stat_ins_hist(int64_t long_id, uint64_t *wait) {
+  uint64_t n = 0;
+  memset(wait, 0, DLX_HIST_BUCKETS * sizeof(uint64_t));
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    for (uint32_t i = 0; i < DLX_STAT_INS; i++) {
+      dlx_ins_stats_t *ins = &shard->ins[i];
+      if (!__atomic_load_n(&ins->n_contended, __ATOMIC_ACQUIRE) || ins->long_id != long_id || !ins->wait_hist)
+        continue;
+      for (uint32_t j = 0; j < DLX_HIST_BUCKETS; j++) {
+        wait[j] += ins->wait_hist[j];
+        n += ins->wait_hist[j];
+      }
+    }
+  }
+  return n;
+}
+
+static void __dlx_stat_pct(FILE *fp, const char *key, const uint64_t *buckets) {
+  fprintf(
+    fp, ", \"%s\": [%lu, %lu, %lu]", key, (unsigned long)dlx_hist_quantile(buckets, 0.5),
+    (unsigned long)dlx_hist_quantile(buckets, 0.99), (unsigned long)dlx_hist_quantile(buckets, 0.999)
+  );
+}
+
+static uint64_t __dlx_stat_hold_estimate(const dlx_lock_stats_t *stats) {
+  return stats->n_hold? (uint64_t)((double)stats->hold_cyc * stats->n_acq / stats->n_hold): 0;
+}
+
+static void __dlx_stat_counters_json(FILE *fp, int32_t site_id) {
+  dlx_lock_counters_t counters;
+  double ipc;
+  if (!g_stats_counters || dlx_stats_site_counters(site_id, &counters) || !counters.n_section)
+    return;
+  fprintf(fp, ", \"counters\": { \"sections\": %lu", (unsigned long)counters.n_section);
+  for (uint32_t i = 0; dlx_perf_name(i); i++)
+    fprintf(fp, ", \"%s\": %lu", dlx_perf_name(i), (unsigned long)counters.count[i]);
+  const char *bound = __dlx_stat_bound(&counters, &ipc);
+  if (ipc >= 0)
+    fprintf(fp, ", \"ipc\": %.3f", ipc);
+  if (bound)
+    fprintf(fp, ", \"bound\": \"%s\"", bound);
+  fprintf(fp, " }");
+}
+
+// Fills top with the most waited for instances of site_id, returns how
+// many there are.
+static uint32_t __dlx_stat_top(int32_t site_id, dlx_ins_stats_t *top) {
+  uint32_t n_top = 0;
+  for (dlx_stat_shard_t *shard = __atomic_load_n(&g_stat_shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+    for (uint32_t i = 0; i < DLX_STAT_INS; i++) {
+      dlx_ins_stats_t ins = shard->ins[i];
+      if (!ins.n_contended || ((indicator_t)ins.long_id).pair.type_id != site_id)
+        continue;
+      // Other shards may hold the same instance, add them all up first.
+      for (dlx_stat_shard_t *other = shard->next; other; other = other->next) {
+        for (uint32_t j = 0; j < DLX_STAT_INS; j++) {
+          if (other->ins[j].n_contended && other->ins[j].long_id == ins.long_id) {
+            ins.n_contended += other->ins[j].n_contended;
+            ins.wait_cyc += other->ins[j].wait_cyc;
+          }
+        }
+      }
+      uint32_t at = 0;
+      while (at < n_top && top[at].long_id != ins.long_id)
+        at++;
+      if (at < n_top)
+        continue;
+      for (at = n_top; at > 0 && top[at - 1].wait_cyc < ins.wait_cyc; at--) {
+        if (at < DLX_STAT_TOP)
+          top[at] = top[at - 1];
+      }
+      if (at < DLX_STAT_TOP) {
+        top[at] = ins;
+        n_top += n_top < DLX_STAT_TOP;
+      }
+    }
+  }
+  return n_top;
+}
+
+int dlx_stats_dump(const char *path) {
+  path = path? path: g_stats_log;
+  FILE *fp = path? fopen(path, "w"): NULL;
+  if (!fp)
+    return path? errno: EINVAL;
+  dlx_lock_stats_t stats;
+  dlx_ins_stats_t top[DLX_STAT_TOP];
+  dlx_lock_hist_t *hist = malloc(sizeof(dlx_lock_hist_t));
+  if (!hist) {
+    fclose(fp);
+    return ENOMEM;
+  }
+  const char *sep = "";
+  fprintf(fp, "{\n  \"sites\": {");
+  for (int32_t site_id = -1; site_id < g_n_site_conf; site_id++) {
+    dlx_stats_site(site_id, &stats);
+    if (!stats.n_acq && !stats.n_contended && !stats.n_try_fail)
+      continue;
+    fprintf(
+      fp, "%s\n    \"%d\": { \"acq\": %lu, \"contended\": %lu, \"try_fail\": %lu, \"cond_wait\": %lu, "
+      "\"wait_cyc\": %lu, \"hold_cyc\": %lu", sep, site_id,
+      (unsigned long)stats.n_acq, (unsigned long)stats.n_contended, (unsigned long)stats.n_try_fail,
+      (unsigned long)stats.n_cond_wait, (unsigned long)stats.wait_cyc, (unsigned long)__dlx_stat_hold_estimate(&stats)
+    );
+    dlx_stats_hist(site_id, hist);
+    __dlx_stat_pct(fp, "wait_pct", hist->wait);
+    __dlx_stat_pct(fp, "hold_pct", hist->hold);
+    __dlx_stat_counters_json(fp, site_id);
+    fprintf(fp, ", \"hot\": [");
+    uint32_t n_top = __dlx_stat_top(site_id, top);
+    for (uint32_t i = 0; i < n_top; i++) {
+      fprintf(
+        fp, "%s[%u, %lu, %lu", i? ", ": "", ((indicator_t)top[i].long_id).pair.ins_id,
+        (unsigned long)top[i].n_contended, (unsigned long)top[i].wait_cyc
+      );
+      if (__dlx_stat_ins_hist(top[i].long_id, hist->wait)) {
+        fprintf(
+          fp, ", %lu, %lu, %lu", (unsigned long)dlx_hist_quantile(hist->wait, 0.5),
+          (unsigned long)dlx_hist_quantile(hist->wait, 0.99), (unsigned long)dlx_hist_quantile(hist->wait, 0.999)
+        );
+      }
+      fprintf(fp, "]");
+    }
+    fprintf(fp, "] }");
+    sep = ",";
+  }
+  fprintf(fp, "\n  },\n  \"types\": {");
+  sep = "";
+  for (uint32_t i = 0; i < DLX_N_LOCK_COLLECTION; i++) {
+    dlx_stats_type_hist(g_lock_collection[i].name, hist);
+    if (!hist->n_acq)
+      continue;
+    fprintf(fp, "%s\n    \"%s\": { \"acq\": %lu", sep, g_lock_collection[i].name, (unsigned long)hist->n_acq);
+    __dlx_stat_pct(fp, "wait_pct", hist->wait);
+    __dlx_stat_pct(fp, "hold_pct", hist->hold);
+    fprintf(fp, " }");
+    sep = ",";
+  }
+  fprintf(fp, "\n  }\n}\n");
+  fclose(fp);
+  free(hist);
+  return 0;
+}
+
+static void __dlx_stats_counters_report(void) {
+  dlx_lock_counters_t counters;
+  double ipc;
+  fprintf(stderr, "[Dylinx] critical sections (sampled, per section:");
+  for (uint32_t i = 0; dlx_perf_name(i); i++)
+    fprintf(stderr, " %s,", dlx_perf_name(i));
+  fprintf(stderr, " IPC, bound by):\n");
+  for (int32_t site_id = -1; site_id < g_n_site_conf; site_id++) {
+    dlx_stats_site_counters(site_id, &counters);
+    if (!counters.n_section)
+      continue;
+    fprintf(stderr, "  %4d %10lu", site_id, (unsigned long)counters.n_section);
+    for (uint32_t i = 0; dlx_perf_name(i); i++)
+      fprintf(stderr, " %12.1f", (double)counters.count[i] / counters.n_section);
+    const char *bound = __dlx_stat_bound(&counters, &ipc);
+    if (ipc >= 0)
+      fprintf(stderr, " %6.2f", ipc);
+    else
+      fprintf(stderr, " %6s", "-");
+    fprintf(stderr, " %s\n", bound? bound: "-");
+  }
+}
+
+static void __dlx_stats_report(void) {
+  dlx_lock_stats_t stats;
+  fprintf(stderr, "[Dylinx] lock contention (acquired, contended, trylock failed, cond waits, wait cycles, hold cycles):\n");
+  for (int32_t site_id = -1; site_id < g_n_site_conf; site_id++) {
+    dlx_stats_site(site_id, &stats);
+    if (!stats.n_acq && !stats.n_contended && !stats.n_try_fail)
+      continue;
+    fprintf(
+      stderr, "  %4d %12lu %10lu %8lu %8lu %16lu %16lu\n", site_id,
+      (unsigned long)stats.n_acq, (unsigned long)stats.n_contended, (unsigned long)stats.n_try_fail,
+      (unsigned long)stats.n_cond_wait, (unsigned long)stats.wait_cyc, (unsigned long)__dlx_stat_hold_estimate(&stats)
+    );
+  }
+  dlx_lock_hist_t *hist = malloc(sizeof(dlx_lock_hist_t));
+  for (uint32_t i = 0; hist && i < DLX_N_LOCK_COLLECTION; i++) {
+    dlx_stats_type_hist(g_lock_collection[i].name, hist);
+    if (!hist->n_acq)
+      continue;
+    fprintf(
+      stderr, "  type %-12s wait p50 %lu p99 %lu p99.9 %lu, hold p50 %lu p99 %lu p99.9 %lu cycles\n",
+      g_lock_collection[i].name, (unsigned long)dlx_hist_quantile(hist->wait, 0.5),
+      (unsigned long)dlx_hist_quantile(hist->wait, 0.99), (unsigned long)dlx_hist_quantile(hist->wait, 0.999),
+      (unsigned long)dlx_hist_quantile(hist->hold, 0.5), (unsigned long)dlx_hist_quantile(hist->hold, 0.99),
+      (unsigned long)dlx_hist_quantile(hist->hold, 0.999)
+    );
+  }
+  free(hist);
+  if (g_stats_counters)
+    __dlx_stats_counters_report();
+  dlx_stats_dump(NULL);
+}
+
+int dlx_stats_log(const char *path) {
+  if (!path || !*path)
+    return 0;
+  g_stats_log = strdup(path);
+  if (!g_stats_log)
+    return ENOMEM;
+  __dlx_hook(DLX_HOOK_STATS);
+  g_stats_on = 1;
+  return atexit(__dlx_stats_report);
+}
+
+int dlx_stats_start(void) {
+  __dlx_hook(DLX_HOOK_STATS);
+  g_stats_on = 1;
+  return 0;
+}
+// }}}
+
+// {{{ lock event tracing
+// Binary successor of the XRay traces of dlx_forward_enable/disable. Each
+// thread writes fixed-size events into a ring of its own, a flusher thread
+// drains the rings into the trace file every DLX_TRACE_FLUSH_NS, or as
+// soon as a producer finds its ring half full. The file
+// is a dlx_trace_header_t padded to DLX_TRACE_HEADER bytes followed by
+// the events, so readers can map it as an array. A producer never waits
+// for the flusher, a full ring drops the event and counts it. Events of
+// one thread keep their order in the file, threads are interleaved by
+// flush. The flusher is a thread of its own, so a traced subject never
+// runs the single-threaded fast path.
+// dlx_trace_sample trades completeness for overhead. A thread then traces
+// roughly one acquisition in the period of its site, with its release.
+// Periods adapt per thread and site: every DLX_TRACE_BUDGET samples within
+// a flush interval double the period, up to the maximum, and an interval
+// under a quarter of the budget halves it. Rare sites are traced in full,
+// hot ones at the maximum. Gaps between samples are random around the
+// period, so periodic lock patterns do not alias. A sample stands for the
+// gap before it, drawn at the period in force at the previous sample. A
+// DLX_TRACE_RATE event with the new period in delta marks each change, so
+// readers weigh a sampled acquisition, failed trylock or timeout by the
+// last RATE before the previous sample of its thread and site, 1 before
+// any. A window further limits sampling to the first window_ms of every
+// cycle_ms. The header keeps how long it was open and how many
+// acquisitions it saw open, n_seen_open of n_seen, so readers scale by
+// acquisitions rather than by time.
+#define DLX_TRACE_RING (1 << 16)
+#define DLX_TRACE_FLUSH_NS 10000000L
+#define DLX_TRACE_HEADER 128
+#define DLX_TRACE_DEPTH 8
+#define DLX_TRACE_BUDGET 64
+#define DLX_TRACE_CALIBRATE 4096
+
+enum { DLX_TRACE_ACQUIRE, DLX_TRACE_RELEASE, DLX_TRACE_TRYFAIL, DLX_TRACE_REACQUIRE, DLX_TRACE_TIMEOUT, DLX_TRACE_RATE };
+
+typedef struct dlx_trace_event {
+  uint64_t tsc;
+  int32_t site_id;
+  uint32_t ins_id;
+  // Cycles waited for an acquisition, held before a release, saturated.
+  uint32_t delta;
+  uint16_t thread;
+  uint8_t op;
+  // Low 8 bits of the CPU.
+  uint8_t cpu;
+} dlx_trace_event_t;
+
+// Written as a placeholder at start and for real when the trace closes.
+// The (tsc, CLOCK_MONOTONIC) pairs let readers turn cycles into time.
+// overhead_cyc is what the tracing cost the traced threads, measured on
+// sampled events and estimated from calibration for the others.
+// max_period is 1 without sampling, window_ms 0 without a window. The
+// struct must fit in DLX_TRACE_HEADER.
+typedef struct dlx_trace_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t event_size;
+  uint64_t n_event;
+  uint64_t n_dropped;
+  uint64_t start_tsc;
+  uint64_t start_ns;
+  uint64_t end_tsc;
+  uint64_t end_ns;
+  uint32_t pid;
+  uint32_t n_thread;
+  uint64_t n_seen;
+  uint64_t n_seen_open;
+  uint64_t overhead_cyc;
+  uint64_t open_ns;
+  uint32_t max_period;
+  uint32_t window_ms;
+  uint32_t cycle_ms;
+} dlx_trace_header_t;
+
+// Sampling state of one site in one thread.
+typedef struct dlx_trace_site {
+  uint32_t countdown;
+  uint32_t period;
+  uint32_t epoch;
+  uint32_t n_sampled;
+} dlx_trace_site_t;
+
+typedef struct dlx_trace_ring {
+  volatile uint64_t head __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  uint64_t n_dropped;
+  uint64_t n_seen;
+  uint64_t n_seen_open;
+  uint64_t overhead_cyc;
+  uint64_t rand;
+  int32_t n_site;
+  // n_site + 1 entries, the last one for untracked locks.
+  dlx_trace_site_t *site;
+  volatile uint64_t tail __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  struct dlx_trace_ring *next;
+  dlx_trace_event_t ev[DLX_TRACE_RING];
+} dlx_trace_ring_t;
+
+static volatile int g_trace_on = 0;
+// Sampling is on with a period above 1 or a window, g_trace_open tells
+// whether the window is open and g_trace_epoch counts flush intervals.
+static int g_trace_sampling = 0;
+static uint32_t g_trace_max_period = 1;
+static uint32_t g_trace_window_ms = 0;
+static uint32_t g_trace_cycle_ms = 0;
+static volatile int g_trace_open = 1;
+static volatile uint32_t g_trace_epoch = 1;
+// Calibrated cycles of an unsampled check and of reading the TSC.
+static uint64_t g_trace_skip_cyc = 0;
+static uint64_t g_trace_tsc_cyc = 0;
+static uint64_t g_trace_cpu_ns = 0;
+static volatile int g_trace_stop = 0;
+static volatile uint32_t g_trace_kick = 0;
+static int g_trace_fd = -1;
+static pthread_t g_trace_flusher;
+static dlx_trace_header_t g_trace_header;
+static dlx_trace_ring_t *g_trace_rings = NULL;
+static uint32_t g_trace_n_thread = 0;
+static __thread dlx_trace_ring_t *t_trace_ring = NULL;
+static __thread uint16_t t_trace_thread;
+static __thread struct { void *lock; uint64_t since; } t_trace_held[DLX_TRACE_DEPTH];
+static __thread uint32_t t_trace_n_held = 0;
+
+static uint64_t __dlx_monotonic_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static dlx_trace_ring_t *__dlx_trace_ring_new(void) {
+  dlx_trace_ring_t *ring = NULL;
+  if (MEMALIGN(&ring, L_CACHE_LINE_SIZE, sizeof(dlx_trace_ring_t)))
+    return NULL;
+  memset(ring, 0, offsetof(dlx_trace_ring_t, ev));
+  if (g_trace_sampling) {
+    ring->site = calloc(g_n_site_conf + 1, sizeof(dlx_trace_site_t));
+    if (!ring->site) {
+      free(ring);
+      return NULL;
+    }
+    ring->n_site = g_n_site_conf;
+  }
+  t_trace_thread = __atomic_fetch_add(&g_trace_n_thread, 1, __ATOMIC_RELAXED);
+  ring->rand = 0x9E3779B97F4A7C15ull * (t_trace_thread + 1);
+  ring->next = __atomic_load_n(&g_trace_rings, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&g_trace_rings, &ring->next, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  t_trace_ring = ring;
+  return ring;
+}
+
+static void __dlx_trace_emit(dlx_generic_lock_t *mtx, uint8_t op, uint64_t tsc, uint64_t delta) {
+  dlx_trace_ring_t *ring = t_trace_ring? t_trace_ring: __dlx_trace_ring_new();
+  if (!ring)
+    return;
+  uint64_t head = ring->head, used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (used >= DLX_TRACE_RING) {
+    ring->n_dropped++;
+    return;
+  }
+  if (used == DLX_TRACE_RING / 2 && !__atomic_exchange_n(&g_trace_kick, 1, __ATOMIC_RELAXED))
+    futex_wake_u32(&g_trace_kick, 1);
+  dlx_trace_event_t *ev = &ring->ev[head % DLX_TRACE_RING];
+  ev->tsc = tsc;
+  ev->site_id = mtx->ind.pair.type_id;
+  ev->ins_id = mtx->ind.pair.ins_id;
+  ev->delta = delta > UINT32_MAX? UINT32_MAX: delta;
+  ev->thread = t_trace_thread;
+  ev->op = op;
+  ev->cpu = dlx_current_cpu();
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static inline void __dlx_trace_rate(dlx_generic_lock_t *mtx, dlx_trace_site_t *site, uint32_t period) {
+  if (period == site->period)
+    return;
+  site->period = period;
+  __dlx_trace_emit(mtx, DLX_TRACE_RATE, rdtsc_u64(), period);
+}
+
+// Whether the calling thread samples this acquisition of mtx.
+static int __dlx_trace_sampled(dlx_generic_lock_t *mtx) {
+  dlx_trace_ring_t *ring = t_trace_ring? t_trace_ring: __dlx_trace_ring_new();
+  if (!ring)
+    return 0;
+  ring->n_seen++;
+  int32_t site_id = mtx->ind.pair.type_id;
+  dlx_trace_site_t *site = &ring->site[site_id >= 0 && site_id < ring->n_site? site_id: ring->n_site];
+  uint32_t epoch = __atomic_load_n(&g_trace_epoch, __ATOMIC_RELAXED);
+  if (site->epoch != epoch) {
+    // Every interval the site sat idle in counts as a quiet one.
+    uint32_t quiet = epoch - site->epoch - 1 + (site->n_sampled < DLX_TRACE_BUDGET / 4);
+    if (!site->period)
+      site->period = 1;
+    else if (quiet)
+      __dlx_trace_rate(mtx, site, quiet < 32 && site->period >> quiet? site->period >> quiet: 1);
+    site->epoch = epoch;
+    site->n_sampled = 0;
+  }
+  if (!g_trace_open)
+    return 0;
+  ring->n_seen_open++;
+  if (site->countdown) {
+    site->countdown--;
+    return 0;
+  }
+  if (++site->n_sampled % DLX_TRACE_BUDGET == 0 && site->period < g_trace_max_period)
+    __dlx_trace_rate(mtx, site, site->period * 2);
+  if (site->period > 1) {
+    ring->rand ^= ring->rand << 13;
+    ring->rand ^= ring->rand >> 7;
+    ring->rand ^= ring->rand << 17;
+    site->countdown = ring->rand % (2 * site->period - 1);
+  }
+  return 1;
+}
+
+// Timestamp before an acquisition, 0 while tracing is off or the
+// acquisition is not sampled.
+static inline uint64_t __dlx_trace_begin(dlx_generic_lock_t *mtx) {
+  if (!g_trace_on || (g_trace_sampling && !__dlx_trace_sampled(mtx)))
+    return 0;
+  return rdtsc_u64();
+}
+
+// Cycles the trace spent on an event emitted at now, and the TSC reads of
+// its acquisition.
+static inline void __dlx_trace_cost(uint64_t now, uint64_t reads) {
+  if (t_trace_ring)
+    t_trace_ring->overhead_cyc += rdtsc_u64() - now + reads * g_trace_tsc_cyc;
+}
+
+static inline void __dlx_trace_acquired(dlx_generic_lock_t *mtx, uint8_t op, uint64_t begin) {
+  if (!begin)
+    return;
+  uint64_t now = rdtsc_u64();
+  if (t_trace_n_held < DLX_TRACE_DEPTH) {
+    t_trace_held[t_trace_n_held].lock = mtx;
+    t_trace_held[t_trace_n_held++].since = now;
+  }
+  __dlx_trace_emit(mtx, op, now, now - begin);
+  __dlx_trace_cost(now, 3);
+}
+
+static inline void __dlx_trace_failed(dlx_generic_lock_t *mtx, uint8_t op, uint64_t begin) {
+  if (!begin)
+    return;
+  uint64_t now = rdtsc_u64();
+  __dlx_trace_emit(mtx, op, now, now - begin);
+  __dlx_trace_cost(now, 3);
+}
+
+// A sampling trace only releases what it saw acquired.
+static inline void __dlx_trace_released(dlx_generic_lock_t *mtx) {
+  if (!g_trace_on || (g_trace_sampling && !t_trace_n_held))
+    return;
+  uint64_t now = rdtsc_u64(), since = 0;
+  for (uint32_t i = t_trace_n_held; i-- > 0;) {
+    if (t_trace_held[i].lock == mtx) {
+      since = t_trace_held[i].since;
+      t_trace_held[i] = t_trace_held[--t_trace_n_held];
+      break;
+    }
+  }
+  if (!since && g_trace_sampling)
+    return;
+  __dlx_trace_emit(mtx, DLX_TRACE_RELEASE, now, since? now - since: 0);
+  __dlx_trace_cost(now, 2);
+}
+
+static int __dlx_write_all(int fd, const void *buf, size_t len) {
+  while (len) {
+    ssize_t n = write(fd, buf, len);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return -1;
+    buf = (const char *)buf + n;
+    len -= n;
+  }
+  return 0;
+}
+
+static void __dlx_trace_drain(void) {
+  for (dlx_trace_ring_t *ring = __atomic_load_n(&g_trace_rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+    uint64_t tail = ring->tail, head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (tail != head) {
+      uint64_t at = tail % DLX_TRACE_RING;
+      uint64_t n = head - tail < DLX_TRACE_RING - at? head - tail: DLX_TRACE_RING - at;
+      if (__dlx_write_all(g_trace_fd, &ring->ev[at], n * sizeof(dlx_trace_event_t)))
+        return;
+      tail += n;
+      g_trace_header.n_event += n;
+      __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+  }
+}
+
+// Moves the sampling window and interval, and accounts the time the
+// window was open since the last call.
+static void __dlx_trace_tick(void) {
+  static uint64_t last_ns = 0;
+  uint64_t now = __dlx_monotonic_ns();
+  if (!last_ns)
+    last_ns = g_trace_header.start_ns;
+  if (g_trace_open)
+    g_trace_header.open_ns += now - last_ns;
+  last_ns = now;
+  __atomic_store_n(&g_trace_epoch, (uint32_t)(now / DLX_TRACE_FLUSH_NS), __ATOMIC_RELAXED);
+  if (g_trace_window_ms) {
+    uint64_t in_cycle = (now - g_trace_header.start_ns) / 1000000 % g_trace_cycle_ms;
+    __atomic_store_n(&g_trace_open, in_cycle < g_trace_window_ms, __ATOMIC_RELAXED);
+  }
+}
+
+static void *__dlx_trace_loop(void *arg) {
+  struct timespec period = { 0, DLX_TRACE_FLUSH_NS };
+  while (!__atomic_load_n(&g_trace_stop, __ATOMIC_ACQUIRE)) {
+    __dlx_trace_tick();
+    __dlx_trace_drain();
+    if (!__atomic_exchange_n(&g_trace_kick, 0, __ATOMIC_RELAXED))
+      syscall(SYS_futex, &g_trace_kick, FUTEX_WAIT_PRIVATE, 0, &period, NULL, 0);
+  }
+  __dlx_trace_tick();
+  __dlx_trace_drain();
+  return NULL;
+}
+
+static uint64_t __dlx_cpu_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// Cost of the per-acquisition check and of a TSC read, on a site of its
+// own so that no real site's sampling state moves.
+static void __dlx_trace_calibrate(void) {
+  dlx_generic_lock_t probe = { 0 };
+  probe.ind.pair.type_id = -1;
+  uint64_t begin = rdtsc_u64();
+  for (uint32_t i = 0; i < DLX_TRACE_CALIBRATE; i++)
+    rdtsc_u64();
+  g_trace_tsc_cyc = (rdtsc_u64() - begin) / DLX_TRACE_CALIBRATE;
+  if (!g_trace_sampling || !__dlx_trace_ring_new())
+    return;
+  int open = g_trace_open;
+  g_trace_open = 0;
+  begin = rdtsc_u64();
+  for (uint32_t i = 0; i < DLX_TRACE_CALIBRATE; i++)
+    __dlx_trace_sampled(&probe);
+  g_trace_skip_cyc = (rdtsc_u64() - begin) / DLX_TRACE_CALIBRATE;
+  g_trace_open = open;
+  t_trace_ring->n_seen = 0;
+  t_trace_ring->n_seen_open = 0;
+  // The probe's RATE events, if any.
+  t_trace_ring->head = 0;
+  memset(&t_trace_ring->site[t_trace_ring->n_site], 0, sizeof(dlx_trace_site_t));
+}
+
+static void __dlx_trace_close(void) {
+  __atomic_store_n(&g_trace_on, 0, __ATOMIC_RELEASE);
+  __atomic_store_n(&g_trace_stop, 1, __ATOMIC_RELEASE);
+  pthread_join(g_trace_flusher, NULL);
+  g_trace_header.end_tsc = rdtsc_u64();
+  g_trace_header.end_ns = __dlx_monotonic_ns();
+  g_trace_cpu_ns = __dlx_cpu_ns() - g_trace_cpu_ns;
+  g_trace_header.n_thread = g_trace_n_thread;
+  for (dlx_trace_ring_t *ring = g_trace_rings; ring; ring = ring->next) {
+    g_trace_header.n_dropped += ring->n_dropped;
+    g_trace_header.n_seen += ring->n_seen;
+    g_trace_header.n_seen_open += ring->n_seen_open;
+    g_trace_header.overhead_cyc += ring->overhead_cyc + ring->n_seen * g_trace_skip_cyc;
+  }
+  pwrite(g_trace_fd, &g_trace_header, sizeof(g_trace_header), 0);
+  close(g_trace_fd);
+  if (g_trace_header.n_dropped) {
+    fprintf(
+      stderr, "[Dylinx] trace dropped %lu of %lu lock events\n",
+      (unsigned long)g_trace_header.n_dropped, (unsigned long)(g_trace_header.n_dropped + g_trace_header.n_event)
+    );
+  }
+  if (g_trace_sampling) {
+    double elapsed_cyc = g_trace_header.end_tsc - g_trace_header.start_tsc;
+    double elapsed_ns = g_trace_header.end_ns - g_trace_header.start_ns;
+    double overhead_ns = g_trace_header.overhead_cyc * (elapsed_ns / (elapsed_cyc + 1));
+    fprintf(
+      stderr, "[Dylinx] trace sampled %lu events over %lu acquisitions, overhead %.0f cycles per acquisition, %.2f%% of CPU time\n",
+      (unsigned long)g_trace_header.n_event, (unsigned long)g_trace_header.n_seen,
+      (double)g_trace_header.overhead_cyc / (g_trace_header.n_seen + 1),
+      100.0 * overhead_ns / (g_trace_cpu_ns + 1)
+    );
+  }
+}
+
+int dlx_trace_sample(const char *spec) {
+  if (!spec || !*spec)
+    return 0;
+  uint32_t max_period = 1, window_ms = 0, cycle_ms = 0;
+  int n = sscanf(spec, "%u:%u/%u", &max_period, &window_ms, &cycle_ms);
+  if (n < 1 || n == 2 || !max_period || (n == 3 && (window_ms < DLX_TRACE_FLUSH_NS / 1000000 || cycle_ms <= window_ms)))
+    return EINVAL;
+  if (g_trace_on)
+    return EBUSY;
+  g_trace_max_period = max_period;
+  g_trace_window_ms = n == 3? window_ms: 0;
+  g_trace_cycle_ms = n == 3? cycle_ms: 0;
+  g_trace_sampling = max_period > 1 || g_trace_window_ms;
+  return 0;
+}
+
+int dlx_trace_start(const char *path) {
+  if (!path || !*path)
+    return 0;
+  g_trace_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (g_trace_fd < 0)
+    return errno;
+  char header[DLX_TRACE_HEADER] = { 0 };
+  memcpy(g_trace_header.magic, "DLXTRACE", 8);
+  g_trace_header.version = 2;
+  g_trace_header.event_size = sizeof(dlx_trace_event_t);
+  g_trace_header.pid = getpid();
+  g_trace_header.start_tsc = rdtsc_u64();
+  g_trace_header.start_ns = __dlx_monotonic_ns();
+  g_trace_header.max_period = g_trace_max_period;
+  g_trace_header.window_ms = g_trace_window_ms;
+  g_trace_header.cycle_ms = g_trace_cycle_ms;
+  __dlx_trace_calibrate();
+  g_trace_cpu_ns = __dlx_cpu_ns();
+  memcpy(header, &g_trace_header, sizeof(g_trace_header));
+  int ret = pthread_create(&g_trace_flusher, NULL, __dlx_trace_loop, NULL);
+  if (ret || __dlx_write_all(g_trace_fd, header, sizeof(header))) {
+    close(g_trace_fd);
+    return ret? ret: errno;
+  }
+  __dlx_hook(DLX_HOOK_TRACE);
+  g_trace_on = 1;
+  return atexit(__dlx_trace_close);
+}
+// }}}
+
+// {{{ causal profiling
+// Virtual speedup in the manner of Coz. While an experiment speeds up
+// g_causal_site by g_causal_pct percent, a thread leaving one of its
+// sections adds that share of the section's cycles to g_causal_delay,
+// and to what it paid itself, since the delay stands for every other
+// thread running slower. Threads pay what they owe before their next
+// mutex or spinlock operation, spinning on short debts and sleeping on
+// long ones, and keep any oversleep as credit. Delays inserted while a
+// thread waited for a lock or a condition are forgiven, the thread that
+// woke it paid them already. A thread that never takes a lock never
+// pays, so progress made outside locks must be counted by threads that
+// do take them now and then.
+#define DLX_CAUSAL_SPIN_CYC 20000
+
+static volatile int g_causal_on = 0;
+static volatile int32_t g_causal_site = -2;
+static volatile uint32_t g_causal_pct = 0;
+static volatile uint32_t g_causal_epoch = 0;
+static volatile uint64_t g_causal_delay = 0;
+static volatile uint64_t g_causal_sections = 0;
+static double g_causal_cyc_per_ns = 1.0;
+static __thread struct {
+  uint32_t epoch;
+  uint64_t paid;
+  void *lock;
+  uint64_t since;
+} t_causal;
+
+// Delays of earlier experiments are not owed.
+static inline void __dlx_causal_sync(void) {
+  uint32_t epoch = __atomic_load_n(&g_causal_epoch, __ATOMIC_ACQUIRE);
+  if (t_causal.epoch == epoch)
+    return;
+  t_causal.epoch = epoch;
+  t_causal.paid = __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED);
+  t_causal.lock = NULL;
+}
+
+static void __dlx_causal_wait(uint64_t owed) {
+  uint64_t begin = rdtsc_u64();
+  if (owed > DLX_CAUSAL_SPIN_CYC) {
+    uint64_t ns = owed / g_causal_cyc_per_ns;
+    struct timespec delay = { ns / 1000000000ull, ns % 1000000000ull };
+    nanosleep(&delay, NULL);
+  } else {
+    while (rdtsc_u64() - begin < owed)
+      CPU_PAUSE();
+  }
+  t_causal.paid += rdtsc_u64() - begin;
+}
+
+static inline void __dlx_causal_pay(void) {
+  if (!g_causal_on)
+    return;
+  __dlx_causal_sync();
+  uint64_t delay = __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED);
+  if ((int64_t)(delay - t_causal.paid) > 0)
+    __dlx_causal_wait(delay - t_causal.paid);
+}
+
+// Returns the delay so far plus one, 0 while off, for
+// __dlx_causal_acquired to forgive what comes on top while the caller
+// waits.
+static inline uint64_t __dlx_causal_begin(void) {
+  return g_causal_on? __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED) + 1: 0;
+}
+
+static inline void __dlx_causal_forgive(uint64_t begin) {
+  if (!g_causal_on)
+    return;
+  __dlx_causal_sync();
+  uint64_t delay = __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED) + 1;
+  if (begin && delay > begin)
+    t_causal.paid += delay - begin;
+}
+
+static inline void __dlx_causal_acquired(dlx_generic_lock_t *mtx, uint64_t begin) {
+  __dlx_causal_forgive(begin);
+  if (g_causal_on && !t_causal.lock && mtx->ind.pair.type_id == g_causal_site) {
+    t_causal.lock = mtx;
+    t_causal.since = rdtsc_u64();
+  }
+}
+
+static inline void __dlx_causal_released(dlx_generic_lock_t *mtx) {
+  if (t_causal.lock != mtx)
+    return;
+  t_causal.lock = NULL;
+  if (!g_causal_on || t_causal.epoch != __atomic_load_n(&g_causal_epoch, __ATOMIC_ACQUIRE))
+    return;
+  uint64_t delay = (rdtsc_u64() - t_causal.since) * g_causal_pct / 100;
+  __atomic_add_fetch(&g_causal_delay, delay, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&g_causal_sections, 1, __ATOMIC_RELAXED);
+  t_causal.paid += delay;
+}
+
+void dlx_causal_speedup(int32_t site_id, uint32_t pct, double cyc_per_ns) {
+  __atomic_store_n(&g_causal_on, 0, __ATOMIC_RELEASE);
+  g_causal_site = site_id;
+  g_causal_pct = pct > 100? 100: pct;
+  g_causal_cyc_per_ns = cyc_per_ns > 0? cyc_per_ns: 1.0;
+  __atomic_store_n(&g_causal_delay, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&g_causal_sections, 0, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&g_causal_epoch, 1, __ATOMIC_RELEASE);
+  if (pct) {
+    __dlx_hook(DLX_HOOK_CAUSAL);
+    __atomic_store_n(&g_causal_on, 1, __ATOMIC_RELEASE);
+  }
+}
+
+uint64_t dlx_causal_take(uint64_t *n_section) {
+  __atomic_store_n(&g_causal_on, 0, __ATOMIC_RELEASE);
+  *n_section = __atomic_load_n(&g_causal_sections, __ATOMIC_RELAXED);
+  return __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED);
+}
+// }}}
+
+// {{{ object reclamation
+// Objects allocated by __dylinx_object_init_ are remembered together with
+// where their mutexes sit, so that dlx_obj_free and dlx_obj_realloc can
+// destroy locks the subject never destroyed itself. Their backends then go
+// back through the destroy method of their type with t_dlx_recycling set,
+// i.e. to the per-type lists of dylinx-numa.c the next lock of that type
+// is drawn from. The rewriter turns free() and realloc() of pointers to a
+// lock type or to a struct holding locks into these two, every other free
+// of the subject never reaches the glue, whatever allocator it links. A
+// counting filter of pointer hashes, decremented when an object is
+// untracked, answers most pointers without a lock, and the registry is
+// split into DLX_OBJ_SHARDS tables with a lock each, picked by the same
+// hash as the filter slot. Only locks of the mutex family are reclaimed,
+// rwlocks, barriers and semaphores in such objects are not.
+#ifdef __DYLINX_RECLAIM__
+#define DLX_OBJ_FILTER_SLOTS (1 << 16)
+#define DLX_OBJ_SHARDS 64
+// A saturated counter stays there, it cannot tell how many left.
+#define DLX_OBJ_FILTER_MAX 0xff
+
+typedef struct dlx_tracked_obj {
+  char *base;
+  uint32_t cnt;
+  uint32_t unit;
+  uint32_t n_field;
+  // (offset, count) pairs of the lock fields within one element.
+  uint32_t *fields;
+} dlx_tracked_obj_t;
+
+typedef struct dlx_obj_shard {
+  volatile int lock __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  uint32_t cap;
+  uint32_t n_used;
+  dlx_tracked_obj_t *table;
+} dlx_obj_shard_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+#define DLX_OBJ_EMPTY ((char *)0)
+#define DLX_OBJ_GONE ((char *)1)
+
+// Counters are only written under the lock of the shard of their slot.
+static volatile uint8_t g_obj_filter[DLX_OBJ_FILTER_SLOTS];
+static dlx_obj_shard_t g_obj_shard[DLX_OBJ_SHARDS];
+static uint32_t g_single_field[2] = { 0, 1 };
+
+#define DLX_VAR_INIT_ENTRY(ltype) (void *)dlx_ ## ltype ## _var_init,
+static void *const g_mutex_var_init[] = { FOR_EACH(DLX_VAR_INIT_ENTRY, ALLOWED_LOCK_TYPE) };
+
+static inline uint32_t __dlx_obj_hash(const void *p) {
+  return (uint32_t)(((uintptr_t)p >> 4) * 0x9E3779B97F4A7C15ull >> 32);
+}
+
+// The filter slot is the low bits of the hash, its shard the lowest of
+// those, and the position in the shard's table the bits above.
+static inline dlx_obj_shard_t *__dlx_obj_shard(uint32_t hash) {
+  return &g_obj_shard[hash % DLX_OBJ_SHARDS];
+}
+
+static inline int __dlx_obj_maybe(const void *p) {
+  return __atomic_load_n(&g_obj_filter[__dlx_obj_hash(p) % DLX_OBJ_FILTER_SLOTS], __ATOMIC_RELAXED) != 0;
+}
+
+static inline void __dlx_obj_acquire(dlx_obj_shard_t *shard) {
+  while (__atomic_exchange_n(&shard->lock, 1, __ATOMIC_ACQUIRE))
+    while (__atomic_load_n(&shard->lock, __ATOMIC_RELAXED))
+      CPU_PAUSE();
+}
+
+static inline void __dlx_obj_release(dlx_obj_shard_t *shard) {
+  __atomic_store_n(&shard->lock, 0, __ATOMIC_RELEASE);
+}
+
+// Open addressing with tombstones, called with the shard lock held.
+static int __dlx_obj_insert(dlx_obj_shard_t *shard, dlx_tracked_obj_t *obj) {
+  if (2 * (shard->n_used + 1) > shard->cap) {
+    uint32_t cap = shard->cap? 2 * shard->cap: 64;
+    dlx_tracked_obj_t *table = malloc(cap * sizeof(dlx_tracked_obj_t));
+    if (!table)
+      return ENOMEM;
+    memset(table, 0, cap * sizeof(dlx_tracked_obj_t));
+    uint32_t n_used = 0;
+    for (uint32_t i = 0; i < shard->cap; i++) {
+      if (shard->table[i].base == DLX_OBJ_EMPTY || shard->table[i].base == DLX_OBJ_GONE)
+        continue;
+      uint32_t at = (__dlx_obj_hash(shard->table[i].base) / DLX_OBJ_SHARDS) % cap;
+      while (table[at].base)
+        at = (at + 1) % cap;
+      table[at] = shard->table[i];
+      n_used++;
+    }
+    free(shard->table);
+    shard->table = table;
+    shard->cap = cap;
+    shard->n_used = n_used;
+  }
+  uint32_t hash = __dlx_obj_hash(obj->base);
+  uint32_t at = (hash / DLX_OBJ_SHARDS) % shard->cap;
+  while (shard->table[at].base != DLX_OBJ_EMPTY && shard->table[at].base != DLX_OBJ_GONE)
+    at = (at + 1) % shard->cap;
+  if (shard->table[at].base == DLX_OBJ_EMPTY)
+    shard->n_used++;
+  shard->table[at] = *obj;
+  volatile uint8_t *count = &g_obj_filter[hash % DLX_OBJ_FILTER_SLOTS];
+  if (*count < DLX_OBJ_FILTER_MAX)
+    __atomic_store_n(count, *count + 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+static int __dlx_obj_remove(dlx_obj_shard_t *shard, const void *base, dlx_tracked_obj_t *obj) {
+  if (!shard->cap)
+    return 0;
+  uint32_t hash = __dlx_obj_hash(base);
+  for (uint32_t at = (hash / DLX_OBJ_SHARDS) % shard->cap; shard->table[at].base; at = (at + 1) % shard->cap) {
+    if (shard->table[at].base != base)
+      continue;
+    *obj = shard->table[at];
+    shard->table[at].base = DLX_OBJ_GONE;
+    volatile uint8_t *count = &g_obj_filter[hash % DLX_OBJ_FILTER_SLOTS];
+    if (*count < DLX_OBJ_FILTER_MAX)
+      __atomic_store_n(count, *count - 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+  return 0;
+}
+
+static void __dlx_obj_track(void *base, uint32_t cnt, uint32_t unit, uint32_t *fields, uint32_t n_field) {
+  dlx_tracked_obj_t obj = { base, cnt, unit, n_field, fields };
+  dlx_obj_shard_t *shard = __dlx_obj_shard(__dlx_obj_hash(base));
+  __dlx_obj_acquire(shard);
+  int ret = __dlx_obj_insert(shard, &obj);
+  __dlx_obj_release(shard);
+  if (ret && fields != g_single_field)
+    free(fields);
+}
+
+static int __dlx_obj_take(const void *base, dlx_tracked_obj_t *obj) {
+  dlx_obj_shard_t *shard = __dlx_obj_shard(__dlx_obj_hash(base));
+  __dlx_obj_acquire(shard);
+  int found = __dlx_obj_remove(shard, base, obj);
+  __dlx_obj_release(shard);
+  return found;
+}
+
+// Destroys the locks of elements [from, cnt) that are still alive.
+static void __dlx_obj_reclaim(dlx_tracked_obj_t *obj, uint32_t from) {
+  t_dlx_recycling = 1;
+  for (uint32_t c = from; c < obj->cnt; c++) {
+    for (uint32_t f = 0; f < obj->n_field; f++) {
+      dlx_generic_lock_t *lock = (dlx_generic_lock_t *)(obj->base + c * obj->unit + obj->fields[2 * f]);
+      for (uint32_t i = 0; i < obj->fields[2 * f + 1]; i++, lock++) {
+        if (lock->check_code != 0x32CB00B5)
+          continue;
+        __atomic_add_fetch(&__dlx_site_footprint(lock->ind.pair.type_id)->n_reclaimed, 1, __ATOMIC_RELAXED);
+        dlx_footprint_t *type = __dlx_type_footprint(lock->methods);
+        if (type)
+          __atomic_add_fetch(&type->n_reclaimed, 1, __ATOMIC_RELAXED);
+        dlx_forward_destroy(lock->ind.long_id, lock);
+      }
+    }
+  }
+  t_dlx_recycling = 0;
+}
+
+static void __dlx_obj_untrack(const void *base, uint32_t keep, dlx_tracked_obj_t *obj) {
+  if (!__dlx_obj_take(base, obj)) {
+    obj->base = NULL;
+    return;
+  }
+  __dlx_obj_reclaim(obj, keep);
+}
+
+void dlx_obj_free(void *p) {
+  if (p && __dlx_obj_maybe(p)) {
+    dlx_tracked_obj_t obj;
+    __dlx_obj_untrack(p, 0, &obj);
+    if (obj.base && obj.fields != g_single_field)
+      free(obj.fields);
+  }
+  free(p);
+}
+
+// Elements cut off by a shrinking realloc lose their locks first. The
+// locks that move along keep their backends, headers only point at them.
+void *dlx_obj_realloc(void *p, size_t n) {
+  if (!p || !__dlx_obj_maybe(p))
+    return realloc(p, n);
+  dlx_tracked_obj_t obj;
+  uint32_t keep = 0;
+  int found = __dlx_obj_take(p, &obj);
+  if (found) {
+    keep = obj.unit? n / obj.unit: 0;
+    if (keep < obj.cnt)
+      __dlx_obj_reclaim(&obj, keep);
+  }
+  void *res = realloc(p, n);
+  if (!found)
+    return res;
+  if (res && keep) {
+    __dlx_obj_track(res, keep < obj.cnt? keep: obj.cnt, obj.unit, obj.fields, obj.n_field);
+  } else if (!res && n) {
+    // p is still there, with the surviving elements.
+    __dlx_obj_track(p, keep < obj.cnt? keep: obj.cnt, obj.unit, obj.fields, obj.n_field);
+  } else if (obj.fields != g_single_field) {
+    free(obj.fields);
+  }
+  return res;
+}
+
+static void __dlx_obj_track_struct(void *base, uint32_t cnt, uint32_t unit, uint32_t *properties, uint32_t n_offset, void **init_funcs) {
+  uint32_t *fields = malloc(2 * n_offset * sizeof(uint32_t));
+  uint32_t n_field = 0;
+  if (!fields)
+    return;
+  for (uint32_t n = 0; n < n_offset; n++) {
+    for (uint32_t i = 0; i < sizeof(g_mutex_var_init) / sizeof(void *); i++) {
+      if (init_funcs[n] != g_mutex_var_init[i])
+        continue;
+      fields[2 * n_field] = properties[2 * n];
+      fields[2 * n_field++ + 1] = properties[2 * n + 1];
+      break;
+    }
+  }
+  if (n_field)
+    __dlx_obj_track(base, cnt, unit, fields, n_field);
+  else
+    free(fields);
+}
+
+static inline void __dlx_obj_track_array(void *base, uint32_t cnt, uint32_t unit) {
+  __dlx_obj_track(base, cnt, unit, g_single_field, 1);
+}
+#else
+static inline void __dlx_obj_track_struct(void *base, uint32_t cnt, uint32_t unit, uint32_t *properties, uint32_t n_offset, void **init_funcs) {}
+static inline void __dlx_obj_track_array(void *base, uint32_t cnt, uint32_t unit) {}
+
+void dlx_obj_free(void *p) {
+  free(p);
+}
+
+void *dlx_obj_realloc(void *p, size_t n) {
+  return realloc(p, n);
+}
+#endif // __DYLINX_RECLAIM__
+// }}}
+
+// {{{ process-shared locks
+// A mutex initialized with PTHREAD_PROCESS_SHARED can be reached from
+// processes that share nothing but the memory it sits in, and there the
+// lock_obj and methods pointers of its header mean nothing. Such a lock
+// gets no backend. Its methods stay NULL and the forwarding functions run
+// the inline lock of lock/pshared-lock.h on the lock_obj slot itself. The
+// inline kind follows the type of the site: TAS and the ticket types keep
+// their algorithm, every other type becomes the futex mutex. Hot swap,
+// re-homing and the single-threaded fast path skip these locks, since
+// another process may hold them.
+static pthread_mutexattr_t g_pshared_attr;
+static pthread_once_t g_pshared_attr_once = PTHREAD_ONCE_INIT;
+
+static void __dlx_pshared_attr_init(void) {
+  pthread_mutexattr_init(&g_pshared_attr);
+  pthread_mutexattr_setpshared(&g_pshared_attr, PTHREAD_PROCESS_SHARED);
+}
+
+// Stands in for the pshared flag of pthread_spin_init, which has no
+// attribute object to carry it.
+pthread_mutexattr_t *dlx_pshared_mutexattr(void) {
+  pthread_once(&g_pshared_attr_once, __dlx_pshared_attr_init);
+  return &g_pshared_attr;
+}
+
+static inline int __dlx_pshared(const dlx_generic_lock_t *mtx) {
+  return !mtx->methods;
+}
+
+// The slot is a member of the packed header, its address is taken off the
+// header itself. Headers live in pthread_mutex_t storage, which keeps the
+// slot aligned.
+static inline pshared_lock_t *__dlx_pshared_slot(dlx_generic_lock_t *mtx) {
+  char *header = (void *)mtx;
+  return (void *)(header + offsetof(dlx_generic_lock_t, lock_obj));
+}
+
+// The lock_obj slot of every generic header kind, taken off the header the
+// same way, for the init functions to fill.
+static inline void **__dlx_obj_slot(void *header, size_t offset) {
+  return (void *)((char *)header + offset);
+}
+
+#define DLX_OBJ_SLOT(header) __dlx_obj_slot(header, offsetof(__typeof__(*(header)), lock_obj))
+
+static inline int __dlx_pshared_attr(const pthread_mutexattr_t *attr) {
+  int pshared = PTHREAD_PROCESS_PRIVATE;
+  return attr && !pthread_mutexattr_getpshared(attr, &pshared) && pshared == PTHREAD_PROCESS_SHARED;
+}
+
+// Called with lock->methods already bound to the type of its site.
+static int dlx_pshared_init(dlx_generic_lock_t *lock) {
+  const dlx_injected_interface_t *methods = lock->methods;
+  pshared_lock_t *inline_lock = __dlx_pshared_slot(lock);
+  inline_lock->word = 0;
+  if (methods == &dlx_tas_methods_collection)
+    inline_lock->cond = PSHARED_TAS;
+  else if (methods == &dlx_ticket_methods_collection || methods == &dlx_ticket16_methods_collection)
+    inline_lock->cond = PSHARED_TICKET;
+  else
+    inline_lock->cond = PSHARED_FUTEX;
+  lock->methods = NULL;
+  dlx_account_lock(lock->ind.pair.type_id, NULL, 1);
+  return 0;
+}
+// }}}
+
+// {{{ single-threaded fast path
+// Nobody contends while the process runs a single thread, so a lock
+// operation only records what is held in g_fast_held and leaves the
+// backend alone. pthread_create is interposed here to count threads, and
+// a thread leaves the count from the destructor of g_fast_key when it
+// exits, joined or detached. Before the second thread starts, every
+// recorded lock is really acquired on its backend and the fence publishes
+// that to the new thread. Threads started inside glibc, by thrd_create,
+// SIGEV_THREAD timers, mq_notify or POSIX AIO, never pass the interposer.
+// So when the count drops back to 1, DLX_HOOK_ALONE only makes lock
+// operations poll, every DLX_FAST_POLL of them, the Threads: line of
+// /proc/self/status, and the fast path comes back once the kernel counts
+// this thread and the quiet threads of the glue alone. A thread the
+// interposer missed that starts while the fast path is on stays unseen,
+// hence __DYLINX_SINGLE_FAST__ is off by default.
+// Whether the caller itself holds a backend, e.g. from before the last
+// pthread_join, is not tracked, so only the blocking operations take the
+// fast path. Trylock and timedlock always ask the backend, after moving a
+// recorded hold of the same lock there. So do a blocking acquisition that
+// finds the lock recorded already, apart from recursive readers, and a
+// condition wait.
+#ifdef __DYLINX_SINGLE_FAST__
+#define DLX_FAST_DEPTH 64
+#define DLX_FAST_POLL 4096
+
+enum { DLX_FAST_MUTEX, DLX_FAST_RDLOCK, DLX_FAST_WRLOCK, DLX_FAST_TRY };
+
+static volatile uint32_t g_n_thread = 1;
+// Threads of dlx_quiet_thread that are running, they never touch a lock.
+static volatile int32_t g_n_quiet = 0;
+static struct { void *lock; uint32_t kind; } g_fast_held[DLX_FAST_DEPTH];
+static volatile uint32_t g_n_fast_held = 0;
+// Racy on purpose, a lost increment only delays a poll.
+static uint32_t g_fast_poll = 0;
+static pthread_key_t g_fast_key;
+static pthread_once_t g_fast_once = PTHREAD_ONCE_INIT;
+static int (*native_pthread_create)(pthread_t *, const pthread_attr_t *, void *(*)(void *), void *);
+
+typedef struct dlx_fast_start {
+  void *(*start)(void *);
+  void *arg;
+  int quiet;
+} dlx_fast_start_t;
+
+// Tasks of the process as the kernel counts them, 0 when unknown.
+static uint32_t __dlx_n_task(void) {
+  char buf[4096];
+  int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return 0;
+  ssize_t len = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (len <= 0)
+    return 0;
+  buf[len] = '\0';
+  char *line = strstr(buf, "\nThreads:");
+  return line? (uint32_t)strtoul(line + strlen("\nThreads:"), NULL, 10): 0;
+}
+
+static inline void __dlx_fast_recheck(void) {
+  g_fast_poll = 0;
+  __dlx_hook(DLX_HOOK_ALONE);
+}
+
+static void __dlx_fast_poll(void) {
+  if (g_fast_poll++ % DLX_FAST_POLL)
+    return;
+  if (__atomic_load_n(&g_n_thread, __ATOMIC_SEQ_CST) != 1)
+    return;
+  if (__dlx_n_task() != 1 + (uint32_t)__atomic_load_n(&g_n_quiet, __ATOMIC_SEQ_CST))
+    return;
+  __atomic_and_fetch(&g_dlx_hooks, ~DLX_HOOK_ALONE, __ATOMIC_SEQ_CST);
+  __dlx_hook(DLX_HOOK_FAST);
+}
+
+// Destructor of g_fast_key, runs as a counted thread exits.
+static void __dlx_fast_exit(void *unused) {
+  if (__atomic_sub_fetch(&g_n_thread, 1, __ATOMIC_SEQ_CST) == 1)
+    __dlx_fast_recheck();
+}
+
+static void __dlx_fast_key_init(void) {
+  pthread_key_create(&g_fast_key, __dlx_fast_exit);
+}
+
+static void *__dlx_fast_run(void *arg) {
+  dlx_fast_start_t run = *(dlx_fast_start_t *)arg;
+  free(arg);
+  if (!run.quiet) {
+    pthread_setspecific(g_fast_key, (void *)1);
+    return run.start(run.arg);
+  }
+  void *ret = run.start(run.arg);
+  __atomic_sub_fetch(&g_n_quiet, 1, __ATOMIC_SEQ_CST);
+  return ret;
+}
+
+static void __dlx_fast_take(uint32_t i) {
+  if (g_fast_held[i].kind == DLX_FAST_MUTEX) {
+    dlx_generic_lock_t *mtx = g_fast_held[i].lock;
+    __dlx_enter(mtx);
+    mtx->methods->lock_fptr(mtx->lock_obj);
+  } else {
+    dlx_generic_rwlock_t *rw = g_fast_held[i].lock;
+    if (g_fast_held[i].kind == DLX_FAST_RDLOCK)
+      rw->methods->rdlock_fptr(rw->lock_obj);
+    else
+      rw->methods->wrlock_fptr(rw->lock_obj);
+  }
+  g_fast_held[i] = g_fast_held[--g_n_fast_held];
+}
+
+// Moves the recorded holds of lock onto its backend, or forgets them when
+// the lock is being destroyed.
+static void __dlx_fast_flush(void *lock, int take) {
+  for (uint32_t i = g_n_fast_held; i-- > 0;) {
+    if (g_fast_held[i].lock != lock)
+      continue;
+    if (take)
+      __dlx_fast_take(i);
+    else
+      g_fast_held[i] = g_fast_held[--g_n_fast_held];
+  }
+}
+
+// Returns 1 when the acquisition got recorded and the backend is skipped.
+static inline int __dlx_fast_acquire(void *lock, uint32_t kind) {
+  if (!(g_dlx_hooks & DLX_HOOK_FAST)) {
+    if (g_dlx_hooks & DLX_HOOK_ALONE)
+      __dlx_fast_poll();
+    return 0;
+  }
+  for (uint32_t i = 0; i < g_n_fast_held; i++) {
+    if (g_fast_held[i].lock == lock && (kind != DLX_FAST_RDLOCK || g_fast_held[i].kind != kind)) {
+      __dlx_fast_flush(lock, 1);
+      return 0;
+    }
+  }
+  if (g_n_fast_held == DLX_FAST_DEPTH)
+    return 0;
+  g_fast_held[g_n_fast_held].lock = lock;
+  g_fast_held[g_n_fast_held++].kind = kind;
+  return 1;
+}
+
+// Returns 1 when the release matched a recorded acquisition.
+static inline int __dlx_fast_release(void *lock) {
+  for (uint32_t i = g_n_fast_held; i-- > 0;) {
+    if (g_fast_held[i].lock == lock) {
+      g_fast_held[i] = g_fast_held[--g_n_fast_held];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static inline void __dlx_fast_materialize(void *lock) {
+  if (g_n_fast_held)
+    __dlx_fast_flush(lock, 1);
+}
+
+static inline void __dlx_fast_forget(void *lock) {
+  if (g_n_fast_held)
+    __dlx_fast_flush(lock, 0);
+}
+
+int pthread_create(pthread_t *tid, const pthread_attr_t *attr, void *(*start)(void *), void *arg) {
+  if (!native_pthread_create)
+    native_pthread_create = dlsym(RTLD_NEXT, "pthread_create");
+  pthread_once(&g_fast_once, __dlx_fast_key_init);
+  dlx_fast_start_t *run = malloc(sizeof(dlx_fast_start_t));
+  if (!run)
+    return EAGAIN;
+  *run = (dlx_fast_start_t){ start, arg, 0 };
+  if (__atomic_fetch_add(&g_n_thread, 1, __ATOMIC_SEQ_CST) == 1) {
+    __atomic_and_fetch(&g_dlx_hooks, ~DLX_HOOK_ALONE, __ATOMIC_SEQ_CST);
+    if (g_dlx_hooks & DLX_HOOK_FAST) {
+      while (g_n_fast_held)
+        __dlx_fast_take(g_n_fast_held - 1);
+      __atomic_and_fetch(&g_dlx_hooks, ~DLX_HOOK_FAST, __ATOMIC_SEQ_CST);
+    }
+  }
+  int ret = native_pthread_create(tid, attr, __dlx_fast_run, run);
+  if (ret) {
+    free(run);
+    if (__atomic_sub_fetch(&g_n_thread, 1, __ATOMIC_SEQ_CST) == 1)
+      __dlx_fast_recheck();
+  }
+  return ret;
+}
+
+// Counted only once it runs, and uncounted before it is gone, so the
+// kernel never shows fewer tasks than the poll expects.
+int dlx_quiet_thread(pthread_t *tid, const pthread_attr_t *attr, void *(*start)(void *), void *arg) {
+  if (!native_pthread_create)
+    native_pthread_create = dlsym(RTLD_NEXT, "pthread_create");
+  dlx_fast_start_t *run = malloc(sizeof(dlx_fast_start_t));
+  if (!run)
+    return EAGAIN;
+  *run = (dlx_fast_start_t){ start, arg, 1 };
+  int ret = native_pthread_create(tid, attr, __dlx_fast_run, run);
+  if (ret)
+    free(run);
+  else
+    __atomic_add_fetch(&g_n_quiet, 1, __ATOMIC_SEQ_CST);
+  return ret;
+}
+
+// Threads started before the glue, e.g. by constructors of libraries,
+// leave the fast path off until they are gone.
+static void __dlx_fast_init(void) {
+  if ((g_dlx_hooks & DLX_HOOK_FAST) && __dlx_n_task() != 1) {
+    __atomic_and_fetch(&g_dlx_hooks, ~DLX_HOOK_FAST, __ATOMIC_SEQ_CST);
+    __dlx_fast_recheck();
+  }
+}
+#else
+enum { DLX_FAST_MUTEX, DLX_FAST_RDLOCK, DLX_FAST_WRLOCK, DLX_FAST_TRY };
+static inline int __dlx_fast_acquire(void *lock, uint32_t kind) { return 0; }
+static inline int __dlx_fast_release(void *lock) { return 0; }
+static inline void __dlx_fast_materialize(void *lock) {}
+static inline void __dlx_fast_forget(void *lock) {}
+static inline void __dlx_fast_init(void) {}
+
+int dlx_quiet_thread(pthread_t *tid, const pthread_attr_t *attr, void *(*start)(void *), void *arg) {
+  return pthread_create(tid, attr, start, arg);
+}
+#endif // __DYLINX_SINGLE_FAST__
+// }}}
+
+// linked order should be concern
+void retrieve_native_symbol() {
+  native_mutex_init = (int (*)(pthread_mutex_t *, const pthread_mutexattr_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_init");
+  CHECK_LOCATE_SYMBOL(native_mutex_init, pthread_mutex_init);
+  native_mutex_lock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_lock");
+  CHECK_LOCATE_SYMBOL(native_mutex_lock, pthread_mutex_lock);
+  native_mutex_unlock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_unlock");
+  CHECK_LOCATE_SYMBOL(native_mutex_unlock, pthread_mutex_unlock);
+  native_mutex_destroy = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_destroy");
+  CHECK_LOCATE_SYMBOL(native_mutex_destroy, pthread_mutex_destroy);
+  native_mutex_trylock = (int (*)(pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_mutex_trylock");
+  CHECK_LOCATE_SYMBOL(native_mutex_trylock, pthread_mutex_trylock);
+  native_mutex_timedlock = (int (*)(pthread_mutex_t *, const struct timespec *))dlsym(RTLD_DEFAULT, "pthread_mutex_timedlock");
+  CHECK_LOCATE_SYMBOL(native_mutex_timedlock, pthread_mutex_timedlock);
+  native_cond_wait = (int (*)(pthread_cond_t *, pthread_mutex_t *))dlsym(RTLD_DEFAULT, "pthread_cond_wait");
+  CHECK_LOCATE_SYMBOL(native_cond_wait, pthread_cond_wait);
+  native_cond_timedwait = (int (*)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *))dlsym(RTLD_DEFAULT, "pthread_cond_timedwait");
+  CHECK_LOCATE_SYMBOL(native_cond_timedwait, pthread_cond_timedwait);
+  native_cond_signal = (int (*)(pthread_cond_t *))dlsym(RTLD_DEFAULT, "pthread_cond_signal");
+  CHECK_LOCATE_SYMBOL(native_cond_signal, pthread_cond_signal);
+  native_cond_broadcast = (int (*)(pthread_cond_t *))dlsym(RTLD_DEFAULT, "pthread_cond_broadcast");
+  CHECK_LOCATE_SYMBOL(native_cond_broadcast, pthread_cond_broadcast);
+  native_rwlock_init = (int (*)(pthread_rwlock_t *, const pthread_rwlockattr_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_init");
+  CHECK_LOCATE_SYMBOL(native_rwlock_init, pthread_rwlock_init);
+  native_rwlock_rdlock = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_rdlock");
+  CHECK_LOCATE_SYMBOL(native_rwlock_rdlock, pthread_rwlock_rdlock);
+  native_rwlock_wrlock = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_wrlock");
+  CHECK_LOCATE_SYMBOL(native_rwlock_wrlock, pthread_rwlock_wrlock);
+  native_rwlock_tryrdlock = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_tryrdlock");
+  CHECK_LOCATE_SYMBOL(native_rwlock_tryrdlock, pthread_rwlock_tryrdlock);
+  native_rwlock_trywrlock = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_trywrlock");
+  CHECK_LOCATE_SYMBOL(native_rwlock_trywrlock, pthread_rwlock_trywrlock);
+  native_rwlock_unlock = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_unlock");
+  CHECK_LOCATE_SYMBOL(native_rwlock_unlock, pthread_rwlock_unlock);
+  native_rwlock_destroy = (int (*)(pthread_rwlock_t *))dlsym(RTLD_DEFAULT, "pthread_rwlock_destroy");
+  CHECK_LOCATE_SYMBOL(native_rwlock_destroy, pthread_rwlock_destroy);
+  native_spin_init = (int (*)(pthread_spinlock_t *, int))dlsym(RTLD_DEFAULT, "pthread_spin_init");
+  CHECK_LOCATE_SYMBOL(native_spin_init, pthread_spin_init);
+  native_spin_lock = (int (*)(pthread_spinlock_t *))dlsym(RTLD_DEFAULT, "pthread_spin_lock");
+  CHECK_LOCATE_SYMBOL(native_spin_lock, pthread_spin_lock);
+  native_spin_trylock = (int (*)(pthread_spinlock_t *))dlsym(RTLD_DEFAULT, "pthread_spin_trylock");
+  CHECK_LOCATE_SYMBOL(native_spin_trylock, pthread_spin_trylock);
+  native_spin_unlock = (int (*)(pthread_spinlock_t *))dlsym(RTLD_DEFAULT, "pthread_spin_unlock");
+  CHECK_LOCATE_SYMBOL(native_spin_unlock, pthread_spin_unlock);
+  native_spin_destroy = (int (*)(pthread_spinlock_t *))dlsym(RTLD_DEFAULT, "pthread_spin_destroy");
+  CHECK_LOCATE_SYMBOL(native_spin_destroy, pthread_spin_destroy);
+  native_barrier_init = (int (*)(pthread_barrier_t *, const pthread_barrierattr_t *, unsigned))dlsym(RTLD_DEFAULT, "pthread_barrier_init");
+  CHECK_LOCATE_SYMBOL(native_barrier_init, pthread_barrier_init);
+  native_barrier_wait = (int (*)(pthread_barrier_t *))dlsym(RTLD_DEFAULT, "pthread_barrier_wait");
+  CHECK_LOCATE_SYMBOL(native_barrier_wait, pthread_barrier_wait);
+  native_barrier_destroy = (int (*)(pthread_barrier_t *))dlsym(RTLD_DEFAULT, "pthread_barrier_destroy");
+  CHECK_LOCATE_SYMBOL(native_barrier_destroy, pthread_barrier_destroy);
+  native_sem_init = (int (*)(sem_t *, int, unsigned))dlsym(RTLD_DEFAULT, "sem_init");
+  CHECK_LOCATE_SYMBOL(native_sem_init, sem_init);
+  native_sem_wait = (int (*)(sem_t *))dlsym(RTLD_DEFAULT, "sem_wait");
+  CHECK_LOCATE_SYMBOL(native_sem_wait, sem_wait);
+  native_sem_trywait = (int (*)(sem_t *))dlsym(RTLD_DEFAULT, "sem_trywait");
+  CHECK_LOCATE_SYMBOL(native_sem_trywait, sem_trywait);
+  native_sem_timedwait = (int (*)(sem_t *, const struct timespec *))dlsym(RTLD_DEFAULT, "sem_timedwait");
+  CHECK_LOCATE_SYMBOL(native_sem_timedwait, sem_timedwait);
+  native_sem_post = (int (*)(sem_t *))dlsym(RTLD_DEFAULT, "sem_post");
+  CHECK_LOCATE_SYMBOL(native_sem_post, sem_post);
+  native_sem_getvalue = (int (*)(sem_t *, int *))dlsym(RTLD_DEFAULT, "sem_getvalue");
+  CHECK_LOCATE_SYMBOL(native_sem_getvalue, sem_getvalue);
+  native_sem_destroy = (int (*)(sem_t *))dlsym(RTLD_DEFAULT, "sem_destroy");
+  CHECK_LOCATE_SYMBOL(native_sem_destroy, sem_destroy);
+  __dlx_fast_init();
+}
+
+// {{{ forwarding function call to native interface
+int pthread_mutex_init_original(pthread_mutex_t *mtx, const pthread_mutexattr_t *attr) {
+    return native_mutex_init(mtx, attr);
+}
+
+int pthread_mutex_lock_original(pthread_mutex_t *mtx) {
+    return native_mutex_lock(mtx);
+}
+
+int pthread_mutex_unlock_original(pthread_mutex_t *mtx) {
+    return native_mutex_unlock(mtx);
+}
+
+int pthread_mutex_destroy_original(pthread_mutex_t *mtx) {
+    return native_mutex_destroy(mtx);
+}
+
+int pthread_mutex_trylock_original(pthread_mutex_t *mtx) {
+    return native_mutex_trylock(mtx);
+}
+
+int pthread_mutex_timedlock_original(pthread_mutex_t *mtx, const struct timespec *time) {
+    return native_mutex_timedlock(mtx, time);
+}
+
+int pthread_cond_wait_original(pthread_cond_t *cond, pthread_mutex_t *mtx) {
+    return native_cond_wait(cond, mtx);
+}
+
+int pthread_cond_timedwait_original(pthread_cond_t *cond, pthread_mutex_t *mtx, const struct timespec *time) {
+    return native_cond_timedwait(cond, mtx, time);
+}
+
+int pthread_cond_signal_original(pthread_cond_t *cond) {
+    return native_cond_signal(cond);
+}
+
+int pthread_cond_broadcast_original(pthread_cond_t *cond) {
+    return native_cond_broadcast(cond);
+}
+
+int pthread_rwlock_init_original(pthread_rwlock_t *rw, const pthread_rwlockattr_t *attr) {
+    return native_rwlock_init(rw, attr);
+}
+
+int pthread_rwlock_rdlock_original(pthread_rwlock_t *rw) {
+    return native_rwlock_rdlock(rw);
+}
+
+int pthread_rwlock_wrlock_original(pthread_rwlock_t *rw) {
+    return native_rwlock_wrlock(rw);
+}
+
+int pthread_rwlock_tryrdlock_original(pthread_rwlock_t *rw) {
+    return native_rwlock_tryrdlock(rw);
+}
+
+int pthread_rwlock_trywrlock_original(pthread_rwlock_t *rw) {
+    return native_rwlock_trywrlock(rw);
+}
+
+int pthread_rwlock_unlock_original(pthread_rwlock_t *rw) {
+    return native_rwlock_unlock(rw);
+}
+
+int pthread_rwlock_destroy_original(pthread_rwlock_t *rw) {
+    return native_rwlock_destroy(rw);
+}
+
+int pthread_spin_init_original(pthread_spinlock_t *spin, int pshared) {
+    return native_spin_init(spin, pshared);
+}
+
+int pthread_spin_lock_original(pthread_spinlock_t *spin) {
+    return native_spin_lock(spin);
+}
+
+int pthread_spin_trylock_original(pthread_spinlock_t *spin) {
+    return native_spin_trylock(spin);
+}
+
+int pthread_spin_unlock_original(pthread_spinlock_t *spin) {
+    return native_spin_unlock(spin);
+}
+
+int pthread_spin_destroy_original(pthread_spinlock_t *spin) {
+    return native_spin_destroy(spin);
+}
+
+int pthread_barrier_init_original(pthread_barrier_t *bar, const pthread_barrierattr_t *attr, unsigned count) {
+    return native_barrier_init(bar, attr, count);
+}
+
+int pthread_barrier_wait_original(pthread_barrier_t *bar) {
+    return native_barrier_wait(bar);
+}
+
+int pthread_barrier_destroy_original(pthread_barrier_t *bar) {
+    return native_barrier_destroy(bar);
+}
+
+int sem_init_original(sem_t *sem, int pshared, unsigned value) {
+    return native_sem_init(sem, pshared, value);
+}
+
+int sem_wait_original(sem_t *sem) {
+    return native_sem_wait(sem);
+}
+
+int sem_trywait_original(sem_t *sem) {
+    return native_sem_trywait(sem);
+}
+
+int sem_timedwait_original(sem_t *sem, const struct timespec *abstime) {
+    return native_sem_timedwait(sem, abstime);
+}
+
+int sem_post_original(sem_t *sem) {
+    return native_sem_post(sem);
+}
+
+int sem_getvalue_original(sem_t *sem, int *value) {
+    return native_sem_getvalue(sem, value);
+}
+
+int sem_destroy_original(sem_t *sem) {
+    return native_sem_destroy(sem);
+}
+// }}}
+
+void *dlx_error_obj_init(uint32_t cnt, uint32_t unit, uint32_t *offsets, uint32_t n_offset, void **init_funcs, int *type_ids, char *file, int line) {
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable memory object lock are trying to init. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, it happens near %s L%d",
+    file, line
+  );
+  HANDLING_ERROR(error_msg);
+  return NULL;
+}
+
+// The third argument property represent two meanings.
+// 1. offset collection (even index)
+// 2. occupied volume unit (odd index) normal variable = 1; array = length
+void *dlx_struct_obj_init(uint32_t cnt, uint32_t unit, uint32_t *properties, uint32_t n_offset, void **init_funcs, int *type_ids, char *file, int line) {
+  char *object = calloc(cnt, unit);
+  if (object) {
+    for (uint32_t c = 0; c < cnt; c++) {
+      for (uint32_t n = 0; n < n_offset; n++) {
+        uint64_t offset = properties[2*n];
+        uint32_t vol = properties[2*n + 1];
+        dlx_generic_lock_t *lock = (dlx_generic_lock_t *)(object + c * unit + offset);
+        int (*init_fptr)(dlx_generic_lock_t *, pthread_mutexattr_t *, int32_t, char *, char *, int);
+        init_fptr = init_funcs[n];
+        for (uint32_t i = 0; i < vol; i++) {
+            init_fptr(lock, NULL, type_ids[n], "forward_from_obj_init", file, line);
+            lock++;
+        }
+      }
+    }
+    __dlx_obj_track_struct(object, cnt, unit, properties, n_offset, init_funcs);
+    return object;
+  }
+  return NULL;
+}
+
+int dlx_error_var_init(void *lock, const pthread_mutexattr_t *attr, int type_id, char *file, char *var_name, int line) {
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable variable of locks are trying to init. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, it happens near %s L%d [%s]",
+    file, line, var_name
+  );
+  HANDLING_ERROR(error_msg);
+  return -1;
+}
+
+int dlx_untrack_var_init(dlx_generic_lock_t *lock, const pthread_mutexattr_t *attr, int type_id, char *var_name, char *file, int line) {
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  char log_msg[300];
+  printf("Untracked lock variable located in %s %s L%4d is initialized\n", file, var_name, line);
+#endif
+  // The untracked lock instance is initialized with pthreadmtx
+  // by default.
+  lock->methods = &dlx_pthreadmtx_methods_collection;
+  lock->check_code = 0x32CB00B5;
+  lock->users = 0;
+  lock->epoch = 0;
+  lock->home = 0;
+  lock->ind.pair.type_id = -1;
+  lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
+  if (__dlx_pshared_attr(attr))
+    return dlx_pshared_init(lock);
+  if (lock->methods->init_fptr(DLX_OBJ_SLOT(lock), NULL, dlx_site_conf(-1)))
+    return -1;
+  dlx_account_lock(-1, lock->methods, 1);
+  return 0;
+}
+
+int dlx_error_check_init(void *object, const pthread_mutexattr_t *attr, char *var_name, char *file, int line) {
+  dlx_generic_lock_t *lock = (dlx_generic_lock_t *)object;
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable checking initialization is conducted. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, error of checking %s happens near %s L%d.",
+    var_name, file, line
+  );
+  HANDLING_ERROR(error_msg);
+  return -1;
+}
+
+int dlx_untrack_check_init(dlx_generic_lock_t *lock, const pthread_mutexattr_t *attr, char *var_name, char *file, int line) {
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  char log_msg[300];
+  printf("Untracked lock variable located in %s %s L%4d is checked\n", file, var_name, line);
+#endif
+  lock->methods = &dlx_pthreadmtx_methods_collection;
+  lock->check_code = 0x32CB00B5;
+  lock->users = 0;
+  lock->epoch = 0;
+  lock->home = 0;
+  lock->ind.pair.type_id = -1;
+  lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
+  if (__dlx_pshared_attr(attr))
+    return dlx_pshared_init(lock);
+  if (lock->methods->init_fptr(DLX_OBJ_SLOT(lock), NULL, dlx_site_conf(-1)))
+    return -1;
+  dlx_account_lock(-1, lock->methods, 1);
+  return 0;
+}
+
+int dlx_error_arr_init(void *lock, uint32_t size, int type_id, char *var_name, char *file, int line) {
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable array of locks are trying to init. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, error of array %s happens near %s L%d.",
+    var_name, file, line
+  );
+  HANDLING_ERROR(error_msg);
+  return -1;
+}
+
+int dlx_untrack_arr_init(dlx_generic_lock_t *lock, uint32_t num, int type_id, char *var_name, char *file, int line) {
+  for (uint32_t i = 0; i < num; i++) {
+    if (lock[i].check_code == 0x32CB00B5)
+      continue;
+
+    // Certain lock element isn't initialized.
+    lock[i].methods = &dlx_pthreadmtx_methods_collection;
+    lock[i].ind.pair.type_id = -1;
+    lock[i].ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
+    lock[i].check_code = 0x32CB00B5;
+    lock[i].users = 0;
+    lock[i].epoch = 0;
+    lock[i].home = 0;
+
+    if (lock[i].methods->init_fptr(DLX_OBJ_SLOT(&lock[i]), NULL, dlx_site_conf(-1)))
+      return -1;
+    dlx_account_lock(-1, lock[i].methods, 1);
+  }
+  return 0;
+}
+
+int dlx_error_enable(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
+  if (mtx && mtx->check_code == 0x32CB00B5)
+      return dlx_forward_enable(long_id, object, var_name, file, line);
+  char err_msg[200];
+  indicator_t id = (indicator_t)long_id;
+  sprintf(
+    err_msg,
+    "Untrackable lock is trying to enable. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+    "(Lock-id: %d-%u) %s:%d",
+    id.pair.type_id, id.pair.ins_id, file, line
+  );
+  HANDLING_ERROR(err_msg);
+  return -1;
+}
+
+int dlx_forward_enable(int64_t long_id, void *lock, char *var_name, char *file, int line) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  do {
+    char log_msg[300];
+    printf("[TID %8d] lock %s located in %s L%4d is enable\n", syscall(SYS_gettid), var_name, file, line);
+  } while(0);
+#endif
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_lock(__dlx_pshared_slot(mtx));
+  if (!g_dlx_hooks) {
+    __dlx_enter(mtx);
+    return mtx->methods->lock_fptr(mtx->lock_obj);
+  }
+  __dlx_causal_pay();
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  uint64_t traced = __dlx_trace_begin(mtx);
+  if (__dlx_fast_acquire(mtx, DLX_FAST_MUTEX)) {
+    if (stats)
+      __dlx_stat_acquired(mtx, stats, 0);
+    __dlx_trace_acquired(mtx, DLX_TRACE_ACQUIRE, traced);
+    __dlx_causal_acquired(mtx, 0);
+    return 0;
+  }
+  __dlx_enter(mtx);
+  uint64_t begin = __dlx_tune_begin();
+  uint64_t delayed = __dlx_causal_begin();
+  int ret = stats? __dlx_stat_lock(mtx, stats, NULL): mtx->methods->lock_fptr(mtx->lock_obj);
+  __dlx_trace_acquired(mtx, DLX_TRACE_ACQUIRE, traced);
+  __dlx_tune_acquired(mtx, begin);
+  __dlx_causal_acquired(mtx, delayed);
+  return ret;
+}
+
+int dlx_error_disable(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
+  if (mtx && mtx->check_code == 0x32CB00B5)
+    return dlx_forward_disable(long_id, object, var_name, file, line);
+  HANDLING_ERROR(
+    "Untrackable lock is trying to unlock. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_disable(int64_t long_id, void *lock, char *var_name, char *file, int line) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  char log_msg[300];
+  printf("[TID %8lu] lock %s located in %s L%4d is disabled\n", syscall(SYS_gettid), var_name, file, line);
+#endif
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_unlock(__dlx_pshared_slot(mtx));
+  int ret;
+  if (!g_dlx_hooks) {
+    ret = mtx->methods->unlock_fptr(mtx->lock_obj);
+    __dlx_leave(mtx);
+    return ret;
+  }
+  __dlx_stat_released(mtx);
+  __dlx_trace_released(mtx);
+  __dlx_causal_released(mtx);
+  if (__dlx_fast_release(mtx))
+    return 0;
+  __dlx_tune_released(mtx);
+  ret = mtx->methods->unlock_fptr(mtx->lock_obj);
+  __dlx_leave(mtx);
+  return ret;
+}
+
+int dlx_error_destroy(int64_t long_id, void *object) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
+  if (mtx && mtx->check_code == 0x32CB00B5)
+    return dlx_forward_destroy(long_id, object);
+  HANDLING_ERROR(
+    "Untrackable lock is trying to destroy. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_destroy(int64_t long_id, void *lock) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  mtx->check_code = 0xBADB00B5;
+  dlx_account_lock(mtx->ind.pair.type_id, mtx->methods, -1);
+  if (__dlx_pshared(mtx))
+    return 0;
+  __dlx_fast_forget(mtx);
+  return mtx->methods->destroy_fptr(mtx->lock_obj);
+}
+
+int dlx_error_trylock(int64_t long_id, void *lock, char *var_name, char *file, int line) {
+  HANDLING_ERROR(
+    "Untrackable lock is trying to destroy. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_trylock(int64_t long_id, void *lock, char *var_name, char *file, int line) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  char log_msg[300];
+  printf("[TID %8lu] lock %s located in %s L%4d is trying to enabled\n", pthread_self(), var_name, file, line);
+#endif
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_trylock(__dlx_pshared_slot(mtx));
+  int ret;
+  if (!g_dlx_hooks) {
+    __dlx_enter(mtx);
+    if ((ret = mtx->methods->trylock_fptr(mtx->lock_obj)))
+      __dlx_leave(mtx);
+    return ret;
+  }
+  __dlx_causal_pay();
+  __dlx_fast_materialize(mtx);
+  __dlx_enter(mtx);
+  uint64_t begin = __dlx_tune_begin();
+  uint64_t traced = __dlx_trace_begin(mtx);
+  ret = mtx->methods->trylock_fptr(mtx->lock_obj);
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  if (stats && ret)
+    stats->n_try_fail++;
+  else if (stats)
+    __dlx_stat_acquired(mtx, stats, 0);
+  if (ret)
+    __dlx_trace_failed(mtx, DLX_TRACE_TRYFAIL, traced);
+  else
+    __dlx_trace_acquired(mtx, DLX_TRACE_ACQUIRE, traced);
+  if (ret != 0) {
+    __dlx_leave(mtx);
+  } else {
+    __dlx_tune_acquired(mtx, begin);
+    __dlx_causal_acquired(mtx, 0);
+  }
+  return ret;
+}
+
+int dlx_error_timedlock(int64_t long_id, void *object, const struct timespec *time, char *var_name, char *file, int line) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
+  if (mtx && mtx->check_code == 0x32CB00B5)
+    return dlx_forward_timedlock(long_id, object, time, var_name, file, line);
+  HANDLING_ERROR(
+    "Untrackable lock is trying to timedlock. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_timedlock(int64_t long_id, void *lock, const struct timespec *time, char *var_name, char *file, int line) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  printf("[TID %8lu] lock %s located in %s L%4d is trying to enable before deadline\n", syscall(SYS_gettid), var_name, file, line);
+#endif
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_timedlock(__dlx_pshared_slot(mtx), time);
+  int ret;
+  if (!g_dlx_hooks) {
+    __dlx_enter(mtx);
+    if ((ret = mtx->methods->timedlock_fptr(mtx->lock_obj, time)))
+      __dlx_leave(mtx);
+    return ret;
+  }
+  __dlx_causal_pay();
+  __dlx_fast_materialize(mtx);
+  __dlx_enter(mtx);
+  uint64_t begin = __dlx_tune_begin();
+  uint64_t delayed = __dlx_causal_begin();
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  uint64_t traced = __dlx_trace_begin(mtx);
+  ret = stats? __dlx_stat_lock(mtx, stats, time): mtx->methods->timedlock_fptr(mtx->lock_obj, time);
+  if (ret)
+    __dlx_trace_failed(mtx, DLX_TRACE_TIMEOUT, traced);
+  else
+    __dlx_trace_acquired(mtx, DLX_TRACE_ACQUIRE, traced);
+  if (ret != 0) {
+    __dlx_leave(mtx);
+    __dlx_causal_forgive(delayed);
+  } else {
+    __dlx_tune_acquired(mtx, begin);
+    __dlx_causal_acquired(mtx, delayed);
+  }
+  return ret;
+}
+
+int dlx_error_cond_wait(int64_t long_id, pthread_cond_t *cond, void *lock) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (lock && mtx->check_code == 0x32CB00B5) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
+    printf("[ WARNING ] entering dlx_error_cond_wait but check code is confirmed\n");
+#endif
+    return dlx_forward_cond_wait(long_id, cond, lock);
+  }
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable memory object lock is trying to wait for condition variable.\n"
+    "Possible cause is _Generic function falls into \'default\' option.\n"
+  );
+  HANDLING_ERROR(error_msg);
+  return -1;
+}
+
+int dlx_forward_cond_wait(int64_t long_id, pthread_cond_t *cond, void *lock) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_cond_timedwait(cond, __dlx_pshared_slot(mtx), 0);
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  if (stats) {
+    __dlx_stat_released(mtx);
+    stats->n_cond_wait++;
+  }
+  __dlx_trace_released(mtx);
+  __dlx_causal_released(mtx);
+  uint64_t traced = __dlx_trace_begin(mtx);
+  uint64_t delayed = __dlx_causal_begin();
+  __dlx_fast_materialize(mtx);
+  __dlx_tune_released(mtx);
+  int ret = mtx->methods->cond_timedwait_fptr(cond, mtx->lock_obj, 0);
+  __dlx_trace_acquired(mtx, DLX_TRACE_REACQUIRE, traced);
+  __dlx_tune_rehold(mtx);
+  __dlx_causal_acquired(mtx, delayed);
+  return ret;
+}
+
+int dlx_error_cond_timedwait(int64_t long_id, pthread_cond_t *cond, void *lock, const struct timespec *time) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (lock && mtx->check_code == 0x32CB00B5) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
+    printf("[ WARNING ] entering dlx_error_cond_timedwait but check code is confirmed\n");
+#endif
+    return dlx_forward_cond_timedwait(long_id, cond, lock, time);
+  }
+  HANDLING_ERROR(
+    "Untrackable lock is trying to wait for condtion variable.\n"
+    "Possible cause is _Generic function falls into \'default\'\n"
+    "option."
+  );
+  return -1;
+}
+
+int dlx_forward_cond_timedwait(int64_t long_id, pthread_cond_t *cond, void *lock, const struct timespec *time) {
+  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
+  if (__dlx_pshared(mtx))
+    return pshared_cond_timedwait(cond, __dlx_pshared_slot(mtx), time);
+  dlx_lock_stats_t *stats = __dlx_stat_of(mtx);
+  if (stats) {
+    __dlx_stat_released(mtx);
+    stats->n_cond_wait++;
+  }
+  __dlx_trace_released(mtx);
+  __dlx_causal_released(mtx);
+  uint64_t traced = __dlx_trace_begin(mtx);
+  uint64_t delayed = __dlx_causal_begin();
+  __dlx_fast_materialize(mtx);
+  __dlx_tune_released(mtx);
+  int ret = mtx->methods->cond_timedwait_fptr(cond, mtx->lock_obj, time);
+  __dlx_trace_acquired(mtx, DLX_TRACE_REACQUIRE, traced);
+  __dlx_tune_rehold(mtx);
+  __dlx_causal_acquired(mtx, delayed);
+  return ret;
+}
+
+int dlx_cond_signal(pthread_cond_t *cond) {
+  return compact_cond_signal(cond, 0);
+}
+
+int dlx_cond_broadcast(pthread_cond_t *cond) {
+  return compact_cond_signal(cond, 1);
+}
+
+// {{{ reader-writer lock interface
+// A rwlock initialized PTHREAD_PROCESS_SHARED stays a native
+// pthread_rwlock_t in place, since a backend would sit in the private
+// memory of the initializing process. glibc keeps a futex word of 0 to 3
+// where check_code sits, so every call below tells it from a tracked one
+// and hands it to glibc, past the single-thread fast path.
+#define DLX_RW_IS_TRACKED(rw) ((rw)->check_code == 0x32CB00B5)
+
+static inline int __dlx_pshared_rwattr(const pthread_rwlockattr_t *attr) {
+  int pshared = PTHREAD_PROCESS_PRIVATE;
+  return attr && !pthread_rwlockattr_getpshared(attr, &pshared) && pshared == PTHREAD_PROCESS_SHARED;
+}
+
+// Untracked rwlock instances, reached through pointers, casts and
+// typedefs, fall back to the neutral pthreadrw implementation.
+static inline int __dlx_untrack_rw_bind(dlx_generic_rwlock_t *lock, const pthread_rwlockattr_t *attr) {
+  void *native = lock;
+  if (__dlx_pshared_rwattr(attr))
+    return pthread_rwlock_init_original(native, attr);
+  lock->methods = calloc(1, sizeof(dlx_injected_rwlock_interface_t));
+  lock->methods->init_fptr = pthreadrw_init;
+  lock->methods->rdlock_fptr = pthreadrw_rdlock;
+  lock->methods->wrlock_fptr = pthreadrw_wrlock;
+  lock->methods->tryrdlock_fptr = pthreadrw_tryrdlock;
+  lock->methods->trywrlock_fptr = pthreadrw_trywrlock;
+  lock->methods->unlock_fptr = pthreadrw_unlock;
+  lock->methods->destroy_fptr = pthreadrw_destroy;
+  lock->check_code = 0x32CB00B5;
+  lock->ind.pair.type_id = -1;
+  lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
+  return (!lock->methods || lock->methods->init_fptr(DLX_OBJ_SLOT(lock), (pthread_rwlockattr_t *)attr))? -1: 0;
+}
+
+int dlx_untrack_rw_var_init(dlx_generic_rwlock_t *lock, const pthread_rwlockattr_t *attr, int type_id, char *var_name, char *file, int line) {
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  printf("Untracked rwlock variable located in %s %s L%4d is initialized\n", file, var_name, line);
+#endif
+  return __dlx_untrack_rw_bind(lock, attr);
+}
+
+int dlx_untrack_rw_check_init(dlx_generic_rwlock_t *lock, const pthread_rwlockattr_t *attr, char *var_name, char *file, int line) {
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+  printf("Untracked rwlock variable located in %s %s L%4d is checked\n", file, var_name, line);
+#endif
+  return __dlx_untrack_rw_bind(lock, attr);
+}
+
+int dlx_untrack_rw_arr_init(dlx_generic_rwlock_t *lock, uint32_t num, int type_id, char *var_name, char *file, int line) {
+  for (uint32_t i = 0; i < num; i++) {
+    if (lock[i].check_code == 0x32CB00B5)
+      continue;
+    if (__dlx_untrack_rw_bind(&lock[i], NULL))
+      return -1;
+  }
+  return 0;
+}
+
+int dlx_error_rw_check_init(void *object, const pthread_rwlockattr_t *attr, char *var_name, char *file, int line) {
+  dlx_generic_rwlock_t *lock = (dlx_generic_rwlock_t *)object;
+  if (lock && lock->check_code == 0x32CB00B5)
+    return 0;
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable rwlock checking initialization is conducted. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, error of checking %s happens near %s L%d.",
+    var_name, file, line
+  );
+  HANDLING_ERROR(error_msg);
+  return -1;
+}
+
+#define DLX_RWLOCK_FORWARD_IMPLEMENT(op, kind)                                                              \
+int dlx_error_ ## op(int64_t long_id, void *object, char *var_name, char *file, int line) {                 \
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;                                                \
+  if (rw && rw->check_code == 0x32CB00B5)                                                                   \
+    return dlx_forward_ ## op(long_id, object, var_name, file, line);                                       \
+  char err_msg[300];                                                                                        \
+  indicator_t id = (indicator_t)long_id;                                                                    \
+  sprintf(                                                                                                  \
+    err_msg,                                                                                                \
+    "Untrackable rwlock is trying to " #op ". Possible cause is\n"                                          \
+    "_Generic function falls into \'default\' option.\n"                                                    \
+    "(Lock-id: %d-%u) %s:%d",                                                                               \
+    id.pair.type_id, id.pair.ins_id, file, line                                                             \
+  );                                                                                                        \
+  HANDLING_ERROR(err_msg);                                                                                  \
+  return -1;                                                                                                \
+}                                                                                                           \
+                                                                                                            \
+int dlx_forward_ ## op(int64_t long_id, void *object, char *var_name, char *file, int line) {               \
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;                                                \
+  if (!DLX_RW_IS_TRACKED(rw))                                                                               \
+    return pthread_rwlock_ ## op ## _original((pthread_rwlock_t *)object);                                  \
+  if (kind == DLX_FAST_TRY)                                                                                  \
+    __dlx_fast_materialize(rw);                                                                             \
+  else if (__dlx_fast_acquire(rw, kind))                                                                    \
+    return 0;                                                                                               \
+  return rw->methods->op ## _fptr(rw->lock_obj);                                                            \
+}
+
+DLX_RWLOCK_FORWARD_IMPLEMENT(rdlock, DLX_FAST_RDLOCK)
+DLX_RWLOCK_FORWARD_IMPLEMENT(wrlock, DLX_FAST_WRLOCK)
+DLX_RWLOCK_FORWARD_IMPLEMENT(tryrdlock, DLX_FAST_TRY)
+DLX_RWLOCK_FORWARD_IMPLEMENT(trywrlock, DLX_FAST_TRY)
+
+int dlx_error_rwunlock(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;
+  if (rw && rw->check_code == 0x32CB00B5)
+    return dlx_forward_rwunlock(long_id, object, var_name, file, line);
+  HANDLING_ERROR(
+    "Untrackable rwlock is trying to unlock. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_rwunlock(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;
+  if (!DLX_RW_IS_TRACKED(rw))
+    return pthread_rwlock_unlock_original((pthread_rwlock_t *)object);
+  if (__dlx_fast_release(rw))
+    return 0;
+  return rw->methods->unlock_fptr(rw->lock_obj);
+}
+
+int dlx_error_rwdestroy(int64_t long_id, void *object) {
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;
+  if (rw && rw->check_code == 0x32CB00B5)
+    return dlx_forward_rwdestroy(long_id, object);
+  HANDLING_ERROR(
+    "Untrackable rwlock is trying to destroy. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+  );
+  return -1;
+}
+
+int dlx_forward_rwdestroy(int64_t long_id, void *object) {
+  dlx_generic_rwlock_t *rw = (dlx_generic_rwlock_t *)object;
+  if (!DLX_RW_IS_TRACKED(rw))
+    return pthread_rwlock_destroy_original((pthread_rwlock_t *)object);
+  __dlx_fast_forget(rw);
+  rw->check_code = 0xBADB00B5;
+  int ret = rw->methods->destroy_fptr(rw->lock_obj);
+  free(rw->methods);
+  return ret;
+}
+// }}}
+
+// Elements of one array take consecutive instance ids, even while other
+// threads initialize locks of the same site.
+static int __dlx_arr_init(
+  char *head, uint32_t len, size_t stride, const dlx_injected_interface_t *methods,
+  int32_t type_id, char *var_name, char *file, int line
+) {
+  uint32_t base = dlx_next_instances(type_id, len);
+  for (uint32_t i = 0; i < len; i++) {
+    dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)(head + i * stride);
+    const dlx_injected_interface_t *bound = methods;
+    const dlx_lock_conf_t *conf = dlx_instance_bind(&bound, type_id, base + i);
+    void *obj = NULL;
+    gen_lock->methods = bound;
+    gen_lock->ind.pair.type_id = type_id;
+    gen_lock->ind.pair.ins_id = base + i;
+    gen_lock->check_code = 0x32CB00B5;
+    gen_lock->users = 0;
+    gen_lock->epoch = 0;
+    gen_lock->home = 0;
+    if (bound->init_fptr(&obj, NULL, conf)) {
+      printf("Error happens while initializing lock array %s in %s L%4d\n", var_name, file, line);
+      return -1;
+    }
+    gen_lock->lock_obj = obj;
+    dlx_account_lock(type_id, bound, 1);
+  }
+  return 0;
+}
+
+// Serve every dispatched initialization function call, including
+// normal variable, array and pointer with malloc-like function
+// call.
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
+#	define DLX_LOCK_TEMPLATE_IMPLEMENT(ltype)                                                                                                        \
+int dlx_ ## ltype ##_var_init(                                                                                                                       \
+  dlx_ ## ltype ## _t *lock,                                                                                                                         \
+  pthread_mutexattr_t *attr,                                                                                                                         \
+  int type_id,                                                                                                                                       \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+    return 0;                                                                                                                                        \
+  gen_lock->methods = &dlx_ ## ltype ## _methods_collection;                                                                                         \
+  gen_lock->ind.pair.type_id = type_id;                                                                                                              \
+  gen_lock->ind.pair.ins_id = dlx_next_instance(type_id);                                                                                            \
+  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
+  gen_lock->users = __dlx_swap_pin(attr);                                                                                                                        \
+  gen_lock->epoch = 0;                                                                                                                               \
+  gen_lock->home = 0;                                                                                                                                \
+  const dlx_injected_interface_t *bound = gen_lock->methods;                                                                                         \
+  const dlx_lock_conf_t *conf = dlx_instance_bind(&bound, type_id, gen_lock->ind.pair.ins_id);                                                       \
+  gen_lock->methods = bound;                                                                                                                         \
+  if (__dlx_pshared_attr(attr))                                                                                                                      \
+    return dlx_pshared_init(gen_lock);                                                                                                               \
+  if (gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr, conf)) {                                                                            \
+    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+    return -1;                                                                                                                                       \
+  }                                                                                                                                                  \
+  dlx_account_lock(gen_lock->ind.pair.type_id, gen_lock->methods, 1);                                                                                \
+  return 0;                                                                                                                                          \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+int dlx_ ## ltype ## _check_init(                                                                                                                    \
+  dlx_ ## ltype ## _t *lock,                                                                                                                         \
+  pthread_mutexattr_t *attr,                                                                                                                         \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+    return 0;                                                                                                                                        \
+  printf("[WARNING !!!] Dylinx identifies uninitialized lock instance %s in %s L%4d.\n", var_name, file, line);                                      \
+  gen_lock->methods = &dlx_ ## ltype ## _methods_collection;                                                                                         \
+  gen_lock->ind.pair.type_id = -1;                                                                                                                   \
+  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
+  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
+  gen_lock->users = __dlx_swap_pin(attr);                                                                                                                        \
+  gen_lock->epoch = 0;                                                                                                                               \
+  gen_lock->home = 0;                                                                                                                                \
+  if (__dlx_pshared_attr(attr))                                                                                                                      \
+    return dlx_pshared_init(gen_lock);                                                                                                               \
+  if (gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr, dlx_site_conf(gen_lock->ind.pair.type_id))) {                                       \
+    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+    return -1;                                                                                                                                       \
+  }                                                                                                                                                  \
+  dlx_account_lock(gen_lock->ind.pair.type_id, gen_lock->methods, 1);                                                                                \
+  return 0;                                                                                                                                          \
+}                                                                                                                                                    \
+int dlx_ ## ltype ## _arr_init(                                                                                                                      \
+  dlx_ ## ltype ## _t *head,                                                                                                                         \
+  uint32_t len,                                                                                                                                      \
+  int32_t type_id,                                                                                                                                   \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  return __dlx_arr_init(                                                                                                                             \
+    (char *)head, len, sizeof(dlx_ ## ltype ## _t), &dlx_ ## ltype ## _methods_collection, type_id, var_name, file, line                             \
+  );                                                                                                                                                 \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+void *dlx_ ## ltype ## _obj_init(                                                                                                                    \
+  uint32_t cnt,                                                                                                                                      \
+  uint32_t unit,                                                                                                                                     \
+  uint32_t *offsets,                                                                                                                                 \
+  uint32_t n_offset,                                                                                                                                 \
+  void **init_funcs,                                                                                                                                 \
+  int *type_ptr,                                                                                                                                     \
+  char *file,                                                                                                                                        \
+  int line                                                                                                                                           \
+  ) {                                                                                                                                                \
+  dlx_ ## ltype ## _t *object = calloc(cnt, unit);                                                                                                   \
+  if (object) {                                                                                                                                      \
+    for (uint32_t i = 0; i < cnt; i++) {                                                                                                             \
+      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, file, "forward_from_obj_init", line);                                                  \
+    }                                                                                                                                                \
+    __dlx_obj_track_array(object, cnt, unit);                                                                                                        \
+    return object;                                                                                                                                   \
+  }                                                                                                                                                  \
+  return NULL;                                                                                                                                       \
+}                                                                                                                                                    \
+int dlx_ ## ltype ## _iso_arr_init(                                                                                                                  \
+  dlx_ ## ltype ## _iso_t *head,                                                                                                                     \
+  uint32_t len,                                                                                                                                      \
+  int32_t type_id,                                                                                                                                   \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  return __dlx_arr_init(                                                                                                                             \
+    (char *)head, len, sizeof(dlx_ ## ltype ## _iso_t), &dlx_ ## ltype ## _methods_collection, type_id, var_name, file, line                         \
+  );                                                                                                                                                 \
+}                                                                                                                                                    \
+const dlx_injected_interface_t dlx_ ## ltype ## _methods_collection = {                                                                              \
+  ltype ## _init, ltype ## _lock, ltype ## _trylock, ltype ## _timedlock, ltype ## _unlock,                                                                              \
+  ltype ## _destroy, ltype ## _cond_timedwait, sizeof(ltype ## _lock_t)                                                                              \
+};
+#else
+#	define DLX_LOCK_TEMPLATE_IMPLEMENT(ltype)                                                                                                        \
+int dlx_ ## ltype ##_var_init(                                                                                                                       \
+  dlx_ ## ltype ## _t *lock,                                                                                                                         \
+  pthread_mutexattr_t *attr,                                                                                                                         \
+  int type_id,                                                                                                                                       \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+    return 0;                                                                                                                                        \
+  gen_lock->methods = &dlx_ ## ltype ## _methods_collection;                                                                                         \
+  gen_lock->ind.pair.type_id = type_id;                                                                                                              \
+  gen_lock->ind.pair.ins_id = dlx_next_instance(type_id);                                                                                            \
+  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
+  gen_lock->users = __dlx_swap_pin(attr);                                                                                                                        \
+  gen_lock->epoch = 0;                                                                                                                               \
+  gen_lock->home = 0;                                                                                                                                \
+  const dlx_injected_interface_t *bound = gen_lock->methods;                                                                                         \
+  const dlx_lock_conf_t *conf = dlx_instance_bind(&bound, type_id, gen_lock->ind.pair.ins_id);                                                       \
+  gen_lock->methods = bound;                                                                                                                         \
+  if (__dlx_pshared_attr(attr))                                                                                                                      \
+    return dlx_pshared_init(gen_lock);                                                                                                               \
+  if (gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr, conf)) {                                                                            \
+    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+    return -1;                                                                                                                                       \
+  }                                                                                                                                                  \
+  dlx_account_lock(gen_lock->ind.pair.type_id, gen_lock->methods, 1);                                                                                \
+  return 0;                                                                                                                                          \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+int dlx_ ## ltype ## _check_init(                                                                                                                    \
+  dlx_ ## ltype ## _t *lock,                                                                                                                         \
+  pthread_mutexattr_t *attr,                                                                                                                         \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+    return 0;                                                                                                                                        \
+  gen_lock->methods = &dlx_ ## ltype ## _methods_collection;                                                                                         \
+  gen_lock->ind.pair.type_id = -1;                                                                                                                   \
+  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
+  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
+  gen_lock->users = __dlx_swap_pin(attr);                                                                                                                        \
+  gen_lock->epoch = 0;                                                                                                                               \
+  gen_lock->home = 0;                                                                                                                                \
+  if (__dlx_pshared_attr(attr))                                                                                                                      \
+    return dlx_pshared_init(gen_lock);                                                                                                               \
+  if (gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr, dlx_site_conf(gen_lock->ind.pair.type_id))) {                                       \
+    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+    return -1;                                                                                                                                       \
+  }                                                                                                                                                  \
+  dlx_account_lock(gen_lock->ind.pair.type_id, gen_lock->methods, 1);                                                                                \
+  return 0;                                                                                                                                          \
+}                                                                                                                                                    \
+int dlx_ ## ltype ## _arr_init(                                                                                                                      \
+  dlx_ ## ltype ## _t *head,                                                                                                                         \
+  uint32_t len,                                                                                                                                      \
+  int32_t type_id,                                                                                                                                   \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  return __dlx_arr_init(                                                                                                                             \
+    (char *)head, len, sizeof(dlx_ ## ltype ## _t), &dlx_ ## ltype ## _methods_collection, type_id, var_name, file, line                             \
+  );                                                                                                                                                 \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+void *dlx_ ## ltype ## _obj_init(                                                                                                                    \
+  uint32_t cnt,                                                                                                                                      \
+  uint32_t unit,                                                                                                                                     \
+  uint32_t *offsets,                                                                                                                                 \
+  uint32_t n_offset,                                                                                                                                 \
+  void **init_funcs,                                                                                                                                 \
+  int *type_ptr,                                                                                                                                     \
+  char *file,                                                                                                                                        \
+  int line                                                                                                                                           \
+  ) {                                                                                                                                                \
+  dlx_ ## ltype ## _t *object = calloc(cnt, unit);                                                                                                   \
+  if (object) {                                                                                                                                      \
+    for (uint32_t i = 0; i < cnt; i++) {                                                                                                             \
+      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, file, "forward_from_obj_init", line);                                                  \
+    }                                                                                                                                                \
+    __dlx_obj_track_array(object, cnt, unit);                                                                                                        \
+    return object;                                                                                                                                   \
+  }                                                                                                                                                  \
+  return NULL;                                                                                                                                       \
+}                                                                                                                                                    \
+int dlx_ ## ltype ## _iso_arr_init(                                                                                                                  \
+  dlx_ ## ltype ## _iso_t *head,                                                                                                                     \
+  uint32_t len,                                                                                                                                      \
+  int32_t type_id,                                                                                                                                   \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  return __dlx_arr_init(                                                                                                                             \
+    (char *)head, len, sizeof(dlx_ ## ltype ## _iso_t), &dlx_ ## ltype ## _methods_collection, type_id, var_name, file, line                         \
+  );                                                                                                                                                 \
+}                                                                                                                                                    \
+const dlx_injected_interface_t dlx_ ## ltype ## _methods_collection = {                                                                              \
+  ltype ## _init, ltype ## _lock, ltype ## _trylock, ltype ## _timedlock, ltype ## _unlock,                                                                              \
+  ltype ## _destroy, ltype ## _cond_timedwait, sizeof(ltype ## _lock_t)                                                                              \
+};
+
+#endif // __DYLINX_VERBOSE__
+
+
+#define DLX_IMPLEMENT_EACH_LOCK(...) FOR_EACH(DLX_LOCK_TEMPLATE_IMPLEMENT, __VA_ARGS__)
+DLX_IMPLEMENT_EACH_LOCK(ALLOWED_LOCK_TYPE)
+
+// Reader-writer counterpart of DLX_LOCK_TEMPLATE_IMPLEMENT.
+// {{{ barrier interface
+// A barrier initialized PTHREAD_PROCESS_SHARED stays a native
+// pthread_barrier_t in place instead of getting a backend in the private
+// memory of one process. glibc keeps the participant count where
+// check_code sits, so the calls below tell it from a tracked one and hand
+// it to glibc. A private init afterwards binds pthreadbarrier again.
+#define DLX_BARRIER_IS_TRACKED(bar) ((bar)->check_code == 0x32CB00B5)
+
+static inline int __dlx_pshared_barrierattr(const pthread_barrierattr_t *attr) {
+  int pshared = PTHREAD_PROCESS_PRIVATE;
+  return attr && !pthread_barrierattr_getpshared(attr, &pshared) && pshared == PTHREAD_PROCESS_SHARED;
+}
+
+// Untracked barriers fall back to pthreadbarrier. Binding never allocates
+// since the participant count is unknown until pthread_barrier_init.
+static inline void __dlx_untrack_barrier_bind(dlx_generic_barrier_t *bar) {
+  bar->methods = calloc(1, sizeof(dlx_injected_barrier_interface_t));
+  bar->methods->init_fptr = pthreadbarrier_init;
+  bar->methods->wait_fptr = pthreadbarrier_wait;
+  bar->methods->destroy_fptr = pthreadbarrier_destroy;
+  bar->lock_obj = NULL;
+  bar->check_code = 0x32CB00B5;
+  bar->ind.pair.type_id = -1;
+  bar->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
+}
+
+int dlx_untrack_barrier_var_init(dlx_generic_barrier_t *bar, const pthread_barrierattr_t *attr, int type_id, char *var_name, char *file, int line) {
+  if (bar && bar->check_code == 0x32CB00B5)
+    return 0;
+  __dlx_untrack_barrier_bind(bar);
+  return bar->methods? 0: -1;
+}
+
+int dlx_untrack_barrier_arr_init(dlx_generic_barrier_t *bar, uint32_t num, int type_id, char *var_name, char *file, int line) {
+  for (uint32_t i = 0; i < num; i++) {
+    if (bar[i].check_code != 0x32CB00B5)
+      __dlx_untrack_barrier_bind(&bar[i]);
+  }
+  return 0;
+}
+
+int dlx_untrack_barrier_init(dlx_generic_barrier_t *bar, const pthread_barrierattr_t *attr, unsigned count, char *var_name, char *file, int line) {
+  if (bar->check_code != 0x32CB00B5 && !__dlx_pshared_barrierattr(attr)) {
+#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
+    printf("Untracked barrier located in %s %s L%4d is initialized\n", file, var_name, line);
+#endif
+    __dlx_untrack_barrier_bind(bar);
+  }
+  return dlx_forward_barrier_init(bar, attr, count, var_name, file, line);
+}
+
+int dlx_error_barrier_init(void *object, const pthread_barrierattr_t *attr, unsigned count, char *var_name, char *file, int line) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (bar && bar->check_code == 0x32CB00B5)
+    return dlx_forward_barrier_init(bar, attr, count, var_name, file, line);
+  char error_msg[1000];
+  sprintf(
+    error_msg,
+    "Untrackable barrier initialization is conducted. Possible\n"
     "cause is _Generic function falls into \'default\' option.\n"
-    "According to source code, error of array %s happens near %s L%d.",
+    "According to source code, error of initializing %s happens near %s L%d.",
     var_name, file, line
   );
   HANDLING_ERROR(error_msg);
   return -1;
 }
 
-int dlx_untrack_arr_init(dlx_generic_lock_t *lock, uint32_t num, int type_id, char *var_name, char *file, int line) {
-  for (uint32_t i = 0; i < num; i++) {
-    if (lock[i].check_code == 0x32CB00B5)
-      continue;
-
-    // Certain lock element isn't initialized.
-    lock[i].methods = calloc(1, sizeof(dlx_injected_interface_t));
-    lock[i].methods->init_fptr = pthreadmtx_init;
-    lock[i].methods->lock_fptr = pthreadmtx_lock;
-    lock[i].methods->trylock_fptr = pthreadmtx_trylock;
-    lock[i].methods->unlock_fptr = pthreadmtx_unlock;
-    lock[i].methods->destroy_fptr = pthreadmtx_destroy;
-    lock[i].methods->cond_timedwait_fptr = pthreadmtx_cond_timedwait;
-    lock[i].ind.pair.type_id = -1;
-    lock[i].ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
-    lock[i].check_code = 0x32CB00B5;
-
-    if (!lock[i].methods || lock[i].methods->init_fptr(&lock->lock_obj, NULL))
-      return -1;
+int dlx_forward_barrier_init(void *object, const pthread_barrierattr_t *attr, unsigned count, char *var_name, char *file, int line) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (__dlx_pshared_barrierattr(attr)) {
+    if (DLX_BARRIER_IS_TRACKED(bar)) {
+      if (bar->lock_obj)
+        bar->methods->destroy_fptr(bar->lock_obj);
+      free(bar->methods);
+    }
+    return pthread_barrier_init_original((pthread_barrier_t *)object, attr, count);
   }
-  return 0;
+  if (!DLX_BARRIER_IS_TRACKED(bar))
+    __dlx_untrack_barrier_bind(bar);
+  return bar->methods->init_fptr(DLX_OBJ_SLOT(bar), attr, count);
 }
 
-int dlx_error_enable(int64_t long_id, void *object, char *var_name, char *file, int line) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
-  if (mtx && mtx->check_code == 0x32CB00B5)
-      return mtx->methods->lock_fptr(mtx->lock_obj);
-  char err_msg[200];
+int dlx_error_barrier_wait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (bar && bar->check_code == 0x32CB00B5 && bar->lock_obj)
+    return bar->methods->wait_fptr(bar->lock_obj);
+  char err_msg[300];
   indicator_t id = (indicator_t)long_id;
   sprintf(
     err_msg,
-    "Untrackable lock is trying to enable. Possible cause is\n"
+    "Untrackable barrier is trying to wait. Possible cause is\n"
     "_Generic function falls into \'default\' option.\n"
     "(Lock-id: %d-%u) %s:%d",
     id.pair.type_id, id.pair.ins_id, file, line
@@ -243,143 +3424,297 @@ int dlx_error_enable(int64_t long_id, void *object, char *var_name, char *file,
   return -1;
 }
 
-int dlx_forward_enable(int64_t long_id, void *lock, char *var_name, char *file, int line) {
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
-  do {
-    char log_msg[300];
-    printf("[TID %8d] lock %s located in %s L%4d is enable\n", syscall(SYS_gettid), var_name, file, line);
-  } while(0);
-#endif
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  return mtx->methods->lock_fptr(mtx->lock_obj);
+int dlx_forward_barrier_wait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (!DLX_BARRIER_IS_TRACKED(bar))
+    return pthread_barrier_wait_original((pthread_barrier_t *)object);
+  return bar->methods->wait_fptr(bar->lock_obj);
 }
 
-int dlx_error_disable(int64_t long_id, void *object, char *var_name, char *file, int line) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
-  if (mtx && mtx->check_code == 0x32CB00B5)
-    return mtx->methods->unlock_fptr(mtx->lock_obj);
+int dlx_error_barrier_destroy(int64_t long_id, void *object) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (bar && bar->check_code == 0x32CB00B5)
+    return dlx_forward_barrier_destroy(long_id, object);
   HANDLING_ERROR(
-    "Untrackable lock is trying to unlock. Possible cause is\n"
+    "Untrackable barrier is trying to destroy. Possible cause is\n"
     "_Generic function falls into \'default\' option.\n"
   );
   return -1;
 }
 
-int dlx_forward_disable(int64_t long_id, void *lock, char *var_name, char *file, int line) {
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
-  char log_msg[300];
-  printf("[TID %8lu] lock %s located in %s L%4d is disabled\n", syscall(SYS_gettid), var_name, file, line);
-#endif
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  return mtx->methods->unlock_fptr(mtx->lock_obj);
+// Unlike locks, a destroyed barrier keeps its binding because programs
+// commonly re-initialize the same barrier with a different count.
+int dlx_forward_barrier_destroy(int64_t long_id, void *object) {
+  dlx_generic_barrier_t *bar = (dlx_generic_barrier_t *)object;
+  if (!DLX_BARRIER_IS_TRACKED(bar))
+    return pthread_barrier_destroy_original((pthread_barrier_t *)object);
+  if (!bar->lock_obj)
+    return EINVAL;
+  int ret = bar->methods->destroy_fptr(bar->lock_obj);
+  bar->lock_obj = NULL;
+  return ret;
 }
+// }}}
 
-int dlx_error_destroy(int64_t long_id, void *object) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)object;
-  if (mtx && mtx->check_code == 0x32CB00B5)
-    return mtx->methods->destroy_fptr(mtx->lock_obj);
-  HANDLING_ERROR(
-    "Untrackable lock is trying to destroy. Possible cause is\n"
-    "_Generic function falls into \'default\' option.\n"
-  );
-  return -1;
+// {{{ semaphore interface
+// Untracked semaphores fall back to posixsem. A semaphore pointer without
+// a Dylinx header most likely came from sem_open or from a translation
+// unit that was not rewritten, so it is handed to glibc untouched.
+#define DLX_SEM_IS_TRACKED(sem) ((sem) && (sem)->check_code == 0x32CB00B5)
+
+static inline void __dlx_untrack_sem_bind(dlx_generic_sem_t *sem) {
+  sem->methods = calloc(1, sizeof(dlx_injected_sem_interface_t));
+  *sem->methods = dlx_posixsem_methods_collection;
+  sem->lock_obj = NULL;
+  sem->check_code = 0x32CB00B5;
+  sem->ind.pair.type_id = -1;
+  sem->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);
 }
 
-int dlx_forward_destroy(int64_t long_id, void *lock) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  mtx->check_code = 0xBADB00B5;
-  int ret = mtx->methods->destroy_fptr(mtx->lock_obj);
-  free(mtx->methods);
-  return ret;
+int dlx_untrack_sem_var_init(dlx_generic_sem_t *sem, void *attr, int type_id, char *var_name, char *file, int line) {
+  if (DLX_SEM_IS_TRACKED(sem))
+    return 0;
+  __dlx_untrack_sem_bind(sem);
+  return sem->methods? 0: -1;
 }
 
-int dlx_error_trylock(int64_t long_id, void *lock, char *var_name, char *file, int line) {
-  HANDLING_ERROR(
-    "Untrackable lock is trying to destroy. Possible cause is\n"
-    "_Generic function falls into \'default\' option.\n"
-  );
-  return -1;
+int dlx_untrack_sem_arr_init(dlx_generic_sem_t *sem, uint32_t num, int type_id, char *var_name, char *file, int line) {
+  for (uint32_t i = 0; i < num; i++) {
+    if (!DLX_SEM_IS_TRACKED(&sem[i]))
+      __dlx_untrack_sem_bind(&sem[i]);
+  }
+  return 0;
 }
 
-int dlx_forward_trylock(int64_t long_id, void *lock, char *var_name, char *file, int line) {
+int dlx_untrack_sem_init(void *object, int pshared, unsigned value, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem) && !pshared) {
 #if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
-  char log_msg[300];
-  printf("[TID %8lu] lock %s located in %s L%4d is trying to enabled\n", pthread_self(), var_name, file, line);
+    printf("Untracked semaphore located in %s %s L%4d is initialized\n", file, var_name, line);
 #endif
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  return mtx->methods->trylock_fptr(mtx->lock_obj);
+    __dlx_untrack_sem_bind(sem);
+  }
+  return dlx_forward_sem_init(sem, pshared, value, var_name, file, line);
 }
 
-int dlx_error_cond_wait(int64_t long_id, pthread_cond_t *cond, void *lock) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  if (lock && mtx->check_code == 0x32CB00B5) {
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
-    printf("[ WARNING ] entering dlx_error_cond_wait but check code is confirmed\n");
-#endif
-    return dlx_forward_cond_wait(long_id, cond, lock);
-  }
+int dlx_untrack_sem_wait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_wait_original((sem_t *)object);
+  return dlx_forward_sem_wait(long_id, object, var_name, file, line);
+}
+
+int dlx_untrack_sem_trywait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_trywait_original((sem_t *)object);
+  return dlx_forward_sem_trywait(long_id, object, var_name, file, line);
+}
+
+int dlx_untrack_sem_timedwait(int64_t long_id, void *object, const struct timespec *abstime, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_timedwait_original((sem_t *)object, abstime);
+  return dlx_forward_sem_timedwait(long_id, object, abstime, var_name, file, line);
+}
+
+int dlx_untrack_sem_post(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_post_original((sem_t *)object);
+  return dlx_forward_sem_post(long_id, object, var_name, file, line);
+}
+
+int dlx_untrack_sem_getvalue(int64_t long_id, void *object, int *value) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_getvalue_original((sem_t *)object, value);
+  return dlx_forward_sem_getvalue(long_id, object, value);
+}
+
+int dlx_untrack_sem_destroy(int64_t long_id, void *object) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_destroy_original((sem_t *)object);
+  return dlx_forward_sem_destroy(long_id, object);
+}
+
+static void __dlx_error_sem(const char *action, int64_t long_id, char *file, int line) {
+  char err_msg[300];
+  indicator_t id = (indicator_t)long_id;
+  sprintf(
+    err_msg,
+    "Untrackable semaphore is trying to %s. Possible cause is\n"
+    "_Generic function falls into \'default\' option.\n"
+    "(Lock-id: %d-%u) %s:%d",
+    action, id.pair.type_id, id.pair.ins_id, file, line
+  );
+  HANDLING_ERROR(err_msg);
+}
+
+int dlx_error_sem_init(void *object, int pshared, unsigned value, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem))
+    return dlx_forward_sem_init(sem, pshared, value, var_name, file, line);
   char error_msg[1000];
   sprintf(
     error_msg,
-    "Untrackable memory object lock is trying to wait for condition variable.\n"
-    "Possible cause is _Generic function falls into \'default\' option.\n"
+    "Untrackable semaphore initialization is conducted. Possible\n"
+    "cause is _Generic function falls into \'default\' option.\n"
+    "According to source code, error of initializing %s happens near %s L%d.",
+    var_name, file, line
   );
   HANDLING_ERROR(error_msg);
   return -1;
 }
 
-int dlx_forward_cond_wait(int64_t long_id, pthread_cond_t *cond, void *lock) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  return mtx->methods->cond_timedwait_fptr(cond, mtx->lock_obj, 0);
+int dlx_error_sem_wait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem) && sem->lock_obj)
+    return sem->methods->wait_fptr(sem->lock_obj);
+  __dlx_error_sem("wait", long_id, file, line);
+  return -1;
 }
 
-int dlx_error_cond_timedwait(int64_t long_id, pthread_cond_t *cond, void *lock, const struct timespec *time) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  if (lock && mtx->check_code == 0x32CB00B5) {
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
-    printf("[ WARNING ] entering dlx_error_cond_timedwait but check code is confirmed\n");
-#endif
-    return dlx_forward_cond_timedwait(long_id, cond, lock, time);
-  }
-  HANDLING_ERROR(
-    "Untrackable lock is trying to wait for condtion variable.\n"
-    "Possible cause is _Generic function falls into \'default\'\n"
-    "option."
-  );
+int dlx_error_sem_trywait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem) && sem->lock_obj)
+    return sem->methods->trywait_fptr(sem->lock_obj);
+  __dlx_error_sem("trywait", long_id, file, line);
   return -1;
 }
 
-int dlx_forward_cond_timedwait(int64_t long_id, pthread_cond_t *cond, void *lock, const struct timespec *time) {
-  dlx_generic_lock_t *mtx = (dlx_generic_lock_t *)lock;
-  return mtx->methods->cond_timedwait_fptr(cond, mtx->lock_obj, time);
+int dlx_error_sem_timedwait(int64_t long_id, void *object, const struct timespec *abstime, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem) && sem->lock_obj)
+    return sem->methods->timedwait_fptr(sem->lock_obj, abstime);
+  __dlx_error_sem("timedwait", long_id, file, line);
+  return -1;
 }
 
-// Serve every dispatched initialization function call, including
-// normal variable, array and pointer with malloc-like function
-// call.
-#if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_WAR
-#	define DLX_LOCK_TEMPLATE_IMPLEMENT(ltype)                                                                                                        \
-int dlx_ ## ltype ##_var_init(                                                                                                                       \
+int dlx_error_sem_post(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem) && sem->lock_obj)
+    return sem->methods->post_fptr(sem->lock_obj);
+  __dlx_error_sem("post", long_id, file, line);
+  return -1;
+}
+
+int dlx_error_sem_getvalue(int64_t long_id, void *object, int *value) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem) && sem->lock_obj)
+    return sem->methods->getvalue_fptr(sem->lock_obj, value);
+  __dlx_error_sem("getvalue", long_id, "unknown", 0);
+  return -1;
+}
+
+int dlx_error_sem_destroy(int64_t long_id, void *object) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (DLX_SEM_IS_TRACKED(sem))
+    return dlx_forward_sem_destroy(long_id, object);
+  __dlx_error_sem("destroy", long_id, "unknown", 0);
+  return -1;
+}
+
+// A process-shared semaphore stays a native sem_t in place. A header
+// would point every process at a backend in the private memory of the one
+// that ran sem_init. glibc writes 0 where check_code sits, so the calls
+// below tell it from a tracked one and hand it to glibc. A private
+// sem_init on memory that lost its header that way binds posixsem again.
+int dlx_forward_sem_init(void *object, int pshared, unsigned value, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (pshared) {
+    if (DLX_SEM_IS_TRACKED(sem)) {
+      if (sem->lock_obj)
+        sem->methods->destroy_fptr(sem->lock_obj);
+      free(sem->methods);
+    }
+    return sem_init_original((sem_t *)object, pshared, value);
+  }
+  if (!DLX_SEM_IS_TRACKED(sem))
+    __dlx_untrack_sem_bind(sem);
+  return sem->methods->init_fptr(DLX_OBJ_SLOT(sem), pshared, value);
+}
+
+int dlx_forward_sem_wait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_wait_original((sem_t *)object);
+  return sem->methods->wait_fptr(sem->lock_obj);
+}
+
+int dlx_forward_sem_trywait(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_trywait_original((sem_t *)object);
+  return sem->methods->trywait_fptr(sem->lock_obj);
+}
+
+int dlx_forward_sem_timedwait(int64_t long_id, void *object, const struct timespec *abstime, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_timedwait_original((sem_t *)object, abstime);
+  return sem->methods->timedwait_fptr(sem->lock_obj, abstime);
+}
+
+int dlx_forward_sem_post(int64_t long_id, void *object, char *var_name, char *file, int line) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_post_original((sem_t *)object);
+  return sem->methods->post_fptr(sem->lock_obj);
+}
+
+int dlx_forward_sem_getvalue(int64_t long_id, void *object, int *value) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_getvalue_original((sem_t *)object, value);
+  return sem->methods->getvalue_fptr(sem->lock_obj, value);
+}
+
+// Same as barriers, destroy keeps the binding for a later sem_init.
+int dlx_forward_sem_destroy(int64_t long_id, void *object) {
+  dlx_generic_sem_t *sem = (dlx_generic_sem_t *)object;
+  if (!DLX_SEM_IS_TRACKED(sem))
+    return sem_destroy_original((sem_t *)object);
+  if (!sem->lock_obj) {
+    errno = EINVAL;
+    return -1;
+  }
+  int ret = sem->methods->destroy_fptr(sem->lock_obj);
+  sem->lock_obj = NULL;
+  return ret;
+}
+// }}}
+
+#define DLX_RWLOCK_TEMPLATE_IMPLEMENT(ltype)                                                                                                         \
+static inline void __dlx_ ## ltype ## _bind(dlx_generic_rwlock_t *gen_lock, int type_id) {                                                           \
+  gen_lock->methods = calloc(1, sizeof(dlx_injected_rwlock_interface_t));                                                                            \
+  gen_lock->methods->init_fptr = ltype ## _init;                                                                                                     \
+  gen_lock->methods->rdlock_fptr = ltype ## _rdlock;                                                                                                 \
+  gen_lock->methods->wrlock_fptr = ltype ## _wrlock;                                                                                                 \
+  gen_lock->methods->tryrdlock_fptr = ltype ## _tryrdlock;                                                                                           \
+  gen_lock->methods->trywrlock_fptr = ltype ## _trywrlock;                                                                                           \
+  gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                                 \
+  gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                               \
+  gen_lock->ind.pair.type_id = type_id;                                                                                                              \
+  gen_lock->ind.pair.ins_id = dlx_next_instance(type_id);                                                                                            \
+  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+int dlx_ ## ltype ## _var_init(                                                                                                                      \
   dlx_ ## ltype ## _t *lock,                                                                                                                         \
-  pthread_mutexattr_t *attr,                                                                                                                         \
+  pthread_rwlockattr_t *attr,                                                                                                                        \
   int type_id,                                                                                                                                       \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  dlx_generic_rwlock_t *gen_lock = (dlx_generic_rwlock_t *)lock;                                                                                     \
   if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
     return 0;                                                                                                                                        \
-  gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                   \
-  gen_lock->methods->init_fptr = ltype ## _init;                                                                                                     \
-  gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                     \
-  gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                               \
-  gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                                 \
-  gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                               \
-  gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                                 \
-  gen_lock->ind.pair.type_id = type_id;                                                                                                              \
-  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
-  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
-  if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, attr)) {                          									 \
-    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+  if (__dlx_pshared_rwattr(attr))                                                                                                                    \
+    return pthread_rwlock_init_original((pthread_rwlock_t *)lock, attr);                                                                             \
+  __dlx_ ## ltype ## _bind(gen_lock, type_id);                                                                                                       \
+  if (!gen_lock->methods || gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr)) {                                                            \
+    printf("Error happens while initializing rwlock variable %s in %s L%4d\n", var_name, file, line);                                                \
     return -1;                                                                                                                                       \
   }                                                                                                                                                  \
   return 0;                                                                                                                                          \
@@ -387,49 +3722,33 @@ int dlx_ ## ltype ##_var_init(
                                                                                                                                                      \
 int dlx_ ## ltype ## _check_init(                                                                                                                    \
   dlx_ ## ltype ## _t *lock,                                                                                                                         \
-  pthread_mutexattr_t *attr,                                                                                                                         \
+  pthread_rwlockattr_t *attr,                                                                                                                        \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
+  dlx_generic_rwlock_t *gen_lock = (dlx_generic_rwlock_t *)lock;                                                                                     \
   if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
     return 0;                                                                                                                                        \
-  printf("[WARNING !!!] Dylinx identifies uninitialized lock instance %s in %s L%4d.\n", var_name, file, line);                                      \
-  gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                   \
-  gen_lock->methods->init_fptr = ltype ## _init;                                                                                                     \
-  gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                     \
-  gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                               \
-  gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                                 \
-  gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                               \
-  gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                                 \
-  gen_lock->ind.pair.type_id = -1;                                                                                                                   \
-  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
-  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
-  if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, attr)) {                          									 \
-    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+  if (__dlx_pshared_rwattr(attr))                                                                                                                    \
+    return pthread_rwlock_init_original((pthread_rwlock_t *)lock, attr);                                                                             \
+  __dlx_ ## ltype ## _bind(gen_lock, -1);                                                                                                            \
+  if (!gen_lock->methods || gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), attr)) {                                                            \
+    printf("Error happens while initializing rwlock variable %s in %s L%4d\n", var_name, file, line);                                                \
     return -1;                                                                                                                                       \
   }                                                                                                                                                  \
   return 0;                                                                                                                                          \
 }                                                                                                                                                    \
+                                                                                                                                                     \
 int dlx_ ## ltype ## _arr_init(                                                                                                                      \
   dlx_ ## ltype ## _t *head,                                                                                                                         \
   uint32_t len,                                                                                                                                      \
   int32_t type_id,                                                                                                                                   \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  for (int i = 0; i < len; i++) {                                                                                                                    \
-    dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)head + i;                                                                                   \
-    gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                 \
-    gen_lock->methods->init_fptr = ltype ## _init;                                                                                                   \
-    gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                   \
-    gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                             \
-    gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                               \
-    gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                             \
-    gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                               \
-    gen_lock->ind.pair.type_id = type_id;                                                                                                            \
-    gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                  \
-    gen_lock->check_code = 0x32CB00B5;                                                                                                               \
-    if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, NULL)) {                        									 \
-      printf("Error happens while initializing lock array %s in %s L%4d\n", var_name, file, line);                                                   \
+  for (uint32_t i = 0; i < len; i++) {                                                                                                               \
+    dlx_generic_rwlock_t *gen_lock = (dlx_generic_rwlock_t *)head + i;                                                                               \
+    __dlx_ ## ltype ## _bind(gen_lock, type_id);                                                                                                     \
+    if (!gen_lock->methods || gen_lock->methods->init_fptr(DLX_OBJ_SLOT(gen_lock), NULL)) {                                                          \
+      printf("Error happens while initializing rwlock array %s in %s L%4d\n", var_name, file, line);                                                 \
       return -1;                                                                                                                                     \
     }                                                                                                                                                \
   }                                                                                                                                                  \
@@ -449,90 +3768,124 @@ void *dlx_ ## ltype ## _obj_init(
   dlx_ ## ltype ## _t *object = calloc(cnt, unit);                                                                                                   \
   if (object) {                                                                                                                                      \
     for (uint32_t i = 0; i < cnt; i++) {                                                                                                             \
-      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, file, "forward_from_obj_init", line);                                                  \
+      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, "forward_from_obj_init", file, line);                                                  \
     }                                                                                                                                                \
     return object;                                                                                                                                   \
   }                                                                                                                                                  \
   return NULL;                                                                                                                                       \
 }                                                                                                                                                    \
-const dlx_injected_interface_t dlx_ ## ltype ## _methods_collection = {                                                                              \
-  ltype ## _init, ltype ## _lock, ltype ## _trylock, ltype ## _unlock,                                                                               \
-  ltype ## _destroy, ltype ## _cond_timedwait                                                                                                        \
+const dlx_injected_rwlock_interface_t dlx_ ## ltype ## _methods_collection = {                                                                       \
+  ltype ## _init, ltype ## _rdlock, ltype ## _wrlock, ltype ## _tryrdlock,                                                                           \
+  ltype ## _trywrlock, ltype ## _unlock, ltype ## _destroy                                                                                           \
 };
-#else
-#	define DLX_LOCK_TEMPLATE_IMPLEMENT(ltype)                                                                                                        \
-int dlx_ ## ltype ##_var_init(                                                                                                                       \
-  dlx_ ## ltype ## _t *lock,                                                                                                                         \
-  pthread_mutexattr_t *attr,                                                                                                                         \
+
+#define DLX_IMPLEMENT_EACH_RWLOCK(...) FOR_EACH(DLX_RWLOCK_TEMPLATE_IMPLEMENT, __VA_ARGS__)
+DLX_IMPLEMENT_EACH_RWLOCK(ALLOWED_RWLOCK_TYPE)
+
+#define DLX_BARRIER_TEMPLATE_IMPLEMENT(ltype)                                                                                                        \
+static inline void __dlx_ ## ltype ## _bind(dlx_generic_barrier_t *gen_bar, int type_id) {                                                           \
+  gen_bar->methods = calloc(1, sizeof(dlx_injected_barrier_interface_t));                                                                            \
+  gen_bar->methods->init_fptr = ltype ## _init;                                                                                                      \
+  gen_bar->methods->wait_fptr = ltype ## _wait;                                                                                                      \
+  gen_bar->methods->destroy_fptr = ltype ## _destroy;                                                                                                \
+  gen_bar->lock_obj = NULL;                                                                                                                          \
+  gen_bar->ind.pair.type_id = type_id;                                                                                                               \
+  gen_bar->ind.pair.ins_id = dlx_next_instance(type_id);                                                                                             \
+  gen_bar->check_code = 0x32CB00B5;                                                                                                                  \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+int dlx_ ## ltype ## _var_init(                                                                                                                      \
+  dlx_ ## ltype ## _t *bar,                                                                                                                          \
+  pthread_barrierattr_t *attr,                                                                                                                       \
   int type_id,                                                                                                                                       \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
-  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+  dlx_generic_barrier_t *gen_bar = (dlx_generic_barrier_t *)bar;                                                                                     \
+  if (gen_bar && gen_bar->check_code == 0x32CB00B5)                                                                                                  \
     return 0;                                                                                                                                        \
-  gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                   \
-  gen_lock->methods->init_fptr = ltype ## _init;                                                                                                     \
-  gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                     \
-  gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                               \
-  gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                                 \
-  gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                               \
-  gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                                 \
-  gen_lock->ind.pair.type_id = type_id;                                                                                                              \
-  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
-  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
-  if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, attr)) {                          									 \
-    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+  __dlx_ ## ltype ## _bind(gen_bar, type_id);                                                                                                        \
+  if (!gen_bar->methods) {                                                                                                                           \
+    printf("Error happens while binding barrier variable %s in %s L%4d\n", var_name, file, line);                                                    \
     return -1;                                                                                                                                       \
   }                                                                                                                                                  \
   return 0;                                                                                                                                          \
 }                                                                                                                                                    \
                                                                                                                                                      \
-int dlx_ ## ltype ## _check_init(                                                                                                                    \
-  dlx_ ## ltype ## _t *lock,                                                                                                                         \
-  pthread_mutexattr_t *attr,                                                                                                                         \
+int dlx_ ## ltype ## _arr_init(                                                                                                                      \
+  dlx_ ## ltype ## _t *head,                                                                                                                         \
+  uint32_t len,                                                                                                                                      \
+  int32_t type_id,                                                                                                                                   \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)lock;                                                                                         \
-  if (gen_lock && gen_lock->check_code == 0x32CB00B5)                                                                                                \
+  for (uint32_t i = 0; i < len; i++) {                                                                                                               \
+    if (dlx_ ## ltype ## _var_init(head + i, NULL, type_id, var_name, file, line))                                                                   \
+      return -1;                                                                                                                                     \
+  }                                                                                                                                                  \
+  return 0;                                                                                                                                          \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+void *dlx_ ## ltype ## _obj_init(                                                                                                                    \
+  uint32_t cnt,                                                                                                                                      \
+  uint32_t unit,                                                                                                                                     \
+  uint32_t *offsets,                                                                                                                                 \
+  uint32_t n_offset,                                                                                                                                 \
+  void **init_funcs,                                                                                                                                 \
+  int *type_ptr,                                                                                                                                     \
+  char *file,                                                                                                                                        \
+  int line                                                                                                                                           \
+  ) {                                                                                                                                                \
+  dlx_ ## ltype ## _t *object = calloc(cnt, unit);                                                                                                   \
+  if (object) {                                                                                                                                      \
+    for (uint32_t i = 0; i < cnt; i++) {                                                                                                             \
+      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, "forward_from_obj_init", file, line);                                                  \
+    }                                                                                                                                                \
+    return object;                                                                                                                                   \
+  }                                                                                                                                                  \
+  return NULL;                                                                                                                                       \
+}                                                                                                                                                    \
+const dlx_injected_barrier_interface_t dlx_ ## ltype ## _methods_collection = {                                                                      \
+  ltype ## _init, ltype ## _wait, ltype ## _destroy                                                                                                  \
+};
+
+#define DLX_IMPLEMENT_EACH_BARRIER(...) FOR_EACH(DLX_BARRIER_TEMPLATE_IMPLEMENT, __VA_ARGS__)
+DLX_IMPLEMENT_EACH_BARRIER(ALLOWED_BARRIER_TYPE)
+
+#define DLX_SEM_TEMPLATE_IMPLEMENT(ltype)                                                                                                            \
+static inline void __dlx_ ## ltype ## _bind(dlx_generic_sem_t *gen_sem, int type_id) {                                                               \
+  gen_sem->methods = calloc(1, sizeof(dlx_injected_sem_interface_t));                                                                                \
+  *gen_sem->methods = dlx_ ## ltype ## _methods_collection;                                                                                          \
+  gen_sem->lock_obj = NULL;                                                                                                                          \
+  gen_sem->ind.pair.type_id = type_id;                                                                                                               \
+  gen_sem->ind.pair.ins_id = dlx_next_instance(type_id);                                                                                             \
+  gen_sem->check_code = 0x32CB00B5;                                                                                                                  \
+}                                                                                                                                                    \
+                                                                                                                                                     \
+int dlx_ ## ltype ## _var_init(                                                                                                                      \
+  dlx_ ## ltype ## _t *sem,                                                                                                                          \
+  void *attr,                                                                                                                                        \
+  int type_id,                                                                                                                                       \
+  char *var_name, char *file, int line                                                                                                               \
+  ) {                                                                                                                                                \
+  dlx_generic_sem_t *gen_sem = (dlx_generic_sem_t *)sem;                                                                                             \
+  if (gen_sem && gen_sem->check_code == 0x32CB00B5)                                                                                                  \
     return 0;                                                                                                                                        \
-  gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                   \
-  gen_lock->methods->init_fptr = ltype ## _init;                                                                                                     \
-  gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                     \
-  gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                               \
-  gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                                 \
-  gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                               \
-  gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                                 \
-  gen_lock->ind.pair.type_id = -1;                                                                                                                   \
-  gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                    \
-  gen_lock->check_code = 0x32CB00B5;                                                                                                                 \
-  if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, attr)) {                          									 \
-    printf("Error happens while initializing lock variable %s in %s L%4d\n", var_name, file, line);                                                  \
+  __dlx_ ## ltype ## _bind(gen_sem, type_id);                                                                                                        \
+  if (!gen_sem->methods) {                                                                                                                           \
+    printf("Error happens while binding semaphore variable %s in %s L%4d\n", var_name, file, line);                                                  \
     return -1;                                                                                                                                       \
   }                                                                                                                                                  \
   return 0;                                                                                                                                          \
 }                                                                                                                                                    \
+                                                                                                                                                     \
 int dlx_ ## ltype ## _arr_init(                                                                                                                      \
   dlx_ ## ltype ## _t *head,                                                                                                                         \
   uint32_t len,                                                                                                                                      \
   int32_t type_id,                                                                                                                                   \
   char *var_name, char *file, int line                                                                                                               \
   ) {                                                                                                                                                \
-  for (int i = 0; i < len; i++) {                                                                                                                    \
-    dlx_generic_lock_t *gen_lock = (dlx_generic_lock_t *)head + i;                                                                                   \
-    gen_lock->methods = calloc(1, sizeof(dlx_injected_interface_t));                                                                                 \
-    gen_lock->methods->init_fptr = ltype ## _init;                                                                                                   \
-    gen_lock->methods->lock_fptr = ltype ## _lock;                                                                                                   \
-    gen_lock->methods->trylock_fptr = ltype ## _trylock;                                                                                             \
-    gen_lock->methods->unlock_fptr = ltype ## _unlock;                                                                                               \
-    gen_lock->methods->destroy_fptr = ltype ## _destroy;                                                                                             \
-    gen_lock->methods->cond_timedwait_fptr = ltype ## _cond_timedwait;                                                                               \
-    gen_lock->ind.pair.type_id = type_id;                                                                                                            \
-    gen_lock->ind.pair.ins_id = __sync_fetch_and_add(&g_ins_id, 1);                                                                                  \
-    gen_lock->check_code = 0x32CB00B5;                                                                                                               \
-    if (!gen_lock->methods || gen_lock->methods->init_fptr(&gen_lock->lock_obj, NULL)) {                        									 \
-      printf("Error happens while initializing lock array %s in %s L%4d\n", var_name, file, line);                                                   \
+  for (uint32_t i = 0; i < len; i++) {                                                                                                               \
+    if (dlx_ ## ltype ## _var_init(head + i, NULL, type_id, var_name, file, line))                                                                   \
       return -1;                                                                                                                                     \
-    }                                                                                                                                                \
   }                                                                                                                                                  \
   return 0;                                                                                                                                          \
 }                                                                                                                                                    \
@@ -550,21 +3903,18 @@ void *dlx_ ## ltype ## _obj_init(
   dlx_ ## ltype ## _t *object = calloc(cnt, unit);                                                                                                   \
   if (object) {                                                                                                                                      \
     for (uint32_t i = 0; i < cnt; i++) {                                                                                                             \
-      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, file, "forward_from_obj_init", line);                                                  \
+      dlx_ ## ltype ## _var_init(object + i, NULL, *type_ptr, "forward_from_obj_init", file, line);                                                  \
     }                                                                                                                                                \
     return object;                                                                                                                                   \
   }                                                                                                                                                  \
   return NULL;                                                                                                                                       \
 }                                                                                                                                                    \
-const dlx_injected_interface_t dlx_ ## ltype ## _methods_collection = {                                                                              \
-  ltype ## _init, ltype ## _lock, ltype ## _trylock, ltype ## _unlock,                                                                               \
-  ltype ## _destroy, ltype ## _cond_timedwait                                                                                                        \
+const dlx_injected_sem_interface_t dlx_ ## ltype ## _methods_collection = {                                                                          \
+  ltype ## _init, ltype ## _wait, ltype ## _trywait, ltype ## _timedwait,                                                                            \
+  ltype ## _post, ltype ## _getvalue, ltype ## _destroy                                                                                              \
 };
 
-#endif // __DYLINX_VERBOSE__
-
-
-#define DLX_IMPLEMENT_EACH_LOCK(...) FOR_EACH(DLX_LOCK_TEMPLATE_IMPLEMENT, __VA_ARGS__)
-DLX_IMPLEMENT_EACH_LOCK(ALLOWED_LOCK_TYPE)
+#define DLX_IMPLEMENT_EACH_SEM(...) FOR_EACH(DLX_SEM_TEMPLATE_IMPLEMENT, __VA_ARGS__)
+DLX_IMPLEMENT_EACH_SEM(ALLOWED_SEM_TYPE)
 
 #endif // __DYLINX_GLUE__
@@ -1,6 +1,7 @@
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
+#include <stddef.h>
 #include <stdint.h>
 #include <dlfcn.h>
 #include <string.h>
@@ -8,6 +9,9 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <time.h>
+#include "dylinx-conf.h"
+#include "dylinx-hist.h"
+#include "dylinx-perf.h"
 #ifndef __DYLINX_REPLACE_PTHREAD_NATIVE__
 #define __DYLINX_REPLACE_PTHREAD_NATIVE__
 #define pthread_mutex_init pthread_mutex_init_original
@@ -15,27 +19,90 @@
 #define pthread_mutex_unlock pthread_mutex_unlock_original
 #define pthread_mutex_destroy pthread_mutex_destroy_original
 #define pthread_mutex_trylock pthread_mutex_trylock_original
+#define pthread_mutex_timedlock pthread_mutex_timedlock_original
 #define pthread_cond_wait pthread_cond_wait_original
 #define pthread_cond_timedwait pthread_cond_timedwait_original
+#define pthread_cond_signal pthread_cond_signal_original
+#define pthread_cond_broadcast pthread_cond_broadcast_original
+#define pthread_rwlock_init pthread_rwlock_init_original
+#define pthread_rwlock_rdlock pthread_rwlock_rdlock_original
+#define pthread_rwlock_wrlock pthread_rwlock_wrlock_original
+#define pthread_rwlock_tryrdlock pthread_rwlock_tryrdlock_original
+#define pthread_rwlock_trywrlock pthread_rwlock_trywrlock_original
+#define pthread_rwlock_unlock pthread_rwlock_unlock_original
+#define pthread_rwlock_destroy pthread_rwlock_destroy_original
+#define pthread_spin_init pthread_spin_init_original
+#define pthread_spin_lock pthread_spin_lock_original
+#define pthread_spin_trylock pthread_spin_trylock_original
+#define pthread_spin_unlock pthread_spin_unlock_original
+#define pthread_spin_destroy pthread_spin_destroy_original
+#define pthread_barrier_init pthread_barrier_init_original
+#define pthread_barrier_wait pthread_barrier_wait_original
+#define pthread_barrier_destroy pthread_barrier_destroy_original
 #include <pthread.h>
+#define sem_init sem_init_original
+#define sem_wait sem_wait_original
+#define sem_trywait sem_trywait_original
+#define sem_timedwait sem_timedwait_original
+#define sem_post sem_post_original
+#define sem_getvalue sem_getvalue_original
+#define sem_destroy sem_destroy_original
+#include <semaphore.h>
+#undef sem_init
+#undef sem_wait
+#undef sem_trywait
+#undef sem_timedwait
+#undef sem_post
+#undef sem_getvalue
+#undef sem_destroy
 #undef PTHREAD_MUTEX_INITIALIZER
 #define PTHREAD_MUTEX_INITIALIZER {NULL, 0, {0XABADBABE, 0xFEE1DEAD}, NULL, {0}}
+#undef PTHREAD_RWLOCK_INITIALIZER
+#define PTHREAD_RWLOCK_INITIALIZER {NULL, 0, {0XABADBABE, 0xFEE1DEAD}, NULL, {0}}
 #undef pthread_mutex_init
 #undef pthread_mutex_lock
 #undef pthread_mutex_unlock
 #undef pthread_mutex_destroy
 #undef pthread_mutex_trylock
+#undef pthread_mutex_timedlock
 #undef pthread_cond_wait
 #undef pthread_cond_timedwait
+#undef pthread_cond_signal
+#undef pthread_cond_broadcast
+#undef pthread_rwlock_init
+#undef pthread_rwlock_rdlock
+#undef pthread_rwlock_wrlock
+#undef pthread_rwlock_tryrdlock
+#undef pthread_rwlock_trywrlock
+#undef pthread_rwlock_unlock
+#undef pthread_rwlock_destroy
+#undef pthread_spin_init
+#undef pthread_spin_lock
+#undef pthread_spin_trylock
+#undef pthread_spin_unlock
+#undef pthread_spin_destroy
+#undef pthread_barrier_init
+#undef pthread_barrier_wait
+#undef pthread_barrier_destroy
 #endif
 
 
 #ifndef __DYLINX_SYMBOL__
 #define __DYLINX_SYMBOL__
+#ifdef __clang__
 #pragma clang diagnostic ignored "-Wincompatible-pointer-types"
 #pragma clang diagnostic ignored "-Wmacro-redefined"
+#endif
 
-#define ALLOWED_LOCK_TYPE pthreadmtx, ttas, backoff, adaptivemtx, mcs
+// tas and ticket16 are the compact types: a 1-byte and a 4-byte lock word
+// drawn from a shared pool instead of a cache-aligned backend.
+#define ALLOWED_LOCK_TYPE pthreadmtx, ttas, backoff, adaptivemtx, mcs, ticket, qspinlock, tas, ticket16
+// Spinlock sites reuse the mutex types whose waiting never sleeps in the
+// kernel, so only this subset is accepted by the pthread_spin_* redirection.
+#define ALLOWED_SPINLOCK_TYPE ttas, backoff, ticket, mcs, qspinlock, tas, ticket16
+#define ALLOWED_RWLOCK_TYPE pthreadrw, wprefrw, bigreaderrw, bravorw
+#define ALLOWED_BARRIER_TYPE pthreadbarrier, sensebarrier, treebarrier, tournbarrier, dissembarrier
+#define ALLOWED_SEM_TYPE posixsem, spinparksem, batchsem, percpusem
 #define LOCK_TYPE_LIMIT 10
 #define DYLINX_LOCK_TO_TYPE(lock) dlx_ ## lock ## _t
 #define DYLINX_LOCK_TO_INIT_METHOD
@@ -59,17 +126,24 @@
       FE_2,FE_1,FE_0,                                                       \
   )(action,__VA_ARGS__)
 
+#ifdef __clang__
 #define XRAY_ATTR                                                                 \
   __attribute__((xray_always_instrument))                                         \
   __attribute__((xray_log_args(1)))
+#else
+#define XRAY_ATTR
+#endif
 
 typedef struct InjectedInterfaces {
-  int (*init_fptr)(void **, pthread_mutexattr_t *);
+  int (*init_fptr)(void **, pthread_mutexattr_t *, const dlx_lock_conf_t *);
   int (*lock_fptr)(void *);
   int (*trylock_fptr)(void *);
+  int (*timedlock_fptr)(void *, const struct timespec *);
   int (*unlock_fptr)(void *);
   int (*destroy_fptr)(void *);
   int (*cond_timedwait_fptr)(pthread_cond_t *, void *, const struct timespec *);
+  // Bytes of one backend, for the footprint report.
+  size_t backend_size;
 } dlx_injected_interface_t;
 
 typedef union {
@@ -78,7 +152,8 @@ typedef union {
 } indicator_t;
 
 typedef struct __attribute__((packed)) GenericLock {
-  // Point to actual memory resource for future usage.
+  // Point to actual memory resource for future usage. Process-shared
+  // locks keep their whole state here instead, see pshared-lock.h.
   void *lock_obj;
   // check_code is used as telling whether the specific
   // instance is already initialized or not. If it is
@@ -87,23 +162,126 @@ typedef struct __attribute__((packed)) GenericLock {
   // function since os may reuse the memory.
   uint32_t check_code;
   indicator_t ind;
-  dlx_injected_interface_t *methods;
-  char padding[sizeof(pthread_mutex_t) - 3 * sizeof(uint32_t) - 2 * sizeof(void *)];
+  // The shared dlx_<ltype>_methods_collection of the backend's type,
+  // NULL for a process-shared lock.
+  const dlx_injected_interface_t *methods;
+  // Hot swap bookkeeping, only maintained with __DYLINX_HOTSWAP__. users
+  // counts holders, waiters and cond-waiters, and pins instances with a
+  // non-default attribute. epoch is the site epoch the backend was built
+  // for.
+  volatile uint32_t users;
+  uint32_t epoch;
+  // NUMA re-homing on sites placed with DLX_PLACE_FOLLOW, hot swap builds
+  // only. Bits 0-7 hold 1 + the node of lock_obj (0 while unknown), bits
+  // 8-15 the node leading the sampled acquirers and bits 16-31 its lead.
+  // The header now fills pthread_mutex_t exactly.
+  volatile uint32_t home;
 } dlx_generic_lock_t;
 
-static int (*native_mutex_init)(pthread_mutex_t *, pthread_mutexattr_t *);
+// Reader-writer locks share the header layout of dlx_generic_lock_t so
+// that the same check_code and indicator logic apply. Only the method
+// table differs, since a rwlock site never meets a condition variable.
+typedef struct InjectedRWLockInterfaces {
+  int (*init_fptr)(void **, pthread_rwlockattr_t *);
+  int (*rdlock_fptr)(void *);
+  int (*wrlock_fptr)(void *);
+  int (*tryrdlock_fptr)(void *);
+  int (*trywrlock_fptr)(void *);
+  int (*unlock_fptr)(void *);
+  int (*destroy_fptr)(void *);
+} dlx_injected_rwlock_interface_t;
+
+typedef struct __attribute__((packed)) GenericRWLock {
+  void *lock_obj;
+  uint32_t check_code;
+  indicator_t ind;
+  dlx_injected_rwlock_interface_t *methods;
+  char padding[sizeof(pthread_rwlock_t) - 3 * sizeof(uint32_t) - 2 * sizeof(void *)];
+} dlx_generic_rwlock_t;
+
+// Barriers reuse the header layout as well. The participant count is only
+// known at pthread_barrier_init, so binding a barrier site merely installs
+// the method table and lock_obj stays NULL until the barrier is initialized.
+typedef struct InjectedBarrierInterfaces {
+  int (*init_fptr)(void **, const pthread_barrierattr_t *, unsigned);
+  int (*wait_fptr)(void *);
+  int (*destroy_fptr)(void *);
+} dlx_injected_barrier_interface_t;
+
+typedef struct __attribute__((packed)) GenericBarrier {
+  void *lock_obj;
+  uint32_t check_code;
+  indicator_t ind;
+  dlx_injected_barrier_interface_t *methods;
+  char padding[sizeof(pthread_barrier_t) - 3 * sizeof(uint32_t) - 2 * sizeof(void *)];
+} dlx_generic_barrier_t;
+
+// Semaphores follow the barrier scheme, the initial value only arrives
+// with sem_init. Their methods keep the sem_* convention of returning -1
+// and setting errno.
+typedef struct InjectedSemInterfaces {
+  int (*init_fptr)(void **, int, unsigned);
+  int (*wait_fptr)(void *);
+  int (*trywait_fptr)(void *);
+  int (*timedwait_fptr)(void *, const struct timespec *);
+  int (*post_fptr)(void *);
+  int (*getvalue_fptr)(void *, int *);
+  int (*destroy_fptr)(void *);
+} dlx_injected_sem_interface_t;
+
+typedef struct __attribute__((packed)) GenericSem {
+  void *lock_obj;
+  uint32_t check_code;
+  indicator_t ind;
+  dlx_injected_sem_interface_t *methods;
+  char padding[sizeof(sem_t) - 3 * sizeof(uint32_t) - 2 * sizeof(void *)];
+} dlx_generic_sem_t;
+
+static int (*native_mutex_init)(pthread_mutex_t *, const pthread_mutexattr_t *);
 static int (*native_mutex_lock)(pthread_mutex_t *);
 static int (*native_mutex_unlock)(pthread_mutex_t *);
 static int (*native_mutex_destroy)(pthread_mutex_t *);
 static int (*native_mutex_trylock)(pthread_mutex_t *);
+static int (*native_mutex_timedlock)(pthread_mutex_t *, const struct timespec *);
 static int (*native_cond_wait)(pthread_cond_t *, pthread_mutex_t *);
 static int (*native_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *, const struct timespec *);
+static int (*native_cond_signal)(pthread_cond_t *);
+static int (*native_cond_broadcast)(pthread_cond_t *);
+static int (*native_rwlock_init)(pthread_rwlock_t *, const pthread_rwlockattr_t *);
+static int (*native_rwlock_rdlock)(pthread_rwlock_t *);
+static int (*native_rwlock_wrlock)(pthread_rwlock_t *);
+static int (*native_rwlock_tryrdlock)(pthread_rwlock_t *);
+static int (*native_rwlock_trywrlock)(pthread_rwlock_t *);
+static int (*native_rwlock_unlock)(pthread_rwlock_t *);
+static int (*native_rwlock_destroy)(pthread_rwlock_t *);
+static int (*native_spin_init)(pthread_spinlock_t *, int);
+static int (*native_spin_lock)(pthread_spinlock_t *);
+static int (*native_spin_trylock)(pthread_spinlock_t *);
+static int (*native_spin_unlock)(pthread_spinlock_t *);
+static int (*native_spin_destroy)(pthread_spinlock_t *);
+static int (*native_barrier_init)(pthread_barrier_t *, const pthread_barrierattr_t *, unsigned);
+static int (*native_barrier_wait)(pthread_barrier_t *);
+static int (*native_barrier_destroy)(pthread_barrier_t *);
+static int (*native_sem_init)(sem_t *, int, unsigned);
+static int (*native_sem_wait)(sem_t *);
+static int (*native_sem_trywait)(sem_t *);
+static int (*native_sem_timedwait)(sem_t *, const struct timespec *);
+static int (*native_sem_post)(sem_t *);
+static int (*native_sem_getvalue)(sem_t *, int *);
+static int (*native_sem_destroy)(sem_t *);
 
+// dlx_<ltype>_iso_t is the same lock alone in an aligned prefetch pair, for
+// sites arranged with /ISOLATE. It dispatches like dlx_<ltype>_t.
 #define DLX_LOCK_TEMPLATE_PROTOTYPE(ltype)                                                                     \
   typedef union Dylinx ## ltype ## Lock {                                                                      \
     dlx_generic_lock_t interface;                                                                              \
     pthread_mutex_t dummy_lock;                                                                                \
   } dlx_ ## ltype ## _t;                                                                                       \
+  typedef union Dylinx ## ltype ## IsoLock {                                                                   \
+    dlx_generic_lock_t interface;                                                                              \
+    pthread_mutex_t dummy_lock;                                                                                \
+    char isolation[DLX_PREFETCH_PAIR];                                                                         \
+  } __attribute__((aligned(DLX_PREFETCH_PAIR))) dlx_ ## ltype ## _iso_t;                                       \
   int dlx_ ## ltype ## _var_init(                                                                              \
     dlx_ ## ltype ## _t *,                                                                                     \
     pthread_mutexattr_t *,                                                                                     \
@@ -121,6 +299,12 @@ static int (*native_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *, const s
     int32_t type_id,                                                                                           \
     char *var_name, char *file, int line                                                                       \
   );                                                                                                           \
+  int dlx_ ## ltype ## _iso_arr_init(                                                                          \
+    dlx_ ## ltype ## _iso_t *,                                                                                 \
+    uint32_t,                                                                                                  \
+    int32_t type_id,                                                                                           \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
   void *dlx_ ## ltype ## _obj_init(                                                                            \
     uint32_t cnt,                                                                                              \
     uint32_t unit,                                                                                             \
@@ -131,9 +315,10 @@ static int (*native_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *, const s
     char *file,                                                                                                \
     int line                                                                                                   \
   );                                                                                                           \
-  int ltype ## _init(void **, pthread_mutexattr_t *);                                                          \
+  int ltype ## _init(void **, pthread_mutexattr_t *, const dlx_lock_conf_t *);                                 \
   int ltype ## _lock(void *);                                                                                  \
   int ltype ## _trylock(void *);                                                                               \
+  int ltype ## _timedlock(void *, const struct timespec *);                                                    \
   int ltype ## _unlock(void *);                                                                                \
   int ltype ## _destroy(void *);                                                                               \
   int ltype ## _cond_timedwait(pthread_cond_t *, void *, const struct timespec *);                             \
@@ -142,28 +327,360 @@ static int (*native_cond_timedwait)(pthread_cond_t *, pthread_mutex_t *, const s
 #define DLX_LOCK_TEMPLATE_PROTOTYPE_LIST(...) FOR_EACH(DLX_LOCK_TEMPLATE_PROTOTYPE, __VA_ARGS__)
 DLX_LOCK_TEMPLATE_PROTOTYPE_LIST(ALLOWED_LOCK_TYPE)
 
+#define DLX_RWLOCK_TEMPLATE_PROTOTYPE(ltype)                                                                   \
+  typedef union Dylinx ## ltype ## RWLock {                                                                    \
+    dlx_generic_rwlock_t interface;                                                                            \
+    pthread_rwlock_t dummy_lock;                                                                               \
+  } dlx_ ## ltype ## _t;                                                                                       \
+  int dlx_ ## ltype ## _var_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    pthread_rwlockattr_t *,                                                                                    \
+    int32_t,                                                                                                   \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  int dlx_ ## ltype ## _check_init(                                                                            \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    pthread_rwlockattr_t *,                                                                                    \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  int dlx_ ## ltype ## _arr_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    uint32_t,                                                                                                  \
+    int32_t type_id,                                                                                           \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  void *dlx_ ## ltype ## _obj_init(                                                                            \
+    uint32_t cnt,                                                                                              \
+    uint32_t unit,                                                                                             \
+    uint32_t *offsets,                                                                                         \
+    uint32_t n_offset,                                                                                         \
+    void ** init_funcs,                                                                                        \
+    int32_t *type_ids,                                                                                         \
+    char *file,                                                                                                \
+    int line                                                                                                   \
+  );                                                                                                           \
+  int ltype ## _init(void **, pthread_rwlockattr_t *);                                                         \
+  int ltype ## _rdlock(void *);                                                                                \
+  int ltype ## _wrlock(void *);                                                                                \
+  int ltype ## _tryrdlock(void *);                                                                             \
+  int ltype ## _trywrlock(void *);                                                                             \
+  int ltype ## _unlock(void *);                                                                                \
+  int ltype ## _destroy(void *);                                                                               \
+  extern const dlx_injected_rwlock_interface_t dlx_ ## ltype ## _methods_collection;
+
+#define DLX_RWLOCK_TEMPLATE_PROTOTYPE_LIST(...) FOR_EACH(DLX_RWLOCK_TEMPLATE_PROTOTYPE, __VA_ARGS__)
+DLX_RWLOCK_TEMPLATE_PROTOTYPE_LIST(ALLOWED_RWLOCK_TYPE)
+
+#define DLX_BARRIER_TEMPLATE_PROTOTYPE(ltype)                                                                  \
+  typedef union Dylinx ## ltype ## Barrier {                                                                   \
+    dlx_generic_barrier_t interface;                                                                           \
+    pthread_barrier_t dummy_lock;                                                                              \
+  } dlx_ ## ltype ## _t;                                                                                       \
+  int dlx_ ## ltype ## _var_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    pthread_barrierattr_t *,                                                                                   \
+    int32_t,                                                                                                   \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  int dlx_ ## ltype ## _arr_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    uint32_t,                                                                                                  \
+    int32_t type_id,                                                                                           \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  void *dlx_ ## ltype ## _obj_init(                                                                            \
+    uint32_t cnt,                                                                                              \
+    uint32_t unit,                                                                                             \
+    uint32_t *offsets,                                                                                         \
+    uint32_t n_offset,                                                                                         \
+    void ** init_funcs,                                                                                        \
+    int32_t *type_ids,                                                                                         \
+    char *file,                                                                                                \
+    int line                                                                                                   \
+  );                                                                                                           \
+  int ltype ## _init(void **, const pthread_barrierattr_t *, unsigned);                                        \
+  int ltype ## _wait(void *);                                                                                  \
+  int ltype ## _destroy(void *);                                                                               \
+  extern const dlx_injected_barrier_interface_t dlx_ ## ltype ## _methods_collection;
+
+#define DLX_BARRIER_TEMPLATE_PROTOTYPE_LIST(...) FOR_EACH(DLX_BARRIER_TEMPLATE_PROTOTYPE, __VA_ARGS__)
+DLX_BARRIER_TEMPLATE_PROTOTYPE_LIST(ALLOWED_BARRIER_TYPE)
+
+#define DLX_SEM_TEMPLATE_PROTOTYPE(ltype)                                                                      \
+  typedef union Dylinx ## ltype ## Sem {                                                                       \
+    dlx_generic_sem_t interface;                                                                               \
+    sem_t dummy_lock;                                                                                          \
+  } dlx_ ## ltype ## _t;                                                                                       \
+  int dlx_ ## ltype ## _var_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    void *,                                                                                                    \
+    int32_t,                                                                                                   \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  int dlx_ ## ltype ## _arr_init(                                                                              \
+    dlx_ ## ltype ## _t *,                                                                                     \
+    uint32_t,                                                                                                  \
+    int32_t type_id,                                                                                           \
+    char *var_name, char *file, int line                                                                       \
+  );                                                                                                           \
+  void *dlx_ ## ltype ## _obj_init(                                                                            \
+    uint32_t cnt,                                                                                              \
+    uint32_t unit,                                                                                             \
+    uint32_t *offsets,                                                                                         \
+    uint32_t n_offset,                                                                                         \
+    void ** init_funcs,                                                                                        \
+    int32_t *type_ids,                                                                                         \
+    char *file,                                                                                                \
+    int line                                                                                                   \
+  );                                                                                                           \
+  int ltype ## _init(void **, int, unsigned);                                                                  \
+  int ltype ## _wait(void *);                                                                                  \
+  int ltype ## _trywait(void *);                                                                               \
+  int ltype ## _timedwait(void *, const struct timespec *);                                                    \
+  int ltype ## _post(void *);                                                                                  \
+  int ltype ## _getvalue(void *, int *);                                                                       \
+  int ltype ## _destroy(void *);                                                                               \
+  extern const dlx_injected_sem_interface_t dlx_ ## ltype ## _methods_collection;
+
+#define DLX_SEM_TEMPLATE_PROTOTYPE_LIST(...) FOR_EACH(DLX_SEM_TEMPLATE_PROTOTYPE, __VA_ARGS__)
+DLX_SEM_TEMPLATE_PROTOTYPE_LIST(ALLOWED_SEM_TYPE)
+
 // For debugging and tracking purpose, we add the last three function argument.
 int dlx_untrack_var_init(dlx_generic_lock_t *, const pthread_mutexattr_t *, int type_id, char *var_name, char *file, int line);
 int dlx_untrack_check_init(dlx_generic_lock_t *, const pthread_mutexattr_t *, char *var_name, char *file, int line);
 int dlx_untrack_arr_init(dlx_generic_lock_t *, uint32_t, int type_id, char *var_name, char *file, int line);
+// Per-site lock configuration. The generated dylinx-runtime-init.c
+// registers every non-default site before any lock gets initialized.
+int dlx_set_site_wait(int32_t site_id, uint32_t kind, uint32_t min, uint32_t max, uint32_t budget);
+int dlx_set_site_param(int32_t site_id, uint32_t slot, uint32_t value);
+int dlx_set_site_place(int32_t site_id, uint32_t kind, int32_t node);
+int dlx_set_site_layout(int32_t site_id, uint32_t layout);
+const dlx_lock_conf_t *dlx_site_conf(int32_t site_id);
+
+// Tracked instances are numbered per site in initialization order. The
+// elements of a lock array take consecutive ids, so element i of the
+// first array a site initializes is instance i, but a second array or the
+// lock array members of struct objects continue the count. A mutex site
+// may hand ranges of those instances a different lock type, e.g. a queue
+// lock for the hot buckets of a hash table, with the configuration
+// registered under conf_id (-1 for the defaults). The ranges are best
+// taken from the ids a trace or the statistics report of the same program.
+int dlx_reserve_sites(int32_t n_site);
+uint32_t dlx_next_instance(int32_t site_id);
+uint32_t dlx_next_instances(int32_t site_id, uint32_t n);
+int dlx_set_instance_type(
+  int32_t site_id, uint32_t lo, uint32_t hi, const dlx_injected_interface_t *methods, int32_t conf_id
+);
+const dlx_lock_conf_t *dlx_instance_bind(const dlx_injected_interface_t **methods, int32_t site_id, uint32_t ins_id);
+
+// Hot swap of a mutex site while the program keeps running. Every instance
+// of the site migrates to ltype, built with the current site conf, the
+// next time it is entered while nobody holds or waits for it. Instances
+// initialized with a non-default attribute, e.g. recursive, stay as they
+// are and never count as migrated. Needs the glue built with
+// __DYLINX_HOTSWAP__, otherwise ENOTSUP.
+int dlx_set_site_type(int32_t site_id, const char *ltype);
+int dlx_site_swap_state(int32_t site_id, uint32_t *epoch, uint32_t *n_migrated, uint32_t *n_ins);
+// Starts a thread of the glue that never touches a Dylinx lock, so that it
+// leaves the single-threaded fast path on.
+int dlx_quiet_thread(pthread_t *tid, const pthread_attr_t *attr, void *(*start)(void *), void *arg);
+// Serves dlx_set_site_type and friends on a Unix-domain socket, see
+// dylinx-control.c. The socket is only open to the owner of the process,
+// whatever the umask. A NULL path leaves the control thread off.
+int dlx_control_start(const char *path);
+
+// Per-site lock statistics, gathered on hot-swap builds while
+// dlx_tune_measure is on. Taking them resets the counters.
+typedef struct dlx_site_stats {
+  uint64_t n_acq;
+  uint64_t wait_cyc;
+  uint64_t hold_cyc;
+} dlx_site_stats_t;
+
+int dlx_tune_measure(int on);
+int dlx_site_take_stats(int32_t site_id, dlx_site_stats_t *stats);
+// Online autotuner, see dylinx-autotune.c. Sites are registered with a
+// comma separated list of candidate types, spec is "<warmup ms>[:<round
+// ms>]" and a NULL spec leaves the tuner off. progress, when given,
+// returns a monotonic count of work the application finished and replaces
+// lock statistics as the reward.
+int dlx_autotune_site(int32_t site_id, const char *ltypes);
+int dlx_autotune_reward(uint64_t (*progress)(void));
+int dlx_autotune_start(const char *spec, const char *log_path);
+// Causal profiler, see dylinx-causal.c. Experiments virtually speed up
+// the critical sections of one site at a time and measure how fast the
+// application progresses meanwhile, counted by DLX_PROGRESS() or by the
+// callback of dlx_causal_progress. spec is "<experiment ms>[:<total
+// ms>]", a NULL spec leaves the profiler off. Sites are registered like
+// the autotuner's, with none registered every site takes part.
+extern volatile uint64_t g_dlx_progress;
+#define DLX_PROGRESS() __atomic_add_fetch(&g_dlx_progress, 1, __ATOMIC_RELAXED)
+int dlx_causal_site(int32_t site_id);
+int dlx_causal_progress(uint64_t (*progress)(void));
+int dlx_causal_start(const char *spec, const char *log_path);
+// Begins an experiment: from now on, sections of site_id count pct
+// percent shorter, pct 0 being a baseline. dlx_causal_take ends it and
+// returns the cycles of delay inserted and the sections sped up.
+void dlx_causal_speedup(int32_t site_id, uint32_t pct, double cyc_per_ns);
+uint64_t dlx_causal_take(uint64_t *n_section);
+// Bytes held by live mutex and spinlock locks, headers and backends, per
+// site and per lock type. With a log path the subject prints them when it
+// exits and writes them to the path as JSON. Locks the subject frees
+// without destroying them stay counted, unless __DYLINX_RECLAIM__ catches
+// the free.
+int dlx_footprint_log(const char *path);
+void dlx_account_lock(int32_t site_id, const dlx_injected_interface_t *methods, int32_t n);
+// free() and realloc() of objects from __dylinx_object_init_, emitted by
+// the rewriter. With __DYLINX_RECLAIM__ they destroy the locks left in the
+// memory they release, otherwise they are free() and realloc().
+void dlx_obj_free(void *p);
+void *dlx_obj_realloc(void *p, size_t n);
+
+// Contention counters of mutex and spinlock sites, all builds. They stay
+// off until dlx_stats_log, which also reports them at exit to stderr and,
+// as JSON keyed by site id with -1 for untracked locks, to path.
+// dlx_stats_dump writes the report at once, to path or the logged path.
+// hold_cyc is measured on a sample of the acquisitions, n_hold of them. An
+// acquisition counts as contended once it waited 2048 cycles.
+typedef struct dlx_lock_stats {
+  uint64_t n_acq;
+  uint64_t n_contended;
+  uint64_t n_try_fail;
+  uint64_t n_cond_wait;
+  uint64_t wait_cyc;
+  uint64_t n_hold;
+  uint64_t hold_cyc;
+} dlx_lock_stats_t;
+
+int dlx_stats_log(const char *path);
+// Counts without a report at exit, for the live views.
+int dlx_stats_start(void);
+int dlx_stats_dump(const char *path);
+int dlx_stats_site(int32_t site_id, dlx_lock_stats_t *stats);
+
+// Histograms of wait and hold cycles, kept next to the counters, with the
+// buckets of dylinx-hist.h. Uncontended acquisitions count as waits of 0
+// cycles, holds are sampled like hold_cyc. dlx_stats_hist merges the
+// threads' histograms of a site, dlx_stats_type_hist those of every lock
+// of type ltype, whichever site it belongs to. dlx_stats_instances,
+// before the first lock is taken, also keeps a wait histogram per
+// contended instance.
+typedef struct dlx_lock_hist {
+  uint64_t n_acq;
+  uint64_t wait[DLX_HIST_BUCKETS];
+  uint64_t hold[DLX_HIST_BUCKETS];
+} dlx_lock_hist_t;
+
+int dlx_stats_hist(int32_t site_id, dlx_lock_hist_t *hist);
+int dlx_stats_type_hist(const char *ltype, dlx_lock_hist_t *hist);
+int dlx_stats_instances(const char *on);
+// Hardware counters over the critical sections whose hold time is
+// sampled, with dlx_stats_counters before the first lock is taken. events
+// names the counters, "1" picks cycles, instructions, llc-misses and hitm
+// where the machine has them, see dylinx-perf.c. count[i] adds up counter
+// dlx_perf_name(i) over n_section sections.
+typedef struct dlx_lock_counters {
+  uint64_t n_section;
+  uint64_t count[DLX_PERF_MAX];
+} dlx_lock_counters_t;
+
+int dlx_stats_counters(const char *events);
+int dlx_stats_site_counters(int32_t site_id, dlx_lock_counters_t *counters);
+// Publishes the counters and histograms of every site into a shared
+// memory segment for dylinx-top, see dylinx-shm.c. A name starting with
+// '/' names the segment, anything else non-empty picks DLX_SHM_PREFIX<pid>.
+int dlx_stats_publish(const char *name);
+// Number of sites in the tables, and the lock type a site currently
+// builds, NULL before its first lock.
+int32_t dlx_n_sites(void);
+const char *dlx_site_type(int32_t site_id);
+// Binary trace of mutex and spinlock events to path, closed at exit. A
+// NULL path leaves tracing off. The layout is documented in dylinx-glue.c.
+// dlx_trace_sample, called before dlx_trace_start, samples instead of
+// tracing everything. spec is "<max period>[:<window ms>/<cycle ms>]".
+int dlx_trace_start(const char *path);
+int dlx_trace_sample(const char *spec);
+
+// Process-shared mutexes, see pshared-lock.h. Returns an attribute with
+// PTHREAD_PROCESS_SHARED set, for pthread_spin_init.
+pthread_mutexattr_t *dlx_pshared_mutexattr(void);
+
 int dlx_error_var_init(void *, const pthread_mutexattr_t *, int type_id, char *var_name, char *file, int line);
 int dlx_error_check_init(void *, const pthread_mutexattr_t *, char *var_name, char *file, int line);
 int dlx_error_arr_init(void *, uint32_t, int type_id, char *var_name, char *file, int line);
 void *dlx_error_obj_init(uint32_t, uint32_t, uint32_t *, uint32_t, void **, int *type_ids, char *, int);
 void *dlx_struct_obj_init(uint32_t, uint32_t, uint32_t *, uint32_t, void **, int *type_ids, char *, int);
+int dlx_untrack_rw_var_init(dlx_generic_rwlock_t *, const pthread_rwlockattr_t *, int type_id, char *var_name, char *file, int line);
+int dlx_untrack_rw_check_init(dlx_generic_rwlock_t *, const pthread_rwlockattr_t *, char *var_name, char *file, int line);
+int dlx_untrack_rw_arr_init(dlx_generic_rwlock_t *, uint32_t, int type_id, char *var_name, char *file, int line);
+int dlx_error_rw_check_init(void *, const pthread_rwlockattr_t *, char *var_name, char *file, int line);
+int dlx_untrack_barrier_var_init(dlx_generic_barrier_t *, const pthread_barrierattr_t *, int type_id, char *var_name, char *file, int line);
+int dlx_untrack_barrier_arr_init(dlx_generic_barrier_t *, uint32_t, int type_id, char *var_name, char *file, int line);
+int dlx_untrack_barrier_init(dlx_generic_barrier_t *, const pthread_barrierattr_t *, unsigned, char *var_name, char *file, int line);
+int dlx_error_barrier_init(void *, const pthread_barrierattr_t *, unsigned, char *var_name, char *file, int line);
+int dlx_forward_barrier_init(void *, const pthread_barrierattr_t *, unsigned, char *var_name, char *file, int line);
+int dlx_untrack_sem_var_init(dlx_generic_sem_t *, void *, int type_id, char *var_name, char *file, int line);
+int dlx_untrack_sem_arr_init(dlx_generic_sem_t *, uint32_t, int type_id, char *var_name, char *file, int line);
 
 XRAY_ATTR int dlx_error_enable(int64_t, void *, char *, char *, int);
 XRAY_ATTR int dlx_error_disable(int64_t, void *, char *, char *, int);
 int dlx_error_destroy(int64_t, void *);
 int dlx_error_trylock(int64_t, void *, char *, char *, int);
+int dlx_error_timedlock(int64_t, void *, const struct timespec *, char *, char *, int);
 int dlx_error_cond_timedwait(int64_t, pthread_cond_t *, void *, const struct timespec *);
 int dlx_error_cond_wait(int64_t, pthread_cond_t *, void *);
 XRAY_ATTR int dlx_forward_enable(int64_t, void *, char *, char *, int);
 XRAY_ATTR int dlx_forward_disable(int64_t, void *, char *, char *, int);
 XRAY_ATTR int dlx_forward_destroy(int64_t, void *);
 XRAY_ATTR int dlx_forward_trylock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_timedlock(int64_t, void *, const struct timespec *, char *, char *, int);
 XRAY_ATTR int dlx_forward_cond_wait(int64_t, pthread_cond_t *, void *);
 XRAY_ATTR int dlx_forward_cond_timedwait(int64_t, pthread_cond_t *, void *, const struct timespec *);
+int dlx_cond_signal(pthread_cond_t *);
+int dlx_cond_broadcast(pthread_cond_t *);
+
+int dlx_error_rdlock(int64_t, void *, char *, char *, int);
+int dlx_error_wrlock(int64_t, void *, char *, char *, int);
+int dlx_error_tryrdlock(int64_t, void *, char *, char *, int);
+int dlx_error_trywrlock(int64_t, void *, char *, char *, int);
+int dlx_error_rwunlock(int64_t, void *, char *, char *, int);
+int dlx_error_rwdestroy(int64_t, void *);
+XRAY_ATTR int dlx_forward_rdlock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_wrlock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_tryrdlock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_trywrlock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_rwunlock(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_rwdestroy(int64_t, void *);
+
+int dlx_error_barrier_wait(int64_t, void *, char *, char *, int);
+int dlx_error_barrier_destroy(int64_t, void *);
+XRAY_ATTR int dlx_forward_barrier_wait(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_barrier_destroy(int64_t, void *);
+
+// Untracked semaphore pointers may still refer to a glibc sem_t, for
+// instance one returned by sem_open, so the untrack variants hand objects
+// without a Dylinx header back to the native implementation.
+int dlx_untrack_sem_init(void *, int, unsigned, char *, char *, int);
+int dlx_untrack_sem_wait(int64_t, void *, char *, char *, int);
+int dlx_untrack_sem_trywait(int64_t, void *, char *, char *, int);
+int dlx_untrack_sem_timedwait(int64_t, void *, const struct timespec *, char *, char *, int);
+int dlx_untrack_sem_post(int64_t, void *, char *, char *, int);
+int dlx_untrack_sem_getvalue(int64_t, void *, int *);
+int dlx_untrack_sem_destroy(int64_t, void *);
+int dlx_error_sem_init(void *, int, unsigned, char *, char *, int);
+int dlx_error_sem_wait(int64_t, void *, char *, char *, int);
+int dlx_error_sem_trywait(int64_t, void *, char *, char *, int);
+int dlx_error_sem_timedwait(int64_t, void *, const struct timespec *, char *, char *, int);
+int dlx_error_sem_post(int64_t, void *, char *, char *, int);
+int dlx_error_sem_getvalue(int64_t, void *, int *);
+int dlx_error_sem_destroy(int64_t, void *);
+int dlx_forward_sem_init(void *, int, unsigned, char *, char *, int);
+XRAY_ATTR int dlx_forward_sem_wait(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_sem_trywait(int64_t, void *, char *, char *, int);
+XRAY_ATTR int dlx_forward_sem_timedwait(int64_t, void *, const struct timespec *, char *, char *, int);
+XRAY_ATTR int dlx_forward_sem_post(int64_t, void *, char *, char *, int);
+int dlx_forward_sem_getvalue(int64_t, void *, int *);
+XRAY_ATTR int dlx_forward_sem_destroy(int64_t, void *);
 
 typedef struct UserDefStruct {
   void *dummy;
@@ -181,13 +698,23 @@ extern uint32_t g_ins_id;
 //  unacceptable argument.
 #define DLX_GENERIC_VAR_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_ ## ltype ## _var_init,
 #define DLX_GENERIC_VAR_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_VAR_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define DLX_GENERIC_ISO_VAR_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _iso_t *: dlx_ ## ltype ## _var_init,
+#define DLX_GENERIC_ISO_VAR_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_ISO_VAR_INIT_TYPE_REDIRECT, __VA_ARGS__)
 #define __dylinx_member_init_(entity, attr, type_id) _Generic((entity),                                        \
   DLX_GENERIC_VAR_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                            \
+  DLX_GENERIC_ISO_VAR_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                        \
+  DLX_GENERIC_VAR_INIT_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                          \
+  DLX_GENERIC_VAR_INIT_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                         \
+  DLX_GENERIC_VAR_INIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                             \
   dlx_generic_lock_t *: dlx_untrack_var_init,                                                                  \
+  dlx_generic_rwlock_t *: dlx_untrack_rw_var_init,                                                             \
+  dlx_generic_barrier_t *: dlx_untrack_barrier_var_init,                                                       \
+  dlx_generic_sem_t *: dlx_untrack_sem_var_init,                                                               \
   default: dlx_error_var_init                                                                                  \
 )(entity, attr, type_id, #entity, __FILE__, __LINE__)
 
-#define DLX_GENERIC_CHECK_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_ ## ltype ## _check_init,
+#define DLX_GENERIC_CHECK_INIT_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_ ## ltype ## _check_init, dlx_ ## ltype ## _iso_t *: dlx_ ## ltype ## _check_init,
 #define DLX_GENERIC_CHECK_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_CHECK_INIT_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_mutex_init(entity, attr) _Generic((entity),                                                    \
   DLX_GENERIC_CHECK_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                          \
@@ -199,19 +726,32 @@ extern uint32_t g_ins_id;
 #define DLX_GENERIC_OBJ_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_OBJ_INIT_TYPE_REDIRECT, __VA_ARGS__)
 #define __dylinx_object_init_(cnt, unit, properties, n_offset, ltype, init_funcs, type_ids) _Generic((ltype),     \
   DLX_GENERIC_OBJ_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                            \
+  DLX_GENERIC_OBJ_INIT_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                          \
+  DLX_GENERIC_OBJ_INIT_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                         \
+  DLX_GENERIC_OBJ_INIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                             \
   user_def_struct_t *: dlx_struct_obj_init,                                                                    \
   default: dlx_error_obj_init                                                                                  \
 )(cnt, unit, properties, n_offset, init_funcs, type_ids,  __FILE__, __LINE__)
 
 #define DLX_GENERIC_ARR_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_ ## ltype ## _arr_init,
 #define DLX_GENERIC_ARR_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_ARR_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define DLX_GENERIC_ISO_ARR_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _iso_t *: dlx_ ## ltype ## _iso_arr_init,
+#define DLX_GENERIC_ISO_ARR_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_ISO_ARR_INIT_TYPE_REDIRECT, __VA_ARGS__)
 #define __dylinx_array_init_(entity, len, type_id) _Generic((entity),                                          \
   DLX_GENERIC_ARR_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                            \
+  DLX_GENERIC_ISO_ARR_INIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                        \
+  DLX_GENERIC_ARR_INIT_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                          \
+  DLX_GENERIC_ARR_INIT_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                         \
+  DLX_GENERIC_ARR_INIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                             \
   dlx_generic_lock_t *: dlx_untrack_arr_init,                                                                  \
+  dlx_generic_rwlock_t *: dlx_untrack_rw_arr_init,                                                             \
+  dlx_generic_barrier_t *: dlx_untrack_barrier_arr_init,                                                       \
+  dlx_generic_sem_t *: dlx_untrack_sem_arr_init,                                                               \
   default: dlx_error_arr_init                                                                                  \
 )(entity, len, type_id, #entity, __FILE__, __LINE__)
 
-#define DLX_GENERIC_ENABLE_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_enable,
+#define DLX_GENERIC_ENABLE_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_enable, dlx_ ## ltype ## _iso_t *: dlx_forward_enable,
 #define DLX_GENERIC_ENABLE_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_ENABLE_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_mutex_lock(entity) _Generic((entity),                                                         \
   DLX_GENERIC_ENABLE_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                             \
@@ -219,7 +759,8 @@ extern uint32_t g_ins_id;
   default: dlx_error_enable                                                                                   \
 )(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
 
-#define DLX_GENERIC_DISABLE_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_disable,
+#define DLX_GENERIC_DISABLE_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_disable, dlx_ ## ltype ## _iso_t *: dlx_forward_disable,
 #define DLX_GENERIC_DISABLE_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_DISABLE_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_mutex_unlock(entity) _Generic((entity),                                                       \
   DLX_GENERIC_DISABLE_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                            \
@@ -227,7 +768,8 @@ extern uint32_t g_ins_id;
   default: dlx_error_disable                                                                                  \
 )(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
 
-#define DLX_GENERIC_DESTROY_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_destroy,
+#define DLX_GENERIC_DESTROY_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_destroy, dlx_ ## ltype ## _iso_t *: dlx_forward_destroy,
 #define DLX_GENERIC_DESTROY_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_DESTROY_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_mutex_destroy(entity) _Generic((entity),                                                      \
   DLX_GENERIC_DESTROY_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                            \
@@ -235,7 +777,8 @@ extern uint32_t g_ins_id;
   default: dlx_error_destroy                                                                                  \
 )(((dlx_generic_lock_t *)entity)->ind.long_id, entity)
 
-#define DLX_GENERIC_TRYLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_trylock,
+#define DLX_GENERIC_TRYLOCK_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_trylock, dlx_ ## ltype ## _iso_t *: dlx_forward_trylock,
 #define DLX_GENERIC_TRYLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_TRYLOCK_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_mutex_trylock(entity) _Generic((entity),                                                     \
   DLX_GENERIC_TRYLOCK_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                           \
@@ -243,7 +786,17 @@ extern uint32_t g_ins_id;
   default: dlx_error_trylock                                                                                 \
 )(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
 
-#define DLX_GENERIC_COND_WAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_cond_wait,
+#define DLX_GENERIC_TIMEDLOCK_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_timedlock, dlx_ ## ltype ## _iso_t *: dlx_forward_timedlock,
+#define DLX_GENERIC_TIMEDLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_TIMEDLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_mutex_timedlock(entity, time) _Generic((entity),                                            \
+  DLX_GENERIC_TIMEDLOCK_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                         \
+  dlx_generic_lock_t *: dlx_forward_timedlock,                                                               \
+  default: dlx_error_timedlock                                                                               \
+)(((dlx_generic_lock_t *)entity)->ind.long_id, entity, time, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_COND_WAIT_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_cond_wait, dlx_ ## ltype ## _iso_t *: dlx_forward_cond_wait,
 #define DLX_GENERIC_COND_WAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_COND_WAIT_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_cond_wait(cond, mtx) _Generic((mtx),                                                         \
   DLX_GENERIC_COND_WAIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                         \
@@ -251,7 +804,8 @@ extern uint32_t g_ins_id;
   default: dlx_error_cond_wait                                                                               \
 )(((dlx_generic_lock_t *)mtx)->ind.long_id, cond, mtx)
 
-#define DLX_GENERIC_COND_TIMEDWAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_cond_timedwait,
+#define DLX_GENERIC_COND_TIMEDWAIT_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_forward_cond_timedwait, dlx_ ## ltype ## _iso_t *: dlx_forward_cond_timedwait,
 #define DLX_GENERIC_COND_TIMEDWAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_COND_TIMEDWAIT_TYPE_REDIRECT, __VA_ARGS__)
 #define pthread_cond_timedwait(cond, mtx, time) _Generic((mtx),                                             \
   DLX_GENERIC_COND_TIMEDWAIT_TYPE_LIST(ALLOWED_LOCK_TYPE)                                                   \
@@ -259,4 +813,187 @@ extern uint32_t g_ins_id;
   default: dlx_error_cond_timedwait                                                                         \
 )(((dlx_generic_lock_t *)mtx)->ind.long_id, cond, mtx, time)
 
+// Signals go through the glue so that waiters on compact lock types,
+// which borrow a mutex of their own, see them. See compact-wait.h.
+#define pthread_cond_signal(cond) dlx_cond_signal(cond)
+#define pthread_cond_broadcast(cond) dlx_cond_broadcast(cond)
+
+// Reader-writer lock redirection
+#define DLX_GENERIC_RW_CHECK_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_ ## ltype ## _check_init,
+#define DLX_GENERIC_RW_CHECK_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_RW_CHECK_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_init(entity, attr) _Generic((entity),                                                 \
+  DLX_GENERIC_RW_CHECK_INIT_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                   \
+  dlx_generic_rwlock_t *: dlx_untrack_rw_check_init,                                                         \
+  default: dlx_error_rw_check_init                                                                           \
+)(entity, attr, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_RDLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_rdlock,
+#define DLX_GENERIC_RDLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_RDLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_rdlock(entity) _Generic((entity),                                                     \
+  DLX_GENERIC_RDLOCK_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                          \
+  dlx_generic_rwlock_t *: dlx_forward_rdlock,                                                                \
+  default: dlx_error_rdlock                                                                                  \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_WRLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_wrlock,
+#define DLX_GENERIC_WRLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_WRLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_wrlock(entity) _Generic((entity),                                                     \
+  DLX_GENERIC_WRLOCK_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                          \
+  dlx_generic_rwlock_t *: dlx_forward_wrlock,                                                                \
+  default: dlx_error_wrlock                                                                                  \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_TRYRDLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_tryrdlock,
+#define DLX_GENERIC_TRYRDLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_TRYRDLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_tryrdlock(entity) _Generic((entity),                                                  \
+  DLX_GENERIC_TRYRDLOCK_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                       \
+  dlx_generic_rwlock_t *: dlx_forward_tryrdlock,                                                             \
+  default: dlx_error_tryrdlock                                                                               \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_TRYWRLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_trywrlock,
+#define DLX_GENERIC_TRYWRLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_TRYWRLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_trywrlock(entity) _Generic((entity),                                                  \
+  DLX_GENERIC_TRYWRLOCK_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                       \
+  dlx_generic_rwlock_t *: dlx_forward_trywrlock,                                                             \
+  default: dlx_error_trywrlock                                                                               \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_RWUNLOCK_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_rwunlock,
+#define DLX_GENERIC_RWUNLOCK_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_RWUNLOCK_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_unlock(entity) _Generic((entity),                                                     \
+  DLX_GENERIC_RWUNLOCK_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                        \
+  dlx_generic_rwlock_t *: dlx_forward_rwunlock,                                                              \
+  default: dlx_error_rwunlock                                                                                \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_RWDESTROY_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_rwdestroy,
+#define DLX_GENERIC_RWDESTROY_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_RWDESTROY_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_rwlock_destroy(entity) _Generic((entity),                                                    \
+  DLX_GENERIC_RWDESTROY_TYPE_LIST(ALLOWED_RWLOCK_TYPE)                                                       \
+  dlx_generic_rwlock_t *: dlx_forward_rwdestroy,                                                             \
+  default: dlx_error_rwdestroy                                                                               \
+)(((dlx_generic_rwlock_t *)entity)->ind.long_id, entity)
+
+// Spinlock redirection
+// ----------------------------------------------------------------------------
+// pthread_spinlock_t is far smaller than the generic header, so a spinlock
+// site is rewritten into a full mutex sized dlx_<ltype>_t and shares the
+// mutex forwarding functions. PTHREAD_PROCESS_SHARED is handed over as a
+// process-shared mutex attribute.
+#define DLX_GENERIC_SPIN_INIT_TYPE_REDIRECT(ltype) \
+  dlx_ ## ltype ## _t *: dlx_ ## ltype ## _check_init, dlx_ ## ltype ## _iso_t *: dlx_ ## ltype ## _check_init,
+#define DLX_GENERIC_SPIN_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SPIN_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_spin_init(entity, pshared) _Generic((entity),                                                \
+  DLX_GENERIC_SPIN_INIT_TYPE_LIST(ALLOWED_SPINLOCK_TYPE)                                                     \
+  dlx_generic_lock_t *: dlx_untrack_check_init,                                                              \
+  default: dlx_error_check_init                                                                              \
+)(entity, (pshared) == PTHREAD_PROCESS_SHARED? dlx_pshared_mutexattr(): NULL, #entity, __FILE__, __LINE__)
+
+#define pthread_spin_lock(entity) _Generic((entity),                                                         \
+  DLX_GENERIC_ENABLE_TYPE_LIST(ALLOWED_SPINLOCK_TYPE)                                                        \
+  dlx_generic_lock_t *: dlx_forward_enable,                                                                  \
+  default: dlx_error_enable                                                                                  \
+)(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define pthread_spin_trylock(entity) _Generic((entity),                                                      \
+  DLX_GENERIC_TRYLOCK_TYPE_LIST(ALLOWED_SPINLOCK_TYPE)                                                       \
+  dlx_generic_lock_t *: dlx_forward_trylock,                                                                 \
+  default: dlx_error_trylock                                                                                 \
+)(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define pthread_spin_unlock(entity) _Generic((entity),                                                       \
+  DLX_GENERIC_DISABLE_TYPE_LIST(ALLOWED_SPINLOCK_TYPE)                                                       \
+  dlx_generic_lock_t *: dlx_forward_disable,                                                                 \
+  default: dlx_error_disable                                                                                 \
+)(((dlx_generic_lock_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define pthread_spin_destroy(entity) _Generic((entity),                                                      \
+  DLX_GENERIC_DESTROY_TYPE_LIST(ALLOWED_SPINLOCK_TYPE)                                                       \
+  dlx_generic_lock_t *: dlx_forward_destroy,                                                                 \
+  default: dlx_error_destroy                                                                                 \
+)(((dlx_generic_lock_t *)entity)->ind.long_id, entity)
+
+// Barrier redirection
+#define DLX_GENERIC_BARRIER_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_barrier_init,
+#define DLX_GENERIC_BARRIER_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_BARRIER_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_barrier_init(entity, attr, count) _Generic((entity),                                         \
+  DLX_GENERIC_BARRIER_INIT_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                   \
+  dlx_generic_barrier_t *: dlx_untrack_barrier_init,                                                         \
+  default: dlx_error_barrier_init                                                                            \
+)(entity, attr, count, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_BARRIER_WAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_barrier_wait,
+#define DLX_GENERIC_BARRIER_WAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_BARRIER_WAIT_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_barrier_wait(entity) _Generic((entity),                                                      \
+  DLX_GENERIC_BARRIER_WAIT_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                   \
+  dlx_generic_barrier_t *: dlx_forward_barrier_wait,                                                         \
+  default: dlx_error_barrier_wait                                                                            \
+)(((dlx_generic_barrier_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_BARRIER_DESTROY_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_barrier_destroy,
+#define DLX_GENERIC_BARRIER_DESTROY_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_BARRIER_DESTROY_TYPE_REDIRECT, __VA_ARGS__)
+#define pthread_barrier_destroy(entity) _Generic((entity),                                                   \
+  DLX_GENERIC_BARRIER_DESTROY_TYPE_LIST(ALLOWED_BARRIER_TYPE)                                                \
+  dlx_generic_barrier_t *: dlx_forward_barrier_destroy,                                                      \
+  default: dlx_error_barrier_destroy                                                                         \
+)(((dlx_generic_barrier_t *)entity)->ind.long_id, entity)
+
+// Semaphore redirection
+#define DLX_GENERIC_SEM_INIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_init,
+#define DLX_GENERIC_SEM_INIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_INIT_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_init(entity, pshared, value) _Generic((entity),                                                  \
+  DLX_GENERIC_SEM_INIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                           \
+  dlx_generic_sem_t *: dlx_untrack_sem_init,                                                                 \
+  default: dlx_error_sem_init                                                                                \
+)(entity, pshared, value, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_SEM_WAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_wait,
+#define DLX_GENERIC_SEM_WAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_WAIT_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_wait(entity) _Generic((entity),                                                                  \
+  DLX_GENERIC_SEM_WAIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                           \
+  dlx_generic_sem_t *: dlx_untrack_sem_wait,                                                                 \
+  default: dlx_error_sem_wait                                                                                \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_SEM_TRYWAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_trywait,
+#define DLX_GENERIC_SEM_TRYWAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_TRYWAIT_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_trywait(entity) _Generic((entity),                                                               \
+  DLX_GENERIC_SEM_TRYWAIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                        \
+  dlx_generic_sem_t *: dlx_untrack_sem_trywait,                                                              \
+  default: dlx_error_sem_trywait                                                                             \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_SEM_TIMEDWAIT_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_timedwait,
+#define DLX_GENERIC_SEM_TIMEDWAIT_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_TIMEDWAIT_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_timedwait(entity, time) _Generic((entity),                                                       \
+  DLX_GENERIC_SEM_TIMEDWAIT_TYPE_LIST(ALLOWED_SEM_TYPE)                                                      \
+  dlx_generic_sem_t *: dlx_untrack_sem_timedwait,                                                            \
+  default: dlx_error_sem_timedwait                                                                           \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity, time, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_SEM_POST_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_post,
+#define DLX_GENERIC_SEM_POST_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_POST_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_post(entity) _Generic((entity),                                                                  \
+  DLX_GENERIC_SEM_POST_TYPE_LIST(ALLOWED_SEM_TYPE)                                                           \
+  dlx_generic_sem_t *: dlx_untrack_sem_post,                                                                 \
+  default: dlx_error_sem_post                                                                                \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity, #entity, __FILE__, __LINE__)
+
+#define DLX_GENERIC_SEM_GETVALUE_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_getvalue,
+#define DLX_GENERIC_SEM_GETVALUE_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_GETVALUE_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_getvalue(entity, value) _Generic((entity),                                                       \
+  DLX_GENERIC_SEM_GETVALUE_TYPE_LIST(ALLOWED_SEM_TYPE)                                                       \
+  dlx_generic_sem_t *: dlx_untrack_sem_getvalue,                                                             \
+  default: dlx_error_sem_getvalue                                                                            \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity, value)
+
+#define DLX_GENERIC_SEM_DESTROY_TYPE_REDIRECT(ltype) dlx_ ## ltype ## _t *: dlx_forward_sem_destroy,
+#define DLX_GENERIC_SEM_DESTROY_TYPE_LIST(...) FOR_EACH(DLX_GENERIC_SEM_DESTROY_TYPE_REDIRECT, __VA_ARGS__)
+#define sem_destroy(entity) _Generic((entity),                                                               \
+  DLX_GENERIC_SEM_DESTROY_TYPE_LIST(ALLOWED_SEM_TYPE)                                                        \
+  dlx_generic_sem_t *: dlx_untrack_sem_destroy,                                                              \
+  default: dlx_error_sem_destroy                                                                             \
+)(((dlx_generic_sem_t *)entity)->ind.long_id, entity)
+
 #endif // __DYLINX_SYMBOL__
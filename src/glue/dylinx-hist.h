@@ -0,0 +1,50 @@
+#include <stdint.h>
+
+#ifndef __DYLINX_HIST__
+#define __DYLINX_HIST__
+
+// Log-linear buckets of cycle counts, in the manner of HDR histograms.
+// Values below DLX_HIST_SUB have a bucket each, every power of two above
+// is split into DLX_HIST_SUB buckets, so a bucket is at most 1/DLX_HIST_SUB
+// of its values wide. Values from 2^DLX_HIST_BITS cycles on share the last
+// bucket. Shared by the runtime and dylinx-top.
+#define DLX_HIST_SUB_BITS 3
+#define DLX_HIST_SUB (1 << DLX_HIST_SUB_BITS)
+#define DLX_HIST_BITS 40
+#define DLX_HIST_BUCKETS ((DLX_HIST_BITS - DLX_HIST_SUB_BITS + 1) * DLX_HIST_SUB)
+
+static inline uint32_t dlx_hist_bucket(uint64_t cyc) {
+  if (cyc < DLX_HIST_SUB)
+    return cyc;
+  uint32_t e = 63 - __builtin_clzll(cyc);
+  if (e >= DLX_HIST_BITS)
+    return DLX_HIST_BUCKETS - 1;
+  return (e - DLX_HIST_SUB_BITS + 1) * DLX_HIST_SUB + ((cyc >> (e - DLX_HIST_SUB_BITS)) & (DLX_HIST_SUB - 1));
+}
+
+// Largest value of a bucket.
+static inline uint64_t dlx_hist_upper(uint32_t bucket) {
+  if (bucket < DLX_HIST_SUB)
+    return bucket;
+  uint32_t shift = bucket / DLX_HIST_SUB - 1;
+  return ((uint64_t)(DLX_HIST_SUB + bucket % DLX_HIST_SUB + 1) << shift) - 1;
+}
+
+// Upper bound of the bucket holding quantile q, 0 for an empty histogram.
+static inline uint64_t dlx_hist_quantile(const uint64_t *buckets, double q) {
+  uint64_t total = 0, seen = 0;
+  for (uint32_t i = 0; i < DLX_HIST_BUCKETS; i++)
+    total += buckets[i];
+  if (!total)
+    return 0;
+  uint64_t rank = q * total;
+  rank = rank < 1? 1: rank > total? total: rank;
+  for (uint32_t i = 0; i < DLX_HIST_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank)
+      return dlx_hist_upper(i);
+  }
+  return dlx_hist_upper(DLX_HIST_BUCKETS - 1);
+}
+
+#endif // __DYLINX_HIST__
@@ -0,0 +1,348 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Lock backend placement
+// ----------------------------------------------------------------------------
+// Backends of placed sites come from a small arena per NUMA node. Chunks
+// are mmap'd and bound to their node with mbind before they are touched,
+// then carved into objects of whole cache lines. Freed objects go back to
+// the list of their size class on the same node, so a site that keeps
+// creating and destroying locks stays where it was put. Objects above the
+// largest class get a chunk of their own.
+// MPOL_PREFERRED rather than MPOL_BIND: a full node spills over instead of
+// failing the lock initialization. Queue nodes of MCS are not placed, they
+// are first touched by their waiter, which is the node they should be on.
+
+#define DLX_MAX_NODE 63
+#define DLX_ARENA_CLASS 16
+#define DLX_ARENA_CHUNK (64 * 1024)
+#define DLX_ARENA_MAX_CHUNK 4096
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_F_NODE
+#define MPOL_F_NODE (1 << 0)
+#endif
+#ifndef MPOL_F_ADDR
+#define MPOL_F_ADDR (1 << 1)
+#endif
+
+typedef struct dlx_free_obj {
+  struct dlx_free_obj *next;
+} dlx_free_obj_t;
+
+typedef struct dlx_chunk {
+  char *base;
+  size_t size;
+  int32_t node;
+  // Size class of the objects carved from it, 0 for a dedicated chunk.
+  uint32_t lines;
+} dlx_chunk_t;
+
+typedef struct dlx_arena {
+  char *cur[DLX_ARENA_CLASS + 1];
+  char *end[DLX_ARENA_CLASS + 1];
+  dlx_free_obj_t *free[DLX_ARENA_CLASS + 1];
+  uint64_t n_live;
+  uint64_t live_bytes;
+} dlx_arena_t;
+
+// Heap backends released while t_dlx_recycling is set, i.e. by the object
+// reclamation of dylinx-glue.c, are kept on a list per size in cache
+// lines rather than handed back to malloc. A lock type always asks for
+// the same size, so each list holds the backends of one layout, and the
+// next lock of that type is served from it. A list keeps at most
+// DLX_RECYCLE_KEEP backends, the rest go back to malloc.
+#define DLX_RECYCLE_KEEP 4096
+
+__thread int t_dlx_recycling = 0;
+static dlx_free_obj_t *g_recycle[DLX_ARENA_CLASS + 1];
+static uint32_t g_n_recycle[DLX_ARENA_CLASS + 1];
+static uint64_t g_n_recycled = 0;
+
+static dlx_arena_t g_arena[DLX_MAX_NODE + 1];
+static dlx_chunk_t g_chunk[DLX_ARENA_MAX_CHUNK];
+static uint32_t g_n_chunk = 0;
+static volatile int g_arena_lock = 0;
+static uint32_t g_interleave = 0;
+// Backends handed out per placement kind, DLX_PLACE_DEFAULT included.
+static uint64_t g_n_placed[DLX_PLACE_FOLLOW + 1];
+
+// The arena sits below the pthread wrappers, so it guards itself with a
+// plain spinlock. Lock initialization is rare and short.
+static inline void __dlx_arena_acquire(void) {
+  while (__atomic_exchange_n(&g_arena_lock, 1, __ATOMIC_ACQUIRE))
+    while (__atomic_load_n(&g_arena_lock, __ATOMIC_RELAXED))
+      CPU_PAUSE();
+}
+
+static inline void __dlx_arena_release(void) {
+  __atomic_store_n(&g_arena_lock, 0, __ATOMIC_RELEASE);
+}
+
+static char *__dlx_map_on_node(size_t size, int32_t node) {
+  char *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return NULL;
+  int32_t os_node = dlx_topology()->node_os[node];
+  unsigned long mask[DLX_TOPOLOGY_MAX_NODE / (8 * sizeof(unsigned long))] = { 0 };
+  mask[os_node / (8 * sizeof(unsigned long))] = 1UL << (os_node % (8 * sizeof(unsigned long)));
+  // Without mbind (no NUMA kernel, seccomp) the pages stay first touch.
+  syscall(SYS_mbind, base, size, MPOL_PREFERRED, mask, DLX_TOPOLOGY_MAX_NODE, 0);
+  return base;
+}
+
+static int __dlx_chunk_add(char *base, size_t size, int32_t node, uint32_t lines) {
+  if (g_n_chunk == DLX_ARENA_MAX_CHUNK)
+    return -1;
+  g_chunk[g_n_chunk++] = (dlx_chunk_t){ base, size, node, lines };
+  return 0;
+}
+
+static dlx_chunk_t *__dlx_chunk_of(const void *p) {
+  for (uint32_t i = 0; i < g_n_chunk; i++) {
+    if ((const char *)p >= g_chunk[i].base && (const char *)p < g_chunk[i].base + g_chunk[i].size)
+      return &g_chunk[i];
+  }
+  return NULL;
+}
+
+void *dlx_node_alloc(size_t n, int32_t node) {
+  if (node < 0 || node > DLX_MAX_NODE || (uint32_t)node >= dlx_topology()->n_node)
+    return NULL;
+  size_t size = cache_align(n? n: 1);
+  uint32_t lines = size / L_CACHE_LINE_SIZE;
+  dlx_arena_t *arena = &g_arena[node];
+  char *res = NULL;
+  __dlx_arena_acquire();
+  if (lines > DLX_ARENA_CLASS) {
+    size = (size + DLX_ARENA_CHUNK - 1) & ~((size_t)DLX_ARENA_CHUNK - 1);
+    res = __dlx_map_on_node(size, node);
+    if (res && __dlx_chunk_add(res, size, node, 0)) {
+      munmap(res, size);
+      res = NULL;
+    }
+  } else if (arena->free[lines]) {
+    res = (char *)arena->free[lines];
+    arena->free[lines] = arena->free[lines]->next;
+  } else {
+    if (!arena->cur[lines] || arena->cur[lines] + size > arena->end[lines]) {
+      char *base = __dlx_map_on_node(DLX_ARENA_CHUNK, node);
+      if (base && __dlx_chunk_add(base, DLX_ARENA_CHUNK, node, lines)) {
+        munmap(base, DLX_ARENA_CHUNK);
+        base = NULL;
+      }
+      arena->cur[lines] = base;
+      arena->end[lines] = base? base + DLX_ARENA_CHUNK: NULL;
+    }
+    if (arena->cur[lines]) {
+      res = arena->cur[lines];
+      arena->cur[lines] += size;
+    }
+  }
+  if (res) {
+    arena->n_live++;
+    arena->live_bytes += size;
+  }
+  __dlx_arena_release();
+  return res;
+}
+
+// Called with g_arena_lock held. Blocks of alloc_cache_align are line
+// aligned, their usable size tells the class.
+static int __dlx_recycle_put(void *p) {
+  uint32_t lines = malloc_usable_size(p) / L_CACHE_LINE_SIZE;
+  if (((uintptr_t)p & (L_CACHE_LINE_SIZE - 1)) || !lines || lines > DLX_ARENA_CLASS ||
+      g_n_recycle[lines] >= DLX_RECYCLE_KEEP)
+    return -1;
+  dlx_free_obj_t *obj = p;
+  obj->next = g_recycle[lines];
+  g_recycle[lines] = obj;
+  g_n_recycle[lines]++;
+  return 0;
+}
+
+static void *__dlx_recycle_get(size_t n) {
+  uint32_t lines = cache_align(n? n: 1) / L_CACHE_LINE_SIZE;
+  if (lines > DLX_ARENA_CLASS || !__atomic_load_n(&g_recycle[lines], __ATOMIC_RELAXED))
+    return NULL;
+  __dlx_arena_acquire();
+  dlx_free_obj_t *obj = g_recycle[lines];
+  if (obj) {
+    g_recycle[lines] = obj->next;
+    g_n_recycle[lines]--;
+    g_n_recycled++;
+  }
+  __dlx_arena_release();
+  return obj;
+}
+
+int dlx_node_free(void *p) {
+  __dlx_arena_acquire();
+  dlx_chunk_t *chunk = __dlx_chunk_of(p);
+  if (!chunk) {
+    int kept = t_dlx_recycling? __dlx_recycle_put(p): -1;
+    __dlx_arena_release();
+    return kept;
+  }
+  dlx_arena_t *arena = &g_arena[chunk->node];
+  arena->n_live--;
+  if (!chunk->lines) {
+    arena->live_bytes -= chunk->size;
+    munmap(chunk->base, chunk->size);
+    *chunk = g_chunk[--g_n_chunk];
+  } else {
+    arena->live_bytes -= chunk->lines * L_CACHE_LINE_SIZE;
+    dlx_free_obj_t *obj = p;
+    obj->next = arena->free[chunk->lines];
+    arena->free[chunk->lines] = obj;
+  }
+  __dlx_arena_release();
+  return 0;
+}
+
+void *dlx_alloc_lock(size_t n, const dlx_lock_conf_t *conf) {
+  uint32_t kind = conf? conf->place.kind: DLX_PLACE_DEFAULT;
+  int32_t node = -1;
+  switch (kind) {
+    case DLX_PLACE_LOCAL:
+    case DLX_PLACE_FOLLOW:
+      node = dlx_current_node();
+      break;
+    case DLX_PLACE_INTERLEAVE:
+      node = __atomic_fetch_add(&g_interleave, 1, __ATOMIC_RELAXED) % dlx_topology()->n_node;
+      break;
+    case DLX_PLACE_NODE:
+      node = dlx_topology_node(conf->place.node);
+      break;
+    default:
+      kind = DLX_PLACE_DEFAULT;
+  }
+  // An isolated backend fills whole prefetch pairs. Arena chunks are page
+  // aligned and carve a class into equal objects, so those stay aligned.
+  size_t align = L_CACHE_LINE_SIZE;
+  if (conf && conf->layout == DLX_LAYOUT_ISOLATE) {
+    align = dlx_topology()->prefetch_pair;
+    n = r_align(n, align);
+  }
+  void *res = node >= 0? dlx_node_alloc(n, node): NULL;
+  // A node the machine does not have, or an exhausted chunk table, falls
+  // back to the heap.
+  if (!res) {
+    kind = DLX_PLACE_DEFAULT;
+    if (align == L_CACHE_LINE_SIZE)
+      res = __dlx_recycle_get(n);
+    if (!res && (align == L_CACHE_LINE_SIZE || MEMALIGN(&res, align, n)))
+      res = alloc_cache_align(n);
+  }
+  __atomic_fetch_add(&g_n_placed[kind], 1, __ATOMIC_RELAXED);
+  return res;
+}
+
+int32_t dlx_lock_node(const void *p) {
+  int node = -1;
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0, p, MPOL_F_NODE | MPOL_F_ADDR))
+    return -1;
+  return dlx_topology_node(node);
+}
+
+void dlx_place_report(FILE *out) {
+  static const char *kind_name[] = { "default", "local", "interleave", "node", "follow" };
+  fprintf(out, "[Dylinx] lock placement:");
+  for (uint32_t kind = 0; kind <= DLX_PLACE_FOLLOW; kind++)
+    fprintf(out, " %s %lu", kind_name[kind], (unsigned long)g_n_placed[kind]);
+  if (g_n_recycled)
+    fprintf(out, ", %lu reused from reclaimed locks", (unsigned long)g_n_recycled);
+  fprintf(out, "\n");
+  uint32_t n_node = dlx_topology()->n_node;
+  for (uint32_t node = 0; node < n_node && node <= DLX_MAX_NODE; node++) {
+    if (!g_arena[node].n_live)
+      continue;
+    fprintf(
+      out, "  node %2d: %lu live backends, %lu bytes\n", dlx_topology()->node_os[node],
+      (unsigned long)g_arena[node].n_live, (unsigned long)g_arena[node].live_bytes
+    );
+  }
+}
+
+// Compact lock words
+// ----------------------------------------------------------------------------
+// Compact lock types keep a lock word of a few bytes instead of a backend.
+// Words are carved from shared heap chunks, so that a lock table of a
+// million entries takes megabytes rather than hundreds of them, at the
+// price of many locks per cache line. A freed word cannot link itself
+// into a list, so each size keeps a stack of freed words instead.
+
+#define DLX_COMPACT_CLASS 4
+
+typedef struct dlx_compact_pool {
+  char *cur;
+  char *end;
+  void **free;
+  uint32_t n_free;
+  uint32_t cap_free;
+} dlx_compact_pool_t;
+
+// Sizes 1, 2, 4 and 8, guarded by the arena spinlock.
+static dlx_compact_pool_t g_compact[DLX_COMPACT_CLASS];
+
+static inline uint32_t __dlx_compact_class(size_t n) {
+  return n <= 1? 0: 32 - __builtin_clz((uint32_t)n - 1);
+}
+
+void *dlx_alloc_compact(size_t n) {
+  uint32_t cls = __dlx_compact_class(n);
+  if (cls >= DLX_COMPACT_CLASS)
+    return NULL;
+  size_t size = (size_t)1 << cls;
+  dlx_compact_pool_t *pool = &g_compact[cls];
+  char *res = NULL;
+  __dlx_arena_acquire();
+  if (pool->n_free) {
+    res = pool->free[--pool->n_free];
+  } else {
+    if (!pool->cur || pool->cur + size > pool->end) {
+      pool->cur = malloc(DLX_ARENA_CHUNK);
+      pool->end = pool->cur? pool->cur + DLX_ARENA_CHUNK: NULL;
+    }
+    if (pool->cur) {
+      res = pool->cur;
+      pool->cur += size;
+    }
+  }
+  __dlx_arena_release();
+  if (res)
+    memset(res, 0, size);
+  return res;
+}
+
+void dlx_free_compact(void *p, size_t n) {
+  uint32_t cls = __dlx_compact_class(n);
+  if (!p || cls >= DLX_COMPACT_CLASS)
+    return;
+  dlx_compact_pool_t *pool = &g_compact[cls];
+  __dlx_arena_acquire();
+  if (pool->n_free == pool->cap_free) {
+    uint32_t cap = pool->cap_free? 2 * pool->cap_free: 1024;
+    void **stack = realloc(pool->free, cap * sizeof(void *));
+    if (stack) {
+      pool->free = stack;
+      pool->cap_free = cap;
+    }
+  }
+  // Without room on the stack the word is dropped, it stays in its chunk.
+  if (pool->n_free < pool->cap_free)
+    pool->free[pool->n_free++] = p;
+  __dlx_arena_release();
+}
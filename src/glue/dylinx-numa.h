@@ -0,0 +1,27 @@
+#include "dylinx-conf.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef __DYLINX_NUMA__
+#define __DYLINX_NUMA__
+
+// Lock backend placement, see dylinx-numa.c. Lock types allocate their
+// backend with dlx_alloc_lock and release it with free_cache_align.
+void *dlx_alloc_lock(size_t n, const dlx_lock_conf_t *conf);
+// Nodes are the dense ids of dylinx-topology.h, except place.node of a
+// conf, which is the kernel's.
+void *dlx_node_alloc(size_t n, int32_t node);
+// Returns 0 when p came from dlx_node_alloc, or from malloc while
+// t_dlx_recycling is set, and got recycled, -1 when malloc should take it.
+int dlx_node_free(void *p);
+extern __thread int t_dlx_recycling;
+// Node of the page p lives on, or -1 when the kernel cannot tell.
+int32_t dlx_lock_node(const void *p);
+void dlx_place_report(FILE *out);
+// Lock words of compact lock types, 1 to 8 bytes, zeroed. n must be the
+// same on free.
+void *dlx_alloc_compact(size_t n);
+void dlx_free_compact(void *p, size_t n);
+
+#endif // __DYLINX_NUMA__
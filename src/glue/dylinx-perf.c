@@ -0,0 +1,172 @@
+#include "dylinx-perf.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Hardware counters
+// ----------------------------------------------------------------------------
+// Counters are opened per thread, user space only, as one group so that
+// they are scheduled onto the PMU together and their deltas cover the same
+// instructions. A group that does not fit is multiplexed, and rdpmc then
+// fails while it is switched out rather than returning a stale count.
+// Where the kernel denies rdpmc, e.g. for software events or with
+// /sys/devices/cpu/rdpmc at 0, the group is read with one read(2). The
+// fds of a thread are closed by a key destructor when it exits. A forked
+// child drops the counters of its parent's thread and opens its own.
+// Besides the names below, "r<hex>" takes a raw event code.
+
+typedef struct dlx_perf_event {
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+} dlx_perf_event_t;
+
+// hitm counts loads served by a line another core had modified, i.e.
+// cache line transfers. It is MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM, called
+// XSNP_FWD on later cores, so only Intel gets it.
+static const dlx_perf_event_t g_perf_known[] = {
+  { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { "llc-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  { "hitm", PERF_TYPE_RAW, 0x04d2 },
+  { "task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+  { "context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+};
+
+#define DLX_PERF_DEFAULT "cycles,instructions,llc-misses,hitm"
+#define DLX_PERF_N_KNOWN (sizeof(g_perf_known) / sizeof(dlx_perf_event_t))
+
+uint32_t g_dlx_perf_n = 0;
+__thread dlx_perf_thread_t t_dlx_perf;
+static dlx_perf_event_t g_perf_event[DLX_PERF_MAX];
+static pthread_key_t g_perf_key;
+
+static int __dlx_perf_intel(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t eax, ebx, ecx, edx;
+  return __get_cpuid(0, &eax, &ebx, &ecx, &edx) && ebx == 0x756e6547;
+#else
+  return 0;
+#endif
+}
+
+static int __dlx_perf_open(const dlx_perf_event_t *event, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event->type;
+  attr.config = event->config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC);
+}
+
+static void __dlx_perf_close(dlx_perf_thread_t *perf, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    if (perf->page[i])
+      munmap(perf->page[i], sysconf(_SC_PAGESIZE));
+    close(perf->fd[i]);
+  }
+  memset(perf, 0, sizeof(dlx_perf_thread_t));
+}
+
+static void __dlx_perf_exit(void *arg) {
+  __dlx_perf_close(arg, g_dlx_perf_n);
+  ((dlx_perf_thread_t *)arg)->state = -1;
+}
+
+static void __dlx_perf_forked(void) {
+  if (t_dlx_perf.state > 0)
+    __dlx_perf_close(&t_dlx_perf, g_dlx_perf_n);
+}
+
+int dlx_perf_open_thread(void) {
+  dlx_perf_thread_t *perf = &t_dlx_perf;
+  perf->state = -1;
+  perf->use_read = 0;
+  for (uint32_t i = 0; i < g_dlx_perf_n; i++) {
+    perf->fd[i] = __dlx_perf_open(&g_perf_event[i], i? perf->fd[0]: -1);
+    if (perf->fd[i] < 0) {
+      __dlx_perf_close(perf, i);
+      perf->state = -1;
+      return -1;
+    }
+    perf->page[i] = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, perf->fd[i], 0);
+    if (perf->page[i] == MAP_FAILED)
+      perf->page[i] = NULL;
+    if (!perf->page[i] || !perf->page[i]->cap_user_rdpmc)
+      perf->use_read = 1;
+  }
+  pthread_setspecific(g_perf_key, perf);
+  perf->state = 1;
+  return g_dlx_perf_n? 0: -1;
+}
+
+int dlx_perf_read_group(uint64_t *counts) {
+  uint64_t buf[DLX_PERF_MAX + 1];
+  ssize_t len = (g_dlx_perf_n + 1) * sizeof(uint64_t);
+  if (read(t_dlx_perf.fd[0], buf, len) != len || buf[0] != g_dlx_perf_n)
+    return -1;
+  memcpy(counts, buf + 1, g_dlx_perf_n * sizeof(uint64_t));
+  return 0;
+}
+
+const char *dlx_perf_name(uint32_t i) {
+  return i < g_dlx_perf_n? g_perf_event[i].name: NULL;
+}
+
+int dlx_perf_init(const char *events) {
+  if (!events || !*events)
+    return EINVAL;
+  char *list = strdup(strcmp(events, "1")? events: DLX_PERF_DEFAULT);
+  if (!list)
+    return ENOMEM;
+  int probe[DLX_PERF_MAX];
+  char *save;
+  for (char *name = strtok_r(list, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+    dlx_perf_event_t event = { name, PERF_TYPE_RAW, 0 };
+    uint32_t i = 0;
+    while (i < DLX_PERF_N_KNOWN && strcmp(g_perf_known[i].name, name))
+      i++;
+    if (i < DLX_PERF_N_KNOWN) {
+      event = g_perf_known[i];
+    } else {
+      char *end = NULL;
+      if (name[0] == 'r')
+        event.config = strtoull(name + 1, &end, 16);
+      if (!end || end == name + 1 || *end) {
+        fprintf(stderr, "[Dylinx] unknown counter %s\n", name);
+        continue;
+      }
+    }
+    if (g_dlx_perf_n == DLX_PERF_MAX) {
+      fprintf(stderr, "[Dylinx] counter %s dropped, at most %d are counted\n", name, DLX_PERF_MAX);
+      continue;
+    }
+    if (!strcmp(name, "hitm") && !__dlx_perf_intel())
+      continue;
+    // Try it in the group of those accepted so far, the way threads open them.
+    int fd = __dlx_perf_open(&event, g_dlx_perf_n? probe[0]: -1);
+    if (fd < 0) {
+      fprintf(stderr, "[Dylinx] cannot count %s: %s\n", name, strerror(errno));
+      continue;
+    }
+    probe[g_dlx_perf_n] = fd;
+    g_perf_event[g_dlx_perf_n++] = event;
+  }
+  for (uint32_t i = g_dlx_perf_n; i-- > 0;)
+    close(probe[i]);
+  if (!g_dlx_perf_n)
+    return ENODEV;
+  pthread_key_create(&g_perf_key, __dlx_perf_exit);
+  return pthread_atfork(NULL, NULL, __dlx_perf_forked);
+}
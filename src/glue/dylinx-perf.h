@@ -0,0 +1,74 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <linux/perf_event.h>
+#include <stdint.h>
+
+#ifndef __DYLINX_PERF__
+#define __DYLINX_PERF__
+
+// Hardware counters of the calling thread, see dylinx-perf.c. After
+// dlx_perf_init every thread opens the counters as one group the first
+// time it reads them. Reads go through rdpmc where the kernel allows it
+// in user space and through read(2) on the group otherwise.
+#define DLX_PERF_MAX 4
+
+typedef struct dlx_perf_thread {
+  // 0 before the first read, 1 once open, -1 when the thread gave up.
+  int32_t state;
+  int32_t use_read;
+  int fd[DLX_PERF_MAX];
+  struct perf_event_mmap_page *page[DLX_PERF_MAX];
+} dlx_perf_thread_t;
+
+extern uint32_t g_dlx_perf_n;
+extern __thread dlx_perf_thread_t t_dlx_perf;
+
+// Parses a comma separated list of counter names, "1" for the default
+// set, and keeps the ones this machine can count. Returns 0 when at
+// least one is left.
+int dlx_perf_init(const char *events);
+const char *dlx_perf_name(uint32_t i);
+int dlx_perf_open_thread(void);
+int dlx_perf_read_group(uint64_t *counts);
+
+#if defined(__x86_64__) || defined(__i386__)
+// The lock/index/offset protocol of perf_event_mmap_page. Fails while
+// the group is not on the PMU, e.g. multiplexed out.
+static inline int __dlx_perf_rdpmc(volatile struct perf_event_mmap_page *pc, uint64_t *count) {
+  uint32_t seq, idx, lo, hi;
+  int64_t pmc;
+  do {
+    seq = pc->lock;
+    __asm__ __volatile__("" ::: "memory");
+    idx = pc->index;
+    if (!idx)
+      return -1;
+    __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx - 1));
+    pmc = (int64_t)(((uint64_t)hi << 32 | lo) << (64 - pc->pmc_width)) >> (64 - pc->pmc_width);
+    *count = pc->offset + pmc;
+    __asm__ __volatile__("" ::: "memory");
+  } while (pc->lock != seq);
+  return 0;
+}
+#else
+static inline int __dlx_perf_rdpmc(volatile struct perf_event_mmap_page *pc, uint64_t *count) {
+  return -1;
+}
+#endif
+
+// Fills counts with g_dlx_perf_n running totals, -1 when the thread has
+// no counters or they are not counting right now.
+static inline int dlx_perf_read(uint64_t *counts) {
+  if (t_dlx_perf.state <= 0 && (t_dlx_perf.state < 0 || dlx_perf_open_thread()))
+    return -1;
+  if (t_dlx_perf.use_read)
+    return dlx_perf_read_group(counts);
+  for (uint32_t i = 0; i < g_dlx_perf_n; i++) {
+    if (__dlx_perf_rdpmc(t_dlx_perf.page[i], &counts[i]))
+      return -1;
+  }
+  return 0;
+}
+
+#endif // __DYLINX_PERF__
@@ -0,0 +1,135 @@
+#include "dylinx-glue.h"
+#include "dylinx-shm.h"
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Live statistics segment
+// ----------------------------------------------------------------------------
+// A detached thread merges the per-thread counters and histograms of every
+// site each DLX_SHM_PERIOD_MS and copies them into a POSIX shared memory
+// segment, laid out as dylinx-shm.h describes. The subject's threads never
+// touch the segment, so publishing costs them the statistics alone. The
+// table of sites is sized once at start, like the control socket's, and
+// the segment is unlinked at exit. A subject that crashes leaves it behind
+// for dylinx-top to report as gone.
+
+#define DLX_SHM_PERIOD_MS 250
+
+static char g_shm_name[64];
+static dlx_shm_header_t *g_shm = NULL;
+
+static uint64_t __dlx_shm_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static dlx_shm_site_t *__dlx_shm_site(uint32_t i) {
+  return (dlx_shm_site_t *)((char *)g_shm + g_shm->header_size + (size_t)i * g_shm->site_size);
+}
+
+static void __dlx_shm_publish(dlx_lock_hist_t *hist) {
+  dlx_lock_stats_t stats;
+  for (uint32_t i = 0; i < g_shm->n_site; i++) {
+    int32_t site_id = i + 1 < g_shm->n_site? (int32_t)i: -1;
+    uint32_t epoch, n_migrated, n_ins = 0;
+    const char *ltype = dlx_site_type(site_id);
+    dlx_stats_site(site_id, &stats);
+    dlx_stats_hist(site_id, hist);
+    dlx_site_swap_state(site_id, &epoch, &n_migrated, &n_ins);
+    dlx_shm_site_t *site = __dlx_shm_site(i);
+    dlx_shm_write_begin(&site->seq);
+    strncpy(site->ltype, ltype? ltype: "", DLX_SHM_TYPE_LEN - 1);
+    site->n_ins = n_ins;
+    site->n_acq = stats.n_acq;
+    site->n_contended = stats.n_contended;
+    site->n_try_fail = stats.n_try_fail;
+    site->n_cond_wait = stats.n_cond_wait;
+    site->wait_cyc = stats.wait_cyc;
+    site->hold_cyc = stats.n_hold? (uint64_t)((double)stats.hold_cyc * stats.n_acq / stats.n_hold): 0;
+    memcpy(site->wait, hist->wait, sizeof(site->wait));
+    memcpy(site->hold, hist->hold, sizeof(site->hold));
+    dlx_shm_write_end(&site->seq);
+  }
+  dlx_shm_write_begin(&g_shm->seq);
+  g_shm->n_publish++;
+  g_shm->now_tsc = rdtsc_u64();
+  g_shm->now_ns = __dlx_shm_now_ns();
+  dlx_shm_write_end(&g_shm->seq);
+}
+
+static void *__dlx_shm_loop(void *arg) {
+  dlx_lock_hist_t *hist = arg;
+  struct timespec period = { DLX_SHM_PERIOD_MS / 1000, DLX_SHM_PERIOD_MS % 1000 * 1000000L };
+  while (1) {
+    __dlx_shm_publish(hist);
+    nanosleep(&period, NULL);
+  }
+  return NULL;
+}
+
+static void __dlx_shm_close(void) {
+  shm_unlink(g_shm_name);
+}
+
+int dlx_stats_publish(const char *name) {
+  if (!name || !*name)
+    return 0;
+  if (name[0] == '/')
+    snprintf(g_shm_name, sizeof(g_shm_name), "%s", name);
+  else
+    snprintf(g_shm_name, sizeof(g_shm_name), DLX_SHM_PREFIX "%d", (int)getpid());
+  uint32_t n_site = dlx_n_sites() + 1;
+  size_t size = sizeof(dlx_shm_header_t) + (size_t)n_site * sizeof(dlx_shm_site_t);
+  dlx_lock_hist_t *hist = malloc(sizeof(dlx_lock_hist_t));
+  if (!hist)
+    return ENOMEM;
+  int fd = shm_open(g_shm_name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0 || ftruncate(fd, size)) {
+    int err = errno;
+    if (fd >= 0) {
+      close(fd);
+      shm_unlink(g_shm_name);
+    }
+    free(hist);
+    return err;
+  }
+  g_shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (g_shm == MAP_FAILED) {
+    int err = errno;
+    g_shm = NULL;
+    shm_unlink(g_shm_name);
+    free(hist);
+    return err;
+  }
+  g_shm->version = DLX_SHM_VERSION;
+  g_shm->header_size = sizeof(dlx_shm_header_t);
+  g_shm->site_size = sizeof(dlx_shm_site_t);
+  g_shm->n_site = n_site;
+  g_shm->n_bucket = DLX_HIST_BUCKETS;
+  g_shm->pid = getpid();
+  g_shm->period_ms = DLX_SHM_PERIOD_MS;
+  g_shm->start_tsc = g_shm->now_tsc = rdtsc_u64();
+  g_shm->start_ns = g_shm->now_ns = __dlx_shm_now_ns();
+  for (uint32_t i = 0; i < n_site; i++)
+    __dlx_shm_site(i)->site_id = i + 1 < n_site? (int32_t)i: -1;
+  // Readers ignore the segment until the magic shows up.
+  __atomic_store_n(&g_shm->magic, DLX_SHM_MAGIC, __ATOMIC_RELEASE);
+  dlx_stats_start();
+  pthread_t tid;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int ret = pthread_create(&tid, &attr, __dlx_shm_loop, hist);
+  pthread_attr_destroy(&attr);
+  if (ret) {
+    shm_unlink(g_shm_name);
+    return ret;
+  }
+  return atexit(__dlx_shm_close);
+}
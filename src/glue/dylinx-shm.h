@@ -0,0 +1,85 @@
+#include "dylinx-hist.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __DYLINX_SHM__
+#define __DYLINX_SHM__
+
+// Layout of the live statistics segment, written by dylinx-shm.c and read
+// by dylinx-top. A dlx_shm_header_t is followed by n_site entries of
+// site_size bytes, sites 0 to n_site - 2 in order and untracked locks
+// last. Counters and histograms are totals since the subject started,
+// viewers diff two snapshots for rates. Readers check magic and version
+// and step through entries by site_size, so that entries may grow.
+// Every entry, and the clock fields of the header, sit behind a seqlock:
+// seq is odd while the publisher rewrites them, a reader copies and
+// retries until it saw the same even seq before and after.
+#define DLX_SHM_MAGIC 0x53584c44u
+#define DLX_SHM_VERSION 1
+#define DLX_SHM_PREFIX "/dylinx."
+#define DLX_SHM_TYPE_LEN 16
+
+typedef struct dlx_shm_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t site_size;
+  uint32_t n_site;
+  uint32_t n_bucket;
+  uint32_t pid;
+  uint32_t period_ms;
+  volatile uint32_t seq;
+  uint32_t reserved;
+  uint64_t n_publish;
+  // TSC and CLOCK_MONOTONIC at start and at the latest publish.
+  uint64_t start_tsc;
+  uint64_t start_ns;
+  uint64_t now_tsc;
+  uint64_t now_ns;
+} dlx_shm_header_t;
+
+typedef struct dlx_shm_site {
+  volatile uint32_t seq;
+  int32_t site_id;
+  char ltype[DLX_SHM_TYPE_LEN];
+  uint32_t n_ins;
+  uint32_t reserved;
+  uint64_t n_acq;
+  uint64_t n_contended;
+  uint64_t n_try_fail;
+  uint64_t n_cond_wait;
+  uint64_t wait_cyc;
+  // Estimated from the sampled holds, like the exit report.
+  uint64_t hold_cyc;
+  uint64_t wait[DLX_HIST_BUCKETS];
+  uint64_t hold[DLX_HIST_BUCKETS];
+} dlx_shm_site_t;
+
+static inline void dlx_shm_write_begin(volatile uint32_t *seq) {
+  __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void dlx_shm_write_end(volatile uint32_t *seq) {
+  __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+}
+
+// Consistent copy of len bytes at src guarded by seq. Gives up with -1
+// after DLX_SHM_RETRY attempts, e.g. on the segment of a publisher that
+// died while writing.
+#define DLX_SHM_RETRY 1000
+
+static inline int dlx_shm_read(const volatile uint32_t *seq, const void *src, void *dst, size_t len) {
+  for (uint32_t i = 0; i < DLX_SHM_RETRY; i++) {
+    uint32_t before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    if (before & 1)
+      continue;
+    memcpy(dst, src, len);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(seq, __ATOMIC_RELAXED) == before)
+      return 0;
+  }
+  return -1;
+}
+
+#endif // __DYLINX_SHM__
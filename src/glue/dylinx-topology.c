@@ -0,0 +1,194 @@
+#include "dylinx-topology.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Topology discovery
+// ----------------------------------------------------------------------------
+// Everything comes from /sys/devices/system. A missing file leaves the
+// affected dimension flat: one core per CPU, one LLC and one node for the
+// whole machine, so that callers never have to check for holes.
+
+#define DLX_SYSFS_CPU "/sys/devices/system/cpu"
+#define DLX_SYSFS_NODE "/sys/devices/system/node"
+
+dlx_topology_t g_dlx_topology = { 0 };
+__thread dlx_cpu_cache_t t_dlx_cpu = { 0, 0 };
+
+static int __dlx_read_line(const char *path, char *buf, size_t len) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return -1;
+  char *res = fgets(buf, len, fp);
+  fclose(fp);
+  return res? 0: -1;
+}
+
+static long __dlx_read_long(const char *path, long fallback) {
+  char buf[32];
+  return __dlx_read_line(path, buf, sizeof(buf))? fallback: strtol(buf, NULL, 10);
+}
+
+// Returns the lowest CPU of a cpulist such as "0-3,8-11", or -1 when the
+// file is missing. With a map, every listed CPU below n_cpu is set to value.
+static int32_t __dlx_read_cpulist(const char *path, int32_t *map, int32_t value, uint32_t n_cpu) {
+  char buf[4096];
+  if (__dlx_read_line(path, buf, sizeof(buf)))
+    return -1;
+  int32_t lowest = -1;
+  char *cur = buf;
+  while (*cur && *cur != '\n') {
+    char *end;
+    long lo = strtol(cur, &end, 10), hi = lo;
+    if (end == cur)
+      break;
+    if (*end == '-')
+      hi = strtol(end + 1, &end, 10);
+    for (long cpu = lo; cpu <= hi; cpu++) {
+      if (lowest < 0 || cpu < lowest)
+        lowest = cpu;
+      if (map && cpu < n_cpu)
+        map[cpu] = value;
+    }
+    cur = *end == ','? end + 1: end;
+  }
+  return lowest;
+}
+
+// Turns representative CPUs into dense ids, in order of first appearance.
+static uint32_t __dlx_densify(int32_t *ids, uint32_t n_cpu) {
+  int32_t *dense = malloc(n_cpu * sizeof(int32_t));
+  uint32_t n_id = 0;
+  for (uint32_t i = 0; i < n_cpu; i++)
+    dense[i] = -1;
+  for (uint32_t cpu = 0; cpu < n_cpu; cpu++) {
+    int32_t rep = ids[cpu] >= 0 && ids[cpu] < (int32_t)n_cpu? ids[cpu]: (int32_t)cpu;
+    if (dense[rep] < 0)
+      dense[rep] = n_id++;
+    ids[cpu] = dense[rep];
+  }
+  free(dense);
+  return n_id;
+}
+
+static void __dlx_cache_geometry(dlx_topology_t *topo) {
+  topo->cache_line = __dlx_read_long(DLX_SYSFS_CPU "/cpu0/cache/index0/coherency_line_size", 0);
+  topo->prefetch_pair = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t eax, ebx, ecx, edx;
+  if (!topo->cache_line && __get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    topo->cache_line = ((ebx >> 8) & 0xff) * 8;
+  if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx))
+    topo->has_rdtscp = (edx >> 27) & 1;
+  // Intel's spatial prefetcher completes every line to its 128-byte pair.
+  if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) && ebx == 0x756e6547)
+    topo->prefetch_pair = 2 * (topo->cache_line? topo->cache_line: 64);
+#endif
+  if (!topo->cache_line)
+    topo->cache_line = 64;
+  if (!topo->prefetch_pair)
+    topo->prefetch_pair = topo->cache_line;
+}
+
+static void __dlx_llc_of(uint32_t cpu, int32_t *llc) {
+  char path[128];
+  int best_level = -1;
+  for (uint32_t idx = 0; ; idx++) {
+    snprintf(path, sizeof(path), DLX_SYSFS_CPU "/cpu%u/cache/index%u/level", cpu, idx);
+    long level = __dlx_read_long(path, -1);
+    if (level < 0)
+      break;
+    if (level <= best_level)
+      continue;
+    snprintf(path, sizeof(path), DLX_SYSFS_CPU "/cpu%u/cache/index%u/shared_cpu_list", cpu, idx);
+    int32_t rep = __dlx_read_cpulist(path, NULL, 0, 0);
+    if (rep >= 0) {
+      best_level = level;
+      *llc = rep;
+    }
+  }
+}
+
+int dlx_topology_init(void) {
+  dlx_topology_t *topo = &g_dlx_topology;
+  if (topo->n_cpu)
+    return 0;
+  long n_cpu = sysconf(_SC_NPROCESSORS_CONF);
+  dlx_topology_t res = { .n_cpu = n_cpu > 0? n_cpu: 1 };
+  res.cpu_core = malloc(res.n_cpu * sizeof(int32_t));
+  res.cpu_llc = malloc(res.n_cpu * sizeof(int32_t));
+  res.cpu_node = calloc(res.n_cpu, sizeof(int32_t));
+  res.node_os = calloc(DLX_TOPOLOGY_MAX_NODE, sizeof(int32_t));
+  if (!res.cpu_core || !res.cpu_llc || !res.cpu_node || !res.node_os) {
+    free(res.cpu_core);
+    free(res.cpu_llc);
+    free(res.cpu_node);
+    free(res.node_os);
+    return -1;
+  }
+  __dlx_cache_geometry(&res);
+  char path[128];
+  for (uint32_t cpu = 0; cpu < res.n_cpu; cpu++) {
+    snprintf(path, sizeof(path), DLX_SYSFS_CPU "/cpu%u/topology/thread_siblings_list", cpu);
+    res.cpu_core[cpu] = __dlx_read_cpulist(path, NULL, 0, 0);
+    res.cpu_llc[cpu] = 0;
+    __dlx_llc_of(cpu, &res.cpu_llc[cpu]);
+  }
+  res.n_core = __dlx_densify(res.cpu_core, res.n_cpu);
+  res.n_llc = __dlx_densify(res.cpu_llc, res.n_cpu);
+  // Nodes without CPUs get an id too, memory can still be placed there.
+  for (int32_t os_node = 0; os_node < DLX_TOPOLOGY_MAX_NODE; os_node++) {
+    snprintf(path, sizeof(path), DLX_SYSFS_NODE "/node%d/cpulist", os_node);
+    if (access(path, R_OK))
+      continue;
+    __dlx_read_cpulist(path, res.cpu_node, res.n_node, res.n_cpu);
+    res.node_os[res.n_node++] = os_node;
+  }
+  if (!res.n_node)
+    res.n_node = 1;
+  // n_cpu goes last, readers take a non-zero n_cpu as a complete table.
+  uint32_t n = res.n_cpu;
+  res.n_cpu = 0;
+  *topo = res;
+  __atomic_store_n(&topo->n_cpu, n, __ATOMIC_RELEASE);
+  return 0;
+}
+
+uint32_t dlx_topology_siblings(uint32_t cpu, uint32_t *cpus, uint32_t max) {
+  const dlx_topology_t *topo = dlx_topology();
+  uint32_t n = 0;
+  if (cpu >= topo->n_cpu)
+    return 0;
+  for (uint32_t i = 0; i < topo->n_cpu && n < max; i++) {
+    if (topo->cpu_core[i] == topo->cpu_core[cpu])
+      cpus[n++] = i;
+  }
+  return n;
+}
+
+int32_t dlx_topology_node(int32_t os_node) {
+  const dlx_topology_t *topo = dlx_topology();
+  for (uint32_t node = 0; node < topo->n_node; node++) {
+    if (topo->node_os[node] == os_node)
+      return node;
+  }
+  return -1;
+}
+
+void dlx_topology_dump(FILE *out) {
+  const dlx_topology_t *topo = dlx_topology();
+  fprintf(
+    out, "[Dylinx] %u cpus, %u cores, %u llc domains, %u nodes, line %u, prefetch pair %u%s\n",
+    topo->n_cpu, topo->n_core, topo->n_llc, topo->n_node,
+    topo->cache_line, topo->prefetch_pair, topo->has_rdtscp? ", rdtscp": ""
+  );
+  for (uint32_t cpu = 0; cpu < topo->n_cpu; cpu++) {
+    fprintf(
+      out, "  cpu %3u core %3d llc %2d node %2d (kernel node %d)\n", cpu, topo->cpu_core[cpu], topo->cpu_llc[cpu],
+      topo->cpu_node[cpu], topo->node_os[topo->cpu_node[cpu]]
+    );
+  }
+}
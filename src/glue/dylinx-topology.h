@@ -0,0 +1,91 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <sched.h>
+
+#ifndef __DYLINX_TOPOLOGY_MODULE__
+#define __DYLINX_TOPOLOGY_MODULE__
+
+// Machine topology, read once from sysfs and cpuid by dlx_topology_init,
+// which dylinx-runtime-init.c calls before any lock is initialized. Ids
+// are dense: cores and LLC domains are numbered from 0 in the order their
+// lowest CPU appears, nodes from 0 in the kernel's order with its gaps
+// left out. node_os maps a node back to the kernel's id, which mbind,
+// get_mempolicy and the @NODE<n> placement of an arrangement use. Lock
+// layouts keep using the compile-time L_CACHE_LINE_SIZE, the values here
+// are for placement and affinity decisions taken at runtime.
+#define DLX_TOPOLOGY_MAX_NODE 1024
+
+typedef struct dlx_topology {
+  uint32_t n_cpu;
+  uint32_t n_core;
+  uint32_t n_llc;
+  uint32_t n_node;
+  // Coherence unit, and the unit the adjacent-line prefetcher pulls in
+  // together. Two hot words should sit a prefetch pair apart.
+  uint32_t cache_line;
+  uint32_t prefetch_pair;
+  uint32_t has_rdtscp;
+  int32_t *cpu_core;
+  int32_t *cpu_llc;
+  int32_t *cpu_node;
+  int32_t *node_os;
+} dlx_topology_t;
+
+extern dlx_topology_t g_dlx_topology;
+
+int dlx_topology_init(void);
+void dlx_topology_dump(FILE *out);
+// Fills cpus with the SMT siblings of cpu, cpu included, and returns how
+// many there are.
+uint32_t dlx_topology_siblings(uint32_t cpu, uint32_t *cpus, uint32_t max);
+// Dense id of the kernel's node os_node, -1 when the machine has no such
+// node.
+int32_t dlx_topology_node(int32_t os_node);
+
+static inline const dlx_topology_t *dlx_topology(void) {
+  if (!__atomic_load_n(&g_dlx_topology.n_cpu, __ATOMIC_ACQUIRE))
+    dlx_topology_init();
+  return &g_dlx_topology;
+}
+
+// The CPU of the calling thread is looked up again every DLX_CPU_REFRESH
+// calls only. The scheduler rarely moves a thread more often than that,
+// and a stale answer merely costs locality.
+#define DLX_CPU_REFRESH 64
+
+typedef struct dlx_cpu_cache {
+  uint32_t calls;
+  int32_t cpu;
+} dlx_cpu_cache_t;
+
+extern __thread dlx_cpu_cache_t t_dlx_cpu;
+
+static inline int32_t __dlx_read_cpu(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  // Linux keeps (node << 12) | cpu in TSC_AUX.
+  if (g_dlx_topology.has_rdtscp) {
+    uint32_t lo, hi, aux;
+    __asm__ __volatile__("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+    return aux & 0xfff;
+  }
+#endif
+  int cpu = sched_getcpu();
+  return cpu < 0? 0: cpu;
+}
+
+static inline uint32_t dlx_current_cpu(void) {
+  if (t_dlx_cpu.calls++ % DLX_CPU_REFRESH == 0)
+    t_dlx_cpu.cpu = __dlx_read_cpu();
+  return t_dlx_cpu.cpu;
+}
+
+static inline uint32_t dlx_current_node(void) {
+  const dlx_topology_t *topo = dlx_topology();
+  uint32_t cpu = dlx_current_cpu();
+  return cpu < topo->n_cpu? topo->cpu_node[cpu]: 0;
+}
+
+#endif // __DYLINX_TOPOLOGY_MODULE__
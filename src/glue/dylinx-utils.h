@@ -1,11 +1,20 @@
 #include "dylinx-padding.h"
+#include "dylinx-conf.h"
+#include "dylinx-topology.h"
+#include "dylinx-numa.h"
 #include <time.h>
+#include <sched.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #ifndef __DYLINX_TOPOLOGY__
 #define __DYLINX_TOPOLOGY__
+#ifdef __clang__
 #pragma clang diagnostic ignored "-Waddress-of-packed-member"
+#endif
 
 #define L_CACHE_LINE_SIZE 64
 #define LOCKED 0
@@ -22,7 +31,7 @@
     assert(0);                                                                \
   } while(0)
 
-extern inline void *alloc_cache_align(size_t n) {
+static inline void *alloc_cache_align(size_t n) {
   void *res = 0;
   if ((MEMALIGN(&res, L_CACHE_LINE_SIZE, cache_align(n)) < 0) || !res) {
     fprintf(stderr, "MEMALIGN(%llu, %llu)", (unsigned long long)n,
@@ -32,6 +41,12 @@ extern inline void *alloc_cache_align(size_t n) {
   return res;
 }
 
+// Releases memory from alloc_cache_align as well as placed lock backends.
+static inline void free_cache_align(void *p) {
+  if (p && dlx_node_free(p))
+    free(p);
+}
+
 // Refer to libstock implementation. The key is to make whole operation
 // atomic. Test-and-set operation will try to assign 0b1 to certain memory
 // address and return the old value. The implementation here requires
@@ -58,6 +73,148 @@ static inline void *xchg_64(void *ptr, void *x) {
   return x;
 }
 
+// Timed acquisition follows pthread_mutex_timedlock and takes an absolute
+// CLOCK_REALTIME deadline. Reading the clock costs far more than a pause,
+// so spinning loops only poll it once every DEADLINE_POLL_INTERVAL rounds.
+#define DEADLINE_POLL_INTERVAL 128
+static inline int deadline_passed(const struct timespec *abstime) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return now.tv_sec > abstime->tv_sec ||
+    (now.tv_sec == abstime->tv_sec && now.tv_nsec >= abstime->tv_nsec);
+}
+
+// Spin-then-park waiting shared by barriers and semaphores. A waiter spins
+// SPIN_BEFORE_PARK rounds on the word and then sleeps on it with futex.
+// parked counts sleepers so that wakers skip the syscall when nobody sleeps.
+#define SPIN_BEFORE_PARK 2048
+static inline void futex_wait_u32(volatile uint32_t *addr, uint32_t val) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+// Absolute CLOCK_REALTIME deadline, as taken by the *_timedlock family.
+static inline int futex_wait_abs_u32(volatile uint32_t *addr, uint32_t val, const struct timespec *abstime) {
+  return syscall(
+    SYS_futex, (uint32_t *)addr, FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME,
+    val, abstime, NULL, FUTEX_BITSET_MATCH_ANY
+  );
+}
+
+static inline void futex_wake_u32(volatile uint32_t *addr, int cnt) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE_PRIVATE, cnt, NULL, NULL, 0);
+}
+
+static inline void spin_then_park(volatile uint32_t *addr, uint32_t val, volatile uint32_t *parked) {
+  for (uint32_t i = 0; i < SPIN_BEFORE_PARK; i++) {
+    if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != val)
+      return;
+    CPU_PAUSE();
+  }
+  __atomic_fetch_add(parked, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val)
+    futex_wait_u32(addr, val);
+  __atomic_fetch_sub(parked, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline void wake_parked(volatile uint32_t *addr, volatile uint32_t *parked, int cnt) {
+  if (__atomic_load_n(parked, __ATOMIC_SEQ_CST))
+    futex_wake_u32(addr, cnt);
+}
+
+static inline uint64_t rdtsc_u64(void) {
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+}
+
+// Pluggable waiting policy, see dylinx-conf.h. A lock resolves the policy
+// once at init, then calls dlx_wait_once for every round in which the
+// word it watches still holds val. Every store that may release a waiter
+// must be followed by dlx_wait_wake on the same word, which is free for
+// policies that never sleep.
+typedef struct dlx_wait_state {
+  uint32_t round;
+  uint32_t delay;
+  uint64_t since;
+} dlx_wait_state_t;
+
+static inline dlx_wait_policy_t dlx_wait_resolve(const dlx_lock_conf_t *conf, dlx_wait_policy_t fallback) {
+  if (!conf || conf->wait.kind == DLX_WAIT_DEFAULT)
+    return fallback;
+  return conf->wait;
+}
+
+static inline void dlx_wait_begin(const dlx_wait_policy_t *policy, dlx_wait_state_t *st) {
+  st->round = 0;
+  st->delay = policy->min;
+  st->since = policy->kind == DLX_WAIT_TSC? rdtsc_u64(): 0;
+}
+
+// One round of the policy without sleeping. Long rounds (backoff, yield)
+// tell timed callers to look at their deadline right away, and SLEEP
+// means the spin budget is spent and the caller should park now.
+#define DLX_WAIT_ROUND_SHORT 0
+#define DLX_WAIT_ROUND_LONG 1
+#define DLX_WAIT_ROUND_SLEEP 2
+static inline int dlx_wait_pause(const dlx_wait_policy_t *policy, dlx_wait_state_t *st) {
+  switch (policy->kind) {
+    case DLX_WAIT_BACKOFF:
+      for (uint32_t i = 0; i < st->delay; i++)
+        CPU_PAUSE();
+      if (st->delay < policy->max)
+        st->delay = st->delay * 2 < policy->max? st->delay * 2: policy->max;
+      return DLX_WAIT_ROUND_LONG;
+    case DLX_WAIT_YIELD:
+      if (st->round++ < policy->budget)
+        break;
+      sched_yield();
+      return DLX_WAIT_ROUND_LONG;
+    case DLX_WAIT_PARK:
+      if (st->round++ < policy->budget)
+        break;
+      return DLX_WAIT_ROUND_SLEEP;
+    case DLX_WAIT_TSC:
+      if (rdtsc_u64() - st->since < policy->budget)
+        break;
+      return DLX_WAIT_ROUND_SLEEP;
+  }
+  CPU_PAUSE();
+  return DLX_WAIT_ROUND_SHORT;
+}
+
+// Waits one round while *addr == val, sleeping on addr once the policy
+// says so. Returns non-zero for long rounds like dlx_wait_pause. abstime
+// bounds the sleep and may be NULL.
+static inline int dlx_wait_once(
+  const dlx_wait_policy_t *policy, dlx_wait_state_t *st,
+  volatile uint32_t *addr, uint32_t val, volatile uint32_t *parked,
+  const struct timespec *abstime
+) {
+  int round = dlx_wait_pause(policy, st);
+  if (round != DLX_WAIT_ROUND_SLEEP)
+    return round;
+  __atomic_fetch_add(parked, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(addr, __ATOMIC_SEQ_CST) == val) {
+    if (abstime)
+      futex_wait_abs_u32(addr, val, abstime);
+    else
+      futex_wait_u32(addr, val);
+  }
+  __atomic_fetch_sub(parked, 1, __ATOMIC_SEQ_CST);
+  return round;
+}
+
+static inline void dlx_wait_wake(
+  const dlx_wait_policy_t *policy,
+  volatile uint32_t *addr, volatile uint32_t *parked, int cnt
+) {
+  if (policy->kind < DLX_WAIT_PARK)
+    return;
+  // Pairs with the parked increment of the sleeper.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  wake_parked(addr, parked, cnt);
+}
+
 #define COMPILER_BARRIER() __asm__ __volatile__("" : : : "memory")
 #define DYLINX_VERBOSE_INF 0
 #define DYLINX_VERBOSE_WAR 1
@@ -4,14 +4,22 @@
 #ifndef __DYLINX_ADAPTIVEMTX_LOCK__
 #define __DYLINX_ADAPTIVEMTX_LOCK__
 
+// glibc keeps the adaptive spin count in a process-wide tunable
+// (glibc.mutex.spin_count), so a per-site count is spent on trylock
+// before core is handed the rest. ADAPTIVEMTX(spin=...), 0 leaves it all
+// to glibc.
+enum { ADAPTIVEMTX_PARAM_SPIN };
+
 typedef struct adaptivemtx_lock {
   pthread_mutex_t posix_lock;
   pthread_mutex_t core;
+  uint32_t spin;
 } adaptivemtx_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
-int adaptivemtx_init(void **entity, pthread_mutexattr_t *cond_attr) {
-  *entity = (adaptivemtx_lock_t *)alloc_cache_align(sizeof(adaptivemtx_lock_t));
+int adaptivemtx_init(void **entity, pthread_mutexattr_t *cond_attr, const dlx_lock_conf_t *conf) {
+  *entity = (adaptivemtx_lock_t *)dlx_alloc_lock(sizeof(adaptivemtx_lock_t), conf);
   adaptivemtx_lock_t *mtx = *entity;
+  mtx->spin = dlx_conf_param(conf, ADAPTIVEMTX_PARAM_SPIN, 0);
   pthread_mutexattr_t adap_attr;
   pthread_mutexattr_init(&adap_attr);
   pthread_mutexattr_settype(&adap_attr, PTHREAD_MUTEX_ADAPTIVE_NP);
@@ -23,9 +31,18 @@ int adaptivemtx_init(void **entity, pthread_mutexattr_t *cond_attr) {
   return core_ret || cond_ret;
 }
 
+static inline int __adaptivemtx_spin(adaptivemtx_lock_t *mtx) {
+  for (uint32_t i = 0; i < mtx->spin; i++) {
+    if (pthread_mutex_trylock_original(&mtx->core) == 0)
+      return 1;
+    CPU_PAUSE();
+  }
+  return 0;
+}
+
 int adaptivemtx_lock(void *entity) {
   adaptivemtx_lock_t *mtx = entity;
-  int core_ret = pthread_mutex_lock_original(&mtx->core);
+  int core_ret = __adaptivemtx_spin(mtx) ? 0 : pthread_mutex_lock_original(&mtx->core);
   int posix_ret = pthread_mutex_lock_original(&mtx->posix_lock);
   return core_ret || posix_ret;
 }
@@ -42,6 +59,16 @@ int adaptivemtx_trylock(void *entity) {
   return EBUSY;
 }
 
+int adaptivemtx_timedlock(void *entity, const struct timespec *abstime) {
+  adaptivemtx_lock_t *mtx = entity;
+  int ret = __adaptivemtx_spin(mtx) ? 0 : pthread_mutex_timedlock_original(&mtx->core, abstime);
+  if (ret != 0)
+    return ret;
+  if ((ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime)) != 0)
+    pthread_mutex_unlock_original(&mtx->core);
+  return ret;
+}
+
 int adaptivemtx_unlock(void *entity) {
   adaptivemtx_lock_t *mtx = entity;
   int posix_ret = pthread_mutex_unlock_original(&mtx->posix_lock);
@@ -53,7 +80,7 @@ int adaptivemtx_destroy(void *entity) {
   adaptivemtx_lock_t *mtx = entity;
   int posix_ret = pthread_mutex_destroy_original(&mtx->posix_lock);
   int core_ret = pthread_mutex_destroy_original(&mtx->core);
-  free(mtx);
+  free_cache_align(mtx);
   return posix_ret || core_ret;
 }
 
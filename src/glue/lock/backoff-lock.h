@@ -14,33 +14,52 @@
 #define DEFAULT_BACKOFF_DELAY (1 << 9)
 #define MAX_BACKOFF_DELAY ((1 << 20) -1)
 
+// The delays above only describe the default waiting policy. A site may
+// tune both bounds with BACKOFF(min=...,max=...), or swap the policy
+// entirely, through its conf.
+enum { BACKOFF_PARAM_MIN, BACKOFF_PARAM_MAX };
+
+static const dlx_wait_policy_t backoff_default_wait = {
+  DLX_WAIT_BACKOFF, DEFAULT_BACKOFF_DELAY, MAX_BACKOFF_DELAY, 0
+};
+
 typedef struct backoff_lock {
-  volatile uint8_t spin_lock __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t spin_lock __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+  dlx_wait_policy_t wait;
   pthread_mutex_t posix_lock;
 } backoff_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
-int backoff_init(void **entity, pthread_mutexattr_t *attr) {
+static inline int __backoff_tas(backoff_lock_t *mtx) {
+  return __atomic_exchange_n(&mtx->spin_lock, LOCKED, __ATOMIC_ACQUIRE) == UNLOCKED;
+}
+
+int backoff_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
 #if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
   printf("backoff-lock is initialized\n");
 #endif
-  *entity = (backoff_lock_t *)alloc_cache_align(sizeof(backoff_lock_t));
+  *entity = (backoff_lock_t *)dlx_alloc_lock(sizeof(backoff_lock_t), conf);
   backoff_lock_t *mtx = *entity;
   mtx->spin_lock = UNLOCKED;
+  mtx->parked = 0;
+  dlx_wait_policy_t fallback = backoff_default_wait;
+  fallback.min = dlx_conf_param(conf, BACKOFF_PARAM_MIN, fallback.min);
+  fallback.max = dlx_conf_param(conf, BACKOFF_PARAM_MAX, fallback.max);
+  if (fallback.max < fallback.min)
+    fallback.max = fallback.min;
+  mtx->wait = dlx_wait_resolve(conf, fallback);
   pthread_mutex_init_original(&mtx->posix_lock, NULL);
   return 0;
 }
 
 int backoff_lock(void *entity) {
-  uint32_t delay = DEFAULT_BACKOFF_DELAY;
   backoff_lock_t *mtx = entity;
+  dlx_wait_state_t st;
+  dlx_wait_begin(&mtx->wait, &st);
   while (1) {
-    while (mtx->spin_lock != UNLOCKED) {
-      for (uint32_t i = 0; i < delay; i++)
-        CPU_PAUSE();
-      if (delay < MAX_BACKOFF_DELAY)
-        delay *= 2;
-    }
-    if (l_tas_uint8(&mtx->spin_lock) == UNLOCKED)
+    while (mtx->spin_lock != UNLOCKED)
+      dlx_wait_once(&mtx->wait, &st, &mtx->spin_lock, LOCKED, &mtx->parked, NULL);
+    if (__backoff_tas(mtx))
       break;
   }
   int ret = pthread_mutex_lock_original(&mtx->posix_lock);
@@ -50,7 +69,7 @@ int backoff_lock(void *entity) {
 
 int backoff_trylock(void *entity) {
   backoff_lock_t *mtx = entity;
-  if (l_tas_uint8(&mtx->spin_lock) == UNLOCKED) {
+  if (__backoff_tas(mtx)) {
     int ret = 0;
     while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY)
       CPU_PAUSE();
@@ -64,6 +83,7 @@ int __backoff_unlock(void *entity) {
   COMPILER_BARRIER();
   backoff_lock_t *mtx = entity;
   mtx->spin_lock = UNLOCKED;
+  dlx_wait_wake(&mtx->wait, &mtx->spin_lock, &mtx->parked, 1);
 #if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
   printf("backoff-lock is disabled !!!\n");
 #endif
@@ -77,13 +97,33 @@ int backoff_unlock(void *entity) {
   return __backoff_unlock(entity);
 }
 
+int backoff_timedlock(void *entity, const struct timespec *abstime) {
+  backoff_lock_t *mtx = entity;
+  uint32_t round = 0;
+  dlx_wait_state_t st;
+  dlx_wait_begin(&mtx->wait, &st);
+  while (1) {
+    while (mtx->spin_lock != UNLOCKED) {
+      int slept = dlx_wait_once(&mtx->wait, &st, &mtx->spin_lock, LOCKED, &mtx->parked, abstime);
+      if ((slept || ++round % DEADLINE_POLL_INTERVAL == 0) && deadline_passed(abstime))
+        return ETIMEDOUT;
+    }
+    if (__backoff_tas(mtx))
+      break;
+  }
+  int ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime);
+  if (ret != 0)
+    __backoff_unlock(entity);
+  return ret;
+}
+
 int backoff_destroy(void *entity) {
 #if __DYLINX_VERBOSE__ <= DYLINX_VERBOSE_INF
   printf("backoff-lock is finalized !!!\n");
 #endif
   backoff_lock_t *mtx = entity;
   int ret = pthread_mutex_destroy_original(&mtx->posix_lock);
-  free(mtx);
+  free_cache_align(mtx);
   return ret;
 }
 
@@ -104,7 +144,7 @@ int backoff_cond_timedwait(pthread_cond_t *cond, void *entity, const struct time
     );
   }
   int ret = 0;
-  if (ret = pthread_mutex_unlock_original(&mtx->posix_lock) != 0) {
+  if ((ret = pthread_mutex_unlock_original(&mtx->posix_lock)) != 0) {
     HANDLING_ERROR(
       "Error happens when trying to conduct "
       "pthread_mutex_unlock on internal posix_lock"
@@ -0,0 +1,96 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_BARRIER_SLOT__
+#define __DYLINX_BARRIER_SLOT__
+
+// Tree, tournament and dissemination barriers address their participants
+// by a dense index in [0, count). A thread claims a free index from the
+// team bitmap the first time it waits on a barrier and keeps it in a
+// thread specific slot. The key destructor hands the index back when the
+// thread exits, so a pool that replaces its workers keeps working as long
+// as no more than count threads wait at the same time. Episode numbers
+// belong to the index rather than to the thread for the same reason.
+
+typedef struct barrier_slot {
+  uint32_t id;
+  volatile uint64_t *bitmap;
+} barrier_slot_t;
+
+typedef struct barrier_team {
+  pthread_key_t key;
+  uint32_t count;
+  volatile uint64_t *bitmap;
+  uint32_t *episode;
+} barrier_team_t;
+
+static void __barrier_slot_release(void *value) {
+  barrier_slot_t *slot = value;
+  __atomic_fetch_and(&slot->bitmap[slot->id / 64], ~(1ULL << (slot->id % 64)), __ATOMIC_SEQ_CST);
+  free(slot);
+}
+
+static inline int barrier_team_init(barrier_team_t *team, uint32_t count) {
+  team->count = count;
+  team->bitmap = calloc((count + 63) / 64, sizeof(uint64_t));
+  team->episode = calloc(count, sizeof(uint32_t));
+  if (!team->bitmap || !team->episode)
+    return ENOMEM;
+  return pthread_key_create(&team->key, __barrier_slot_release);
+}
+
+static inline barrier_slot_t *barrier_team_slot(barrier_team_t *team) {
+  barrier_slot_t *slot = pthread_getspecific(team->key);
+  if (slot)
+    return slot;
+  for (uint32_t id = 0; id < team->count; id++) {
+    uint64_t bit = 1ULL << (id % 64);
+    if (team->bitmap[id / 64] & bit)
+      continue;
+    if (__atomic_fetch_or(&team->bitmap[id / 64], bit, __ATOMIC_SEQ_CST) & bit)
+      continue;
+    slot = malloc(sizeof(barrier_slot_t));
+    slot->id = id;
+    slot->bitmap = team->bitmap;
+    pthread_setspecific(team->key, slot);
+    return slot;
+  }
+  HANDLING_ERROR("More threads than the barrier count are waiting on the barrier");
+  return NULL;
+}
+
+static inline void barrier_team_destroy(barrier_team_t *team) {
+  pthread_key_delete(team->key);
+  free((void *)team->bitmap);
+  free(team->episode);
+}
+
+// Point-to-point flags of tournament and dissemination barriers. A flag
+// only moves forward, so a waiter for episode ep proceeds once the flag
+// reaches ep even if a fast signaler already stamped a later episode.
+typedef struct barrier_flag {
+  volatile uint32_t seq;
+  volatile uint32_t parked;
+} barrier_flag_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static inline void barrier_flag_signal(barrier_flag_t *flag, uint32_t ep) {
+  __atomic_store_n(&flag->seq, ep, __ATOMIC_SEQ_CST);
+  wake_parked(&flag->seq, &flag->parked, 1);
+}
+
+static inline void barrier_flag_wait(barrier_flag_t *flag, uint32_t ep) {
+  uint32_t cur;
+  while ((int32_t)((cur = __atomic_load_n(&flag->seq, __ATOMIC_ACQUIRE)) - ep) < 0)
+    spin_then_park(&flag->seq, cur, &flag->parked);
+}
+
+static inline uint32_t barrier_rounds(uint32_t count) {
+  uint32_t rounds = 0;
+  while ((1U << rounds) < count)
+    rounds++;
+  return rounds;
+}
+
+#endif // __DYLINX_BARRIER_SLOT__
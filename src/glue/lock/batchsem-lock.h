@@ -0,0 +1,86 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include "spinparksem-lock.h"
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_BATCHSEM_LOCK__
+#define __DYLINX_BATCHSEM_LOCK__
+
+// Semaphore with batched wakeup. A burst of posts on a semaphore with
+// parked consumers normally costs one FUTEX_WAKE per post. Here only one
+// poster at a time owns the waking flag and wakes as many sleepers as
+// there are tokens in a single syscall. Posters that find the flag taken
+// return immediately. The owner re-checks after dropping the flag, so a
+// token posted meanwhile is never left behind with a sleeping consumer.
+
+typedef struct batchsem_lock {
+  volatile uint32_t value __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+  volatile uint32_t waking __attribute__((aligned(L_CACHE_LINE_SIZE)));
+} batchsem_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int batchsem_init(void **entity, int pshared, unsigned value) {
+  (void)pshared;
+  *entity = (batchsem_lock_t *)alloc_cache_align(sizeof(batchsem_lock_t));
+  batchsem_lock_t *sem = *entity;
+  sem->value = value;
+  sem->parked = 0;
+  sem->waking = 0;
+  return 0;
+}
+
+static inline void __batchsem_wake(batchsem_lock_t *sem) {
+  while (__atomic_load_n(&sem->parked, __ATOMIC_SEQ_CST)) {
+    uint32_t tokens = __atomic_load_n(&sem->value, __ATOMIC_SEQ_CST);
+    if (!tokens)
+      return;
+    uint32_t idle = 0;
+    if (!__atomic_compare_exchange_n(&sem->waking, &idle, 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+      return;
+    futex_wake_u32(&sem->value, tokens > INT_MAX? INT_MAX: (int)tokens);
+    __atomic_store_n(&sem->waking, 0, __ATOMIC_SEQ_CST);
+  }
+}
+
+int batchsem_wait(void *entity) {
+  batchsem_lock_t *sem = entity;
+  while (!__sem_take_token(&sem->value))
+    spin_then_park(&sem->value, 0, &sem->parked);
+  return 0;
+}
+
+int batchsem_trywait(void *entity) {
+  batchsem_lock_t *sem = entity;
+  if (__sem_take_token(&sem->value))
+    return 0;
+  errno = EAGAIN;
+  return -1;
+}
+
+int batchsem_timedwait(void *entity, const struct timespec *abstime) {
+  batchsem_lock_t *sem = entity;
+  return __sem_timedwait_word(&sem->value, &sem->parked, abstime);
+}
+
+int batchsem_post(void *entity) {
+  batchsem_lock_t *sem = entity;
+  __atomic_fetch_add(&sem->value, 1, __ATOMIC_SEQ_CST);
+  __batchsem_wake(sem);
+  return 0;
+}
+
+int batchsem_getvalue(void *entity, int *value) {
+  batchsem_lock_t *sem = entity;
+  *value = __atomic_load_n(&sem->value, __ATOMIC_RELAXED);
+  return 0;
+}
+
+int batchsem_destroy(void *entity) {
+  free(entity);
+  return 0;
+}
+
+#endif // __DYLINX_BATCHSEM_LOCK__
@@ -0,0 +1,140 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifndef __DYLINX_BIGREADERRW_LOCK__
+#define __DYLINX_BIGREADERRW_LOCK__
+
+// Big-reader lock (brlock) as used in early Linux kernels. Every CPU owns
+// a cache-line sized reader counter, so readers on different CPUs never
+// touch the same line. A writer takes the central writer flag and then
+// waits for every distributed counter to drain, which makes writing
+// expensive and reading almost free.
+//
+// Note:
+// 1. A reader must release the counter it incremented even if it has
+//    migrated meanwhile. Each thread therefore sticks to the slot of the
+//    CPU it first ran a read acquisition on.
+// 2. Readers never hold the lock together with a writer, but a reader may
+//    release while a writer is draining. The owner field tells the two
+//    unlock paths apart.
+typedef struct bigreaderrw_slot {
+  volatile uint32_t readers;
+} bigreaderrw_slot_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+typedef struct bigreaderrw_lock {
+  volatile uint8_t writer __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  pthread_t owner;
+  uint32_t n_slot;
+  bigreaderrw_slot_t *slots;
+} bigreaderrw_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static __thread int32_t bigreaderrw_slot_hint = -1;
+
+static inline bigreaderrw_slot_t *__bigreaderrw_slot(bigreaderrw_lock_t *rw) {
+  if (bigreaderrw_slot_hint < 0) {
+    int cpu = sched_getcpu();
+    bigreaderrw_slot_hint = cpu < 0? 0: cpu;
+  }
+  return &rw->slots[bigreaderrw_slot_hint % rw->n_slot];
+}
+
+int bigreaderrw_init(void **entity, pthread_rwlockattr_t *attr) {
+  (void)attr;
+  *entity = (bigreaderrw_lock_t *)alloc_cache_align(sizeof(bigreaderrw_lock_t));
+  bigreaderrw_lock_t *rw = *entity;
+  long n_cpu = sysconf(_SC_NPROCESSORS_CONF);
+  rw->n_slot = n_cpu > 0? n_cpu: 1;
+  rw->slots = alloc_cache_align(rw->n_slot * sizeof(bigreaderrw_slot_t));
+  memset(rw->slots, 0, rw->n_slot * sizeof(bigreaderrw_slot_t));
+  rw->writer = UNLOCKED;
+  rw->owner = 0;
+  return 0;
+}
+
+int bigreaderrw_tryrdlock(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  bigreaderrw_slot_t *slot = __bigreaderrw_slot(rw);
+  if (rw->writer != UNLOCKED)
+    return EBUSY;
+  __atomic_fetch_add(&slot->readers, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&rw->writer, __ATOMIC_SEQ_CST) == UNLOCKED)
+    return 0;
+  __atomic_fetch_sub(&slot->readers, 1, __ATOMIC_RELEASE);
+  return EBUSY;
+}
+
+int bigreaderrw_rdlock(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  bigreaderrw_slot_t *slot = __bigreaderrw_slot(rw);
+  while (1) {
+    while (rw->writer != UNLOCKED)
+      CPU_PAUSE();
+    __atomic_fetch_add(&slot->readers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&rw->writer, __ATOMIC_SEQ_CST) == UNLOCKED)
+      return 0;
+    __atomic_fetch_sub(&slot->readers, 1, __ATOMIC_RELEASE);
+  }
+}
+
+static inline int __bigreaderrw_drained(bigreaderrw_lock_t *rw) {
+  for (uint32_t i = 0; i < rw->n_slot; i++) {
+    if (__atomic_load_n(&rw->slots[i].readers, __ATOMIC_SEQ_CST))
+      return 0;
+  }
+  return 1;
+}
+
+int bigreaderrw_wrlock(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  while (1) {
+    while (rw->writer != UNLOCKED)
+      CPU_PAUSE();
+    if (l_tas_uint8(&rw->writer) == UNLOCKED)
+      break;
+  }
+  for (uint32_t i = 0; i < rw->n_slot; i++) {
+    while (__atomic_load_n(&rw->slots[i].readers, __ATOMIC_SEQ_CST))
+      CPU_PAUSE();
+  }
+  rw->owner = pthread_self();
+  return 0;
+}
+
+int bigreaderrw_trywrlock(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  if (l_tas_uint8(&rw->writer) != UNLOCKED)
+    return EBUSY;
+  if (!__bigreaderrw_drained(rw)) {
+    COMPILER_BARRIER();
+    rw->writer = UNLOCKED;
+    return EBUSY;
+  }
+  rw->owner = pthread_self();
+  return 0;
+}
+
+int bigreaderrw_unlock(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  if (rw->writer != UNLOCKED && pthread_equal(rw->owner, pthread_self())) {
+    rw->owner = 0;
+    COMPILER_BARRIER();
+    rw->writer = UNLOCKED;
+    return 0;
+  }
+  __atomic_fetch_sub(&__bigreaderrw_slot(rw)->readers, 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+int bigreaderrw_destroy(void *entity) {
+  bigreaderrw_lock_t *rw = entity;
+  free(rw->slots);
+  free(rw);
+  return 0;
+}
+
+#endif // __DYLINX_BIGREADERRW_LOCK__
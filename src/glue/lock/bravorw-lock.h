@@ -0,0 +1,149 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include "lock/wprefrw-lock.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef __DYLINX_BRAVORW_LOCK__
+#define __DYLINX_BRAVORW_LOCK__
+
+// Paper:
+// BRAVO -- Biased Locking for Reader-Writer Locks (USENIX ATC '19)
+// ---------------------------------------------------------------------------
+// Note:
+// 1. BRAVO is an overlay. While rbias is set, readers publish themselves
+//    in a process-wide visible readers table instead of touching the
+//    underlying lock. Here the underlying lock is wprefrw.
+// 2. A writer revokes the bias, waits until no table entry refers to the
+//    lock and then keeps the bias disabled for BRAVO_INHIBIT_MULTIPLIER
+//    times the revocation cost, bounding the writer slowdown.
+// 3. pthread_rwlock_unlock carries no hint about how the read lock was
+//    taken, so each thread remembers its fast-path acquisitions locally.
+#define BRAVO_TABLE_SIZE 4096
+#define BRAVO_INHIBIT_MULTIPLIER 9
+#define BRAVO_MAX_FAST_READ 8
+
+typedef struct bravorw_lock {
+  volatile uint32_t rbias;
+  volatile uint64_t inhibit_until;
+  wprefrw_lock_t underlying;
+} bravorw_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static void *volatile bravo_visible_readers[BRAVO_TABLE_SIZE] __attribute__((aligned(L_CACHE_LINE_SIZE)));
+static __thread struct { void *lock; uint32_t slot; } bravo_fast_reads[BRAVO_MAX_FAST_READ];
+static __thread uint32_t bravo_n_fast_read = 0;
+
+static inline uint64_t __bravorw_now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static inline uint32_t __bravorw_slot(bravorw_lock_t *rw) {
+  uint64_t key = (uintptr_t)rw ^ ((uintptr_t)pthread_self() << 7);
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 52) % BRAVO_TABLE_SIZE;
+}
+
+static inline int __bravorw_fast_read(bravorw_lock_t *rw) {
+  if (!rw->rbias || bravo_n_fast_read == BRAVO_MAX_FAST_READ)
+    return 0;
+  uint32_t slot = __bravorw_slot(rw);
+  void *empty = NULL;
+  if (!__atomic_compare_exchange_n(&bravo_visible_readers[slot], &empty, rw, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    return 0;
+  if (__atomic_load_n(&rw->rbias, __ATOMIC_SEQ_CST)) {
+    bravo_fast_reads[bravo_n_fast_read].lock = rw;
+    bravo_fast_reads[bravo_n_fast_read].slot = slot;
+    bravo_n_fast_read++;
+    return 1;
+  }
+  __atomic_store_n(&bravo_visible_readers[slot], NULL, __ATOMIC_RELEASE);
+  return 0;
+}
+
+// Return 0 once every fast reader has left, otherwise give up right away
+// when wait is not set.
+static inline int __bravorw_revoke(bravorw_lock_t *rw, int wait) {
+  uint64_t start = __bravorw_now();
+  __atomic_store_n(&rw->rbias, 0, __ATOMIC_SEQ_CST);
+  for (uint32_t i = 0; i < BRAVO_TABLE_SIZE; i++) {
+    while (__atomic_load_n(&bravo_visible_readers[i], __ATOMIC_SEQ_CST) == rw) {
+      if (!wait) {
+        __atomic_store_n(&rw->rbias, 1, __ATOMIC_SEQ_CST);
+        return EBUSY;
+      }
+      CPU_PAUSE();
+    }
+  }
+  uint64_t end = __bravorw_now();
+  rw->inhibit_until = end + (end - start) * BRAVO_INHIBIT_MULTIPLIER;
+  return 0;
+}
+
+int bravorw_init(void **entity, pthread_rwlockattr_t *attr) {
+  (void)attr;
+  *entity = (bravorw_lock_t *)alloc_cache_align(sizeof(bravorw_lock_t));
+  bravorw_lock_t *rw = *entity;
+  rw->rbias = 1;
+  rw->inhibit_until = 0;
+  rw->underlying.state = 0;
+  rw->underlying.pending_writers = 0;
+  return 0;
+}
+
+int bravorw_rdlock(void *entity) {
+  bravorw_lock_t *rw = entity;
+  if (__bravorw_fast_read(rw))
+    return 0;
+  wprefrw_rdlock(&rw->underlying);
+  if (!rw->rbias && __bravorw_now() >= rw->inhibit_until)
+    rw->rbias = 1;
+  return 0;
+}
+
+int bravorw_tryrdlock(void *entity) {
+  bravorw_lock_t *rw = entity;
+  if (__bravorw_fast_read(rw))
+    return 0;
+  return wprefrw_tryrdlock(&rw->underlying);
+}
+
+int bravorw_wrlock(void *entity) {
+  bravorw_lock_t *rw = entity;
+  wprefrw_wrlock(&rw->underlying);
+  if (rw->rbias)
+    __bravorw_revoke(rw, 1);
+  return 0;
+}
+
+int bravorw_trywrlock(void *entity) {
+  bravorw_lock_t *rw = entity;
+  if (wprefrw_trywrlock(&rw->underlying))
+    return EBUSY;
+  if (rw->rbias && __bravorw_revoke(rw, 0)) {
+    wprefrw_unlock(&rw->underlying);
+    return EBUSY;
+  }
+  return 0;
+}
+
+int bravorw_unlock(void *entity) {
+  bravorw_lock_t *rw = entity;
+  for (uint32_t i = 0; i < bravo_n_fast_read; i++) {
+    if (bravo_fast_reads[i].lock != rw)
+      continue;
+    __atomic_store_n(&bravo_visible_readers[bravo_fast_reads[i].slot], NULL, __ATOMIC_RELEASE);
+    bravo_fast_reads[i] = bravo_fast_reads[--bravo_n_fast_read];
+    return 0;
+  }
+  return wprefrw_unlock(&rw->underlying);
+}
+
+int bravorw_destroy(void *entity) {
+  free(entity);
+  return 0;
+}
+
+#endif // __DYLINX_BRAVORW_LOCK__
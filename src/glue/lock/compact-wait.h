@@ -0,0 +1,91 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <errno.h>
+#include <sched.h>
+#include <stdint.h>
+
+#ifndef __DYLINX_COMPACT_WAIT__
+#define __DYLINX_COMPACT_WAIT__
+
+// Waiting shared by the compact lock types, whose whole state is a lock
+// word of a few bytes from dlx_alloc_compact.
+// 1. Spinning waiters yield the CPU every COMPACT_YIELD rounds, there is
+//    no room in the word for a parking protocol.
+// 2. A condition wait needs a pthread mutex, so it borrows the one of
+//    COMPACT_STRIPE stripes picked by the address of the condition
+//    variable. The waiter takes that mutex and counts itself in n_wait
+//    of the stripe before it releases the lock word, then sleeps until
+//    the sequence of the stripe moves. pthread_cond_signal and
+//    pthread_cond_broadcast bump the sequence under the stripe mutex
+//    before signalling, but only while n_wait is nonzero, so a signal
+//    cannot fall in between and condition variables never used with a
+//    compact lock keep the plain native path. A signaller that changed
+//    the predicate under the lock word sees the count of every waiter
+//    that went to sleep before. Signals from code built without the glue
+//    header skip the stripe and may be lost.
+#define COMPACT_YIELD 256
+#define COMPACT_STRIPE 64
+
+typedef struct compact_stripe {
+  pthread_mutex_t mtx __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  uint64_t seq;
+  volatile uint32_t n_wait;
+} compact_stripe_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static compact_stripe_t g_compact_stripe[COMPACT_STRIPE];
+static pthread_once_t g_compact_stripe_once = PTHREAD_ONCE_INIT;
+
+static void __compact_stripe_init(void) {
+  for (uint32_t i = 0; i < COMPACT_STRIPE; i++)
+    pthread_mutex_init_original(&g_compact_stripe[i].mtx, NULL);
+}
+
+static inline compact_stripe_t *__compact_stripe_of(pthread_cond_t *cond) {
+  return &g_compact_stripe[((uintptr_t)cond >> 4) % COMPACT_STRIPE];
+}
+
+static inline void compact_relax(uint32_t *round) {
+  if (++*round % COMPACT_YIELD == 0)
+    sched_yield();
+  else
+    CPU_PAUSE();
+}
+
+static int compact_cond_timedwait(
+  pthread_cond_t *cond, void *entity, const struct timespec *abstime,
+  int (*unlock)(void *), int (*lock)(void *)
+) {
+  pthread_once(&g_compact_stripe_once, __compact_stripe_init);
+  compact_stripe_t *stripe = __compact_stripe_of(cond);
+  int res = 0;
+  pthread_mutex_lock_original(&stripe->mtx);
+  // Counted before the lock word is released, a signaller that takes the
+  // lock afterwards sees it.
+  __atomic_store_n(&stripe->n_wait, stripe->n_wait + 1, __ATOMIC_SEQ_CST);
+  uint64_t seq = stripe->seq;
+  unlock(entity);
+  while (stripe->seq == seq && !res) {
+    if (abstime)
+      res = pthread_cond_timedwait_original(cond, &stripe->mtx, abstime);
+    else
+      res = pthread_cond_wait_original(cond, &stripe->mtx);
+  }
+  __atomic_store_n(&stripe->n_wait, stripe->n_wait - 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock_original(&stripe->mtx);
+  lock(entity);
+  return res;
+}
+
+// pthread_cond_signal and pthread_cond_broadcast of the subject.
+static int compact_cond_signal(pthread_cond_t *cond, int broadcast) {
+  compact_stripe_t *stripe = __compact_stripe_of(cond);
+  if (!__atomic_load_n(&stripe->n_wait, __ATOMIC_SEQ_CST))
+    return broadcast? pthread_cond_broadcast_original(cond): pthread_cond_signal_original(cond);
+  pthread_mutex_lock_original(&stripe->mtx);
+  stripe->seq++;
+  int res = broadcast? pthread_cond_broadcast_original(cond): pthread_cond_signal_original(cond);
+  pthread_mutex_unlock_original(&stripe->mtx);
+  return res;
+}
+
+#endif // __DYLINX_COMPACT_WAIT__
@@ -0,0 +1,61 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include "barrier-slot.h"
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_DISSEMBARRIER_LOCK__
+#define __DYLINX_DISSEMBARRIER_LOCK__
+
+// Paper:
+// Two Algorithms for Barrier Synchronization (Hensgen, Finkel and Manber)
+// ---------------------------------------------------------------------------
+// Note:
+// 1. In round r participant i signals (i + 2^r) mod count and waits for
+//    its own flag. After ceil(log2(count)) rounds every participant has
+//    transitively heard from everybody, so there is no release phase.
+// 2. Each flag has exactly one signaler per round, therefore plain stores
+//    of the episode number are enough.
+
+typedef struct dissembarrier_lock {
+  barrier_team_t team;
+  uint32_t rounds;
+  barrier_flag_t *flags;
+} dissembarrier_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int dissembarrier_init(void **entity, const pthread_barrierattr_t *attr, unsigned count) {
+  (void)attr;
+  if (count == 0)
+    return EINVAL;
+  *entity = (dissembarrier_lock_t *)alloc_cache_align(sizeof(dissembarrier_lock_t));
+  dissembarrier_lock_t *bar = *entity;
+  bar->rounds = barrier_rounds(count);
+  bar->flags = alloc_cache_align((count * bar->rounds + 1) * sizeof(barrier_flag_t));
+  memset(bar->flags, 0, (count * bar->rounds + 1) * sizeof(barrier_flag_t));
+  return barrier_team_init(&bar->team, count);
+}
+
+int dissembarrier_wait(void *entity) {
+  dissembarrier_lock_t *bar = entity;
+  barrier_slot_t *slot = barrier_team_slot(&bar->team);
+  uint32_t id = slot->id;
+  uint32_t ep = ++bar->team.episode[id];
+  for (uint32_t r = 0; r < bar->rounds; r++) {
+    uint32_t partner = (id + (1U << r)) % bar->team.count;
+    barrier_flag_signal(&bar->flags[partner * bar->rounds + r], ep);
+    barrier_flag_wait(&bar->flags[id * bar->rounds + r], ep);
+  }
+  return id == 0? PTHREAD_BARRIER_SERIAL_THREAD: 0;
+}
+
+int dissembarrier_destroy(void *entity) {
+  dissembarrier_lock_t *bar = entity;
+  barrier_team_destroy(&bar->team);
+  free(bar->flags);
+  free(bar);
+  return 0;
+}
+
+#endif // __DYLINX_DISSEMBARRIER_LOCK__
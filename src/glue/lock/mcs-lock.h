@@ -6,37 +6,111 @@
 #include <sys/syscall.h>
 #ifndef __DYLINX_MCS_LOCK__
 #define __DYLINX_MCS_LOCK__
+// Queue node states. A waiter whose deadline expires flips its own node
+// from LOCKED to MCS_ABANDONED and walks away without touching the queue.
+// The releaser that later reaches an abandoned node takes ownership of it,
+// frees it and hands the lock further down, so a timed acquirer never
+// stalls the threads queued behind it.
+#define MCS_ABANDONED 2
+// A waiter whose policy wants to sleep first flips its node from LOCKED to
+// MCS_PARKED. A releaser that meets MCS_PARKED stores UNLOCKED, wakes the
+// sleeper and raises node->released last. The woken waiter must not free
+// its node before that, since the releaser is still touching it.
+#define MCS_PARKED 3
+
 typedef struct mcs_node {
   struct mcs_node *volatile next;
-  volatile int spin  __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t spin  __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t released;
 } mcs_node_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
 typedef struct mcs_lock {
   pthread_mutex_t posix_lock;
   pthread_key_t key;
+  dlx_wait_policy_t wait;
   mcs_node_t *volatile tail __attribute__((aligned(L_CACHE_LINE_SIZE)));
 } mcs_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
-int mcs_init(void **entity, pthread_mutexattr_t *attr) {
-  *entity = (mcs_lock_t *)alloc_cache_align(sizeof(mcs_lock_t));
+static const dlx_wait_policy_t mcs_default_wait = { DLX_WAIT_SPIN, 0, 0, 0 };
+
+int mcs_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  *entity = (mcs_lock_t *)dlx_alloc_lock(sizeof(mcs_lock_t), conf);
   mcs_lock_t *mtx = *entity;
   pthread_key_create(&mtx->key, NULL);
+  mtx->wait = dlx_wait_resolve(conf, mcs_default_wait);
   mtx->tail = NULL;
   return pthread_mutex_init_original(&mtx->posix_lock, attr);
 }
 
-int __mcs_lock(mcs_lock_t *mtx) {
-  mcs_node_t *node = (mcs_lock_t *)alloc_cache_align(sizeof(mcs_node_t));
-  pthread_setspecific(mtx->key, node);
+static inline mcs_node_t *__mcs_alloc_node() {
+  mcs_node_t *node = (mcs_node_t *)alloc_cache_align(sizeof(mcs_node_t));
   node->next = NULL;
   node->spin = LOCKED;
+  node->released = 0;
+  return node;
+}
+
+// Waits on node until the lock is handed over and returns 0. With abstime,
+// returns ETIMEDOUT once the node has been abandoned instead.
+static int __mcs_wait(mcs_lock_t *mtx, mcs_node_t *node, const struct timespec *abstime) {
+  dlx_wait_state_t st;
+  uint32_t round = 0;
+  uint32_t expected;
+  dlx_wait_begin(&mtx->wait, &st);
+  while (__atomic_load_n(&node->spin, __ATOMIC_ACQUIRE) == LOCKED) {
+    int kind = dlx_wait_pause(&mtx->wait, &st);
+    if (kind == DLX_WAIT_ROUND_SLEEP) {
+      expected = LOCKED;
+      if (!__atomic_compare_exchange_n(&node->spin, &expected, MCS_PARKED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        break;
+      while (__atomic_load_n(&node->spin, __ATOMIC_SEQ_CST) == MCS_PARKED) {
+        if (!abstime) {
+          futex_wait_u32(&node->spin, MCS_PARKED);
+          continue;
+        }
+        futex_wait_abs_u32(&node->spin, MCS_PARKED, abstime);
+        expected = MCS_PARKED;
+        if (deadline_passed(abstime) && __atomic_compare_exchange_n(
+          &node->spin, &expected, MCS_ABANDONED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+        ))
+          return ETIMEDOUT;
+      }
+      while (!__atomic_load_n(&node->released, __ATOMIC_ACQUIRE))
+        CPU_PAUSE();
+      break;
+    }
+    if (!abstime || (kind == DLX_WAIT_ROUND_SHORT && ++round % DEADLINE_POLL_INTERVAL) || !deadline_passed(abstime))
+      continue;
+    expected = LOCKED;
+    if (__atomic_compare_exchange_n(&node->spin, &expected, MCS_ABANDONED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      return ETIMEDOUT;
+    // The lock was granted while the deadline was being checked.
+    break;
+  }
+  return 0;
+}
+
+int __mcs_lock(mcs_lock_t *mtx) {
+  mcs_node_t *node = __mcs_alloc_node();
+  pthread_setspecific(mtx->key, node);
   mcs_node_t *tail = xchg_64((void *)&mtx->tail, (void *)node);
   if (!tail)
     return 0;
   tail->next = node;
   COMPILER_BARRIER();
-  while (node->spin == LOCKED)
-    CPU_PAUSE();
+  return __mcs_wait(mtx, node, NULL);
+}
+
+int __mcs_timedlock(mcs_lock_t *mtx, const struct timespec *abstime) {
+  mcs_node_t *node = __mcs_alloc_node();
+  mcs_node_t *tail = xchg_64((void *)&mtx->tail, (void *)node);
+  if (tail) {
+    tail->next = node;
+    COMPILER_BARRIER();
+    if (__mcs_wait(mtx, node, abstime))
+      return ETIMEDOUT;
+  }
+  pthread_setspecific(mtx->key, node);
   return 0;
 }
 
@@ -49,31 +123,47 @@ int mcs_lock(void *entity) {
 
 int mcs_trylock(void *entity) {
   mcs_lock_t *mtx = entity;
-  mcs_node_t *node = (mcs_lock_t *)alloc_cache_align(sizeof(mcs_node_t));
-  node->next = NULL;
-  node->spin = LOCKED;
-  pthread_setspecific(mtx->key, &node);
-  __atomic_compare_exchange(&mtx->tail, NULL, node, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-  if (!mtx->tail) {
-    int ret = 0;
-    while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY);
-    assert(ret == 0);
-    return 0;
+  mcs_node_t *node = __mcs_alloc_node();
+  mcs_node_t *empty = NULL;
+  if (!__atomic_compare_exchange_n(&mtx->tail, &empty, node, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+    free(node);
+    return EBUSY;
   }
-  return EBUSY;
+  pthread_setspecific(mtx->key, node);
+  int ret = 0;
+  while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY)
+    CPU_PAUSE();
+  assert(ret == 0);
+  return 0;
 }
 
 int __mcs_unlock(mcs_lock_t *mtx) {
   mcs_node_t *node = (mcs_node_t *)pthread_getspecific(mtx->key);
-  mcs_node_t *empty = NULL;
-  if (!node->next) {
-    if (__atomic_compare_exchange(&mtx->tail, &node, &empty, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+  while (1) {
+    mcs_node_t *expected = node;
+    if (!node->next) {
+      if (__atomic_compare_exchange_n(&mtx->tail, &expected, NULL, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+        free(node);
+        return 0;
+      }
+      while (!node->next)
+        CPU_PAUSE();
+    }
+    mcs_node_t *succ = node->next;
+    free(node);
+    uint32_t waiting = LOCKED;
+    if (__atomic_compare_exchange_n(&succ->spin, &waiting, UNLOCKED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
       return 0;
-    while (!node->next)
-      CPU_PAUSE();
+    if (waiting == MCS_PARKED && __atomic_compare_exchange_n(
+      &succ->spin, &waiting, UNLOCKED, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+    )) {
+      futex_wake_u32(&succ->spin, 1);
+      __atomic_store_n(&succ->released, 1, __ATOMIC_RELEASE);
+      return 0;
+    }
+    // Successor has timed out. Inherit its node and keep passing.
+    node = succ;
   }
-  node->next->spin = UNLOCKED;
-  return 0;
 }
 
 int mcs_unlock(void *entity) {
@@ -82,10 +172,21 @@ int mcs_unlock(void *entity) {
   return __mcs_unlock(mtx);
 }
 
+int mcs_timedlock(void *entity, const struct timespec *abstime) {
+  mcs_lock_t *mtx = entity;
+  int ret = __mcs_timedlock(mtx, abstime);
+  if (ret != 0)
+    return ret;
+  if ((ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime)) != 0)
+    __mcs_unlock(mtx);
+  return ret;
+}
+
 int mcs_destroy(void *entity) {
   mcs_lock_t *mtx = entity;
   pthread_mutex_destroy_original(&mtx->posix_lock);
-  free(entity);
+  pthread_key_delete(mtx->key);
+  free_cache_align(entity);
   return 0;
 }
 
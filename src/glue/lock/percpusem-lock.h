@@ -0,0 +1,131 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifndef __DYLINX_PERCPUSEM_LOCK__
+#define __DYLINX_PERCPUSEM_LOCK__
+
+// Semaphore whose tokens are cached per CPU. A post drops its token into
+// the slot of the CPU it runs on and a wait first looks at its own slot,
+// so producer and consumer pairs on the same CPU never share a cache line.
+// A consumer with an empty slot steals from the other slots before it
+// parks on the central sequence word.
+//
+// Note:
+// 1. A waiter registers in parked before its final scan and posters check
+//    parked after dropping their token. Either the poster sees the waiter
+//    and bumps seq, or the waiter sees the token.
+// 2. Tokens are not bound to a CPU. Migrating threads only lose locality.
+
+typedef struct percpusem_slot {
+  volatile uint32_t tokens;
+} percpusem_slot_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+typedef struct percpusem_lock {
+  uint32_t n_slot;
+  percpusem_slot_t *slots;
+  volatile uint32_t seq __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+} percpusem_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static inline uint32_t __percpusem_home(percpusem_lock_t *sem) {
+  return dlx_current_cpu() % sem->n_slot;
+}
+
+static inline int __percpusem_take(percpusem_lock_t *sem) {
+  uint32_t home = __percpusem_home(sem);
+  for (uint32_t i = 0; i < sem->n_slot; i++) {
+    volatile uint32_t *tokens = &sem->slots[(home + i) % sem->n_slot].tokens;
+    uint32_t cur = __atomic_load_n(tokens, __ATOMIC_SEQ_CST);
+    while (cur > 0) {
+      if (__atomic_compare_exchange_n(tokens, &cur, cur - 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return 1;
+    }
+  }
+  return 0;
+}
+
+int percpusem_init(void **entity, int pshared, unsigned value) {
+  (void)pshared;
+  *entity = (percpusem_lock_t *)alloc_cache_align(sizeof(percpusem_lock_t));
+  percpusem_lock_t *sem = *entity;
+  sem->n_slot = dlx_topology()->n_cpu;
+  sem->slots = alloc_cache_align(sem->n_slot * sizeof(percpusem_slot_t));
+  memset(sem->slots, 0, sem->n_slot * sizeof(percpusem_slot_t));
+  sem->slots[0].tokens = value;
+  sem->seq = 0;
+  sem->parked = 0;
+  return 0;
+}
+
+static inline int __percpusem_wait(percpusem_lock_t *sem, const struct timespec *abstime) {
+  for (uint32_t round = 0; round < SPIN_BEFORE_PARK; round++) {
+    if (__percpusem_take(sem))
+      return 0;
+    CPU_PAUSE();
+  }
+  while (1) {
+    __atomic_fetch_add(&sem->parked, 1, __ATOMIC_SEQ_CST);
+    uint32_t seq = __atomic_load_n(&sem->seq, __ATOMIC_SEQ_CST);
+    if (__percpusem_take(sem)) {
+      __atomic_fetch_sub(&sem->parked, 1, __ATOMIC_SEQ_CST);
+      return 0;
+    }
+    int ret = abstime? futex_wait_abs_u32(&sem->seq, seq, abstime): (futex_wait_u32(&sem->seq, seq), 0);
+    __atomic_fetch_sub(&sem->parked, 1, __ATOMIC_SEQ_CST);
+    if (ret == -1 && errno == ETIMEDOUT) {
+      if (__percpusem_take(sem))
+        return 0;
+      errno = ETIMEDOUT;
+      return -1;
+    }
+  }
+}
+
+int percpusem_wait(void *entity) {
+  return __percpusem_wait(entity, NULL);
+}
+
+int percpusem_trywait(void *entity) {
+  if (__percpusem_take(entity))
+    return 0;
+  errno = EAGAIN;
+  return -1;
+}
+
+int percpusem_timedwait(void *entity, const struct timespec *abstime) {
+  return __percpusem_wait(entity, abstime);
+}
+
+int percpusem_post(void *entity) {
+  percpusem_lock_t *sem = entity;
+  __atomic_fetch_add(&sem->slots[__percpusem_home(sem)].tokens, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&sem->parked, __ATOMIC_SEQ_CST)) {
+    __atomic_fetch_add(&sem->seq, 1, __ATOMIC_SEQ_CST);
+    futex_wake_u32(&sem->seq, 1);
+  }
+  return 0;
+}
+
+int percpusem_getvalue(void *entity, int *value) {
+  percpusem_lock_t *sem = entity;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < sem->n_slot; i++)
+    sum += __atomic_load_n(&sem->slots[i].tokens, __ATOMIC_RELAXED);
+  *value = sum > INT_MAX? INT_MAX: (int)sum;
+  return 0;
+}
+
+int percpusem_destroy(void *entity) {
+  percpusem_lock_t *sem = entity;
+  free(sem->slots);
+  free(sem);
+  return 0;
+}
+
+#endif // __DYLINX_PERCPUSEM_LOCK__
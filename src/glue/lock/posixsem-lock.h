@@ -0,0 +1,38 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_POSIXSEM_LOCK__
+#define __DYLINX_POSIXSEM_LOCK__
+
+// Neutral default of the semaphore family which forwards to glibc. The
+// backend is private memory, process-shared semaphores never get here,
+// see dlx_forward_sem_init.
+int posixsem_init(void **entity, int pshared, unsigned value) {
+  *entity = malloc(sizeof(sem_t));
+  return sem_init_original((sem_t *)(*entity), pshared, value);
+}
+int posixsem_wait(void *entity) {
+  return sem_wait_original((sem_t *)entity);
+}
+int posixsem_trywait(void *entity) {
+  return sem_trywait_original((sem_t *)entity);
+}
+int posixsem_timedwait(void *entity, const struct timespec *abstime) {
+  return sem_timedwait_original((sem_t *)entity, abstime);
+}
+int posixsem_post(void *entity) {
+  return sem_post_original((sem_t *)entity);
+}
+int posixsem_getvalue(void *entity, int *value) {
+  return sem_getvalue_original((sem_t *)entity, value);
+}
+int posixsem_destroy(void *entity) {
+  int ret = sem_destroy_original((sem_t *)entity);
+  free(entity);
+  return ret;
+}
+
+#endif // __DYLINX_POSIXSEM_LOCK__
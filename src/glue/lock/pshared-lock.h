@@ -0,0 +1,181 @@
+#include "compact-wait.h"
+#include <errno.h>
+#include <stdint.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef __DYLINX_PSHARED_LOCK__
+#define __DYLINX_PSHARED_LOCK__
+
+// Process-shared lock, kept inline in the 8-byte lock_obj slot of the
+// generic header instead of in a backend. Nothing in the slot is an
+// address, so a header in shared memory works from every process mapping
+// it, wherever the mapping sits. kind is picked from the type of the
+// site, see dlx_pshared_init.
+// PSHARED_FUTEX is the three-state mutex of Drepper's "Futexes Are
+// Tricky": 0 free, 1 held, 2 held with possible sleepers. Its futex calls
+// drop FUTEX_PRIVATE_FLAG so that they match across processes.
+// cond keeps the kind in its low byte, a flag telling that condition
+// waiters sleep on it and a sequence above. See pshared_cond_timedwait.
+enum { PSHARED_FUTEX, PSHARED_TAS, PSHARED_TICKET };
+
+#define PSHARED_KIND_MASK 0xffU
+#define PSHARED_COND_WAITER (1U << 8)
+#define PSHARED_COND_SEQ (1U << 9)
+#define PSHARED_KIND(mtx) ((mtx)->cond & PSHARED_KIND_MASK)
+
+typedef struct pshared_lock {
+  union {
+    volatile uint32_t word;
+    struct {
+      volatile uint16_t owner;
+      volatile uint16_t next;
+    } half;
+  };
+  volatile uint32_t cond;
+} pshared_lock_t;
+
+static inline void pshared_futex_wait(volatile uint32_t *addr, uint32_t val) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static inline int pshared_futex_wait_abs(volatile uint32_t *addr, uint32_t val, const struct timespec *abstime) {
+  return syscall(
+    SYS_futex, (uint32_t *)addr, FUTEX_WAIT_BITSET | FUTEX_CLOCK_REALTIME,
+    val, abstime, NULL, FUTEX_BITSET_MATCH_ANY
+  );
+}
+
+static inline void pshared_futex_wake(volatile uint32_t *addr, int cnt) {
+  syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, cnt, NULL, NULL, 0);
+}
+
+int pshared_trylock(void *entity) {
+  pshared_lock_t *mtx = entity;
+  uint32_t expected = 0;
+  pshared_lock_t cur, upd;
+  switch (PSHARED_KIND(mtx)) {
+    case PSHARED_TICKET:
+      cur.word = __atomic_load_n(&mtx->word, __ATOMIC_ACQUIRE);
+      if (cur.half.owner != cur.half.next)
+        return EBUSY;
+      upd.word = cur.word;
+      upd.half.next++;
+      expected = cur.word;
+      return __atomic_compare_exchange_n(&mtx->word, &expected, upd.word, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)? 0: EBUSY;
+    case PSHARED_TAS:
+      return __atomic_exchange_n(&mtx->word, 1, __ATOMIC_ACQUIRE)? EBUSY: 0;
+    default:
+      return __atomic_compare_exchange_n(&mtx->word, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)? 0: EBUSY;
+  }
+}
+
+// Returns ETIMEDOUT once abstime passed, never with abstime NULL.
+static int __pshared_acquire(pshared_lock_t *mtx, const struct timespec *abstime) {
+  uint32_t round = 0;
+  if (PSHARED_KIND(mtx) == PSHARED_TICKET && !abstime) {
+    uint16_t mine = __atomic_fetch_add(&mtx->half.next, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&mtx->half.owner, __ATOMIC_ACQUIRE) != mine)
+      compact_relax(&round);
+    return 0;
+  }
+  if (PSHARED_KIND(mtx) != PSHARED_FUTEX) {
+    // A taken ticket cannot be handed back, so a timed ticket acquisition
+    // retries the trylock like TAS does.
+    while (pshared_trylock(mtx)) {
+      compact_relax(&round);
+      if (abstime && round % DEADLINE_POLL_INTERVAL == 0 && deadline_passed(abstime))
+        return ETIMEDOUT;
+    }
+    return 0;
+  }
+  uint32_t c = 0;
+  if (__atomic_compare_exchange_n(&mtx->word, &c, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+  if (c != 2)
+    c = __atomic_exchange_n(&mtx->word, 2, __ATOMIC_ACQUIRE);
+  while (c) {
+    if (!abstime)
+      pshared_futex_wait(&mtx->word, 2);
+    else if (pshared_futex_wait_abs(&mtx->word, 2, abstime) && errno == ETIMEDOUT)
+      return ETIMEDOUT;
+    c = __atomic_exchange_n(&mtx->word, 2, __ATOMIC_ACQUIRE);
+  }
+  return 0;
+}
+
+int pshared_lock(void *entity) {
+  return __pshared_acquire(entity, NULL);
+}
+
+int pshared_timedlock(void *entity, const struct timespec *abstime) {
+  return __pshared_acquire(entity, abstime);
+}
+
+static void __pshared_release(pshared_lock_t *mtx) {
+  switch (PSHARED_KIND(mtx)) {
+    case PSHARED_TICKET:
+      __atomic_store_n(&mtx->half.owner, (uint16_t)(mtx->half.owner + 1), __ATOMIC_RELEASE);
+      break;
+    case PSHARED_TAS:
+      __atomic_store_n(&mtx->word, 0, __ATOMIC_RELEASE);
+      break;
+    default:
+      if (__atomic_fetch_sub(&mtx->word, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&mtx->word, 0, __ATOMIC_RELEASE);
+        pshared_futex_wake(&mtx->word, 1);
+      }
+  }
+}
+
+// Moves the sequence and wakes every condition waiter, if there is one.
+static void __pshared_cond_wake(pshared_lock_t *mtx) {
+  uint32_t cond = __atomic_load_n(&mtx->cond, __ATOMIC_SEQ_CST);
+  while (cond & PSHARED_COND_WAITER) {
+    uint32_t next = (cond + PSHARED_COND_SEQ) & ~PSHARED_COND_WAITER;
+    if (__atomic_compare_exchange_n(&mtx->cond, &cond, next, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+      pshared_futex_wake(&mtx->cond, INT32_MAX);
+      break;
+    }
+  }
+}
+
+int pshared_unlock(void *entity) {
+  pshared_lock_t *mtx = entity;
+  __pshared_release(mtx);
+  __pshared_cond_wake(mtx);
+  return 0;
+}
+
+// The condition variable cannot help here: pthread_cond_signal takes no
+// mutex and waking a waiter through it would need a process-shared mutex
+// the inline lock does not have. Instead waiters sleep on the futex of
+// cond and every unlock that finds the waiter flag moves the sequence and
+// wakes them all. A signaller changes the predicate with the lock held,
+// so the unlock after it wakes the waiter, from whatever process. The
+// flag is raised before the lock is released, hence no unlock is missed,
+// and a waiter that finds other waiters wakes them on its way out, since
+// it may have changed the predicate as well. Signals themselves are not
+// needed, the cost is a wakeup on every unlock while someone waits.
+int pshared_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
+  (void)cond;
+  pshared_lock_t *mtx = entity;
+  uint32_t seen = __atomic_fetch_or(&mtx->cond, PSHARED_COND_WAITER, __ATOMIC_SEQ_CST);
+  if (seen & PSHARED_COND_WAITER) {
+    seen = __atomic_add_fetch(&mtx->cond, PSHARED_COND_SEQ, __ATOMIC_SEQ_CST);
+    pshared_futex_wake(&mtx->cond, INT32_MAX);
+  } else {
+    seen |= PSHARED_COND_WAITER;
+  }
+  __pshared_release(mtx);
+  int res = 0;
+  if (!time)
+    pshared_futex_wait(&mtx->cond, seen);
+  else if (pshared_futex_wait_abs(&mtx->cond, seen, time) && errno == ETIMEDOUT)
+    res = ETIMEDOUT;
+  __pshared_acquire(mtx, NULL);
+  return res;
+}
+
+#endif // __DYLINX_PSHARED_LOCK__
@@ -0,0 +1,24 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_PTHREADBARRIER_LOCK__
+#define __DYLINX_PTHREADBARRIER_LOCK__
+
+// Neutral default of the barrier family which forwards to glibc.
+int pthreadbarrier_init(void **entity, const pthread_barrierattr_t *attr, unsigned count) {
+  *entity = malloc(sizeof(pthread_barrier_t));
+  return pthread_barrier_init_original((pthread_barrier_t *)(*entity), attr, count);
+}
+int pthreadbarrier_wait(void *entity) {
+  return pthread_barrier_wait_original((pthread_barrier_t *)entity);
+}
+int pthreadbarrier_destroy(void *entity) {
+  int ret = pthread_barrier_destroy_original((pthread_barrier_t *)entity);
+  free(entity);
+  return ret;
+}
+
+#endif // __DYLINX_PTHREADBARRIER_LOCK__
@@ -11,8 +11,8 @@ typedef struct pthreadmtx_lock {
   pthread_mutex_t posix_lock;
 } pthreadmtx_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
-int pthreadmtx_init(void **entity, pthread_mutexattr_t *attr) {
-  *entity = malloc(sizeof(pthread_mutex_t));
+int pthreadmtx_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  *entity = dlx_alloc_lock(sizeof(pthread_mutex_t), conf);
   return pthread_mutex_init_original((pthread_mutex_t *)(*entity), attr);
 }
 int pthreadmtx_lock(void *entity) {
@@ -21,11 +21,16 @@ int pthreadmtx_lock(void *entity) {
 int pthreadmtx_trylock(void *entity) {
   return pthread_mutex_trylock_original((pthread_mutex_t *)entity);
 }
+int pthreadmtx_timedlock(void *entity, const struct timespec *abstime) {
+  return pthread_mutex_timedlock_original((pthread_mutex_t *)entity, abstime);
+}
 int pthreadmtx_unlock(void *entity) {
   return pthread_mutex_unlock_original((pthread_mutex_t *)entity);
 }
 int pthreadmtx_destroy(void *entity) {
-  return pthread_mutex_destroy_original((pthread_mutex_t *)entity);
+  int ret = pthread_mutex_destroy_original((pthread_mutex_t *)entity);
+  free_cache_align(entity);
+  return ret;
 }
 int pthreadmtx_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
   if (time)
@@ -0,0 +1,38 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_PTHREADRW_LOCK__
+#define __DYLINX_PTHREADRW_LOCK__
+
+// Neutral default of the reader-writer family. It simply forwards to
+// glibc so that untracked and unconfigured rwlock sites keep their
+// original behavior.
+int pthreadrw_init(void **entity, pthread_rwlockattr_t *attr) {
+  *entity = malloc(sizeof(pthread_rwlock_t));
+  return pthread_rwlock_init_original((pthread_rwlock_t *)(*entity), attr);
+}
+int pthreadrw_rdlock(void *entity) {
+  return pthread_rwlock_rdlock_original((pthread_rwlock_t *)entity);
+}
+int pthreadrw_wrlock(void *entity) {
+  return pthread_rwlock_wrlock_original((pthread_rwlock_t *)entity);
+}
+int pthreadrw_tryrdlock(void *entity) {
+  return pthread_rwlock_tryrdlock_original((pthread_rwlock_t *)entity);
+}
+int pthreadrw_trywrlock(void *entity) {
+  return pthread_rwlock_trywrlock_original((pthread_rwlock_t *)entity);
+}
+int pthreadrw_unlock(void *entity) {
+  return pthread_rwlock_unlock_original((pthread_rwlock_t *)entity);
+}
+int pthreadrw_destroy(void *entity) {
+  int ret = pthread_rwlock_destroy_original((pthread_rwlock_t *)entity);
+  free(entity);
+  return ret;
+}
+
+#endif // __DYLINX_PTHREADRW_LOCK__
@@ -0,0 +1,172 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_QSPINLOCK_LOCK__
+#define __DYLINX_QSPINLOCK_LOCK__
+
+// Source code implementation refers to the queued spinlock of Linux kernel.
+// https://github.com/torvalds/linux/blob/master/kernel/locking/qspinlock.c
+// ---------------------------------------------------------------------------
+// Note:
+// 1. Uncontended acquisition is a single CAS on the locked byte.
+// 2. The first contender sets the pending byte and spins on the lock word
+//    itself, so light contention never touches a queue node.
+// 3. Everybody else joins an MCS queue whose node lives on the waiter's
+//    stack. Only the queue head spins on the lock word and the node is
+//    released as soon as the lock is taken, since unlock only clears the
+//    locked byte.
+// 4. Timed acquirers never join the queue. They poll the fast path until
+//    the deadline passes.
+
+#define QSPIN_LOCKED_VAL 0x0001
+#define QSPIN_PENDING_VAL 0x0100
+
+typedef struct qspin_node {
+  struct qspin_node *volatile next;
+  volatile int head;
+} qspin_node_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+typedef struct qspinlock_lock {
+  union {
+    volatile uint16_t val;
+    struct {
+      volatile uint8_t locked;
+      volatile uint8_t pending;
+    };
+  } __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  qspin_node_t *volatile tail;
+  pthread_mutex_t posix_lock;
+} qspinlock_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int qspinlock_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  *entity = (qspinlock_lock_t *)dlx_alloc_lock(sizeof(qspinlock_lock_t), conf);
+  qspinlock_lock_t *mtx = *entity;
+  mtx->val = 0;
+  mtx->tail = NULL;
+  return pthread_mutex_init_original(&mtx->posix_lock, attr);
+}
+
+static inline int __qspin_fastpath(qspinlock_lock_t *mtx) {
+  uint16_t expected = 0;
+  return !mtx->tail && __atomic_compare_exchange_n(
+    &mtx->val, &expected, QSPIN_LOCKED_VAL, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+  );
+}
+
+static void __qspin_slowpath(qspinlock_lock_t *mtx) {
+  // Pending path: only taken when the lock is held and nobody waits.
+  uint16_t expected = QSPIN_LOCKED_VAL;
+  if (!mtx->tail && __atomic_compare_exchange_n(
+    &mtx->val, &expected, QSPIN_LOCKED_VAL | QSPIN_PENDING_VAL, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+  )) {
+    while (__atomic_load_n(&mtx->locked, __ATOMIC_ACQUIRE))
+      CPU_PAUSE();
+    // Nobody else can take a word whose pending byte is set.
+    __atomic_store_n(&mtx->val, QSPIN_LOCKED_VAL, __ATOMIC_RELEASE);
+    return;
+  }
+
+  qspin_node_t node = { .next = NULL, .head = 0 };
+  qspin_node_t *prev = xchg_64((void *)&mtx->tail, (void *)&node);
+  if (prev) {
+    prev->next = &node;
+    while (!__atomic_load_n(&node.head, __ATOMIC_ACQUIRE))
+      CPU_PAUSE();
+  }
+  while (1) {
+    expected = 0;
+    if (__atomic_load_n(&mtx->val, __ATOMIC_RELAXED) == 0 && __atomic_compare_exchange_n(
+      &mtx->val, &expected, QSPIN_LOCKED_VAL, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+    ))
+      break;
+    CPU_PAUSE();
+  }
+  qspin_node_t *self = &node;
+  if (__atomic_compare_exchange_n(&mtx->tail, &self, NULL, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    return;
+  while (!node.next)
+    CPU_PAUSE();
+  __atomic_store_n(&node.next->head, 1, __ATOMIC_RELEASE);
+}
+
+static inline void __qspin_unlock(qspinlock_lock_t *mtx) {
+  __atomic_store_n(&mtx->locked, 0, __ATOMIC_RELEASE);
+}
+
+int qspinlock_lock(void *entity) {
+  qspinlock_lock_t *mtx = entity;
+  if (!__qspin_fastpath(mtx))
+    __qspin_slowpath(mtx);
+  int ret = pthread_mutex_lock_original(&mtx->posix_lock);
+  assert(ret == 0);
+  return 0;
+}
+
+int qspinlock_trylock(void *entity) {
+  qspinlock_lock_t *mtx = entity;
+  if (!__qspin_fastpath(mtx))
+    return EBUSY;
+  int ret;
+  while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY)
+    CPU_PAUSE();
+  assert(ret == 0);
+  return 0;
+}
+
+int qspinlock_unlock(void *entity) {
+  qspinlock_lock_t *mtx = entity;
+  int ret = pthread_mutex_unlock_original(&mtx->posix_lock);
+  __qspin_unlock(mtx);
+  return ret;
+}
+
+int qspinlock_timedlock(void *entity, const struct timespec *abstime) {
+  qspinlock_lock_t *mtx = entity;
+  uint32_t round = 0;
+  while (!__qspin_fastpath(mtx)) {
+    CPU_PAUSE();
+    if (++round % DEADLINE_POLL_INTERVAL == 0 && deadline_passed(abstime))
+      return ETIMEDOUT;
+  }
+  int ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime);
+  if (ret != 0)
+    __qspin_unlock(mtx);
+  return ret;
+}
+
+int qspinlock_destroy(void *entity) {
+  qspinlock_lock_t *mtx = entity;
+  int ret = pthread_mutex_destroy_original(&mtx->posix_lock);
+  free_cache_align(mtx);
+  return ret;
+}
+
+int qspinlock_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
+  qspinlock_lock_t *mtx = entity;
+  int res;
+  __qspin_unlock(mtx);
+  if (time)
+    res = pthread_cond_timedwait_original(cond, &mtx->posix_lock, time);
+  else
+    res = pthread_cond_wait_original(cond, &mtx->posix_lock);
+  if (res != 0 && res != ETIMEDOUT) {
+    HANDLING_ERROR(
+      "Error happens when trying to conduct "
+      "pthread_cond_wait on internal posix_lock"
+      "in a qspinlock_lock"
+    );
+  }
+  if (pthread_mutex_unlock_original(&mtx->posix_lock) != 0) {
+    HANDLING_ERROR(
+      "Error happens when trying to conduct "
+      "pthread_mutex_unlock on internal posix_lock"
+    );
+  }
+  qspinlock_lock(entity);
+  return res;
+}
+
+#endif // __DYLINX_QSPINLOCK_LOCK__
@@ -0,0 +1,60 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_SENSEBARRIER_LOCK__
+#define __DYLINX_SENSEBARRIER_LOCK__
+
+// Paper:
+// Algorithms for Scalable Synchronization on Shared-Memory Multiprocessors
+// ---------------------------------------------------------------------------
+// Note:
+// 1. Centralized sense-reversing barrier. The sense is kept as a phase
+//    counter, so every waiter compares against the phase it observed on
+//    arrival instead of keeping a thread local sense per barrier.
+// 2. The last arrival resets the counter before advancing the phase, and
+//    nobody of the next episode is able to arrive before that.
+
+typedef struct sensebarrier_lock {
+  volatile uint32_t remain __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  uint32_t count;
+  volatile uint32_t phase __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+} sensebarrier_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int sensebarrier_init(void **entity, const pthread_barrierattr_t *attr, unsigned count) {
+  (void)attr;
+  if (count == 0)
+    return EINVAL;
+  *entity = (sensebarrier_lock_t *)alloc_cache_align(sizeof(sensebarrier_lock_t));
+  sensebarrier_lock_t *bar = *entity;
+  bar->remain = count;
+  bar->count = count;
+  bar->phase = 0;
+  bar->parked = 0;
+  return 0;
+}
+
+int sensebarrier_wait(void *entity) {
+  sensebarrier_lock_t *bar = entity;
+  uint32_t phase = __atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE);
+  if (__atomic_fetch_sub(&bar->remain, 1, __ATOMIC_SEQ_CST) == 1) {
+    bar->remain = bar->count;
+    __atomic_store_n(&bar->phase, phase + 1, __ATOMIC_SEQ_CST);
+    wake_parked(&bar->phase, &bar->parked, INT_MAX);
+    return PTHREAD_BARRIER_SERIAL_THREAD;
+  }
+  while (__atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE) == phase)
+    spin_then_park(&bar->phase, phase, &bar->parked);
+  return 0;
+}
+
+int sensebarrier_destroy(void *entity) {
+  free(entity);
+  return 0;
+}
+
+#endif // __DYLINX_SENSEBARRIER_LOCK__
@@ -0,0 +1,100 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_SPINPARKSEM_LOCK__
+#define __DYLINX_SPINPARKSEM_LOCK__
+
+// Counting semaphore on a single futex word. Waiters spin for a while
+// before parking, so a producer that posts shortly after the consumer ran
+// dry hands the token over without any syscall on either side. Posters
+// only enter the kernel when somebody is actually parked.
+//
+// Like glibc, the functions follow the sem_* convention of returning -1
+// and reporting the cause through errno.
+
+typedef struct spinparksem_lock {
+  volatile uint32_t value __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+} spinparksem_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static inline int __sem_take_token(volatile uint32_t *value) {
+  uint32_t cur = __atomic_load_n(value, __ATOMIC_RELAXED);
+  while (cur > 0) {
+    if (__atomic_compare_exchange_n(value, &cur, cur - 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      return 1;
+  }
+  return 0;
+}
+
+// Timed wait on a token word shared by the futex based semaphores.
+static inline int __sem_timedwait_word(volatile uint32_t *value, volatile uint32_t *parked, const struct timespec *abstime) {
+  uint32_t round = 0;
+  while (!__sem_take_token(value)) {
+    if (++round < SPIN_BEFORE_PARK) {
+      CPU_PAUSE();
+      continue;
+    }
+    __atomic_fetch_add(parked, 1, __ATOMIC_SEQ_CST);
+    int ret = 0;
+    if (__atomic_load_n(value, __ATOMIC_SEQ_CST) == 0)
+      ret = futex_wait_abs_u32(value, 0, abstime);
+    __atomic_fetch_sub(parked, 1, __ATOMIC_SEQ_CST);
+    if (ret == -1 && errno == ETIMEDOUT && !__sem_take_token(value)) {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int spinparksem_init(void **entity, int pshared, unsigned value) {
+  (void)pshared;
+  *entity = (spinparksem_lock_t *)alloc_cache_align(sizeof(spinparksem_lock_t));
+  spinparksem_lock_t *sem = *entity;
+  sem->value = value;
+  sem->parked = 0;
+  return 0;
+}
+
+int spinparksem_wait(void *entity) {
+  spinparksem_lock_t *sem = entity;
+  while (!__sem_take_token(&sem->value))
+    spin_then_park(&sem->value, 0, &sem->parked);
+  return 0;
+}
+
+int spinparksem_trywait(void *entity) {
+  spinparksem_lock_t *sem = entity;
+  if (__sem_take_token(&sem->value))
+    return 0;
+  errno = EAGAIN;
+  return -1;
+}
+
+int spinparksem_timedwait(void *entity, const struct timespec *abstime) {
+  spinparksem_lock_t *sem = entity;
+  return __sem_timedwait_word(&sem->value, &sem->parked, abstime);
+}
+
+int spinparksem_post(void *entity) {
+  spinparksem_lock_t *sem = entity;
+  __atomic_fetch_add(&sem->value, 1, __ATOMIC_SEQ_CST);
+  wake_parked(&sem->value, &sem->parked, 1);
+  return 0;
+}
+
+int spinparksem_getvalue(void *entity, int *value) {
+  spinparksem_lock_t *sem = entity;
+  *value = __atomic_load_n(&sem->value, __ATOMIC_RELAXED);
+  return 0;
+}
+
+int spinparksem_destroy(void *entity) {
+  free(entity);
+  return 0;
+}
+
+#endif // __DYLINX_SPINPARKSEM_LOCK__
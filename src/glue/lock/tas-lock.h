@@ -0,0 +1,64 @@
+#include "compact-wait.h"
+#include <errno.h>
+
+#ifndef __DYLINX_TAS_LOCK__
+#define __DYLINX_TAS_LOCK__
+
+// Compact test-and-test-and-set lock. The whole lock is one byte from
+// dlx_alloc_compact, 0 when free, so there is no backend to allocate and
+// neither placement nor waiting policies apply.
+typedef struct tas_lock {
+  volatile uint8_t held;
+} tas_lock_t;
+
+int tas_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  (void)attr;
+  (void)conf;
+  *entity = dlx_alloc_compact(sizeof(tas_lock_t));
+  return *entity? 0: ENOMEM;
+}
+
+int tas_trylock(void *entity) {
+  tas_lock_t *mtx = entity;
+  return __atomic_exchange_n(&mtx->held, 1, __ATOMIC_ACQUIRE)? EBUSY: 0;
+}
+
+int tas_lock(void *entity) {
+  tas_lock_t *mtx = entity;
+  uint32_t round = 0;
+  while (tas_trylock(entity)) {
+    while (mtx->held)
+      compact_relax(&round);
+  }
+  return 0;
+}
+
+int tas_timedlock(void *entity, const struct timespec *abstime) {
+  tas_lock_t *mtx = entity;
+  uint32_t round = 0;
+  while (tas_trylock(entity)) {
+    while (mtx->held) {
+      compact_relax(&round);
+      if (round % DEADLINE_POLL_INTERVAL == 0 && deadline_passed(abstime))
+        return ETIMEDOUT;
+    }
+  }
+  return 0;
+}
+
+int tas_unlock(void *entity) {
+  tas_lock_t *mtx = entity;
+  __atomic_store_n(&mtx->held, 0, __ATOMIC_RELEASE);
+  return 0;
+}
+
+int tas_destroy(void *entity) {
+  dlx_free_compact(entity, sizeof(tas_lock_t));
+  return 0;
+}
+
+int tas_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
+  return compact_cond_timedwait(cond, entity, time, tas_unlock, tas_lock);
+}
+
+#endif // __DYLINX_TAS_LOCK__
@@ -0,0 +1,161 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_TICKET_LOCK__
+#define __DYLINX_TICKET_LOCK__
+
+// Paper:
+// Algorithms for Scalable Synchronization on Shared-Memory Multiprocessors
+// ---------------------------------------------------------------------------
+// Note:
+// 1. owner and next share one 64-bit word so that trylock is able to take
+//    a ticket only when nobody is queueing, which is a single CAS.
+// 2. Waiters back off in proportion to their distance from the owner.
+// 3. A ticket cannot be handed back once drawn, therefore timedlock polls
+//    trylock instead of queueing.
+// 4. Proportional backoff is the default waiting policy. Any other policy
+//    waits on the owner half, and since every waiter watches that same
+//    word a release wakes all the sleepers.
+
+#define TICKET_BACKOFF_BASE 64
+
+// Tunables, TICKET(base=...): pauses per ticket ahead of the caller.
+enum { TICKET_PARAM_BASE };
+
+typedef union ticket_word {
+  volatile uint64_t whole;
+  struct {
+    volatile uint32_t owner;
+    volatile uint32_t next;
+  } half;
+} ticket_word_t;
+
+typedef struct ticket_lock {
+  ticket_word_t ticket __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+  uint32_t base;
+  dlx_wait_policy_t wait;
+  pthread_mutex_t posix_lock;
+} ticket_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+static const dlx_wait_policy_t ticket_default_wait = { DLX_WAIT_DEFAULT, 0, 0, 0 };
+
+int ticket_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  *entity = (ticket_lock_t *)dlx_alloc_lock(sizeof(ticket_lock_t), conf);
+  ticket_lock_t *mtx = *entity;
+  mtx->ticket.whole = 0;
+  mtx->parked = 0;
+  mtx->base = dlx_conf_param(conf, TICKET_PARAM_BASE, TICKET_BACKOFF_BASE);
+  mtx->wait = dlx_wait_resolve(conf, ticket_default_wait);
+  return pthread_mutex_init_original(&mtx->posix_lock, attr);
+}
+
+static inline void __ticket_lock(ticket_lock_t *mtx) {
+  uint32_t mine = __atomic_fetch_add(&mtx->ticket.half.next, 1, __ATOMIC_SEQ_CST);
+  uint32_t owner;
+  dlx_wait_state_t st;
+  dlx_wait_begin(&mtx->wait, &st);
+  while ((owner = __atomic_load_n(&mtx->ticket.half.owner, __ATOMIC_ACQUIRE)) != mine) {
+    if (mtx->wait.kind != DLX_WAIT_DEFAULT) {
+      dlx_wait_once(&mtx->wait, &st, &mtx->ticket.half.owner, owner, &mtx->parked, NULL);
+      continue;
+    }
+    for (uint32_t i = 0; i < (mine - owner) * mtx->base; i++)
+      CPU_PAUSE();
+  }
+}
+
+static inline int __ticket_trylock(ticket_lock_t *mtx) {
+  ticket_word_t cur, upd;
+  cur.whole = __atomic_load_n(&mtx->ticket.whole, __ATOMIC_ACQUIRE);
+  if (cur.half.owner != cur.half.next)
+    return EBUSY;
+  upd.whole = cur.whole;
+  upd.half.next++;
+  uint64_t expected = cur.whole;
+  if (!__atomic_compare_exchange_n(&mtx->ticket.whole, &expected, upd.whole, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    return EBUSY;
+  return 0;
+}
+
+static inline void __ticket_unlock(ticket_lock_t *mtx) {
+  __atomic_store_n(&mtx->ticket.half.owner, mtx->ticket.half.owner + 1, __ATOMIC_RELEASE);
+  dlx_wait_wake(&mtx->wait, &mtx->ticket.half.owner, &mtx->parked, INT32_MAX);
+}
+
+int ticket_lock(void *entity) {
+  ticket_lock_t *mtx = entity;
+  __ticket_lock(mtx);
+  int ret = pthread_mutex_lock_original(&mtx->posix_lock);
+  assert(ret == 0);
+  return 0;
+}
+
+int ticket_trylock(void *entity) {
+  ticket_lock_t *mtx = entity;
+  if (__ticket_trylock(mtx))
+    return EBUSY;
+  int ret;
+  while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY)
+    CPU_PAUSE();
+  assert(ret == 0);
+  return 0;
+}
+
+int ticket_unlock(void *entity) {
+  ticket_lock_t *mtx = entity;
+  int ret = pthread_mutex_unlock_original(&mtx->posix_lock);
+  __ticket_unlock(mtx);
+  return ret;
+}
+
+int ticket_timedlock(void *entity, const struct timespec *abstime) {
+  ticket_lock_t *mtx = entity;
+  uint32_t round = 0;
+  while (__ticket_trylock(mtx)) {
+    CPU_PAUSE();
+    if (++round % DEADLINE_POLL_INTERVAL == 0 && deadline_passed(abstime))
+      return ETIMEDOUT;
+  }
+  int ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime);
+  if (ret != 0)
+    __ticket_unlock(mtx);
+  return ret;
+}
+
+int ticket_destroy(void *entity) {
+  ticket_lock_t *mtx = entity;
+  int ret = pthread_mutex_destroy_original(&mtx->posix_lock);
+  free_cache_align(mtx);
+  return ret;
+}
+
+int ticket_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
+  ticket_lock_t *mtx = entity;
+  int res;
+  __ticket_unlock(mtx);
+  if (time)
+    res = pthread_cond_timedwait_original(cond, &mtx->posix_lock, time);
+  else
+    res = pthread_cond_wait_original(cond, &mtx->posix_lock);
+  if (res != 0 && res != ETIMEDOUT) {
+    HANDLING_ERROR(
+      "Error happens when trying to conduct "
+      "pthread_cond_wait on internal posix_lock"
+      "in a ticket_lock"
+    );
+  }
+  if (pthread_mutex_unlock_original(&mtx->posix_lock) != 0) {
+    HANDLING_ERROR(
+      "Error happens when trying to conduct "
+      "pthread_mutex_unlock on internal posix_lock"
+    );
+  }
+  ticket_lock(entity);
+  return res;
+}
+
+#endif // __DYLINX_TICKET_LOCK__
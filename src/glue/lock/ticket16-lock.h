@@ -0,0 +1,75 @@
+#include "compact-wait.h"
+#include <errno.h>
+
+#ifndef __DYLINX_TICKET16_LOCK__
+#define __DYLINX_TICKET16_LOCK__
+
+// Compact ticket lock in one 32-bit word from dlx_alloc_compact, owner in
+// the low half and next in the high one. It stays fair for up to 65535
+// waiters, more would wrap the next ticket onto a waiting one.
+typedef union ticket16_lock {
+  volatile uint32_t whole;
+  struct {
+    volatile uint16_t owner;
+    volatile uint16_t next;
+  } half;
+} ticket16_lock_t;
+
+int ticket16_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  (void)attr;
+  (void)conf;
+  *entity = dlx_alloc_compact(sizeof(ticket16_lock_t));
+  return *entity? 0: ENOMEM;
+}
+
+int ticket16_lock(void *entity) {
+  ticket16_lock_t *mtx = entity;
+  uint16_t mine = __atomic_fetch_add(&mtx->half.next, 1, __ATOMIC_SEQ_CST);
+  uint32_t round = 0;
+  while (__atomic_load_n(&mtx->half.owner, __ATOMIC_ACQUIRE) != mine)
+    compact_relax(&round);
+  return 0;
+}
+
+int ticket16_trylock(void *entity) {
+  ticket16_lock_t *mtx = entity;
+  ticket16_lock_t cur, upd;
+  cur.whole = __atomic_load_n(&mtx->whole, __ATOMIC_ACQUIRE);
+  if (cur.half.owner != cur.half.next)
+    return EBUSY;
+  upd.whole = cur.whole;
+  upd.half.next++;
+  uint32_t expected = cur.whole;
+  if (!__atomic_compare_exchange_n(&mtx->whole, &expected, upd.whole, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    return EBUSY;
+  return 0;
+}
+
+// A taken ticket cannot be handed back, so a timed acquisition only
+// retries the trylock until the deadline.
+int ticket16_timedlock(void *entity, const struct timespec *abstime) {
+  uint32_t round = 0;
+  while (ticket16_trylock(entity)) {
+    compact_relax(&round);
+    if (round % DEADLINE_POLL_INTERVAL == 0 && deadline_passed(abstime))
+      return ETIMEDOUT;
+  }
+  return 0;
+}
+
+int ticket16_unlock(void *entity) {
+  ticket16_lock_t *mtx = entity;
+  __atomic_store_n(&mtx->half.owner, (uint16_t)(mtx->half.owner + 1), __ATOMIC_RELEASE);
+  return 0;
+}
+
+int ticket16_destroy(void *entity) {
+  dlx_free_compact(entity, sizeof(ticket16_lock_t));
+  return 0;
+}
+
+int ticket16_cond_timedwait(pthread_cond_t *cond, void *entity, const struct timespec *time) {
+  return compact_cond_timedwait(cond, entity, time, ticket16_unlock, ticket16_lock);
+}
+
+#endif // __DYLINX_TICKET16_LOCK__
@@ -0,0 +1,75 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include "barrier-slot.h"
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_TOURNBARRIER_LOCK__
+#define __DYLINX_TOURNBARRIER_LOCK__
+
+// Paper:
+// Algorithms for Scalable Synchronization on Shared-Memory Multiprocessors
+// ---------------------------------------------------------------------------
+// Note:
+// 1. In round r the participant whose index is a multiple of 2^(r+1) wins
+//    statically and waits for the flag of its opponent index + 2^r. The
+//    loser signals and leaves the tournament.
+// 2. Index 0 is the champion. It advances the phase word, which plays the
+//    role of the global wakeup flag.
+
+typedef struct tournbarrier_lock {
+  barrier_team_t team;
+  uint32_t rounds;
+  barrier_flag_t *flags;
+  volatile uint32_t phase __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+} tournbarrier_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int tournbarrier_init(void **entity, const pthread_barrierattr_t *attr, unsigned count) {
+  (void)attr;
+  if (count == 0)
+    return EINVAL;
+  *entity = (tournbarrier_lock_t *)alloc_cache_align(sizeof(tournbarrier_lock_t));
+  tournbarrier_lock_t *bar = *entity;
+  bar->phase = 0;
+  bar->parked = 0;
+  bar->rounds = barrier_rounds(count);
+  bar->flags = alloc_cache_align((count * bar->rounds + 1) * sizeof(barrier_flag_t));
+  memset(bar->flags, 0, (count * bar->rounds + 1) * sizeof(barrier_flag_t));
+  return barrier_team_init(&bar->team, count);
+}
+
+int tournbarrier_wait(void *entity) {
+  tournbarrier_lock_t *bar = entity;
+  barrier_slot_t *slot = barrier_team_slot(&bar->team);
+  uint32_t id = slot->id;
+  uint32_t ep = ++bar->team.episode[id];
+  uint32_t phase = __atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE);
+  for (uint32_t r = 0; r < bar->rounds; r++) {
+    if (id % (1U << (r + 1))) {
+      barrier_flag_signal(&bar->flags[id * bar->rounds + r], ep);
+      while (__atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE) == phase)
+        spin_then_park(&bar->phase, phase, &bar->parked);
+      return 0;
+    }
+    uint32_t opponent = id + (1U << r);
+    if (opponent < bar->team.count)
+      barrier_flag_wait(&bar->flags[opponent * bar->rounds + r], ep);
+  }
+  __atomic_store_n(&bar->phase, phase + 1, __ATOMIC_SEQ_CST);
+  wake_parked(&bar->phase, &bar->parked, INT_MAX);
+  return PTHREAD_BARRIER_SERIAL_THREAD;
+}
+
+int tournbarrier_destroy(void *entity) {
+  tournbarrier_lock_t *bar = entity;
+  barrier_team_destroy(&bar->team);
+  free(bar->flags);
+  free(bar);
+  return 0;
+}
+
+#endif // __DYLINX_TOURNBARRIER_LOCK__
@@ -0,0 +1,97 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include "barrier-slot.h"
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_TREEBARRIER_LOCK__
+#define __DYLINX_TREEBARRIER_LOCK__
+
+// Paper:
+// Combining Tree Barrier, The Art of Multiprocessor Programming Ch.17
+// ---------------------------------------------------------------------------
+// Note:
+// 1. Arrivals are combined through a tree of fan-in TREEBARRIER_FANIN so
+//    that no counter is shared by more than TREEBARRIER_FANIN threads.
+// 2. The thread completing the root releases everybody through a single
+//    phase word, which keeps wakeup cheap for the spin-then-park waiters.
+
+#define TREEBARRIER_FANIN 4
+
+typedef struct treebarrier_node {
+  volatile uint32_t arrived;
+  uint32_t expected;
+  int32_t parent;
+} treebarrier_node_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+typedef struct treebarrier_lock {
+  barrier_team_t team;
+  treebarrier_node_t *nodes;
+  volatile uint32_t phase __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+} treebarrier_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int treebarrier_init(void **entity, const pthread_barrierattr_t *attr, unsigned count) {
+  (void)attr;
+  if (count == 0)
+    return EINVAL;
+  *entity = (treebarrier_lock_t *)alloc_cache_align(sizeof(treebarrier_lock_t));
+  treebarrier_lock_t *bar = *entity;
+  bar->phase = 0;
+  bar->parked = 0;
+
+  uint32_t n_node = 0;
+  for (uint32_t width = count; ; width = (width + TREEBARRIER_FANIN - 1) / TREEBARRIER_FANIN) {
+    n_node += (width + TREEBARRIER_FANIN - 1) / TREEBARRIER_FANIN;
+    if (width <= TREEBARRIER_FANIN)
+      break;
+  }
+  bar->nodes = alloc_cache_align(n_node * sizeof(treebarrier_node_t));
+  // Level by level from the leaves, where width is the number of children
+  // of the current level and offset its first node.
+  uint32_t offset = 0;
+  for (uint32_t width = count; ; width = (width + TREEBARRIER_FANIN - 1) / TREEBARRIER_FANIN) {
+    uint32_t level = (width + TREEBARRIER_FANIN - 1) / TREEBARRIER_FANIN;
+    for (uint32_t i = 0; i < level; i++) {
+      treebarrier_node_t *node = &bar->nodes[offset + i];
+      node->arrived = 0;
+      node->expected = (i + 1) * TREEBARRIER_FANIN <= width? TREEBARRIER_FANIN: width - i * TREEBARRIER_FANIN;
+      node->parent = level == 1? -1: (int32_t)(offset + level + i / TREEBARRIER_FANIN);
+    }
+    offset += level;
+    if (level == 1)
+      break;
+  }
+  return barrier_team_init(&bar->team, count);
+}
+
+int treebarrier_wait(void *entity) {
+  treebarrier_lock_t *bar = entity;
+  barrier_slot_t *slot = barrier_team_slot(&bar->team);
+  uint32_t phase = __atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE);
+  treebarrier_node_t *node = &bar->nodes[slot->id / TREEBARRIER_FANIN];
+  while (__atomic_add_fetch(&node->arrived, 1, __ATOMIC_SEQ_CST) == node->expected) {
+    node->arrived = 0;
+    if (node->parent < 0) {
+      __atomic_store_n(&bar->phase, phase + 1, __ATOMIC_SEQ_CST);
+      wake_parked(&bar->phase, &bar->parked, INT_MAX);
+      return PTHREAD_BARRIER_SERIAL_THREAD;
+    }
+    node = &bar->nodes[node->parent];
+  }
+  while (__atomic_load_n(&bar->phase, __ATOMIC_ACQUIRE) == phase)
+    spin_then_park(&bar->phase, phase, &bar->parked);
+  return 0;
+}
+
+int treebarrier_destroy(void *entity) {
+  treebarrier_lock_t *bar = entity;
+  barrier_team_destroy(&bar->team);
+  free(bar->nodes);
+  free(bar);
+  return 0;
+}
+
+#endif // __DYLINX_TREEBARRIER_LOCK__
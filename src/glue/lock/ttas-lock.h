@@ -10,6 +10,7 @@
 #define pthread_mutex_unlock pthread_mutex_unlock_original
 #define pthread_mutex_destroy pthread_mutex_destroy_original
 #define pthread_mutex_trylock pthread_mutex_trylock_original
+#define pthread_mutex_timedlock pthread_mutex_timedlock_original
 #define pthread_cond_wait pthread_cond_wait_original
 #define pthread_cond_timedwait pthread_cond_timedwait_original
 #include <pthread.h>
@@ -18,6 +19,7 @@
 #undef pthread_mutex_unlock
 #undef pthread_mutex_destroy
 #undef pthread_mutex_trylock
+#undef pthread_mutex_timedlock
 #undef pthread_cond_wait
 #undef pthread_cond_timedwait
 #endif
@@ -26,7 +28,9 @@
 #define __DYLINX_TTAS_LOCK__
 
 typedef struct ttas_lock {
-  volatile uint8_t spin_lock __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t spin_lock __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t parked;
+  dlx_wait_policy_t wait;
   pthread_mutex_t posix_lock;
 } ttas_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
 
@@ -34,13 +38,22 @@ typedef struct ttas_lock {
 // The Performance of Spin Lock Alternatives for Shared-Memory Multiprocessors
 // ---------------------------------------------------------------------------
 // Note:
-// 1. The private attribute ttas_lock_t *impl will switch among three states
-//    {UNLOCKED=1, LOCKED-1, 255}
+// 1. The private attribute ttas_lock_t *impl will switch between two states
+//    {UNLOCKED=1, LOCKED=0}. The word is 32 bits wide so that the PARK and
+//    TSC waiting policies are able to sleep on it.
 
-int ttas_init(void **entity, pthread_mutexattr_t *attr) {
-  *entity = (ttas_lock_t *)alloc_cache_align(sizeof(ttas_lock_t));
+static const dlx_wait_policy_t ttas_default_wait = { DLX_WAIT_SPIN, 0, 0, 0 };
+
+static inline int __ttas_tas(ttas_lock_t *mtx) {
+  return __atomic_exchange_n(&mtx->spin_lock, LOCKED, __ATOMIC_ACQUIRE) == UNLOCKED;
+}
+
+int ttas_init(void **entity, pthread_mutexattr_t *attr, const dlx_lock_conf_t *conf) {
+  *entity = (ttas_lock_t *)dlx_alloc_lock(sizeof(ttas_lock_t), conf);
   ttas_lock_t *mtx = *entity;
   mtx->spin_lock = UNLOCKED;
+  mtx->parked = 0;
+  mtx->wait = dlx_wait_resolve(conf, ttas_default_wait);
   pthread_mutex_init_original(&mtx->posix_lock, attr);
 #ifdef __DYLINX_DEBUG__
   printf("ttas-lock is initialized !!!\n");
@@ -53,10 +66,12 @@ int ttas_lock(void *entity) {
   printf("ttas-lock is enabled !!!\n");
 #endif
   ttas_lock_t *mtx = entity;
+  dlx_wait_state_t st;
+  dlx_wait_begin(&mtx->wait, &st);
   while (1) {
     while (mtx->spin_lock != UNLOCKED)
-      CPU_PAUSE();
-    if (l_tas_uint8(&mtx->spin_lock) == UNLOCKED)
+      dlx_wait_once(&mtx->wait, &st, &mtx->spin_lock, LOCKED, &mtx->parked, NULL);
+    if (__ttas_tas(mtx))
       break;
   }
   int ret = pthread_mutex_lock_original(&mtx->posix_lock);
@@ -66,7 +81,7 @@ int ttas_lock(void *entity) {
 
 int ttas_trylock(void *entity) {
   ttas_lock_t *mtx = entity;
-  if (l_tas_uint8(&mtx->spin_lock) == UNLOCKED) {
+  if (__ttas_tas(mtx)) {
     int ret;
     while ((ret = pthread_mutex_trylock_original(&mtx->posix_lock)) == EBUSY)
       CPU_PAUSE();
@@ -80,6 +95,7 @@ int __ttas_unlock(void *entity) {
   COMPILER_BARRIER();
   ttas_lock_t *mtx = entity;
   mtx->spin_lock = UNLOCKED;
+  dlx_wait_wake(&mtx->wait, &mtx->spin_lock, &mtx->parked, 1);
 #ifdef __DYLINX_DEBUG__
   printf("ttas-lock is disabled !!!\n");
 #endif
@@ -93,13 +109,33 @@ int ttas_unlock(void *entity) {
   return __ttas_unlock(entity);
 }
 
+int ttas_timedlock(void *entity, const struct timespec *abstime) {
+  ttas_lock_t *mtx = entity;
+  uint32_t round = 0;
+  dlx_wait_state_t st;
+  dlx_wait_begin(&mtx->wait, &st);
+  while (1) {
+    while (mtx->spin_lock != UNLOCKED) {
+      int slept = dlx_wait_once(&mtx->wait, &st, &mtx->spin_lock, LOCKED, &mtx->parked, abstime);
+      if ((slept || ++round % DEADLINE_POLL_INTERVAL == 0) && deadline_passed(abstime))
+        return ETIMEDOUT;
+    }
+    if (__ttas_tas(mtx))
+      break;
+  }
+  int ret = pthread_mutex_timedlock_original(&mtx->posix_lock, abstime);
+  if (ret != 0)
+    __ttas_unlock(entity);
+  return ret;
+}
+
 int ttas_destroy(void *entity) {
 #ifdef __DYLINX_DEBUG__
   printf("ttas-lock is finalized !!!\n");
 #endif
   ttas_lock_t *mtx = entity;
   int ret = pthread_mutex_destroy_original(&mtx->posix_lock);
-  free(mtx);
+  free_cache_align(mtx);
   return ret;
 }
 
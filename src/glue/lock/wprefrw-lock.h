@@ -0,0 +1,92 @@
+#include "dylinx-padding.h"
+#include "dylinx-utils.h"
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef __DYLINX_WPREFRW_LOCK__
+#define __DYLINX_WPREFRW_LOCK__
+
+// Writer-preferring spinning reader-writer lock. The state word holds the
+// number of active readers and a writer bit. Readers back off as soon as
+// any writer announces itself in pending_writers, so a steady stream of
+// readers can no longer starve writers.
+//
+// Note:
+// 1. The writer bit is only ever set while the reader count is zero, so
+//    observing it in unlock means the caller is the writer.
+#define WPREFRW_WRITER (1U << 31)
+
+typedef struct wprefrw_lock {
+  volatile uint32_t state __attribute__((aligned(L_CACHE_LINE_SIZE)));
+  volatile uint32_t pending_writers __attribute__((aligned(L_CACHE_LINE_SIZE)));
+} wprefrw_lock_t __attribute__((aligned(L_CACHE_LINE_SIZE)));
+
+int wprefrw_init(void **entity, pthread_rwlockattr_t *attr) {
+  (void)attr;
+  *entity = (wprefrw_lock_t *)alloc_cache_align(sizeof(wprefrw_lock_t));
+  wprefrw_lock_t *rw = *entity;
+  rw->state = 0;
+  rw->pending_writers = 0;
+  return 0;
+}
+
+int wprefrw_tryrdlock(void *entity) {
+  wprefrw_lock_t *rw = entity;
+  uint32_t state = rw->state;
+  if (rw->pending_writers || (state & WPREFRW_WRITER))
+    return EBUSY;
+  if (__atomic_compare_exchange_n(&rw->state, &state, state + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+  return EBUSY;
+}
+
+int wprefrw_rdlock(void *entity) {
+  wprefrw_lock_t *rw = entity;
+  while (1) {
+    while (rw->pending_writers || (rw->state & WPREFRW_WRITER))
+      CPU_PAUSE();
+    uint32_t state = rw->state;
+    if (!(state & WPREFRW_WRITER) &&
+        __atomic_compare_exchange_n(&rw->state, &state, state + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      return 0;
+  }
+}
+
+int wprefrw_trywrlock(void *entity) {
+  wprefrw_lock_t *rw = entity;
+  uint32_t idle = 0;
+  if (__atomic_compare_exchange_n(&rw->state, &idle, WPREFRW_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+  return EBUSY;
+}
+
+int wprefrw_wrlock(void *entity) {
+  wprefrw_lock_t *rw = entity;
+  __atomic_fetch_add(&rw->pending_writers, 1, __ATOMIC_SEQ_CST);
+  while (1) {
+    while (rw->state != 0)
+      CPU_PAUSE();
+    uint32_t idle = 0;
+    if (__atomic_compare_exchange_n(&rw->state, &idle, WPREFRW_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+      break;
+  }
+  __atomic_fetch_sub(&rw->pending_writers, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+int wprefrw_unlock(void *entity) {
+  wprefrw_lock_t *rw = entity;
+  if (rw->state & WPREFRW_WRITER)
+    __atomic_store_n(&rw->state, 0, __ATOMIC_RELEASE);
+  else
+    __atomic_fetch_sub(&rw->state, 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+int wprefrw_destroy(void *entity) {
+  free(entity);
+  return 0;
+}
+
+#endif // __DYLINX_WPREFRW_LOCK__
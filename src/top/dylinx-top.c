@@ -0,0 +1,197 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dylinx-shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// dylinx-top
+// ----------------------------------------------------------------------------
+// Live view of the statistics segment a subject publishes with
+// dlx_stats_publish. Every refresh diffs the segment against the previous
+// snapshot, so rates, means per acquisition and percentiles cover the
+// last interval only, and lists the sites with the most wait time first.
+//   dylinx-top [-i <interval ms>] [-n <refreshes>] [-s <sites>] <pid | /name>
+
+#define DLX_TOP_INTERVAL_MS 1000
+#define DLX_TOP_SITES 20
+
+typedef struct dlx_top_row {
+  const dlx_shm_site_t *now;
+  uint64_t d_acq;
+  uint64_t d_contended;
+  uint64_t d_wait;
+  uint64_t d_hold;
+  uint64_t wait_p99;
+  uint64_t hold_p99;
+} dlx_top_row_t;
+
+static void __dlx_top_usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-i <interval ms>] [-n <refreshes>] [-s <sites>] <pid | /name>\n", prog);
+  exit(2);
+}
+
+static const dlx_shm_header_t *__dlx_top_attach(const char *target, size_t *size) {
+  char name[64];
+  if (target[0] == '/')
+    snprintf(name, sizeof(name), "%s", target);
+  else
+    snprintf(name, sizeof(name), DLX_SHM_PREFIX "%s", target);
+  int fd = shm_open(name, O_RDONLY, 0);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st)) {
+    fprintf(stderr, "dylinx-top: %s: %s\n", name, strerror(errno));
+    exit(1);
+  }
+  const dlx_shm_header_t *shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED || (size_t)st.st_size < sizeof(dlx_shm_header_t)) {
+    fprintf(stderr, "dylinx-top: %s: not a statistics segment\n", name);
+    exit(1);
+  }
+  if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != DLX_SHM_MAGIC || shm->version != DLX_SHM_VERSION ||
+      shm->n_bucket != DLX_HIST_BUCKETS || shm->site_size < sizeof(dlx_shm_site_t) ||
+      shm->header_size + (size_t)shm->n_site * shm->site_size > (size_t)st.st_size) {
+    fprintf(stderr, "dylinx-top: %s: unknown segment layout\n", name);
+    exit(1);
+  }
+  *size = st.st_size;
+  return shm;
+}
+
+static int __dlx_top_snapshot(const dlx_shm_header_t *shm, dlx_shm_header_t *header, dlx_shm_site_t *sites) {
+  if (dlx_shm_read(&shm->seq, shm, header, sizeof(dlx_shm_header_t)))
+    return -1;
+  for (uint32_t i = 0; i < header->n_site; i++) {
+    const dlx_shm_site_t *site = (const void *)((const char *)shm + header->header_size + (size_t)i * header->site_size);
+    // An entry caught mid-write keeps its previous values.
+    dlx_shm_read(&site->seq, site, &sites[i], sizeof(dlx_shm_site_t));
+  }
+  return 0;
+}
+
+static uint64_t __dlx_top_p99(const uint64_t *now, const uint64_t *prev, uint64_t *diff) {
+  for (uint32_t i = 0; i < DLX_HIST_BUCKETS; i++)
+    diff[i] = now[i] - prev[i];
+  return dlx_hist_quantile(diff, 0.99);
+}
+
+static int __dlx_top_cmp(const void *a, const void *b) {
+  const dlx_top_row_t *x = a, *y = b;
+  if (x->d_wait != y->d_wait)
+    return x->d_wait < y->d_wait? 1: -1;
+  return x->d_acq < y->d_acq? 1: x->d_acq > y->d_acq? -1: 0;
+}
+
+static void __dlx_top_show(
+  const dlx_shm_header_t *header, const dlx_shm_header_t *last, const dlx_shm_site_t *now,
+  const dlx_shm_site_t *prev, dlx_top_row_t *rows, uint32_t max_rows
+) {
+  uint64_t diff[DLX_HIST_BUCKETS];
+  double seconds = (header->now_ns - last->now_ns) / 1e9;
+  double cyc_per_ns = (header->now_ns > header->start_ns)?
+    (double)(header->now_tsc - header->start_tsc) / (header->now_ns - header->start_ns): 1;
+  uint64_t total_wait = 0;
+  uint32_t n_row = 0;
+  for (uint32_t i = 0; i < header->n_site; i++) {
+    dlx_top_row_t *row = &rows[n_row];
+    row->now = &now[i];
+    row->d_acq = now[i].n_acq - prev[i].n_acq;
+    row->d_contended = now[i].n_contended - prev[i].n_contended;
+    row->d_wait = now[i].wait_cyc - prev[i].wait_cyc;
+    row->d_hold = now[i].hold_cyc - prev[i].hold_cyc;
+    if (!row->d_acq && !row->d_contended)
+      continue;
+    row->wait_p99 = __dlx_top_p99(now[i].wait, prev[i].wait, diff);
+    row->hold_p99 = __dlx_top_p99(now[i].hold, prev[i].hold, diff);
+    total_wait += row->d_wait;
+    n_row++;
+  }
+  qsort(rows, n_row, sizeof(dlx_top_row_t), __dlx_top_cmp);
+  if (isatty(STDOUT_FILENO))
+    printf("\033[H\033[J");
+  printf(
+    "dylinx-top  pid %u  interval %.2fs  %u sites active  %.2f cycles/ns\n\n",
+    header->pid, seconds, n_row, cyc_per_ns
+  );
+  printf(
+    "%5s %-14s %8s %12s %7s %7s %10s %10s %10s %10s\n", "SITE", "TYPE", "INS", "ACQ/S", "CONT%",
+    "WAIT%", "WAIT(ns)", "P99W(ns)", "HOLD(ns)", "P99H(ns)"
+  );
+  for (uint32_t i = 0; i < n_row && i < max_rows; i++) {
+    dlx_top_row_t *row = &rows[i];
+    double per_acq = row->d_acq? cyc_per_ns * row->d_acq: cyc_per_ns;
+    printf(
+      "%5d %-14s %8u %12.0f %7.2f %7.2f %10.1f %10.0f %10.1f %10.0f\n",
+      row->now->site_id, row->now->ltype[0]? row->now->ltype: "-", row->now->n_ins,
+      seconds > 0? row->d_acq / seconds: 0, row->d_acq? 100.0 * row->d_contended / row->d_acq: 0,
+      total_wait? 100.0 * row->d_wait / total_wait: 0, row->d_wait / per_acq, row->wait_p99 / cyc_per_ns,
+      row->d_hold / per_acq, row->hold_p99 / cyc_per_ns
+    );
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  uint32_t interval_ms = DLX_TOP_INTERVAL_MS, max_rows = DLX_TOP_SITES;
+  int64_t refreshes = -1;
+  int opt;
+  while ((opt = getopt(argc, argv, "i:n:s:")) != -1) {
+    switch (opt) {
+      case 'i':
+        interval_ms = strtoul(optarg, NULL, 10);
+        break;
+      case 'n':
+        refreshes = strtol(optarg, NULL, 10);
+        break;
+      case 's':
+        max_rows = strtoul(optarg, NULL, 10);
+        break;
+      default:
+        __dlx_top_usage(argv[0]);
+    }
+  }
+  if (optind + 1 != argc || !interval_ms)
+    __dlx_top_usage(argv[0]);
+  size_t size;
+  const dlx_shm_header_t *shm = __dlx_top_attach(argv[optind], &size);
+  uint32_t n_site = shm->n_site;
+  dlx_shm_header_t header, last;
+  dlx_shm_site_t *now = calloc(n_site, sizeof(dlx_shm_site_t));
+  dlx_shm_site_t *prev = calloc(n_site, sizeof(dlx_shm_site_t));
+  dlx_top_row_t *rows = calloc(n_site, sizeof(dlx_top_row_t));
+  if (!now || !prev || !rows || __dlx_top_snapshot(shm, &last, prev)) {
+    fprintf(stderr, "dylinx-top: cannot read the segment\n");
+    return 1;
+  }
+  struct timespec period = { interval_ms / 1000, interval_ms % 1000 * 1000000L };
+  for (; refreshes; refreshes -= refreshes > 0) {
+    nanosleep(&period, NULL);
+    if (kill(last.pid, 0) && errno == ESRCH) {
+      printf("dylinx-top: pid %u is gone\n", last.pid);
+      break;
+    }
+    if (__dlx_top_snapshot(shm, &header, now))
+      continue;
+    // The publisher has not refreshed the segment since the last round.
+    if (header.n_publish == last.n_publish)
+      continue;
+    __dlx_top_show(&header, &last, now, prev, rows, max_rows);
+    dlx_shm_site_t *swap = prev;
+    prev = now;
+    now = swap;
+    last = header;
+  }
+  munmap((void *)shm, size);
+  return 0;
+}
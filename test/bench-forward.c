@@ -0,0 +1,76 @@
+#include "dlx-test.h"
+
+// Cost of the forward functions with every feature off, against calling
+// the backend directly, for an uncontended lock. A parked thread keeps the
+// process multi-threaded, so the single-threaded fast path stays out of
+// the way. Fails when the forward path adds DLX_BENCH_BUDGET_NS or more,
+// unless built with __DYLINX_HOTSWAP__, whose count of the threads inside
+// a lock costs two atomic operations on its header.
+#define DLX_BENCH_BUDGET_NS 5.0
+#define DLX_BENCH_ITER 2000000
+#define DLX_BENCH_ROUND 7
+
+static volatile int g_done = 0;
+
+static void *__bench_park(void *arg) {
+  while (!g_done)
+    usleep(1000);
+  return NULL;
+}
+
+static double __bench_direct(dlx_generic_lock_t *mtx) {
+  double best = 1e9;
+  for (int r = 0; r < DLX_BENCH_ROUND; r++) {
+    uint64_t begin = dlx_test_now_ns();
+    for (int i = 0; i < DLX_BENCH_ITER; i++) {
+      mtx->methods->lock_fptr(mtx->lock_obj);
+      mtx->methods->unlock_fptr(mtx->lock_obj);
+    }
+    double ns = (double)(dlx_test_now_ns() - begin) / DLX_BENCH_ITER;
+    best = ns < best? ns: best;
+  }
+  return best;
+}
+
+static double __bench_forward(dlx_generic_lock_t *mtx) {
+  double best = 1e9;
+  for (int r = 0; r < DLX_BENCH_ROUND; r++) {
+    uint64_t begin = dlx_test_now_ns();
+    for (int i = 0; i < DLX_BENCH_ITER; i++) {
+      dlx_forward_enable(mtx->ind.long_id, mtx, "lock", __FILE__, __LINE__);
+      dlx_forward_disable(mtx->ind.long_id, mtx, "lock", __FILE__, __LINE__);
+    }
+    double ns = (double)(dlx_test_now_ns() - begin) / DLX_BENCH_ITER;
+    best = ns < best? ns: best;
+  }
+  return best;
+}
+
+int main() {
+  dlx_test_init(2);
+  pthread_t parked;
+  DLX_CHECK(!pthread_create(&parked, NULL, __bench_park, NULL));
+  DLX_CHECK(!g_dlx_hooks);
+  dlx_tas_t tas;
+  dlx_pthreadmtx_t native;
+  DLX_CHECK(!dlx_tas_var_init(&tas, NULL, 0, "tas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_pthreadmtx_var_init(&native, NULL, 1, "native", __FILE__, __LINE__));
+  struct { const char *name; dlx_generic_lock_t *mtx; } locks[] = {
+    { "tas", &tas.interface }, { "pthreadmtx", &native.interface }
+  };
+  int ret = 0;
+  for (uint32_t i = 0; i < sizeof(locks) / sizeof(locks[0]); i++) {
+    double direct = __bench_direct(locks[i].mtx);
+    double forward = __bench_forward(locks[i].mtx);
+    printf(
+      "%-12s direct %6.2f ns  forward %6.2f ns  overhead %5.2f ns per lock/unlock\n",
+      locks[i].name, direct, forward, forward - direct
+    );
+#ifndef __DYLINX_HOTSWAP__
+    ret |= forward - direct >= DLX_BENCH_BUDGET_NS;
+#endif
+  }
+  g_done = 1;
+  pthread_join(parked, NULL);
+  return ret;
+}
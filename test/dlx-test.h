@@ -0,0 +1,44 @@
+#ifndef __DYLINX_TEST__
+#define __DYLINX_TEST__
+
+// Behaviour tests of the glue
+// ----------------------------------------------------------------------------
+// A test defines the build flags it runs with, e.g. __DYLINX_HOTSWAP__,
+// and includes this header, which compiles the glue into the test so that
+// the test can look at its internals. The test is its own subject, it
+// registers no sites from an insertion file and reserves them instead.
+#ifndef __DYLINX_VERBOSE__
+#define __DYLINX_VERBOSE__ 3
+#endif
+
+#include "dylinx-glue.c"
+#include "dylinx-topology.c"
+#include "dylinx-numa.c"
+#include "dylinx-causal.c"
+#include "dylinx-perf.c"
+#include "dylinx-shm.c"
+#include "dylinx-control.c"
+#include "dylinx-autotune.c"
+
+void __dylinx_global_mtx_init_() {}
+
+#define DLX_CHECK(cond) do {                                                                                  \
+  if (!(cond)) {                                                                                              \
+    fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                  \
+    exit(1);                                                                                                  \
+  }                                                                                                           \
+} while(0)
+
+static inline void dlx_test_init(int32_t n_site) {
+  retrieve_native_symbol();
+  dlx_topology_init();
+  DLX_CHECK(!dlx_reserve_sites(n_site));
+}
+
+static inline uint64_t dlx_test_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+#endif // __DYLINX_TEST__
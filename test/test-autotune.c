@@ -0,0 +1,94 @@
+#define __DYLINX_HOTSWAP__
+#include "dlx-test.h"
+
+// Online autotuner. Workers report progress through the reward callback
+// and make eight times more of it while their locks run as mcs, so the
+// bandit has to settle the site on mcs, log it, and leave a site with a
+// single candidate alone. No increment may get lost across the swaps.
+#define N_LOCK 4
+#define N_WORKER 2
+#define WARMUP_MS 1500
+
+static dlx_ttas_t g_locks[N_LOCK];
+static dlx_ttas_t g_single;
+static long g_counter[N_LOCK];
+static long g_done[N_WORKER];
+static volatile uint64_t g_progress;
+static volatile int g_stop;
+
+static uint64_t __progress(void) {
+  return g_progress;
+}
+
+static void *__worker(void *arg) {
+  long *done = arg;
+  for (uint32_t k = 0; !g_stop; k++) {
+    uint32_t i = k % N_LOCK;
+    pthread_mutex_lock(&g_locks[i]);
+    g_counter[i]++;
+    (*done)++;
+    int fast = g_locks[i].interface.methods == &dlx_mcs_methods_collection;
+    pthread_mutex_unlock(&g_locks[i]);
+    __atomic_add_fetch(&g_progress, fast? 8: 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&g_single);
+    pthread_mutex_unlock(&g_single);
+    if (k % 64 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  char log_path[] = "/tmp/dlx-autotune-XXXXXX";
+  int fd = mkstemp(log_path);
+  DLX_CHECK(fd >= 0);
+  close(fd);
+  DLX_CHECK(!dlx_ttas_arr_init(g_locks, N_LOCK, 0, "g_locks", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_single, NULL, 1, "g_single", __FILE__, __LINE__));
+  DLX_CHECK(dlx_autotune_site(-1, "tas,mcs") == EINVAL);
+  DLX_CHECK(!dlx_autotune_site(0, "tas,mcs,pthreadmtx"));
+  DLX_CHECK(!dlx_autotune_site(1, "tas"));
+  DLX_CHECK(!dlx_autotune_reward(__progress));
+  DLX_CHECK(dlx_autotune_start("100:0", NULL) == EINVAL);
+
+  pthread_t tids[N_WORKER];
+  for (int i = 0; i < N_WORKER; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __worker, &g_done[i]));
+  char spec[32];
+  snprintf(spec, sizeof(spec), "%d:50", WARMUP_MS);
+  DLX_CHECK(!dlx_autotune_start(spec, log_path));
+  // The log is written once the tuner committed.
+  char log[256] = { 0 };
+  for (int i = 0; i < 200 && !strchr(log, '}'); i++) {
+    usleep(50000);
+    FILE *fp = fopen(log_path, "r");
+    if (fp) {
+      size_t n = fread(log, 1, sizeof(log) - 1, fp);
+      log[n] = '\0';
+      fclose(fp);
+    }
+  }
+  g_stop = 1;
+  for (int i = 0; i < N_WORKER; i++)
+    pthread_join(tids[i], NULL);
+  unlink(log_path);
+
+  DLX_CHECK(strstr(log, "\"0\": \"mcs\""));
+  DLX_CHECK(!strstr(log, "\"1\""));
+  DLX_CHECK(!strcmp(dlx_site_type(0), "mcs"));
+  DLX_CHECK(g_single.interface.methods == &dlx_ttas_methods_collection);
+  long total = 0, done = 0;
+  for (int i = 0; i < N_LOCK; i++) {
+    pthread_mutex_lock(&g_locks[i]);
+    pthread_mutex_unlock(&g_locks[i]);
+    DLX_CHECK(g_locks[i].interface.methods == &dlx_mcs_methods_collection);
+    total += g_counter[i];
+  }
+  for (int i = 0; i < N_WORKER; i++)
+    done += g_done[i];
+  DLX_CHECK(total == done);
+  printf("autotune: site 0 settled on mcs after %ld sections\n", total);
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include "dlx-test.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Barrier types. No thread leaves a round before every thread arrived in
+// it, exactly one thread per round is the serial one, and a destroyed
+// barrier can be initialized again for another number of threads. A
+// process-shared barrier in a shared mapping stays native, with no
+// header, and holds forked processes to the same rounds.
+#define N_THREAD 3
+#define N_ROUND 500
+
+static dlx_pthreadbarrier_t g_pthreadbarrier;
+static dlx_sensebarrier_t g_sensebarrier;
+static dlx_treebarrier_t g_treebarrier;
+static dlx_tournbarrier_t g_tournbarrier;
+static dlx_dissembarrier_t g_dissembarrier;
+static dlx_generic_barrier_t *g_bar;
+static long g_arrived, g_n_serial;
+static int g_n_thread;
+
+static void *__rounds(void *arg) {
+  for (long r = 0; r < N_ROUND; r++) {
+    __atomic_fetch_add(&g_arrived, 1, __ATOMIC_SEQ_CST);
+    int ret = pthread_barrier_wait(g_bar);
+    DLX_CHECK(!ret || ret == PTHREAD_BARRIER_SERIAL_THREAD);
+    if (ret == PTHREAD_BARRIER_SERIAL_THREAD)
+      __atomic_fetch_add(&g_n_serial, 1, __ATOMIC_SEQ_CST);
+    DLX_CHECK(__atomic_load_n(&g_arrived, __ATOMIC_SEQ_CST) >= (r + 1) * g_n_thread);
+  }
+  return NULL;
+}
+
+static void __run(int n_thread) {
+  pthread_t tids[N_THREAD];
+  g_arrived = g_n_serial = 0;
+  g_n_thread = n_thread;
+  DLX_CHECK(!pthread_barrier_init(g_bar, NULL, n_thread));
+  for (int i = 0; i < n_thread; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __rounds, NULL));
+  for (int i = 0; i < n_thread; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_arrived == (long)n_thread * N_ROUND && g_n_serial == N_ROUND);
+  DLX_CHECK(!pthread_barrier_destroy(g_bar));
+}
+
+static void __check(dlx_generic_barrier_t *bar) {
+  g_bar = bar;
+  __run(N_THREAD);
+  __run(2);
+}
+
+typedef struct {
+  dlx_sensebarrier_t bar;
+  volatile long arrived[2];
+} shared_t;
+
+static void __shared_rounds(shared_t *shared, int me) {
+  for (long r = 0; r < N_ROUND; r++) {
+    shared->arrived[me] = r + 1;
+    pthread_barrier_wait(&shared->bar);
+    DLX_CHECK(shared->arrived[!me] >= r + 1);
+    pthread_barrier_wait(&shared->bar);
+  }
+}
+
+static void __check_shared(void) {
+  shared_t *shared = mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  DLX_CHECK(shared != MAP_FAILED);
+  pthread_barrierattr_t attr;
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  DLX_CHECK(!pthread_barrier_init(&shared->bar, &attr, 2) && !DLX_BARRIER_IS_TRACKED(&shared->bar.interface));
+  pthread_barrierattr_destroy(&attr);
+  pid_t pid = fork();
+  if (!pid) {
+    __shared_rounds(shared, 1);
+    exit(0);
+  }
+  __shared_rounds(shared, 0);
+  int status;
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  DLX_CHECK(!pthread_barrier_destroy(&shared->bar));
+  DLX_CHECK(!pthread_barrier_init(&shared->bar, NULL, 1) && DLX_BARRIER_IS_TRACKED(&shared->bar.interface));
+  DLX_CHECK(pthread_barrier_wait(&shared->bar) == PTHREAD_BARRIER_SERIAL_THREAD);
+  DLX_CHECK(!pthread_barrier_destroy(&shared->bar));
+  munmap(shared, sizeof(shared_t));
+}
+
+int main() {
+  dlx_test_init(5);
+  alarm(120);
+  DLX_CHECK(!dlx_pthreadbarrier_var_init(&g_pthreadbarrier, NULL, 0, "g_pthreadbarrier", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_sensebarrier_var_init(&g_sensebarrier, NULL, 1, "g_sensebarrier", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_treebarrier_var_init(&g_treebarrier, NULL, 2, "g_treebarrier", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_tournbarrier_var_init(&g_tournbarrier, NULL, 3, "g_tournbarrier", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_dissembarrier_var_init(&g_dissembarrier, NULL, 4, "g_dissembarrier", __FILE__, __LINE__));
+  __check(&g_pthreadbarrier.interface);
+  __check(&g_sensebarrier.interface);
+  __check(&g_treebarrier.interface);
+  __check(&g_tournbarrier.interface);
+  __check(&g_dissembarrier.interface);
+  __check_shared();
+  printf("barrier: 5 types, %d rounds of %d and of 2 threads\n", N_ROUND, N_THREAD);
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include "dlx-test.h"
+#include <sys/wait.h>
+
+// Causal profiling. While an experiment speeds a site up, each section of
+// it owes the other threads its share of cycles, which they pay before
+// their next lock operation while the section's own thread does not, and
+// nothing else adds to the delay. A profiled child whose progress is
+// bound by one site's sections has to find that site worth speeding up,
+// and the empty site hardly at all.
+#define N_SECTION 200
+#define SECTION_CYC 200000
+#define N_WORKER 2
+#define EXPERIMENT_MS 20
+#define TOTAL_MS 3000
+
+static dlx_ttas_t g_slow, g_empty;
+static volatile int g_stop;
+
+static void __section(void) {
+  pthread_mutex_lock(&g_slow);
+  uint64_t begin = rdtsc_u64();
+  while (rdtsc_u64() - begin < SECTION_CYC)
+    CPU_PAUSE();
+  pthread_mutex_unlock(&g_slow);
+}
+
+static uint64_t g_ran;
+static int64_t g_owed;
+
+static void *__sped_up(void *arg) {
+  uint64_t begin = rdtsc_u64();
+  for (int i = 0; i < N_SECTION; i++)
+    __section();
+  g_ran = rdtsc_u64() - begin;
+  g_owed = __atomic_load_n(&g_causal_delay, __ATOMIC_RELAXED) - t_causal.paid;
+  return NULL;
+}
+
+static void *__worker(void *arg) {
+  while (!g_stop) {
+    __section();
+    DLX_PROGRESS();
+    pthread_mutex_lock(&g_empty);
+    pthread_mutex_unlock(&g_empty);
+  }
+  return NULL;
+}
+
+static void __profile(const char *log_path) {
+  if (fork())
+    return;
+  char spec[32];
+  snprintf(spec, sizeof(spec), "%d:%d", EXPERIMENT_MS, TOTAL_MS);
+  DLX_CHECK(!dlx_causal_start(spec, log_path));
+  pthread_t tids[N_WORKER];
+  for (int i = 0; i < N_WORKER; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __worker, NULL));
+  usleep((TOTAL_MS + 2 * EXPERIMENT_MS) * 1000);
+  g_stop = 1;
+  for (int i = 0; i < N_WORKER; i++)
+    pthread_join(tids[i], NULL);
+  exit(0);
+}
+
+// Best predicted gain of a site in the log, -1 when it is not there.
+static double __best_gain(const char *log, int32_t site_id) {
+  char key[16];
+  snprintf(key, sizeof(key), "\"%d\": {", site_id);
+  const char *at = strstr(log, key);
+  if (!at)
+    return -1;
+  double best = -1;
+  for (int i = 0; i < 4; i++) {
+    static const char *pct[] = { "\"25\": [", "\"50\": [", "\"75\": [", "\"100\": [" };
+    const char *point = strstr(at, pct[i]);
+    double gain;
+    unsigned n;
+    DLX_CHECK(point && sscanf(point + strlen(pct[i]), "%lf, %u", &gain, &n) == 2);
+    if (n && gain > best)
+      best = gain;
+  }
+  return best;
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  DLX_CHECK(!dlx_ttas_var_init(&g_slow, NULL, 0, "g_slow", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_empty, NULL, 1, "g_empty", __FILE__, __LINE__));
+  DLX_CHECK(dlx_causal_site(-1) == EINVAL);
+  DLX_CHECK(!dlx_causal_start(NULL, NULL));
+  DLX_CHECK(dlx_causal_start("0", NULL) == EINVAL && dlx_causal_start("fast", NULL) == EINVAL);
+
+  // Sections of the sped up site owe half their cycles, the main thread
+  // pays it at its next lock, the thread running them does not.
+  uint64_t ns = dlx_test_now_ns(), tsc = rdtsc_u64();
+  usleep(100000);
+  double cyc_per_ns = (double)(rdtsc_u64() - tsc) / (dlx_test_now_ns() - ns);
+  dlx_causal_speedup(0, 50, cyc_per_ns);
+  pthread_mutex_lock(&g_empty);
+  pthread_mutex_unlock(&g_empty);
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, __sped_up, NULL));
+  pthread_join(tid, NULL);
+  uint64_t begin = dlx_test_now_ns();
+  pthread_mutex_lock(&g_empty);
+  pthread_mutex_unlock(&g_empty);
+  uint64_t paid_ns = dlx_test_now_ns() - begin;
+  uint64_t n_section, delay = dlx_causal_take(&n_section);
+  DLX_CHECK(n_section == N_SECTION);
+  DLX_CHECK(delay >= N_SECTION * (SECTION_CYC / 2) && delay <= g_ran / 2);
+  DLX_CHECK(paid_ns >= 0.9 * delay / cyc_per_ns && g_owed <= 0);
+  // Over, and other sites never owed anything.
+  __section();
+  DLX_CHECK(dlx_causal_take(&n_section) == delay && n_section == N_SECTION);
+  dlx_causal_speedup(1, 100, cyc_per_ns);
+  __section();
+  DLX_CHECK(!dlx_causal_take(&n_section) && !n_section);
+
+  char log_path[] = "/tmp/dlx-causal-XXXXXX";
+  int fd = mkstemp(log_path);
+  DLX_CHECK(fd >= 0);
+  close(fd);
+  __profile(log_path);
+  int status;
+  wait(&status);
+  DLX_CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+  char log[4096] = { 0 };
+  FILE *fp = fopen(log_path, "r");
+  DLX_CHECK(fp);
+  fread(log, 1, sizeof(log) - 1, fp);
+  fclose(fp);
+  unlink(log_path);
+  unsigned n_base;
+  const char *base = strstr(log, "\"experiments\": ");
+  DLX_CHECK(base && sscanf(base, "\"experiments\": %u", &n_base) == 1 && n_base > 0);
+  double slow = __best_gain(log, 0), empty = __best_gain(log, 1);
+  DLX_CHECK(slow > 0.2 && slow > empty + 0.1);
+  printf("causal: speeding up the slow site predicts %+.0f%%, the empty one %+.0f%%\n", 100 * slow, 100 * empty);
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include "dlx-test.h"
+
+// Compact lock types. Two threads hand a turn back and forth through a
+// condition variable on a tas and a ticket16 lock, so each signal races
+// with the other thread going to sleep; a lost wakeup stalls the ping-pong
+// and the alarm fails the test. Signals on a condition variable nobody
+// waits on with a compact lock leave the stripes alone. The footprint of
+// the compact sites has to come out below the one of a queue lock site.
+#define N_ROUND 20000
+#define N_FOOTPRINT 16
+
+static dlx_tas_t g_tas;
+static dlx_ticket16_t g_ticket16;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static volatile int g_turn;
+
+static void *__pingpong_tas(void *arg) {
+  int me = (int)(intptr_t)arg;
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_tas);
+    while (g_turn != me)
+      pthread_cond_wait(&g_cond, &g_tas);
+    g_turn = !me;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_tas);
+  }
+  return NULL;
+}
+
+static void *__pingpong_ticket16(void *arg) {
+  int me = (int)(intptr_t)arg;
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_ticket16);
+    while (g_turn != me)
+      pthread_cond_wait(&g_cond, &g_ticket16);
+    g_turn = !me;
+    pthread_cond_broadcast(&g_cond);
+    pthread_mutex_unlock(&g_ticket16);
+  }
+  return NULL;
+}
+
+static void __pingpong(void *(*body)(void *)) {
+  pthread_t tids[2];
+  g_turn = 0;
+  for (intptr_t i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, body, (void *)i));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+}
+
+int main() {
+  dlx_test_init(5);
+  alarm(60);
+  DLX_CHECK(!dlx_tas_var_init(&g_tas, NULL, 0, "g_tas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket16_var_init(&g_ticket16, NULL, 1, "g_ticket16", __FILE__, __LINE__));
+  __pingpong(__pingpong_tas);
+  __pingpong(__pingpong_ticket16);
+
+  // Timed waits on a compact lock time out with the lock held again.
+  struct timespec until;
+  clock_gettime(CLOCK_REALTIME, &until);
+  until.tv_nsec += 10000000;
+  if (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  pthread_mutex_lock(&g_tas);
+  DLX_CHECK(pthread_cond_timedwait(&g_cond, &g_tas, &until) == ETIMEDOUT);
+  DLX_CHECK(pthread_mutex_trylock(&g_tas) != 0);
+  pthread_mutex_unlock(&g_tas);
+  compact_stripe_t *stripe = __compact_stripe_of(&g_cond);
+  uint64_t seq = stripe->seq;
+  DLX_CHECK(!stripe->n_wait);
+  pthread_cond_signal(&g_cond);
+  pthread_cond_broadcast(&g_cond);
+  DLX_CHECK(stripe->seq == seq);
+
+  dlx_tas_t tas[N_FOOTPRINT];
+  dlx_ticket16_t ticket16[N_FOOTPRINT];
+  dlx_mcs_t mcs[N_FOOTPRINT];
+  DLX_CHECK(!dlx_tas_arr_init(tas, N_FOOTPRINT, 2, "tas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket16_arr_init(ticket16, N_FOOTPRINT, 3, "ticket16", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_mcs_arr_init(mcs, N_FOOTPRINT, 4, "mcs", __FILE__, __LINE__));
+  for (int32_t site = 2; site <= 4; site++)
+    DLX_CHECK(g_site_state[site].footprint.n_live == N_FOOTPRINT);
+  DLX_CHECK(g_site_state[2].footprint.bytes < g_site_state[4].footprint.bytes);
+  DLX_CHECK(g_site_state[3].footprint.bytes < g_site_state[4].footprint.bytes);
+  for (int i = 0; i < N_FOOTPRINT; i++)
+    pthread_mutex_destroy(&tas[i]);
+  DLX_CHECK(g_site_state[2].footprint.n_live == 0 && g_site_state[2].footprint.bytes == 0);
+  printf(
+    "compact: %d round trips each, %lu bytes for %d tas against %lu for mcs\n", N_ROUND,
+    (unsigned long)g_site_state[2].footprint.peak, N_FOOTPRINT, (unsigned long)g_site_state[4].footprint.bytes
+  );
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "dlx-test.h"
+#include <sys/wait.h>
+
+// Lock event rings. A child process traces a short script whose events
+// are known one by one: each thread's events reach the file complete and
+// in order, with their site, instance and op, releases pair up with their
+// own acquisition when locks nest, and the wait and hold deltas show the
+// sleeping holder. The header accounts for the events and the threads.
+#define HOLD_US 20000
+// Cycles a HOLD_US sleep surely exceeds, at a TSC of 100MHz or more.
+#define LONG_CYC (HOLD_US * 100ull)
+#define N_MAIN 12
+#define N_WAITER 4
+
+static dlx_ttas_t g_locks[2];
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+
+typedef struct dlx_expect {
+  uint8_t op;
+  uint32_t ins_id;
+  int slow;
+} dlx_expect_t;
+
+static const dlx_expect_t g_main[N_MAIN] = {
+  { DLX_TRACE_ACQUIRE, 0, 0 }, { DLX_TRACE_RELEASE, 0, 0 },
+  { DLX_TRACE_ACQUIRE, 0, 0 }, { DLX_TRACE_ACQUIRE, 1, 0 }, { DLX_TRACE_RELEASE, 0, 0 }, { DLX_TRACE_RELEASE, 1, 0 },
+  { DLX_TRACE_ACQUIRE, 0, 0 }, { DLX_TRACE_RELEASE, 0, 1 },
+  { DLX_TRACE_ACQUIRE, 0, 0 }, { DLX_TRACE_RELEASE, 0, 0 }, { DLX_TRACE_REACQUIRE, 0, 0 }, { DLX_TRACE_RELEASE, 0, 0 }
+};
+
+static const dlx_expect_t g_waiter[N_WAITER] = {
+  { DLX_TRACE_TRYFAIL, 0, 0 }, { DLX_TRACE_TIMEOUT, 0, 0 }, { DLX_TRACE_ACQUIRE, 0, 1 }, { DLX_TRACE_RELEASE, 0, 0 }
+};
+
+static void __deadline(struct timespec *until, long ns) {
+  clock_gettime(CLOCK_REALTIME, until);
+  until->tv_nsec += ns;
+  if (until->tv_nsec >= 1000000000) {
+    until->tv_sec++;
+    until->tv_nsec -= 1000000000;
+  }
+}
+
+static void *__waiter(void *arg) {
+  struct timespec until;
+  DLX_CHECK(pthread_mutex_trylock(&g_locks[0]) == EBUSY);
+  __deadline(&until, 100000);
+  DLX_CHECK(pthread_mutex_timedlock(&g_locks[0], &until) == ETIMEDOUT);
+  pthread_mutex_lock(&g_locks[0]);
+  pthread_mutex_unlock(&g_locks[0]);
+  return NULL;
+}
+
+static void __run_traced(const char *path) {
+  if (fork())
+    return;
+  DLX_CHECK(!dlx_trace_start(path));
+  pthread_mutex_lock(&g_locks[0]);
+  pthread_mutex_unlock(&g_locks[0]);
+  pthread_mutex_lock(&g_locks[0]);
+  pthread_mutex_lock(&g_locks[1]);
+  pthread_mutex_unlock(&g_locks[0]);
+  pthread_mutex_unlock(&g_locks[1]);
+  pthread_mutex_lock(&g_locks[0]);
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, __waiter, NULL));
+  usleep(HOLD_US);
+  pthread_mutex_unlock(&g_locks[0]);
+  pthread_join(tid, NULL);
+  struct timespec until;
+  pthread_mutex_lock(&g_locks[0]);
+  __deadline(&until, 100000);
+  DLX_CHECK(pthread_cond_timedwait(&g_cond, &g_locks[0], &until) == ETIMEDOUT);
+  pthread_mutex_unlock(&g_locks[0]);
+  exit(0);
+}
+
+static void __check_event(const dlx_trace_event_t *ev, const dlx_expect_t *expect) {
+  DLX_CHECK(ev->op == expect->op && ev->site_id == 0 && ev->ins_id == expect->ins_id);
+  DLX_CHECK(expect->slow? ev->delta >= LONG_CYC: ev->delta < LONG_CYC);
+}
+
+int main() {
+  dlx_test_init(1);
+  alarm(60);
+  DLX_CHECK(!dlx_ttas_arr_init(g_locks, 2, 0, "g_locks", __FILE__, __LINE__));
+  char path[] = "/tmp/dlx-events-XXXXXX";
+  int fd = mkstemp(path);
+  DLX_CHECK(fd >= 0);
+  close(fd);
+  __run_traced(path);
+  int status;
+  pid_t pid = wait(&status);
+  DLX_CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+
+  FILE *file = fopen(path, "rb");
+  DLX_CHECK(file);
+  char pad[DLX_TRACE_HEADER];
+  dlx_trace_header_t header;
+  DLX_CHECK(fread(pad, DLX_TRACE_HEADER, 1, file) == 1);
+  memcpy(&header, pad, sizeof(header));
+  DLX_CHECK(!memcmp(header.magic, "DLXTRACE", 8) && header.event_size == sizeof(dlx_trace_event_t));
+  DLX_CHECK(header.pid == (uint32_t)pid && header.n_thread == 2 && header.max_period == 1);
+  DLX_CHECK(header.n_event == N_MAIN + N_WAITER && !header.n_dropped);
+  DLX_CHECK(header.start_tsc < header.end_tsc && header.start_ns < header.end_ns);
+
+  // Threads are numbered in the order they first emit.
+  uint32_t seen[2] = { 0 };
+  uint64_t last_tsc[2] = { 0 };
+  dlx_trace_event_t ev;
+  while (fread(&ev, sizeof(ev), 1, file) == 1) {
+    DLX_CHECK(ev.thread < 2 && ev.tsc >= header.start_tsc && ev.tsc <= header.end_tsc);
+    DLX_CHECK(ev.tsc >= last_tsc[ev.thread]);
+    last_tsc[ev.thread] = ev.tsc;
+    if (ev.thread == 0) {
+      DLX_CHECK(seen[0] < N_MAIN);
+      __check_event(&ev, &g_main[seen[0]++]);
+    } else {
+      DLX_CHECK(seen[1] < N_WAITER);
+      __check_event(&ev, &g_waiter[seen[1]++]);
+    }
+  }
+  fclose(file);
+  unlink(path);
+  DLX_CHECK(seen[0] == N_MAIN && seen[1] == N_WAITER);
+  printf("events: %d events of 2 threads traced in order\n", N_MAIN + N_WAITER);
+  return 0;
+}
@@ -0,0 +1,91 @@
+#define __DYLINX_HOTSWAP__
+#include "dlx-test.h"
+
+// Re-homing of FOLLOW backends. The test gives the topology a second node
+// and moves every CPU onto it once the locks are built, so the sampled
+// votes of the only thread have to move a FOLLOW backend to the new node,
+// and only that one: a LOCAL lock stays put, and a held lock is never
+// rebuilt under its holder. The lock keeps counting on the new backend.
+#define N_SETTLE 2000
+#define N_MAX_ROUND 1000000
+#define N_ROUND 20000
+
+static dlx_ttas_t g_follow, g_local;
+static long g_counter;
+static int32_t g_node_os[2];
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_follow);
+    g_counter++;
+    pthread_mutex_unlock(&g_follow);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void __use(void) {
+  pthread_mutex_lock(&g_follow);
+  g_counter++;
+  pthread_mutex_unlock(&g_follow);
+  pthread_mutex_lock(&g_local);
+  pthread_mutex_unlock(&g_local);
+}
+
+static int32_t __arena_node(const void *p) {
+  dlx_chunk_t *chunk = __dlx_chunk_of(p);
+  return chunk? chunk->node: -1;
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  dlx_topology_t *topo = &g_dlx_topology;
+  int32_t *cpu_node = calloc(topo->n_cpu, sizeof(int32_t));
+  DLX_CHECK(cpu_node);
+  g_node_os[0] = topo->node_os[0];
+  g_node_os[1] = topo->node_os[topo->n_node - 1] + 1;
+  topo->n_node = 2;
+  topo->node_os = g_node_os;
+  topo->cpu_node = cpu_node;
+  DLX_CHECK(!dlx_set_site_place(0, DLX_PLACE_FOLLOW, 0));
+  DLX_CHECK(!dlx_set_site_place(1, DLX_PLACE_LOCAL, 0));
+  DLX_CHECK(!dlx_ttas_var_init(&g_follow, NULL, 0, "g_follow", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_local, NULL, 1, "g_local", __FILE__, __LINE__));
+  void *built = g_follow.interface.lock_obj, *local = g_local.interface.lock_obj;
+  DLX_CHECK(__arena_node(built) == 0 && __arena_node(local) == 0);
+
+  // Votes for the node the backend is on keep it there.
+  for (int i = 0; i < N_SETTLE; i++)
+    __use();
+  DLX_CHECK(g_follow.interface.lock_obj == built && !g_site_state[0].n_rehomed);
+
+  for (uint32_t cpu = 0; cpu < topo->n_cpu; cpu++)
+    cpu_node[cpu] = 1;
+  // A held lock is left alone whatever the votes say.
+  pthread_mutex_lock(&g_follow);
+  __dlx_rehome(&g_follow.interface, &g_site_state[0], 1);
+  DLX_CHECK(g_follow.interface.lock_obj == built && !g_site_state[0].n_rehomed);
+  pthread_mutex_unlock(&g_follow);
+
+  int round = 0;
+  while (g_follow.interface.lock_obj == built && round++ < N_MAX_ROUND)
+    __use();
+  DLX_CHECK(g_follow.interface.lock_obj != built);
+  DLX_CHECK(g_site_state[0].n_rehomed == 1 && __arena_node(g_follow.interface.lock_obj) == 1);
+  DLX_CHECK(DLX_HOME_NODE(g_follow.interface.home) == 2);
+  DLX_CHECK(g_local.interface.lock_obj == local && !g_site_state[1].n_rehomed);
+  DLX_CHECK(g_follow.interface.methods == &dlx_ttas_methods_collection);
+
+  long settled = g_counter;
+  DLX_CHECK(settled == N_SETTLE + round);
+  pthread_t tids[2];
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == settled + 2 * N_ROUND);
+  printf("follow: backend moved to the second node after %d acquisitions there\n", round);
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "dlx-test.h"
+
+// Wait and hold histograms. Buckets cover every value within an eighth of
+// it and quantiles land on the right bucket. At runtime each site's
+// histograms account for every acquisition and every sampled hold, a
+// site holding its lock across a sleep shows it in its hold quantiles,
+// a waiter behind the sleeper in its wait tail and in the histogram of
+// the instance, and the per-type histograms keep ttas and mcs apart.
+#define N_SHORT 1600
+#define N_LONG 64
+#define LONG_US 500
+#define HOLD_US 10000
+
+static dlx_ttas_t g_short;
+static dlx_mcs_t g_long[2];
+
+static void *__hold_long(void *arg) {
+  for (int i = 0; i < N_LONG; i++) {
+    pthread_mutex_lock(&g_long[0]);
+    usleep(LONG_US);
+    pthread_mutex_unlock(&g_long[0]);
+  }
+  return NULL;
+}
+
+static void *__wait_holder(void *arg) {
+  pthread_mutex_lock(&g_long[1]);
+  pthread_mutex_unlock(&g_long[1]);
+  return NULL;
+}
+
+static uint64_t __sum(const uint64_t *buckets) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < DLX_HIST_BUCKETS; i++)
+    total += buckets[i];
+  return total;
+}
+
+static void __check_buckets(void) {
+  uint32_t last = 0;
+  for (uint64_t v = 0; v < (1ull << DLX_HIST_BITS); v = v < 64? v + 1: v + v / 7) {
+    uint32_t bucket = dlx_hist_bucket(v);
+    DLX_CHECK(bucket < DLX_HIST_BUCKETS - 1 && bucket >= last);
+    DLX_CHECK(dlx_hist_upper(bucket) >= v && (!bucket || dlx_hist_upper(bucket - 1) < v));
+    DLX_CHECK(dlx_hist_upper(bucket) - v <= v / DLX_HIST_SUB);
+    last = bucket;
+  }
+  DLX_CHECK(dlx_hist_bucket(1ull << DLX_HIST_BITS) == DLX_HIST_BUCKETS - 1);
+  DLX_CHECK(dlx_hist_bucket(UINT64_MAX) == DLX_HIST_BUCKETS - 1);
+
+  static uint64_t buckets[DLX_HIST_BUCKETS];
+  DLX_CHECK(!dlx_hist_quantile(buckets, 0.5));
+  buckets[dlx_hist_bucket(1000)] = 999;
+  buckets[dlx_hist_bucket(1000000)] = 1;
+  DLX_CHECK(dlx_hist_quantile(buckets, 0.5) == dlx_hist_upper(dlx_hist_bucket(1000)));
+  DLX_CHECK(dlx_hist_quantile(buckets, 0.99) == dlx_hist_upper(dlx_hist_bucket(1000)));
+  DLX_CHECK(dlx_hist_quantile(buckets, 1) == dlx_hist_upper(dlx_hist_bucket(1000000)));
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  __check_buckets();
+  DLX_CHECK(!dlx_stats_instances("1"));
+  DLX_CHECK(!dlx_stats_start());
+  DLX_CHECK(!dlx_ttas_var_init(&g_short, NULL, 0, "g_short", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_mcs_arr_init(g_long, 2, 1, "g_long", __FILE__, __LINE__));
+  for (int i = 0; i < N_SHORT; i++) {
+    pthread_mutex_lock(&g_short);
+    pthread_mutex_unlock(&g_short);
+  }
+  // A thread of its own, so that its holds are sampled from the first on.
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, __hold_long, NULL));
+  pthread_join(tid, NULL);
+  pthread_mutex_lock(&g_long[1]);
+  DLX_CHECK(!pthread_create(&tid, NULL, __wait_holder, NULL));
+  usleep(HOLD_US);
+  pthread_mutex_unlock(&g_long[1]);
+  pthread_join(tid, NULL);
+
+  static dlx_lock_hist_t short_hist, long_hist, type_hist;
+  dlx_lock_stats_t stats;
+  DLX_CHECK(!dlx_stats_hist(0, &short_hist) && !dlx_stats_site(0, &stats));
+  DLX_CHECK(short_hist.n_acq == N_SHORT && __sum(short_hist.wait) == N_SHORT);
+  DLX_CHECK(__sum(short_hist.hold) == stats.n_hold && stats.n_hold == N_SHORT / DLX_STAT_HOLD_SAMPLE);
+  DLX_CHECK(!dlx_stats_hist(1, &long_hist) && !dlx_stats_site(1, &stats));
+  DLX_CHECK(long_hist.n_acq == N_LONG + 2 && __sum(long_hist.wait) == N_LONG + 2);
+  DLX_CHECK(__sum(long_hist.hold) == stats.n_hold && stats.n_hold >= N_LONG / DLX_STAT_HOLD_SAMPLE);
+  uint64_t short_p50 = dlx_hist_quantile(short_hist.hold, 0.5);
+  DLX_CHECK(dlx_hist_quantile(long_hist.hold, 0.5) > 100 * short_p50);
+  // The waiter behind the 10ms hold waited far longer than a hold of 500us.
+  DLX_CHECK(dlx_hist_quantile(long_hist.wait, 1) > 10 * dlx_hist_quantile(long_hist.hold, 0.5));
+  DLX_CHECK(dlx_stats_hist(2, &long_hist) == EINVAL);
+
+  uint64_t wait[DLX_HIST_BUCKETS];
+  DLX_CHECK(__dlx_stat_ins_hist(g_long[1].interface.ind.long_id, wait) >= 1);
+  DLX_CHECK(dlx_hist_quantile(wait, 1) == dlx_hist_quantile(long_hist.wait, 1));
+
+  DLX_CHECK(!dlx_stats_type_hist("ttas", &type_hist) && type_hist.n_acq == N_SHORT);
+  DLX_CHECK(!dlx_stats_type_hist("MCS", &type_hist) && type_hist.n_acq == N_LONG + 2);
+  DLX_CHECK(dlx_stats_type_hist("nolock", &type_hist) == EINVAL);
+  DLX_CHECK(dlx_stats_type_hist(NULL, &type_hist) == EINVAL);
+  printf(
+    "hist: hold p50 %lu cycles on the short site, %lu on the sleeping one\n", (unsigned long)short_p50,
+    (unsigned long)dlx_hist_quantile(long_hist.hold, 0.5)
+  );
+  return 0;
+}
@@ -0,0 +1,131 @@
+#define __DYLINX_HOTSWAP__
+#include "dlx-test.h"
+
+// Swaps the type of a site under threads that keep entering its locks,
+// some of them through condition waits, and checks that no increment got
+// lost and that every instance ends up on the last type. A recursive
+// mutex on another site has to stay on its backend and stay recursive.
+// The control socket swaps too, and only its owner may connect.
+#define N_LOCK 4
+#define N_WORKER 3
+#define N_ROUND 12
+
+static dlx_ttas_t g_locks[N_LOCK];
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static long g_counter[N_LOCK];
+static long g_done[N_WORKER + 1];
+static volatile int g_stop = 0;
+
+static void *__worker(void *arg) {
+  long *done = arg;
+  for (uint32_t k = 0; !g_stop; k++) {
+    uint32_t i = k % N_LOCK;
+    pthread_mutex_lock(&g_locks[i]);
+    g_counter[i]++;
+    (*done)++;
+    pthread_mutex_unlock(&g_locks[i]);
+    if (k % 64 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void *__waiter(void *arg) {
+  long *done = arg;
+  while (!g_stop) {
+    pthread_mutex_lock(&g_locks[0]);
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += 1000000;
+    if (until.tv_nsec >= 1000000000) {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&g_cond, &g_locks[0], &until);
+    g_counter[0]++;
+    (*done)++;
+    pthread_mutex_unlock(&g_locks[0]);
+  }
+  return NULL;
+}
+
+int main() {
+  static const char *types[] = { "mcs", "ticket", "backoff", "pthreadmtx" };
+  static const dlx_injected_interface_t *methods[] = {
+    &dlx_mcs_methods_collection, &dlx_ticket_methods_collection,
+    &dlx_backoff_methods_collection, &dlx_pthreadmtx_methods_collection
+  };
+  dlx_test_init(2);
+  DLX_CHECK(!dlx_ttas_arr_init(g_locks, N_LOCK, 0, "g_locks", __FILE__, __LINE__));
+  pthread_t tids[N_WORKER + 1];
+  for (int i = 0; i < N_WORKER; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __worker, &g_done[i]));
+  DLX_CHECK(!pthread_create(&tids[N_WORKER], NULL, __waiter, &g_done[N_WORKER]));
+  for (int r = 0; r < N_ROUND; r++) {
+    usleep(50000);
+    DLX_CHECK(!dlx_set_site_type(0, types[r % 4]));
+  }
+  g_stop = 1;
+  for (int i = 0; i <= N_WORKER; i++)
+    pthread_join(tids[i], NULL);
+  long total = 0, done = 0;
+  for (int i = 0; i < N_LOCK; i++)
+    total += g_counter[i];
+  for (int i = 0; i <= N_WORKER; i++)
+    done += g_done[i];
+  DLX_CHECK(total == done);
+  // Idle instances migrate the next time they are entered.
+  uint32_t epoch, n_migrated, n_ins;
+  for (int i = 0; i < N_LOCK; i++) {
+    pthread_mutex_lock(&g_locks[i]);
+    pthread_mutex_unlock(&g_locks[i]);
+    DLX_CHECK(g_locks[i].interface.methods == methods[(N_ROUND - 1) % 4]);
+  }
+  DLX_CHECK(!dlx_site_swap_state(0, &epoch, &n_migrated, &n_ins));
+  DLX_CHECK(epoch == N_ROUND && n_ins == N_LOCK && n_migrated == N_LOCK);
+
+  // A recursive mutex keeps its backend, a default one next to it moves.
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  dlx_pthreadmtx_t recursive, plain;
+  DLX_CHECK(!dlx_pthreadmtx_var_init(&recursive, &attr, 1, "recursive", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_pthreadmtx_var_init(&plain, NULL, 1, "plain", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_set_site_type(1, "tas"));
+  for (int i = 0; i < 2; i++) {
+    DLX_CHECK(!pthread_mutex_lock(&recursive));
+    DLX_CHECK(!pthread_mutex_lock(&recursive));
+    DLX_CHECK(!pthread_mutex_unlock(&recursive));
+    DLX_CHECK(!pthread_mutex_unlock(&recursive));
+    DLX_CHECK(!pthread_mutex_lock(&plain));
+    DLX_CHECK(!pthread_mutex_unlock(&plain));
+  }
+  DLX_CHECK(recursive.interface.methods == &dlx_pthreadmtx_methods_collection);
+  DLX_CHECK(plain.interface.methods == &dlx_tas_methods_collection);
+  DLX_CHECK(!dlx_site_swap_state(1, &epoch, &n_migrated, &n_ins));
+  DLX_CHECK(n_migrated == 1 && n_ins == 2);
+
+  char path[] = "/tmp/dlx-control-XXXXXX";
+  DLX_CHECK(mkdtemp(path));
+  char sock[64];
+  snprintf(sock, sizeof(sock), "%s/sock", path);
+  umask(0);
+  DLX_CHECK(!dlx_control_start(sock));
+  struct stat st;
+  DLX_CHECK(!stat(sock, &st) && (st.st_mode & 0777) == 0600);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  strcpy(addr.sun_path, sock);
+  DLX_CHECK(!connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+  char reply[64] = { 0 };
+  DLX_CHECK(write(fd, "type 1 ttas\n", 12) == 12 && read(fd, reply, sizeof(reply) - 1) > 0);
+  DLX_CHECK(!dlx_site_swap_state(1, &epoch, &n_migrated, &n_ins));
+  char expect[16];
+  snprintf(expect, sizeof(expect), "ok %u\n", epoch);
+  DLX_CHECK(!strcmp(reply, expect) && epoch == 2);
+  close(fd);
+  unlink(sock);
+  rmdir(path);
+  printf("hot swap: %ld sections over %d swaps\n", total, N_ROUND);
+  return 0;
+}
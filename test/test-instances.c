@@ -0,0 +1,58 @@
+#include "dlx-test.h"
+
+// Instance ids and per-instance types. Ids count the locks of a site in
+// initialization order, the elements of one array consecutively even
+// while other threads initialize arrays of the same site, and rules pick
+// instances by those ids.
+#define N_THREAD 4
+#define N_ELEM 64
+
+static dlx_ttas_t g_arrays[N_THREAD][N_ELEM];
+
+static void *__init_array(void *arg) {
+  dlx_ttas_t *head = arg;
+  for (int i = 0; i < 8; i++)
+    sched_yield();
+  DLX_CHECK(!dlx_ttas_arr_init(head, N_ELEM, 1, "array", __FILE__, __LINE__));
+  return NULL;
+}
+
+int main() {
+  dlx_test_init(2);
+  DLX_CHECK(!dlx_set_instance_type(0, 2, 6, &dlx_mcs_methods_collection, -1));
+  dlx_ttas_t first[4], second[4];
+  DLX_CHECK(!dlx_ttas_arr_init(first, 4, 0, "first", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_arr_init(second, 4, 0, "second", __FILE__, __LINE__));
+  for (uint32_t i = 0; i < 4; i++) {
+    DLX_CHECK(first[i].interface.ind.pair.ins_id == i);
+    DLX_CHECK(second[i].interface.ind.pair.ins_id == 4 + i);
+    // The rule covers ids 2-5, i.e. the tail of the first array and the
+    // head of the second.
+    const dlx_injected_interface_t *want = i >= 2? &dlx_mcs_methods_collection: &dlx_ttas_methods_collection;
+    DLX_CHECK(first[i].interface.methods == want);
+    want = i < 2? &dlx_mcs_methods_collection: &dlx_ttas_methods_collection;
+    DLX_CHECK(second[i].interface.methods == want);
+  }
+  // Padded arrays are numbered the same way.
+  dlx_ttas_iso_t iso[3];
+  DLX_CHECK(!dlx_ttas_iso_arr_init(iso, 3, 0, "iso", __FILE__, __LINE__));
+  for (uint32_t i = 0; i < 3; i++)
+    DLX_CHECK(iso[i].interface.ind.pair.ins_id == 8 + i);
+
+  pthread_t tids[N_THREAD];
+  for (int t = 0; t < N_THREAD; t++)
+    DLX_CHECK(!pthread_create(&tids[t], NULL, __init_array, g_arrays[t]));
+  for (int t = 0; t < N_THREAD; t++)
+    pthread_join(tids[t], NULL);
+  uint8_t seen[N_THREAD * N_ELEM] = { 0 };
+  for (int t = 0; t < N_THREAD; t++) {
+    uint32_t base = g_arrays[t][0].interface.ind.pair.ins_id;
+    DLX_CHECK(base % N_ELEM == 0 && base < N_THREAD * N_ELEM);
+    for (uint32_t i = 0; i < N_ELEM; i++) {
+      DLX_CHECK(g_arrays[t][i].interface.ind.pair.ins_id == base + i);
+      DLX_CHECK(!seen[base + i]++);
+    }
+  }
+  printf("instances: rules and array numbering hold\n");
+  return 0;
+}
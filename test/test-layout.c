@@ -0,0 +1,79 @@
+#include "dlx-test.h"
+
+// Lock layouts. An isolated lock fills an aligned prefetch pair of its own,
+// its site pads and aligns the backend the same way and accounts for the
+// padding, while a default site keeps its locks packed. Neighbouring
+// isolated locks stay independent locks.
+#define N_LOCK 4
+#define N_ROUND 20000
+
+static dlx_ttas_iso_t g_isolated[N_LOCK];
+static dlx_ttas_t g_packed[N_LOCK];
+static long g_counter[N_LOCK];
+
+static void *__count(void *arg) {
+  long i = (long)arg;
+  for (int k = 0; k < N_ROUND; k++) {
+    pthread_mutex_lock(&g_isolated[i].interface);
+    g_counter[i]++;
+    pthread_mutex_unlock(&g_isolated[i].interface);
+    if (k % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+int main() {
+  dlx_test_init(3);
+  alarm(60);
+  const dlx_topology_t *topo = dlx_topology();
+  DLX_CHECK(sizeof(dlx_ttas_iso_t) == DLX_PREFETCH_PAIR && _Alignof(dlx_ttas_iso_t) == DLX_PREFETCH_PAIR);
+  DLX_CHECK(sizeof(dlx_ttas_t) == sizeof(pthread_mutex_t));
+  DLX_CHECK(dlx_set_site_layout(0, DLX_LAYOUT_COLOCATE + 1) == EINVAL);
+  DLX_CHECK(dlx_set_site_layout(-1, DLX_LAYOUT_ISOLATE) == EINVAL);
+  DLX_CHECK(!dlx_set_site_layout(0, DLX_LAYOUT_ISOLATE));
+  DLX_CHECK(!dlx_set_site_layout(2, DLX_LAYOUT_COLOCATE));
+  DLX_CHECK(!dlx_ttas_iso_arr_init(g_isolated, N_LOCK, 0, "g_isolated", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_arr_init(g_packed, N_LOCK, 1, "g_packed", __FILE__, __LINE__));
+  dlx_ttas_t colocated;
+  DLX_CHECK(!dlx_ttas_var_init(&colocated, NULL, 2, "colocated", __FILE__, __LINE__));
+  DLX_CHECK(dlx_site_conf(2)->layout == DLX_LAYOUT_COLOCATE);
+
+  // No two isolated backends share a prefetch pair.
+  uintptr_t pair[N_LOCK];
+  for (int i = 0; i < N_LOCK; i++) {
+    DLX_CHECK(!((uintptr_t)&g_isolated[i] % DLX_PREFETCH_PAIR));
+    DLX_CHECK(g_isolated[i].interface.check_code == 0x32CB00B5);
+    uintptr_t obj = (uintptr_t)g_isolated[i].interface.lock_obj;
+    DLX_CHECK(!(obj % topo->prefetch_pair));
+    pair[i] = obj / topo->prefetch_pair;
+    for (int j = 0; j < i; j++)
+      DLX_CHECK(pair[j] != pair[i]);
+    DLX_CHECK(!((uintptr_t)g_packed[i].interface.lock_obj % L_CACHE_LINE_SIZE));
+    DLX_CHECK(g_packed[i].interface.check_code == 0x32CB00B5);
+  }
+  size_t backend = dlx_ttas_methods_collection.backend_size;
+  DLX_CHECK(g_site_state[0].footprint.bytes == N_LOCK * (DLX_PREFETCH_PAIR + backend));
+  DLX_CHECK(g_site_state[1].footprint.bytes == N_LOCK * (sizeof(dlx_generic_lock_t) + backend));
+
+  // Holding one isolated lock leaves its neighbours free.
+  pthread_mutex_lock(&g_isolated[1].interface);
+  DLX_CHECK(!pthread_mutex_trylock(&g_isolated[0].interface));
+  DLX_CHECK(!pthread_mutex_trylock(&g_isolated[2].interface));
+  pthread_mutex_unlock(&g_isolated[2].interface);
+  pthread_mutex_unlock(&g_isolated[0].interface);
+  pthread_mutex_unlock(&g_isolated[1].interface);
+
+  pthread_t tids[N_LOCK];
+  for (long i = 0; i < N_LOCK; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, (void *)i));
+  for (int i = 0; i < N_LOCK; i++)
+    pthread_join(tids[i], NULL);
+  for (int i = 0; i < N_LOCK; i++)
+    DLX_CHECK(g_counter[i] == N_ROUND);
+  printf(
+    "layout: isolated locks take %d bytes and a prefetch pair of %u for each backend\n", DLX_PREFETCH_PAIR,
+    topo->prefetch_pair
+  );
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include "dlx-test.h"
+
+// Per-site tunables. Every instance copies the values of its site at
+// init, a zero slot keeps the default of the type, tunables combine with
+// a waiting policy, and a later change of the site only reaches locks
+// initialized after it.
+#define N_ROUND 20000
+
+static long g_counter;
+static dlx_generic_lock_t *g_lock;
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(g_lock);
+    g_counter++;
+    pthread_mutex_unlock(g_lock);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void __count_under(dlx_generic_lock_t *lock) {
+  pthread_t tids[2];
+  g_lock = lock;
+  g_counter = 0;
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == 2 * N_ROUND);
+}
+
+int main() {
+  dlx_test_init(5);
+  alarm(120);
+  DLX_CHECK(dlx_set_site_param(0, DLX_LOCK_PARAM_MAX, 1) == EINVAL);
+  DLX_CHECK(dlx_set_site_param(-1, 0, 1) == EINVAL);
+  DLX_CHECK(!dlx_set_site_param(0, BACKOFF_PARAM_MIN, 64));
+  DLX_CHECK(!dlx_set_site_param(0, BACKOFF_PARAM_MAX, 4096));
+  DLX_CHECK(!dlx_set_site_param(1, BACKOFF_PARAM_MIN, 128));
+  DLX_CHECK(!dlx_set_site_param(2, TICKET_PARAM_BASE, 8));
+  DLX_CHECK(!dlx_set_site_wait(2, DLX_WAIT_PARK, 0, 0, 0));
+  DLX_CHECK(!dlx_set_site_param(3, ADAPTIVEMTX_PARAM_SPIN, 100));
+
+  dlx_backoff_t bounded, min_only, default_backoff, moved;
+  dlx_ticket_t ticket, default_ticket;
+  dlx_adaptivemtx_t adaptive, default_adaptive;
+  DLX_CHECK(!dlx_backoff_var_init(&bounded, NULL, 0, "bounded", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_backoff_var_init(&min_only, NULL, 1, "min_only", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_backoff_var_init(&default_backoff, NULL, 4, "default_backoff", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket_var_init(&ticket, NULL, 2, "ticket", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket_var_init(&default_ticket, NULL, 4, "default_ticket", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_adaptivemtx_var_init(&adaptive, NULL, 3, "adaptive", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_adaptivemtx_var_init(&default_adaptive, NULL, 4, "default_adaptive", __FILE__, __LINE__));
+
+  backoff_lock_t *backoff = bounded.interface.lock_obj;
+  DLX_CHECK(backoff->wait.min == 64 && backoff->wait.max == 4096);
+  backoff = min_only.interface.lock_obj;
+  DLX_CHECK(backoff->wait.min == 128 && backoff->wait.max == backoff_default_wait.max);
+  backoff = default_backoff.interface.lock_obj;
+  DLX_CHECK(backoff->wait.min == backoff_default_wait.min && backoff->wait.max == backoff_default_wait.max);
+  ticket_lock_t *ticket_obj = ticket.interface.lock_obj;
+  DLX_CHECK(ticket_obj->base == 8 && ticket_obj->wait.kind == DLX_WAIT_PARK);
+  ticket_obj = default_ticket.interface.lock_obj;
+  DLX_CHECK(ticket_obj->base == TICKET_BACKOFF_BASE && ticket_obj->wait.kind == DLX_WAIT_DEFAULT);
+  DLX_CHECK(((adaptivemtx_lock_t *)adaptive.interface.lock_obj)->spin == 100);
+  DLX_CHECK(((adaptivemtx_lock_t *)default_adaptive.interface.lock_obj)->spin == 0);
+
+  // Values live in the instance, the site may move on.
+  DLX_CHECK(!dlx_set_site_param(0, BACKOFF_PARAM_MIN, 256));
+  DLX_CHECK(!dlx_backoff_var_init(&moved, NULL, 0, "moved", __FILE__, __LINE__));
+  DLX_CHECK(((backoff_lock_t *)bounded.interface.lock_obj)->wait.min == 64);
+  DLX_CHECK(((backoff_lock_t *)moved.interface.lock_obj)->wait.min == 256);
+
+  __count_under(&bounded.interface);
+  __count_under(&ticket.interface);
+  __count_under(&adaptive.interface);
+  printf("params: tunables reach backoff, ticket and adaptivemtx instances\n");
+  return 0;
+}
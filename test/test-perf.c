@@ -0,0 +1,85 @@
+#include "dlx-test.h"
+#include <sys/wait.h>
+
+// Counters over critical sections. Unknown names are refused, counters
+// the machine cannot count are left out rather than failing the set, and
+// the sampled sections of each site add up their counter deltas, so a
+// site spinning inside its lock shows far more task-clock per section
+// than an empty one. A forked child opens counters of its own. Where the
+// kernel allows no counter at all the statistics go on without them.
+#define N_ROUND 1600
+#define N_SPIN 20000
+
+static dlx_ttas_t g_busy, g_empty;
+
+static void __run(void) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_busy);
+    for (volatile int k = 0; k < N_SPIN; k++);
+    pthread_mutex_unlock(&g_busy);
+  }
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_empty);
+    pthread_mutex_unlock(&g_empty);
+  }
+}
+
+static int __counted(const char *name) {
+  for (uint32_t i = 0; dlx_perf_name(i); i++) {
+    if (!strcmp(dlx_perf_name(i), name))
+      return i;
+  }
+  return -1;
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  DLX_CHECK(dlx_perf_init(NULL) == EINVAL && dlx_perf_init("") == EINVAL);
+  DLX_CHECK(dlx_perf_init("bogus,rxyz,r") == ENODEV && !g_dlx_perf_n);
+  DLX_CHECK(!dlx_stats_counters(""));
+  DLX_CHECK(!dlx_ttas_var_init(&g_busy, NULL, 0, "g_busy", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_empty, NULL, 1, "g_empty", __FILE__, __LINE__));
+  int ret = dlx_stats_counters("cycles,task-clock,context-switches");
+  DLX_CHECK(!dlx_stats_start());
+  __run();
+  dlx_lock_stats_t stats[2];
+  dlx_lock_counters_t counters[2];
+  for (int site = 0; site < 2; site++) {
+    DLX_CHECK(!dlx_stats_site(site, &stats[site]) && stats[site].n_acq == N_ROUND);
+    DLX_CHECK(!dlx_stats_site_counters(site, &counters[site]));
+  }
+  DLX_CHECK(dlx_stats_site_counters(2, &counters[0]) == EINVAL);
+  if (ret) {
+    DLX_CHECK(ret == ENODEV && !g_stats_counters && !g_dlx_perf_n);
+    DLX_CHECK(!counters[0].n_section && !counters[1].n_section);
+    printf("perf: no counter allowed here, statistics kept without them\n");
+    return 0;
+  }
+
+  DLX_CHECK(g_dlx_perf_n >= 2 && !dlx_perf_name(g_dlx_perf_n));
+  int clock = __counted("task-clock");
+  DLX_CHECK(clock >= 0 && __counted("context-switches") >= 0);
+  for (int site = 0; site < 2; site++)
+    DLX_CHECK(counters[site].n_section == stats[site].n_hold && counters[site].n_section > 0);
+  DLX_CHECK(
+    counters[0].count[clock] / counters[0].n_section > 10 * (counters[1].count[clock] / counters[1].n_section)
+  );
+
+  uint64_t before[DLX_PERF_MAX], after[DLX_PERF_MAX];
+  DLX_CHECK(!dlx_perf_read(before));
+  for (volatile int k = 0; k < N_SPIN; k++);
+  DLX_CHECK(!dlx_perf_read(after) && after[clock] > before[clock]);
+  pid_t pid = fork();
+  if (!pid) {
+    int fresh = !t_dlx_perf.state;
+    exit(fresh && !dlx_perf_read(after) && t_dlx_perf.state == 1 && after[clock] < before[clock]? 0: 1);
+  }
+  int status;
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  printf(
+    "perf: %u counters, %lu ns task-clock per busy section\n", g_dlx_perf_n,
+    (unsigned long)(counters[0].count[clock] / counters[0].n_section)
+  );
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include "dlx-test.h"
+
+// Backend placement. A placed site carves its backends from the arena of
+// the node it names, a node the machine does not have falls back to the
+// heap, freed arena objects serve the next lock of the same size, and the
+// report counts the backends per placement kind.
+#define N_LOCK 8
+#define N_ROUND 20000
+
+static dlx_ttas_t g_locals[N_LOCK], g_interleaved[N_LOCK], g_nodes[N_LOCK], g_missings[N_LOCK];
+static dlx_generic_lock_t *g_lock;
+static long g_counter;
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(g_lock);
+    g_counter++;
+    pthread_mutex_unlock(g_lock);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+// Node of the arena chunk p was carved from, -1 for the heap. Where the
+// kernel tells, the page has to agree.
+static int32_t __arena_node(const void *p) {
+  DLX_CHECK(!((uintptr_t)p & (L_CACHE_LINE_SIZE - 1)));
+  dlx_chunk_t *chunk = __dlx_chunk_of(p);
+  if (!chunk)
+    return -1;
+  int32_t at = dlx_lock_node(p);
+  DLX_CHECK(at == -1 || at == chunk->node);
+  return chunk->node;
+}
+
+int main() {
+  dlx_test_init(4);
+  alarm(60);
+  const dlx_topology_t *topo = dlx_topology();
+  DLX_CHECK(dlx_set_site_place(0, DLX_PLACE_FOLLOW + 1, 0) == EINVAL);
+  DLX_CHECK(dlx_set_site_place(2, DLX_PLACE_NODE, -1) == EINVAL);
+  DLX_CHECK(!dlx_set_site_place(0, DLX_PLACE_LOCAL, 0));
+  DLX_CHECK(!dlx_set_site_place(1, DLX_PLACE_INTERLEAVE, 0));
+  DLX_CHECK(!dlx_set_site_place(2, DLX_PLACE_NODE, topo->node_os[topo->n_node - 1]));
+  DLX_CHECK(!dlx_set_site_place(3, DLX_PLACE_NODE, topo->node_os[topo->n_node - 1] + 1));
+  uint64_t n_default = g_n_placed[DLX_PLACE_DEFAULT];
+  DLX_CHECK(!dlx_ttas_arr_init(g_locals, N_LOCK, 0, "g_locals", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_arr_init(g_interleaved, N_LOCK, 1, "g_interleaved", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_arr_init(g_nodes, N_LOCK, 2, "g_nodes", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_arr_init(g_missings, N_LOCK, 3, "g_missings", __FILE__, __LINE__));
+  DLX_CHECK(g_n_placed[DLX_PLACE_LOCAL] == N_LOCK);
+  DLX_CHECK(g_n_placed[DLX_PLACE_INTERLEAVE] == N_LOCK);
+  DLX_CHECK(g_n_placed[DLX_PLACE_NODE] == N_LOCK);
+  DLX_CHECK(g_n_placed[DLX_PLACE_DEFAULT] == n_default + N_LOCK);
+
+  // Interleaved backends take the nodes in turn.
+  uint32_t n_per_node[DLX_TOPOLOGY_MAX_NODE] = { 0 };
+  for (int i = 0; i < N_LOCK; i++) {
+    DLX_CHECK(__arena_node(g_locals[i].interface.lock_obj) == (int32_t)dlx_current_node());
+    DLX_CHECK(__arena_node(g_nodes[i].interface.lock_obj) == (int32_t)topo->n_node - 1);
+    DLX_CHECK(__arena_node(g_missings[i].interface.lock_obj) == -1);
+    int32_t node = __arena_node(g_interleaved[i].interface.lock_obj);
+    DLX_CHECK(node >= 0);
+    n_per_node[node]++;
+  }
+  for (uint32_t node = 0; node < topo->n_node; node++)
+    DLX_CHECK(n_per_node[node] >= N_LOCK / topo->n_node);
+
+  DLX_CHECK(!dlx_node_alloc(64, -1));
+  DLX_CHECK(!dlx_node_alloc(64, topo->n_node));
+  // A freed object serves the next one of its size, an object past the
+  // largest class maps its own chunk and unmaps it on free.
+  void *small = dlx_node_alloc(3 * L_CACHE_LINE_SIZE, 0);
+  DLX_CHECK(small && !dlx_node_free(small));
+  DLX_CHECK(dlx_node_alloc(3 * L_CACHE_LINE_SIZE, 0) == small);
+  uint32_t n_chunk = g_n_chunk;
+  uint64_t n_live = g_arena[0].n_live;
+  void *large = dlx_node_alloc((DLX_ARENA_CLASS + 1) * L_CACHE_LINE_SIZE, 0);
+  DLX_CHECK(large && g_n_chunk == n_chunk + 1 && !__dlx_chunk_of(large)->lines);
+  memset(large, 0xff, (DLX_ARENA_CLASS + 1) * L_CACHE_LINE_SIZE);
+  DLX_CHECK(!dlx_node_free(large));
+  DLX_CHECK(g_n_chunk == n_chunk && g_arena[0].n_live == n_live);
+  DLX_CHECK(!dlx_node_free(small));
+  int heap_byte;
+  DLX_CHECK(dlx_node_free(&heap_byte) == -1);
+
+  g_lock = &g_nodes[0].interface;
+  pthread_t tids[2];
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == 2 * N_ROUND);
+
+  // Destroyed backends leave the arena.
+  uint32_t last = topo->n_node - 1;
+  n_live = g_arena[last].n_live;
+  for (int i = 0; i < N_LOCK; i++)
+    DLX_CHECK(!pthread_mutex_destroy(&g_nodes[i]));
+  DLX_CHECK(g_arena[last].n_live <= n_live - N_LOCK);
+
+  char report[4096] = { 0 };
+  FILE *out = fmemopen(report, sizeof(report) - 1, "w");
+  DLX_CHECK(out);
+  dlx_place_report(out);
+  fclose(out);
+  char expect[64];
+  snprintf(expect, sizeof(expect), "local %d interleave %d node %d", N_LOCK, N_LOCK, N_LOCK);
+  DLX_CHECK(strstr(report, expect));
+  printf("placement: %d backends each placed local, interleaved and on node %d\n", N_LOCK, topo->node_os[last]);
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include "dlx-test.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Process-shared mutexes in an anonymous shared mapping. Forked processes
+// count under each kind of shared lock, then hand a turn back and forth
+// through a process-shared condition variable; a lost wakeup between the
+// processes stalls the ping-pong and the alarm fails the test.
+#define N_PROC 3
+#define N_COUNT 20000
+#define N_ROUND 5000
+
+typedef struct {
+  dlx_mcs_t mcs;
+  dlx_tas_t tas;
+  dlx_ticket_t ticket;
+  pthread_cond_t cond;
+  long counter[3];
+  volatile int turn[3];
+} shared_t;
+
+static shared_t *g_shared;
+
+static void __count(void) {
+  for (int n = 0; n < N_COUNT; n++) {
+    pthread_mutex_lock(&g_shared->mcs);
+    g_shared->counter[0]++;
+    pthread_mutex_unlock(&g_shared->mcs);
+    pthread_mutex_lock(&g_shared->tas);
+    g_shared->counter[1]++;
+    pthread_mutex_unlock(&g_shared->tas);
+    pthread_mutex_lock(&g_shared->ticket);
+    g_shared->counter[2]++;
+    pthread_mutex_unlock(&g_shared->ticket);
+  }
+}
+
+#define PINGPONG(entity, slot, me) do {                                                                       \
+  for (int n = 0; n < N_ROUND; n++) {                                                                         \
+    pthread_mutex_lock(entity);                                                                               \
+    while (g_shared->turn[slot] != me)                                                                        \
+      pthread_cond_wait(&g_shared->cond, entity);                                                             \
+    g_shared->turn[slot] = !me;                                                                               \
+    pthread_cond_signal(&g_shared->cond);                                                                     \
+    pthread_mutex_unlock(entity);                                                                             \
+  }                                                                                                           \
+} while(0)
+
+static void __pingpong(int slot, int me) {
+  switch (slot) {
+    case 0: PINGPONG(&g_shared->mcs, 0, me); break;
+    case 1: PINGPONG(&g_shared->tas, 1, me); break;
+    default: PINGPONG(&g_shared->ticket, 2, me); break;
+  }
+}
+
+static void __wait_children(void) {
+  int status;
+  while (wait(&status) > 0)
+    DLX_CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+}
+
+int main() {
+  dlx_test_init(4);
+  alarm(120);
+  g_shared = mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  DLX_CHECK(g_shared != MAP_FAILED);
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  DLX_CHECK(!dlx_mcs_var_init(&g_shared->mcs, &attr, 1, "mcs", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_tas_var_init(&g_shared->tas, &attr, 2, "tas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket_var_init(&g_shared->ticket, dlx_pshared_mutexattr(), 3, "ticket", __FILE__, __LINE__));
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  DLX_CHECK(!pthread_cond_init(&g_shared->cond, &cond_attr));
+
+  // Shared locks keep their state inline, the kind follows the site type.
+  dlx_generic_lock_t *locks[3] = {
+    (dlx_generic_lock_t *)&g_shared->mcs, (dlx_generic_lock_t *)&g_shared->tas,
+    (dlx_generic_lock_t *)&g_shared->ticket
+  };
+  uint32_t kinds[3] = { PSHARED_FUTEX, PSHARED_TAS, PSHARED_TICKET };
+  for (int i = 0; i < 3; i++) {
+    DLX_CHECK(!locks[i]->methods);
+    DLX_CHECK(PSHARED_KIND(__dlx_pshared_slot(locks[i])) == kinds[i]);
+  }
+
+  for (int p = 0; p < N_PROC; p++) {
+    if (!fork()) {
+      __count();
+      _exit(0);
+    }
+  }
+  __wait_children();
+  for (int i = 0; i < 3; i++)
+    DLX_CHECK(g_shared->counter[i] == N_PROC * N_COUNT);
+
+  for (int slot = 0; slot < 3; slot++) {
+    for (int me = 0; me < 2; me++) {
+      if (!fork()) {
+        __pingpong(slot, me);
+        _exit(0);
+      }
+    }
+    __wait_children();
+  }
+
+  // A held shared lock refuses trylock, and a timed wait on the shared
+  // condition times out with the lock held again.
+  struct timespec until;
+  clock_gettime(CLOCK_REALTIME, &until);
+  until.tv_nsec += 10000000;
+  if (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  pthread_mutex_lock(&g_shared->mcs);
+  if (!fork())
+    _exit(pthread_mutex_trylock(&g_shared->mcs) == EBUSY? 0: 1);
+  __wait_children();
+  DLX_CHECK(pthread_cond_timedwait(&g_shared->cond, &g_shared->mcs, &until) == ETIMEDOUT);
+  DLX_CHECK(pthread_mutex_trylock(&g_shared->mcs) == EBUSY);
+  pthread_mutex_unlock(&g_shared->mcs);
+
+  pthread_mutex_destroy(&g_shared->mcs);
+  pthread_mutex_destroy(&g_shared->tas);
+  pthread_mutex_destroy(&g_shared->ticket);
+  for (int32_t site = 1; site <= 3; site++)
+    DLX_CHECK(!g_site_state[site].footprint.n_live);
+  printf("pshared: %d processes counted, %d round trips per kind\n", N_PROC, N_ROUND);
+  return 0;
+}
@@ -0,0 +1,61 @@
+#define __DYLINX_RECLAIM__
+#include "dlx-test.h"
+
+// Locks inside heap objects that the program frees, or shrinks away with
+// realloc, without destroying them first, through the dlx_obj_free and
+// dlx_obj_realloc the rewriter emits. Their backends have to be released
+// and counted as reclaimed, a lock destroyed before the free must not be
+// counted twice, and the next locks of the same type reuse the freed
+// backends. Untracked pointers must leave the registry filter empty.
+typedef struct {
+  int a;
+  dlx_ttas_t single;
+  long b;
+  dlx_pthreadmtx_t pair[2];
+} object_t;
+
+int main() {
+  dlx_test_init(4);
+  int32_t array_site = 1;
+  dlx_pthreadmtx_t *array = dlx_pthreadmtx_obj_init(
+    10, sizeof(dlx_pthreadmtx_t), NULL, 0, NULL, &array_site, __FILE__, __LINE__
+  );
+  DLX_CHECK(array);
+  for (int i = 0; i < 10; i++) {
+    pthread_mutex_lock(&array[i]);
+    pthread_mutex_unlock(&array[i]);
+  }
+  DLX_CHECK(g_site_state[1].footprint.n_live == 10);
+  array = dlx_obj_realloc(array, 4 * sizeof(dlx_pthreadmtx_t));
+  DLX_CHECK(array);
+  DLX_CHECK(g_site_state[1].footprint.n_live == 4 && g_site_state[1].footprint.n_reclaimed == 6);
+  pthread_mutex_lock(&array[3]);
+  pthread_mutex_unlock(&array[3]);
+  dlx_obj_free(array);
+  DLX_CHECK(g_site_state[1].footprint.n_live == 0 && g_site_state[1].footprint.n_reclaimed == 10);
+
+  uint32_t properties[] = { offsetof(object_t, single), 1, offsetof(object_t, pair), 2 };
+  void *inits[] = { (void *)dlx_ttas_var_init, (void *)dlx_pthreadmtx_var_init };
+  int sites[] = { 2, 3 };
+  object_t *objects = dlx_struct_obj_init(3, sizeof(object_t), properties, 2, inits, sites, __FILE__, __LINE__);
+  DLX_CHECK(objects);
+  DLX_CHECK(g_site_state[2].footprint.n_live == 3 && g_site_state[3].footprint.n_live == 6);
+  pthread_mutex_destroy(&objects[0].single);
+  dlx_obj_free(objects);
+  DLX_CHECK(g_site_state[2].footprint.n_live == 0 && g_site_state[2].footprint.n_reclaimed == 2);
+  DLX_CHECK(g_site_state[3].footprint.n_live == 0 && g_site_state[3].footprint.n_reclaimed == 6);
+
+  for (int i = 0; i < 100000; i++)
+    dlx_obj_free(malloc(32));
+  void *other = dlx_obj_realloc(malloc(5), 500);
+  dlx_obj_free(other);
+  for (uint32_t i = 0; i < DLX_OBJ_FILTER_SLOTS; i++)
+    DLX_CHECK(!g_obj_filter[i]);
+
+  uint64_t recycled = g_n_recycled;
+  array = dlx_pthreadmtx_obj_init(10, sizeof(dlx_pthreadmtx_t), NULL, 0, NULL, &array_site, __FILE__, __LINE__);
+  DLX_CHECK(array && g_n_recycled > recycled);
+  dlx_obj_free(array);
+  printf("reclaim: %lu backends reused\n", (unsigned long)g_n_recycled);
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include "dlx-test.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Reader-writer lock types. Readers share the lock and keep writers out,
+// a writer keeps everybody out, and under a mix of both a reader never
+// sees a write half done. A process-shared rwlock in a shared mapping
+// stays native, with no header, and keeps forked processes apart; a
+// private init after its destroy tracks it again.
+#define N_READER 2
+#define N_ROUND 2000
+#define N_SHARED_ROUND 5000
+
+static dlx_pthreadrw_t g_pthreadrw;
+static dlx_wprefrw_t g_wprefrw;
+static dlx_bigreaderrw_t g_bigreaderrw;
+static dlx_bravorw_t g_bravorw;
+static dlx_generic_rwlock_t *g_rw;
+static volatile long g_first, g_second;
+static volatile int g_stop;
+static long g_n_read;
+
+static void *__try_shared(void *arg) {
+  DLX_CHECK(!pthread_rwlock_tryrdlock(g_rw));
+  DLX_CHECK(pthread_rwlock_trywrlock(g_rw) == EBUSY);
+  pthread_rwlock_unlock(g_rw);
+  return NULL;
+}
+
+static void *__try_exclusive(void *arg) {
+  DLX_CHECK(pthread_rwlock_tryrdlock(g_rw) == EBUSY);
+  DLX_CHECK(pthread_rwlock_trywrlock(g_rw) == EBUSY);
+  return NULL;
+}
+
+static void *__reader(void *arg) {
+  long n_read = 0;
+  while (!g_stop) {
+    pthread_rwlock_rdlock(g_rw);
+    DLX_CHECK(g_first == g_second);
+    pthread_rwlock_unlock(g_rw);
+    if (++n_read % 16 == 0)
+      sched_yield();
+  }
+  __atomic_fetch_add(&g_n_read, n_read, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+static void __run(void *(*body)(void *)) {
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, body, NULL));
+  pthread_join(tid, NULL);
+}
+
+static void __check(dlx_generic_rwlock_t *rw) {
+  g_rw = rw;
+  pthread_rwlock_rdlock(g_rw);
+  __run(__try_shared);
+  pthread_rwlock_unlock(g_rw);
+  pthread_rwlock_wrlock(g_rw);
+  __run(__try_exclusive);
+  pthread_rwlock_unlock(g_rw);
+
+  pthread_t tids[N_READER];
+  g_stop = 0;
+  for (int i = 0; i < N_READER; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __reader, NULL));
+  for (long i = 0; i < N_ROUND; i++) {
+    pthread_rwlock_wrlock(g_rw);
+    g_first = i;
+    // Gives the readers a chance at the half-done write, rarely, since
+    // readers of the spinning types burn a time slice on it.
+    if (i % 64 == 0)
+      sched_yield();
+    g_second = i;
+    pthread_rwlock_unlock(g_rw);
+    sched_yield();
+  }
+  g_stop = 1;
+  for (int i = 0; i < N_READER; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(!pthread_rwlock_trywrlock(g_rw));
+  pthread_rwlock_unlock(g_rw);
+}
+
+typedef struct {
+  dlx_bravorw_t rw;
+  long counter;
+} shared_t;
+
+static void __count_shared(shared_t *shared) {
+  for (int i = 0; i < N_SHARED_ROUND; i++) {
+    pthread_rwlock_wrlock(&shared->rw);
+    shared->counter++;
+    pthread_rwlock_unlock(&shared->rw);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+}
+
+static void __check_shared(void) {
+  shared_t *shared = mmap(NULL, sizeof(shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  DLX_CHECK(shared != MAP_FAILED);
+  pthread_rwlockattr_t attr;
+  pthread_rwlockattr_init(&attr);
+  pthread_rwlockattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  DLX_CHECK(!pthread_rwlock_init(&shared->rw, &attr) && !DLX_RW_IS_TRACKED(&shared->rw.interface));
+  pthread_rwlockattr_destroy(&attr);
+  int status;
+  pthread_rwlock_rdlock(&shared->rw);
+  pid_t pid = fork();
+  if (!pid) {
+    DLX_CHECK(pthread_rwlock_trywrlock(&shared->rw) == EBUSY);
+    DLX_CHECK(!pthread_rwlock_tryrdlock(&shared->rw));
+    pthread_rwlock_unlock(&shared->rw);
+    exit(0);
+  }
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  pthread_rwlock_unlock(&shared->rw);
+  pid = fork();
+  if (!pid) {
+    __count_shared(shared);
+    exit(0);
+  }
+  __count_shared(shared);
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  DLX_CHECK(shared->counter == 2 * N_SHARED_ROUND);
+  DLX_CHECK(!pthread_rwlock_destroy(&shared->rw));
+  DLX_CHECK(!pthread_rwlock_init(&shared->rw, NULL) && DLX_RW_IS_TRACKED(&shared->rw.interface));
+  pthread_rwlock_destroy(&shared->rw);
+  munmap(shared, sizeof(shared_t));
+}
+
+int main() {
+  dlx_test_init(4);
+  alarm(120);
+  DLX_CHECK(!dlx_pthreadrw_var_init(&g_pthreadrw, NULL, 0, "g_pthreadrw", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_wprefrw_var_init(&g_wprefrw, NULL, 1, "g_wprefrw", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_bigreaderrw_var_init(&g_bigreaderrw, NULL, 2, "g_bigreaderrw", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_bravorw_var_init(&g_bravorw, NULL, 3, "g_bravorw", __FILE__, __LINE__));
+  __check(&g_pthreadrw.interface);
+  __check(&g_wprefrw.interface);
+  __check(&g_bigreaderrw.interface);
+  __check(&g_bravorw.interface);
+  pthread_rwlock_destroy(&g_pthreadrw);
+  pthread_rwlock_destroy(&g_wprefrw);
+  pthread_rwlock_destroy(&g_bigreaderrw);
+  pthread_rwlock_destroy(&g_bravorw);
+  __check_shared();
+  printf("rwlock: 4 types, %d writes and %ld reads each on average\n", N_ROUND, g_n_read / 4);
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "dlx-test.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Semaphore types between producers and consumers. Every post is consumed
+// exactly once, the value never goes negative, and an empty semaphore
+// fails trywait with EAGAIN and timedwait with ETIMEDOUT. Process-shared
+// semaphores in a shared mapping stay native, with no header, and pass
+// posts between forked processes; a sem_init without pshared afterwards
+// tracks the semaphore again.
+#define N_PRODUCER 2
+#define N_CONSUMER 2
+#define N_ITEM 20000
+#define N_SHARED_ITEM 2000
+
+static dlx_posixsem_t g_posixsem;
+static dlx_spinparksem_t g_spinparksem;
+static dlx_batchsem_t g_batchsem;
+static dlx_percpusem_t g_percpusem;
+static dlx_generic_sem_t *g_sem;
+static long g_produced, g_consumed;
+
+static void *__produce(void *arg) {
+  for (int i = 0; i < N_ITEM; i++) {
+    __atomic_fetch_add(&g_produced, 1, __ATOMIC_SEQ_CST);
+    DLX_CHECK(!sem_post(g_sem));
+    if (i % 64 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void *__consume(void *arg) {
+  for (int i = 0; i < N_ITEM; i++) {
+    if (i % 2 || sem_trywait(g_sem))
+      DLX_CHECK(!sem_wait(g_sem));
+    DLX_CHECK(__atomic_add_fetch(&g_consumed, 1, __ATOMIC_SEQ_CST) <= __atomic_load_n(&g_produced, __ATOMIC_SEQ_CST));
+  }
+  return NULL;
+}
+
+static void __check(dlx_generic_sem_t *sem) {
+  g_sem = sem;
+  g_produced = g_consumed = 0;
+  int value = -1;
+  DLX_CHECK(!sem_init(g_sem, 0, 2));
+  DLX_CHECK(!sem_getvalue(g_sem, &value) && value == 2);
+  DLX_CHECK(!sem_wait(g_sem) && !sem_trywait(g_sem));
+  errno = 0;
+  DLX_CHECK(sem_trywait(g_sem) == -1 && errno == EAGAIN);
+  struct timespec until;
+  clock_gettime(CLOCK_REALTIME, &until);
+  until.tv_nsec += 5000000;
+  if (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  errno = 0;
+  DLX_CHECK(sem_timedwait(g_sem, &until) == -1 && errno == ETIMEDOUT);
+
+  pthread_t tids[N_PRODUCER + N_CONSUMER];
+  for (int i = 0; i < N_CONSUMER; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __consume, NULL));
+  for (int i = 0; i < N_PRODUCER; i++)
+    DLX_CHECK(!pthread_create(&tids[N_CONSUMER + i], NULL, __produce, NULL));
+  for (int i = 0; i < N_PRODUCER + N_CONSUMER; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_consumed == N_CONSUMER * N_ITEM);
+  DLX_CHECK(!sem_getvalue(g_sem, &value) && value == 0);
+  DLX_CHECK(!sem_destroy(g_sem));
+}
+
+static void __check_shared(dlx_generic_sem_t *sem) {
+  int value = -1;
+  DLX_CHECK(!sem_init(sem, 1, 0) && !DLX_SEM_IS_TRACKED(sem));
+  pid_t pid = fork();
+  if (!pid) {
+    for (int i = 0; i < N_SHARED_ITEM; i++)
+      DLX_CHECK(!sem_post(sem));
+    exit(0);
+  }
+  for (int i = 0; i < N_SHARED_ITEM; i++)
+    DLX_CHECK(!sem_wait(sem));
+  int status;
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  errno = 0;
+  DLX_CHECK(sem_trywait(sem) == -1 && errno == EAGAIN);
+  DLX_CHECK(!sem_getvalue(sem, &value) && !value && !sem_destroy(sem));
+  DLX_CHECK(!sem_init(sem, 0, 1) && DLX_SEM_IS_TRACKED(sem));
+  DLX_CHECK(!sem_wait(sem) && !sem_destroy(sem));
+}
+
+int main() {
+  dlx_test_init(4);
+  alarm(120);
+  DLX_CHECK(!dlx_posixsem_var_init(&g_posixsem, NULL, 0, "g_posixsem", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_spinparksem_var_init(&g_spinparksem, NULL, 1, "g_spinparksem", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_batchsem_var_init(&g_batchsem, NULL, 2, "g_batchsem", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_percpusem_var_init(&g_percpusem, NULL, 3, "g_percpusem", __FILE__, __LINE__));
+  __check(&g_posixsem.interface);
+  __check(&g_spinparksem.interface);
+  __check(&g_batchsem.interface);
+  __check(&g_percpusem.interface);
+  dlx_spinparksem_t *shared = mmap(NULL, 2 * sizeof(dlx_spinparksem_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  DLX_CHECK(shared != MAP_FAILED);
+  __check_shared(&shared[0].interface);
+  DLX_CHECK(!sem_init(&shared[1], 1, 0) && !DLX_SEM_IS_TRACKED(&shared[1].interface));
+  DLX_CHECK(!sem_post(&shared[1]) && !sem_wait(&shared[1]) && !sem_destroy(&shared[1]));
+  // A semaphore once tracked drops its header too.
+  DLX_CHECK(!sem_init(&g_batchsem, 1, 1) && !DLX_SEM_IS_TRACKED(&g_batchsem.interface));
+  DLX_CHECK(!sem_wait(&g_batchsem) && !sem_destroy(&g_batchsem));
+  munmap(shared, 2 * sizeof(dlx_spinparksem_t));
+  printf("sem: 4 types, %d items through each\n", N_PRODUCER * N_ITEM);
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "dlx-test.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Live statistics segment, read from another process the way dylinx-top
+// reads it. A child publishes, runs a known number of acquisitions on two
+// sites and waits. Snapshots taken meanwhile have to be consistent and
+// never go backwards, the snapshot after the run has to hold the exact
+// counts and types, and the segment has to be gone once the child exits.
+#define N_THREAD 3
+#define N_ACQ 200000
+
+static dlx_ttas_t g_hot[4];
+static dlx_pthreadmtx_t g_cold;
+
+static void *__worker(void *arg) {
+  for (int i = 0; i < N_ACQ; i++) {
+    if (i % 8) {
+      pthread_mutex_lock(&g_hot[i % 4]);
+      pthread_mutex_unlock(&g_hot[i % 4]);
+    } else {
+      pthread_mutex_lock(&g_cold);
+      pthread_mutex_unlock(&g_cold);
+    }
+  }
+  return NULL;
+}
+
+static void __publisher(const char *name, int done_fd, int exit_fd) {
+  DLX_CHECK(!dlx_ttas_arr_init(g_hot, 4, 1, "g_hot", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_pthreadmtx_var_init(&g_cold, NULL, 2, "g_cold", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_stats_publish(name));
+  pthread_t tids[N_THREAD];
+  for (int t = 0; t < N_THREAD; t++)
+    DLX_CHECK(!pthread_create(&tids[t], NULL, __worker, NULL));
+  for (int t = 0; t < N_THREAD; t++)
+    pthread_join(tids[t], NULL);
+  char byte = 0;
+  DLX_CHECK(write(done_fd, &byte, 1) == 1);
+  DLX_CHECK(read(exit_fd, &byte, 1) == 1);
+  exit(0);
+}
+
+static dlx_shm_header_t *__attach(const char *name) {
+  for (int i = 0; i < 1000; i++) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd >= 0) {
+      struct stat st;
+      DLX_CHECK(!fstat(fd, &st));
+      dlx_shm_header_t *shm = NULL;
+      if (st.st_size >= (off_t)sizeof(dlx_shm_header_t)) {
+        shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        DLX_CHECK(shm != MAP_FAILED);
+      }
+      close(fd);
+      if (shm && __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) == DLX_SHM_MAGIC)
+        return shm;
+    }
+    usleep(1000);
+  }
+  return NULL;
+}
+
+static void __snapshot(dlx_shm_header_t *shm, dlx_shm_header_t *header, dlx_shm_site_t *sites) {
+  DLX_CHECK(!dlx_shm_read(&shm->seq, shm, header, sizeof(dlx_shm_header_t)));
+  for (uint32_t i = 0; i < header->n_site; i++) {
+    dlx_shm_site_t *site = (dlx_shm_site_t *)((char *)shm + header->header_size + (size_t)i * header->site_size);
+    DLX_CHECK(!dlx_shm_read(&site->seq, site, &sites[i], sizeof(dlx_shm_site_t)));
+  }
+}
+
+int main() {
+  dlx_test_init(3);
+  char name[64];
+  snprintf(name, sizeof(name), "/dlx-test-shm.%d", (int)getpid());
+  int done[2], quit[2];
+  DLX_CHECK(!pipe(done) && !pipe(quit));
+  pid_t pid = fork();
+  if (!pid)
+    __publisher(name, done[1], quit[0]);
+
+  dlx_shm_header_t *shm = __attach(name);
+  DLX_CHECK(shm);
+  DLX_CHECK(shm->version == DLX_SHM_VERSION && shm->pid == (uint32_t)pid);
+  DLX_CHECK(shm->header_size == sizeof(dlx_shm_header_t) && shm->site_size == sizeof(dlx_shm_site_t));
+  DLX_CHECK(shm->n_site == 4 && shm->n_bucket == DLX_HIST_BUCKETS);
+  dlx_shm_header_t header;
+  dlx_shm_site_t sites[4], last[4] = { 0 };
+  char byte;
+  while (1) {
+    __snapshot(shm, &header, sites);
+    for (int i = 0; i < 4; i++) {
+      DLX_CHECK(sites[i].site_id == (i < 3? i: -1));
+      DLX_CHECK(sites[i].n_acq >= last[i].n_acq && sites[i].n_contended <= sites[i].n_acq);
+    }
+    memcpy(last, sites, sizeof(sites));
+    struct timeval none = { 0 };
+    fd_set ready;
+    FD_ZERO(&ready);
+    FD_SET(done[0], &ready);
+    if (select(done[0] + 1, &ready, NULL, NULL, &none) > 0)
+      break;
+    usleep(20000);
+  }
+  DLX_CHECK(read(done[0], &byte, 1) == 1);
+  // Two publishes after the run make sure one started after it.
+  uint64_t n_publish = header.n_publish;
+  do {
+    usleep(50000);
+    __snapshot(shm, &header, sites);
+  } while (header.n_publish < n_publish + 2);
+  DLX_CHECK(header.now_ns > header.start_ns && header.now_tsc > header.start_tsc);
+  DLX_CHECK(sites[1].n_acq == N_THREAD * N_ACQ / 8 * 7 && sites[1].n_ins == 4);
+  DLX_CHECK(sites[2].n_acq == N_THREAD * N_ACQ / 8 && sites[2].n_ins == 1);
+  DLX_CHECK(!strcmp(sites[1].ltype, "ttas") && !strcmp(sites[2].ltype, "pthreadmtx"));
+  DLX_CHECK(!sites[0].n_acq && !sites[0].ltype[0]);
+  for (int i = 1; i <= 2; i++) {
+    uint64_t n_wait = 0;
+    for (int b = 0; b < DLX_HIST_BUCKETS; b++)
+      n_wait += sites[i].wait[b];
+    DLX_CHECK(n_wait == sites[i].n_acq);
+  }
+
+  DLX_CHECK(write(quit[1], &byte, 1) == 1);
+  int status;
+  DLX_CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && !WEXITSTATUS(status));
+  DLX_CHECK(shm_open(name, O_RDONLY, 0) < 0 && errno == ENOENT);
+  printf(
+    "shm: %lu publishes, %lu acquisitions on site 1\n", (unsigned long)header.n_publish,
+    (unsigned long)sites[1].n_acq
+  );
+  return 0;
+}
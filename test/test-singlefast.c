@@ -0,0 +1,158 @@
+#define __DYLINX_SINGLE_FAST__
+#include "dlx-test.h"
+
+// Single-threaded fast path. While one thread runs, blocking acquisitions
+// leave the backends alone; holds recorded then, including recursive
+// reads, have to be on the backends before a second thread starts. The
+// fast path comes back once the other threads exited, joined or detached,
+// but not while a thread the interposer never saw is alive. The quiet
+// control thread leaves it on.
+#define N_ROUND 100000
+#define N_POLL 20
+
+static dlx_ttas_t g_mutex;
+static dlx_wprefrw_t g_writer, g_readers;
+static long g_counter;
+
+#define TTAS_WORD(entity) (((ttas_lock_t *)(entity).interface.lock_obj)->spin_lock)
+#define WPREFRW_STATE(entity) (((wprefrw_lock_t *)(entity).interface.lock_obj)->state)
+
+static void *__try_held(void *arg) {
+  DLX_CHECK(!(g_dlx_hooks & DLX_HOOK_FAST));
+  DLX_CHECK(pthread_mutex_trylock(&g_mutex) == EBUSY);
+  DLX_CHECK(pthread_rwlock_tryrdlock(&g_writer) == EBUSY);
+  DLX_CHECK(pthread_rwlock_trywrlock(&g_readers) == EBUSY);
+  DLX_CHECK(!pthread_rwlock_tryrdlock(&g_readers));
+  pthread_rwlock_unlock(&g_readers);
+  // Blocks until the main thread lets go.
+  pthread_mutex_lock(&g_mutex);
+  g_counter++;
+  pthread_mutex_unlock(&g_mutex);
+  return NULL;
+}
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_mutex);
+    g_counter++;
+    pthread_mutex_unlock(&g_mutex);
+  }
+  return NULL;
+}
+
+static void *__leave(void *arg) {
+  return NULL;
+}
+
+static volatile int g_gate[2];
+
+static void *__wait_gate(void *arg) {
+  volatile int *gate = arg;
+  while (!*gate)
+    usleep(1000);
+  return NULL;
+}
+
+// Lock operations poll the thread count of the kernel while the glue
+// counts a single thread, n_poll times here.
+static void __poll(int n_poll) {
+  for (int i = 0; i < n_poll * DLX_FAST_POLL; i++) {
+    pthread_mutex_lock(&g_mutex);
+    pthread_mutex_unlock(&g_mutex);
+  }
+}
+
+static int __settle(void) {
+  for (int i = 0; i < 1000 && !(g_dlx_hooks & DLX_HOOK_FAST); i++) {
+    __poll(1);
+    usleep(1000);
+  }
+  return (g_dlx_hooks & DLX_HOOK_FAST) != 0;
+}
+
+int main() {
+  dlx_test_init(3);
+  alarm(60);
+  DLX_CHECK(!dlx_ttas_var_init(&g_mutex, NULL, 0, "g_mutex", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_wprefrw_var_init(&g_writer, NULL, 1, "g_writer", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_wprefrw_var_init(&g_readers, NULL, 2, "g_readers", __FILE__, __LINE__));
+  DLX_CHECK(g_dlx_hooks & DLX_HOOK_FAST);
+  pthread_mutex_lock(&g_mutex);
+  DLX_CHECK(TTAS_WORD(g_mutex) == UNLOCKED);
+  pthread_mutex_unlock(&g_mutex);
+  // Trylock asks the backend even now.
+  DLX_CHECK(!pthread_mutex_trylock(&g_mutex));
+  DLX_CHECK(TTAS_WORD(g_mutex) == LOCKED);
+  pthread_mutex_unlock(&g_mutex);
+  DLX_CHECK(TTAS_WORD(g_mutex) == UNLOCKED);
+
+  pthread_mutex_lock(&g_mutex);
+  pthread_rwlock_wrlock(&g_writer);
+  pthread_rwlock_rdlock(&g_readers);
+  pthread_rwlock_rdlock(&g_readers);
+  DLX_CHECK(TTAS_WORD(g_mutex) == UNLOCKED && !WPREFRW_STATE(g_writer) && !WPREFRW_STATE(g_readers));
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, __try_held, NULL));
+  DLX_CHECK(TTAS_WORD(g_mutex) == LOCKED && WPREFRW_STATE(g_writer) && WPREFRW_STATE(g_readers) == 2);
+  usleep(10000);
+  pthread_rwlock_unlock(&g_readers);
+  pthread_rwlock_unlock(&g_readers);
+  pthread_rwlock_unlock(&g_writer);
+  g_counter++;
+  pthread_mutex_unlock(&g_mutex);
+  pthread_join(tid, NULL);
+  DLX_CHECK(g_counter == 2);
+  DLX_CHECK(!WPREFRW_STATE(g_writer) && !WPREFRW_STATE(g_readers));
+
+  DLX_CHECK(__settle());
+  pthread_t tids[2];
+  g_counter = 0;
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  DLX_CHECK(!(g_dlx_hooks & DLX_HOOK_FAST));
+  __count(NULL);
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == 3 * N_ROUND);
+  DLX_CHECK(__settle());
+
+  DLX_CHECK(!pthread_create(&tid, NULL, __leave, NULL));
+  DLX_CHECK(!pthread_detach(tid));
+  DLX_CHECK(!(g_dlx_hooks & DLX_HOOK_FAST));
+  DLX_CHECK(__settle());
+
+  // A thread started behind the interposer, as thrd_create would, while
+  // another one keeps the fast path off.
+  int (*hidden_create)(pthread_t *, const pthread_attr_t *, void *(*)(void *), void *);
+  hidden_create = dlsym(RTLD_NEXT, "pthread_create");
+  pthread_t hidden;
+  DLX_CHECK(!pthread_create(&tid, NULL, __wait_gate, (void *)&g_gate[0]));
+  DLX_CHECK(!hidden_create(&hidden, NULL, __wait_gate, (void *)&g_gate[1]));
+  g_gate[0] = 1;
+  pthread_join(tid, NULL);
+  usleep(10000);
+  __poll(N_POLL);
+  DLX_CHECK(!(g_dlx_hooks & DLX_HOOK_FAST) && (g_dlx_hooks & DLX_HOOK_ALONE));
+  pthread_mutex_lock(&g_mutex);
+  DLX_CHECK(TTAS_WORD(g_mutex) == LOCKED);
+  pthread_mutex_unlock(&g_mutex);
+  g_gate[1] = 1;
+  pthread_join(hidden, NULL);
+  DLX_CHECK(__settle() && !(g_dlx_hooks & DLX_HOOK_ALONE));
+
+  char path[] = "/tmp/dlx-singlefast-XXXXXX";
+  DLX_CHECK(mkdtemp(path));
+  char sock[64];
+  snprintf(sock, sizeof(sock), "%s/sock", path);
+  DLX_CHECK(!dlx_control_start(sock));
+  usleep(10000);
+  __poll(N_POLL);
+  DLX_CHECK((g_dlx_hooks & DLX_HOOK_FAST) && g_n_quiet == 1);
+  pthread_mutex_lock(&g_mutex);
+  DLX_CHECK(TTAS_WORD(g_mutex) == UNLOCKED);
+  pthread_mutex_unlock(&g_mutex);
+  unlink(sock);
+  rmdir(path);
+  printf("single fast: recorded holds reached the backends before the second thread\n");
+  return 0;
+}
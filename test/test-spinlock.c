@@ -0,0 +1,105 @@
+#include "dlx-test.h"
+
+// pthread_spin_* on every spin-capable lock type, through the same calls
+// a rewritten spinlock site makes. Two threads count under each lock, a
+// held lock refuses trylock, and PTHREAD_PROCESS_SHARED gives a shared
+// lock of the kind of the type. In a malloc'd struct the spinlock grows
+// into a Dylinx header, the lock fields after it are initialized where
+// the rewritten struct has them.
+#define N_THREAD 2
+#define N_ROUND 20000
+
+static dlx_ttas_t g_ttas;
+static dlx_backoff_t g_backoff;
+static dlx_ticket_t g_ticket;
+static dlx_mcs_t g_mcs;
+static dlx_qspinlock_t g_qspinlock;
+static dlx_tas_t g_tas;
+static dlx_ticket16_t g_ticket16;
+static dlx_generic_lock_t *g_spin;
+static long g_counter;
+
+// struct { pthread_spinlock_t spin; int count; pthread_mutex_t mtx; }
+// after rewriting, mtx sat at offset 8 before.
+typedef struct {
+  dlx_ttas_t spin;
+  int count;
+  dlx_mcs_t mtx;
+} object_t;
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_spin_lock(g_spin);
+    g_counter++;
+    pthread_spin_unlock(g_spin);
+    // A fair lock hands itself to the other thread, which has to run
+    // before this one can get it back on a single CPU.
+    sched_yield();
+  }
+  return NULL;
+}
+
+static void *__try_held(void *arg) {
+  DLX_CHECK(pthread_spin_trylock(g_spin) == EBUSY);
+  return NULL;
+}
+
+static void __check(dlx_generic_lock_t *spin) {
+  pthread_t tids[N_THREAD];
+  g_spin = spin;
+  g_counter = 0;
+  DLX_CHECK(spin->methods);
+  for (int i = 0; i < N_THREAD; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < N_THREAD; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == N_THREAD * N_ROUND);
+  DLX_CHECK(!pthread_spin_trylock(spin));
+  DLX_CHECK(!pthread_create(&tids[0], NULL, __try_held, NULL));
+  pthread_join(tids[0], NULL);
+  DLX_CHECK(!pthread_spin_unlock(spin));
+  DLX_CHECK(!pthread_spin_destroy(spin));
+}
+
+int main() {
+  dlx_test_init(3);
+  alarm(120);
+  DLX_CHECK(!pthread_spin_init(&g_ttas, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_backoff, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_ticket, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_mcs, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_qspinlock, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_tas, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(!pthread_spin_init(&g_ticket16, PTHREAD_PROCESS_PRIVATE));
+  DLX_CHECK(g_ticket.interface.methods == &dlx_ticket_methods_collection);
+  DLX_CHECK(g_qspinlock.interface.methods == &dlx_qspinlock_methods_collection);
+  __check(&g_ttas.interface);
+  __check(&g_backoff.interface);
+  __check(&g_ticket.interface);
+  __check(&g_mcs.interface);
+  __check(&g_qspinlock.interface);
+  __check(&g_tas.interface);
+  __check(&g_ticket16.interface);
+
+  DLX_CHECK(!pthread_spin_init(&g_ticket, PTHREAD_PROCESS_SHARED));
+  DLX_CHECK(!g_ticket.interface.methods);
+  DLX_CHECK(PSHARED_KIND(__dlx_pshared_slot(&g_ticket.interface)) == PSHARED_TICKET);
+  DLX_CHECK(!pthread_spin_lock(&g_ticket));
+  DLX_CHECK(pthread_spin_trylock(&g_ticket) == EBUSY);
+  DLX_CHECK(!pthread_spin_unlock(&g_ticket));
+  DLX_CHECK(!pthread_spin_destroy(&g_ticket));
+
+  uint32_t properties[] = { offsetof(object_t, spin), 1, offsetof(object_t, mtx), 1 };
+  void *inits[] = { (void *)dlx_ttas_var_init, (void *)dlx_mcs_var_init };
+  int sites[] = { 1, 2 };
+  object_t *objects = dlx_struct_obj_init(2, sizeof(object_t), properties, 2, inits, sites, __FILE__, __LINE__);
+  DLX_CHECK(objects && offsetof(object_t, mtx) > 8);
+  for (int i = 0; i < 2; i++) {
+    DLX_CHECK(objects[i].spin.interface.methods == &dlx_ttas_methods_collection && !objects[i].count);
+    DLX_CHECK(objects[i].mtx.interface.methods == &dlx_mcs_methods_collection);
+    DLX_CHECK(!pthread_spin_lock(&objects[i].spin) && !pthread_mutex_lock(&objects[i].mtx));
+    DLX_CHECK(!pthread_mutex_unlock(&objects[i].mtx) && !pthread_spin_unlock(&objects[i].spin));
+  }
+  printf("spinlock: 7 types, %d acquisitions each\n", N_THREAD * N_ROUND);
+  return 0;
+}
@@ -0,0 +1,117 @@
+#include "dlx-test.h"
+
+// Contention counters. Acquisitions, failed trylocks and condition waits
+// are counted exactly per site, threads that finished keep their counts,
+// a waiter behind a sleeping holder counts as contended with its wait,
+// a sample of the holds is timed, and the report lists each site under
+// its id.
+#define N_ROUND 20000
+#define N_TRY 10
+#define HOLD_US 10000
+
+static dlx_ttas_t g_ttas;
+static dlx_mcs_t g_mcs;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static long g_counter;
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_mcs);
+    g_counter++;
+    pthread_mutex_unlock(&g_mcs);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void *__try_held(void *arg) {
+  for (int i = 0; i < N_TRY; i++)
+    DLX_CHECK(pthread_mutex_trylock(&g_ttas) == EBUSY);
+  return NULL;
+}
+
+static void *__wait_holder(void *arg) {
+  pthread_mutex_lock(&g_ttas);
+  pthread_mutex_unlock(&g_ttas);
+  return NULL;
+}
+
+int main() {
+  dlx_test_init(2);
+  alarm(60);
+  char log_path[] = "/tmp/dlx-stats-XXXXXX";
+  int fd = mkstemp(log_path);
+  DLX_CHECK(fd >= 0);
+  close(fd);
+  DLX_CHECK(!dlx_ttas_var_init(&g_ttas, NULL, 0, "g_ttas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_mcs_var_init(&g_mcs, NULL, 1, "g_mcs", __FILE__, __LINE__));
+  // Off until started.
+  pthread_mutex_lock(&g_ttas);
+  pthread_mutex_unlock(&g_ttas);
+  dlx_lock_stats_t stats;
+  DLX_CHECK(!dlx_stats_site(0, &stats) && !stats.n_acq);
+  DLX_CHECK(dlx_stats_site(-2, &stats) == EINVAL && dlx_stats_site(2, &stats) == EINVAL);
+  DLX_CHECK(!dlx_stats_start());
+
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(&g_ttas);
+    pthread_mutex_unlock(&g_ttas);
+  }
+  DLX_CHECK(!dlx_stats_site(0, &stats));
+  DLX_CHECK(stats.n_acq == N_ROUND && !stats.n_try_fail && !stats.n_cond_wait);
+  // A free lock only counts as contended when the thread got preempted.
+  DLX_CHECK(stats.n_contended < N_ROUND / 100);
+  DLX_CHECK(stats.n_hold == N_ROUND / DLX_STAT_HOLD_SAMPLE && stats.hold_cyc > 0);
+
+  pthread_mutex_lock(&g_ttas);
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, __try_held, NULL));
+  pthread_join(tid, NULL);
+  struct timespec until;
+  clock_gettime(CLOCK_REALTIME, &until);
+  until.tv_nsec += 1000000;
+  if (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  DLX_CHECK(pthread_cond_timedwait(&g_cond, &g_ttas, &until) == ETIMEDOUT);
+  uint64_t n_contended = stats.n_contended, wait_cyc = stats.wait_cyc;
+  DLX_CHECK(!pthread_create(&tid, NULL, __wait_holder, NULL));
+  usleep(HOLD_US);
+  pthread_mutex_unlock(&g_ttas);
+  pthread_join(tid, NULL);
+  DLX_CHECK(!dlx_stats_site(0, &stats));
+  DLX_CHECK(stats.n_acq == N_ROUND + 2 && stats.n_try_fail == N_TRY && stats.n_cond_wait == 1);
+  DLX_CHECK(stats.n_contended > n_contended && stats.wait_cyc - wait_cyc >= DLX_STAT_CONTENDED_CYC);
+
+  pthread_t tids[2];
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == 2 * N_ROUND);
+  DLX_CHECK(!dlx_stats_site(1, &stats));
+  DLX_CHECK(stats.n_acq == 2 * N_ROUND && !stats.n_try_fail);
+  DLX_CHECK(stats.n_hold >= 2 * (N_ROUND / DLX_STAT_HOLD_SAMPLE - 1));
+
+  DLX_CHECK(!dlx_stats_dump(log_path));
+  char report[8192] = { 0 };
+  FILE *fp = fopen(log_path, "r");
+  DLX_CHECK(fp);
+  fread(report, 1, sizeof(report) - 1, fp);
+  fclose(fp);
+  unlink(log_path);
+  char expect[64];
+  snprintf(expect, sizeof(expect), "\"0\": { \"acq\": %d,", N_ROUND + 2);
+  DLX_CHECK(strstr(report, expect));
+  snprintf(expect, sizeof(expect), "\"1\": { \"acq\": %d,", 2 * N_ROUND);
+  DLX_CHECK(strstr(report, expect));
+  snprintf(expect, sizeof(expect), "\"try_fail\": %d, \"cond_wait\": 1,", N_TRY);
+  DLX_CHECK(strstr(report, expect));
+  printf(
+    "stats: %lu acquisitions on site 1, %lu of them contended\n", (unsigned long)stats.n_acq,
+    (unsigned long)stats.n_contended
+  );
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "dlx-test.h"
+
+// pthread_mutex_timedlock on every mutex type. A held lock times out both
+// before and past its deadline, a free one is taken even past it. Waiters
+// that give up in an MCS queue must not stall the ones queued behind
+// them, also while timed and plain acquisitions keep racing.
+#define N_TYPE 9
+#define N_ROUND 2000
+
+static const dlx_injected_interface_t *g_methods[N_TYPE] = {
+  &dlx_pthreadmtx_methods_collection, &dlx_ttas_methods_collection, &dlx_backoff_methods_collection,
+  &dlx_adaptivemtx_methods_collection, &dlx_mcs_methods_collection, &dlx_ticket_methods_collection,
+  &dlx_qspinlock_methods_collection, &dlx_tas_methods_collection, &dlx_ticket16_methods_collection
+};
+static dlx_ttas_t g_locks[N_TYPE];
+static dlx_ttas_t *g_lock;
+static long g_counter, g_n_timed;
+
+static struct timespec __deadline(long ns) {
+  struct timespec until;
+  clock_gettime(CLOCK_REALTIME, &until);
+  until.tv_nsec += ns;
+  while (until.tv_nsec >= 1000000000) {
+    until.tv_sec++;
+    until.tv_nsec -= 1000000000;
+  }
+  while (until.tv_nsec < 0) {
+    until.tv_sec--;
+    until.tv_nsec += 1000000000;
+  }
+  return until;
+}
+
+static void *__expect_timeout(void *arg) {
+  struct timespec until = __deadline(5000000);
+  DLX_CHECK(pthread_mutex_timedlock(g_lock, &until) == ETIMEDOUT);
+  until = __deadline(-1000000);
+  DLX_CHECK(pthread_mutex_timedlock(g_lock, &until) == ETIMEDOUT);
+  return NULL;
+}
+
+static void *__expect_taken(void *arg) {
+  struct timespec until = __deadline(-1000000);
+  DLX_CHECK(!pthread_mutex_timedlock(g_lock, &until));
+  pthread_mutex_unlock(g_lock);
+  return NULL;
+}
+
+static void *__give_up(void *arg) {
+  struct timespec until = __deadline(20000000);
+  DLX_CHECK(pthread_mutex_timedlock(g_lock, &until) == ETIMEDOUT);
+  return NULL;
+}
+
+static void *__plain(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(g_lock);
+    g_counter++;
+    // Lets the timed thread queue up and give up behind the holder.
+    if (i % 8 == 0)
+      sched_yield();
+    pthread_mutex_unlock(g_lock);
+  }
+  return NULL;
+}
+
+static void *__timed(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    struct timespec until = __deadline(i % 2? 50000: 5000000);
+    if (!pthread_mutex_timedlock(g_lock, &until)) {
+      g_counter++;
+      g_n_timed++;
+      pthread_mutex_unlock(g_lock);
+    }
+  }
+  return NULL;
+}
+
+static void __run(void *(*body)(void *)) {
+  pthread_t tid;
+  DLX_CHECK(!pthread_create(&tid, NULL, body, NULL));
+  pthread_join(tid, NULL);
+}
+
+int main() {
+  dlx_test_init(1);
+  alarm(60);
+  for (uint32_t i = 0; i < N_TYPE; i++)
+    DLX_CHECK(!dlx_set_instance_type(0, i, i + 1, g_methods[i], -1));
+  DLX_CHECK(!dlx_ttas_arr_init(g_locks, N_TYPE, 0, "g_locks", __FILE__, __LINE__));
+  for (int i = 0; i < N_TYPE; i++) {
+    g_lock = &g_locks[i];
+    DLX_CHECK(g_lock->interface.methods == g_methods[i]);
+    pthread_mutex_lock(g_lock);
+    __run(__expect_timeout);
+    pthread_mutex_unlock(g_lock);
+    __run(__expect_taken);
+  }
+
+  // Two waiters give up in the queue of a held MCS lock, the one queued
+  // behind them still gets it.
+  g_lock = &g_locks[4];
+  pthread_t tids[3];
+  pthread_mutex_lock(g_lock);
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __give_up, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  g_counter = 0;
+  DLX_CHECK(!pthread_create(&tids[2], NULL, __plain, NULL));
+  usleep(10000);
+  pthread_mutex_unlock(g_lock);
+  pthread_join(tids[2], NULL);
+  DLX_CHECK(g_counter == N_ROUND);
+
+  g_counter = 0;
+  DLX_CHECK(!pthread_create(&tids[0], NULL, __plain, NULL));
+  DLX_CHECK(!pthread_create(&tids[1], NULL, __timed, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == N_ROUND + g_n_timed);
+  DLX_CHECK(!pthread_mutex_trylock(g_lock));
+  pthread_mutex_unlock(g_lock);
+  printf("timedlock: %d types, %ld of %d racing timed acquisitions on mcs\n", N_TYPE, g_n_timed, N_ROUND);
+  return 0;
+}
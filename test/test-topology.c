@@ -0,0 +1,85 @@
+#include "dlx-test.h"
+
+// Topology module. Whatever the machine, ids are dense and numbered in
+// the order of their lowest CPU, SMT siblings share a core, nodes map
+// back and forth to the kernel's ids, and the cached current CPU follows
+// the thread once it is pinned.
+
+// Checks that ids[0..n_cpu) cover [0, n) and first appear in increasing
+// order.
+static void __check_dense(const int32_t *ids, uint32_t n_cpu, uint32_t n) {
+  int32_t next = 0;
+  for (uint32_t cpu = 0; cpu < n_cpu; cpu++) {
+    DLX_CHECK(ids[cpu] >= 0 && ids[cpu] < (int32_t)n);
+    DLX_CHECK(ids[cpu] <= next);
+    if (ids[cpu] == next)
+      next++;
+  }
+  DLX_CHECK(next == (int32_t)n);
+}
+
+int main() {
+  DLX_CHECK(!dlx_topology_init());
+  const dlx_topology_t *topo = dlx_topology();
+  DLX_CHECK(topo->n_cpu == (uint32_t)sysconf(_SC_NPROCESSORS_CONF));
+  DLX_CHECK(topo->n_core >= 1 && topo->n_core <= topo->n_cpu);
+  DLX_CHECK(topo->n_llc >= 1 && topo->n_llc <= topo->n_core);
+  DLX_CHECK(topo->n_node >= 1 && topo->n_node <= DLX_TOPOLOGY_MAX_NODE);
+  DLX_CHECK(topo->cache_line >= 16 && !(topo->cache_line & (topo->cache_line - 1)));
+  DLX_CHECK(topo->prefetch_pair == topo->cache_line || topo->prefetch_pair == 2 * topo->cache_line);
+  __check_dense(topo->cpu_core, topo->n_cpu, topo->n_core);
+  __check_dense(topo->cpu_llc, topo->n_cpu, topo->n_llc);
+  for (uint32_t cpu = 0; cpu < topo->n_cpu; cpu++)
+    DLX_CHECK(topo->cpu_node[cpu] >= 0 && topo->cpu_node[cpu] < (int32_t)topo->n_node);
+
+  uint32_t siblings[64];
+  for (uint32_t cpu = 0; cpu < topo->n_cpu; cpu++) {
+    uint32_t n = dlx_topology_siblings(cpu, siblings, 64);
+    int self = 0;
+    DLX_CHECK(n >= 1);
+    for (uint32_t i = 0; i < n && i < 64; i++) {
+      self |= siblings[i] == cpu;
+      DLX_CHECK(topo->cpu_core[siblings[i]] == topo->cpu_core[cpu]);
+    }
+    DLX_CHECK(self);
+  }
+
+  for (uint32_t node = 0; node < topo->n_node; node++) {
+    DLX_CHECK(topo->node_os[node] >= (int32_t)node);
+    DLX_CHECK(dlx_topology_node(topo->node_os[node]) == (int32_t)node);
+    DLX_CHECK(!node || topo->node_os[node] > topo->node_os[node - 1]);
+  }
+  DLX_CHECK(dlx_topology_node(-1) == -1);
+  DLX_CHECK(dlx_topology_node(topo->node_os[topo->n_node - 1] + 1) == -1);
+
+  // Pins the thread to its last allowed CPU, the cache catches up within
+  // DLX_CPU_REFRESH calls.
+  cpu_set_t allowed;
+  DLX_CHECK(!sched_getaffinity(0, sizeof(allowed), &allowed));
+  int target = -1;
+  for (uint32_t cpu = 0; cpu < topo->n_cpu && cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed))
+      target = cpu;
+  }
+  DLX_CHECK(target >= 0);
+  cpu_set_t pinned;
+  CPU_ZERO(&pinned);
+  CPU_SET(target, &pinned);
+  DLX_CHECK(!sched_setaffinity(0, sizeof(pinned), &pinned));
+  for (int i = 0; i < DLX_CPU_REFRESH; i++)
+    dlx_current_cpu();
+  DLX_CHECK(dlx_current_cpu() == (uint32_t)target);
+  DLX_CHECK(dlx_current_node() == (uint32_t)topo->cpu_node[target]);
+
+  char dump[4096] = { 0 };
+  FILE *out = fmemopen(dump, sizeof(dump) - 1, "w");
+  DLX_CHECK(out);
+  dlx_topology_dump(out);
+  fclose(out);
+  DLX_CHECK(strstr(dump, "cpus") && strstr(dump, "kernel node"));
+  printf(
+    "topology: %u cpus, %u cores, %u llc domains, %u nodes\n", topo->n_cpu, topo->n_core, topo->n_llc,
+    topo->n_node
+  );
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include "dlx-test.h"
+#include <sys/wait.h>
+
+// Lock event trace, in full and sampled. A child process traces threads
+// hammering a hot site and touching a rare one, and exits, which closes
+// the trace. The full trace has to account for every acquisition and
+// release, written or dropped when a ring filled up. The sampled one
+// has to hold far fewer events, still every acquisition of the rare site,
+// and once its samples are weighed the way DylinxRuntimeReport weighs
+// them, extrapolate the hot site to its true count.
+#define N_THREAD 4
+#define N_HOT 100000
+#define N_RARE 50
+#define MAX_PERIOD 256
+
+static dlx_ttas_t g_hot[2];
+static dlx_pthreadmtx_t g_rare;
+static long g_counter;
+
+static void *__worker(void *arg) {
+  for (int i = 0; i < N_HOT; i++) {
+    pthread_mutex_lock(&g_hot[i % 2]);
+    g_counter++;
+    pthread_mutex_unlock(&g_hot[i % 2]);
+    if (i % (N_HOT / N_RARE) == 0) {
+      pthread_mutex_lock(&g_rare);
+      g_counter++;
+      pthread_mutex_unlock(&g_rare);
+    }
+  }
+  return NULL;
+}
+
+static void __run_traced(const char *path, const char *sample) {
+  if (!fork()) {
+    DLX_CHECK(!dlx_trace_sample(sample));
+    DLX_CHECK(!dlx_trace_start(path));
+    pthread_t tids[N_THREAD];
+    for (int t = 0; t < N_THREAD; t++)
+      DLX_CHECK(!pthread_create(&tids[t], NULL, __worker, NULL));
+    for (int t = 0; t < N_THREAD; t++)
+      pthread_join(tids[t], NULL);
+    exit(g_counter == N_THREAD * (N_HOT + N_RARE)? 0: 1);
+  }
+  int status;
+  wait(&status);
+  DLX_CHECK(WIFEXITED(status) && !WEXITSTATUS(status));
+}
+
+// Reads the trace back, counting acquisition events per site and their
+// weighed sum.
+static dlx_trace_header_t __load(const char *path, uint64_t *n_acquire, double *weighed) {
+  FILE *file = fopen(path, "rb");
+  DLX_CHECK(file);
+  dlx_trace_header_t header;
+  char pad[DLX_TRACE_HEADER];
+  DLX_CHECK(fread(pad, DLX_TRACE_HEADER, 1, file) == 1);
+  memcpy(&header, pad, sizeof(header));
+  DLX_CHECK(!memcmp(header.magic, "DLXTRACE", 8) && header.version == 2);
+  DLX_CHECK(header.event_size == sizeof(dlx_trace_event_t));
+  // Period in force at the last sample and the latest one, per thread and
+  // site.
+  uint32_t period[N_THREAD + 2][3], pending[N_THREAD + 2][3];
+  for (int t = 0; t < N_THREAD + 2; t++)
+    for (int s = 0; s < 3; s++)
+      period[t][s] = pending[t][s] = 1;
+  double scale = header.n_seen_open? (double)header.n_seen / header.n_seen_open: 1;
+  dlx_trace_event_t ev;
+  uint64_t n_event = 0;
+  while (fread(&ev, sizeof(ev), 1, file) == 1) {
+    n_event++;
+    DLX_CHECK(ev.thread < N_THREAD + 2 && ev.site_id >= 1 && ev.site_id <= 2);
+    uint32_t *last = &period[ev.thread][ev.site_id], *next = &pending[ev.thread][ev.site_id];
+    if (ev.op == DLX_TRACE_RATE) {
+      DLX_CHECK(ev.delta >= 1 && ev.delta <= MAX_PERIOD);
+      *next = ev.delta;
+      continue;
+    }
+    if (ev.op == DLX_TRACE_RELEASE)
+      continue;
+    DLX_CHECK(ev.op == DLX_TRACE_ACQUIRE);
+    n_acquire[ev.site_id]++;
+    weighed[ev.site_id] += *last * scale;
+    *last = *next;
+  }
+  fclose(file);
+  DLX_CHECK(n_event == header.n_event);
+  return header;
+}
+
+int main() {
+  dlx_test_init(3);
+  DLX_CHECK(!dlx_ttas_arr_init(g_hot, 2, 1, "g_hot", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_pthreadmtx_var_init(&g_rare, NULL, 2, "g_rare", __FILE__, __LINE__));
+  DLX_CHECK(dlx_trace_sample("256:5/1000") == EINVAL);
+  DLX_CHECK(dlx_trace_sample("0") == EINVAL);
+  char path[] = "/tmp/dlx-trace-XXXXXX";
+  int fd = mkstemp(path);
+  DLX_CHECK(fd >= 0);
+  close(fd);
+
+  uint64_t full[3] = { 0 }, sampled[3] = { 0 };
+  double full_weighed[3] = { 0 }, sampled_weighed[3] = { 0 };
+  __run_traced(path, NULL);
+  dlx_trace_header_t header = __load(path, full, full_weighed);
+  DLX_CHECK(header.max_period == 1);
+  DLX_CHECK(header.n_event + header.n_dropped == 2 * N_THREAD * (N_HOT + N_RARE));
+  DLX_CHECK(full[1] + full[2] <= N_THREAD * (N_HOT + N_RARE));
+
+  char spec[16];
+  snprintf(spec, sizeof(spec), "%d", MAX_PERIOD);
+  __run_traced(path, spec);
+  header = __load(path, sampled, sampled_weighed);
+  unlink(path);
+  DLX_CHECK(header.max_period == MAX_PERIOD && !header.window_ms);
+  DLX_CHECK(!header.n_dropped && header.n_seen == N_THREAD * (N_HOT + N_RARE));
+  DLX_CHECK(header.overhead_cyc > 0);
+  DLX_CHECK(sampled[1] < N_THREAD * N_HOT / 16);
+  DLX_CHECK(sampled[2] == N_THREAD * N_RARE);
+  double error = sampled_weighed[1] / (N_THREAD * N_HOT) - 1;
+  DLX_CHECK(error > -0.05 && error < 0.05);
+  printf(
+    "trace: %lu of %d hot acquisitions sampled, extrapolated to %.0f, overhead %.1f cycles per acquisition\n",
+    (unsigned long)sampled[1], N_THREAD * N_HOT, sampled_weighed[1], (double)header.overhead_cyc / header.n_seen
+  );
+  return 0;
+}
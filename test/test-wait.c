@@ -0,0 +1,107 @@
+#include "dlx-test.h"
+
+// Waiting policies. Each lock resolves the policy of its site, keeps
+// mutual exclusion under it, and waits the way the policy says: a waiter
+// behind a sleeping holder burns its CPU time under SPIN and hardly any
+// under PARK or TSC, and still gets the lock once it is released.
+#define N_SITE 7
+#define N_ROUND 20000
+#define HOLD_US 100000
+
+static dlx_ttas_t g_park_ttas, g_spin_ttas, g_yield_ttas, g_tsc_ttas;
+static dlx_mcs_t g_park_mcs;
+static dlx_ticket_t g_park_ticket;
+static dlx_backoff_t g_backoff;
+static dlx_generic_lock_t *g_lock;
+static long g_counter;
+static uint64_t g_wait_cpu_ns;
+
+static uint64_t __thread_cpu_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void *__count(void *arg) {
+  for (int i = 0; i < N_ROUND; i++) {
+    pthread_mutex_lock(g_lock);
+    g_counter++;
+    pthread_mutex_unlock(g_lock);
+    if (i % 16 == 0)
+      sched_yield();
+  }
+  return NULL;
+}
+
+static void *__wait_holder(void *arg) {
+  uint64_t begin = __thread_cpu_ns();
+  pthread_mutex_lock(g_lock);
+  g_wait_cpu_ns = __thread_cpu_ns() - begin;
+  pthread_mutex_unlock(g_lock);
+  return NULL;
+}
+
+// Policy the backend resolved, every type used here keeps it in a field
+// named wait.
+#define RESOLVED(entity, ltype) (((ltype ## _lock_t *)(entity).interface.lock_obj)->wait.kind)
+
+static uint64_t __check(dlx_generic_lock_t *lock) {
+  pthread_t tids[2];
+  g_lock = lock;
+  g_counter = 0;
+  for (int i = 0; i < 2; i++)
+    DLX_CHECK(!pthread_create(&tids[i], NULL, __count, NULL));
+  for (int i = 0; i < 2; i++)
+    pthread_join(tids[i], NULL);
+  DLX_CHECK(g_counter == 2 * N_ROUND);
+  pthread_mutex_lock(g_lock);
+  DLX_CHECK(!pthread_create(&tids[0], NULL, __wait_holder, NULL));
+  usleep(HOLD_US);
+  pthread_mutex_unlock(g_lock);
+  pthread_join(tids[0], NULL);
+  return g_wait_cpu_ns;
+}
+
+int main() {
+  dlx_test_init(N_SITE);
+  alarm(120);
+  DLX_CHECK(!dlx_set_site_wait(0, DLX_WAIT_PARK, 0, 0, 64));
+  DLX_CHECK(!dlx_set_site_wait(1, DLX_WAIT_PARK, 0, 0, 64));
+  DLX_CHECK(!dlx_set_site_wait(2, DLX_WAIT_PARK, 0, 0, 64));
+  DLX_CHECK(!dlx_set_site_wait(3, DLX_WAIT_SPIN, 0, 0, 0));
+  DLX_CHECK(!dlx_set_site_wait(4, DLX_WAIT_YIELD, 0, 0, 16));
+  DLX_CHECK(!dlx_set_site_wait(5, DLX_WAIT_BACKOFF, 64, 4096, 0));
+  DLX_CHECK(!dlx_set_site_wait(6, DLX_WAIT_TSC, 0, 0, 20000));
+  DLX_CHECK(!dlx_ttas_var_init(&g_park_ttas, NULL, 0, "g_park_ttas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_mcs_var_init(&g_park_mcs, NULL, 1, "g_park_mcs", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ticket_var_init(&g_park_ticket, NULL, 2, "g_park_ticket", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_spin_ttas, NULL, 3, "g_spin_ttas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_yield_ttas, NULL, 4, "g_yield_ttas", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_backoff_var_init(&g_backoff, NULL, 5, "g_backoff", __FILE__, __LINE__));
+  DLX_CHECK(!dlx_ttas_var_init(&g_tsc_ttas, NULL, 6, "g_tsc_ttas", __FILE__, __LINE__));
+  DLX_CHECK(RESOLVED(g_park_ttas, ttas) == DLX_WAIT_PARK);
+  DLX_CHECK(RESOLVED(g_park_mcs, mcs) == DLX_WAIT_PARK);
+  DLX_CHECK(RESOLVED(g_park_ticket, ticket) == DLX_WAIT_PARK);
+  DLX_CHECK(RESOLVED(g_spin_ttas, ttas) == DLX_WAIT_SPIN);
+  DLX_CHECK(RESOLVED(g_yield_ttas, ttas) == DLX_WAIT_YIELD);
+  DLX_CHECK(RESOLVED(g_backoff, backoff) == DLX_WAIT_BACKOFF);
+  backoff_lock_t *backoff = g_backoff.interface.lock_obj;
+  DLX_CHECK(backoff->wait.min == 64 && backoff->wait.max == 4096);
+  DLX_CHECK(RESOLVED(g_tsc_ttas, ttas) == DLX_WAIT_TSC);
+
+  uint64_t spin_ns = __check(&g_spin_ttas.interface);
+  __check(&g_yield_ttas.interface);
+  __check(&g_backoff.interface);
+  uint64_t park_ns[4] = {
+    __check(&g_park_ttas.interface), __check(&g_park_mcs.interface),
+    __check(&g_park_ticket.interface), __check(&g_tsc_ttas.interface)
+  };
+  DLX_CHECK(spin_ns > HOLD_US * 1000ull / 2);
+  for (int i = 0; i < 4; i++)
+    DLX_CHECK(park_ns[i] < HOLD_US * 1000ull / 10);
+  printf(
+    "wait: a %dms hold cost a spinning waiter %lums and a parked one %lums\n", HOLD_US / 1000,
+    (unsigned long)(spin_ns / 1000000), (unsigned long)(park_ns[0] / 1000000)
+  );
+  return 0;
+}
@@ -27,11 +27,33 @@ target("dylinx")
   )
 target_end()
 
+option("hotswap")
+  set_default(false)
+  set_showmenu(true)
+  set_description("Allow swapping the lock type of a site while the subject runs")
+  add_defines("__DYLINX_HOTSWAP__")
+option_end()
+
+option("singlefast")
+  set_default(false)
+  set_showmenu(true)
+  set_description("Skip lock backends while the subject runs a single thread")
+  add_defines("__DYLINX_SINGLE_FAST__")
+option_end()
+
+option("reclaim")
+  set_default(true)
+  set_showmenu(true)
+  set_description("Destroy locks left in objects freed by the subject without destroying them")
+  add_defines("__DYLINX_RECLAIM__")
+option_end()
+
 target("dlx-glue")
   set_kind("static")
   add_files("src/glue/*.c|dylinx-init.c")
   add_includedirs("src/glue")
   add_defines("__DYLINX_VERBOSE__=3")
+  add_options("hotswap", "singlefast", "reclaim")
   set_targetdir("build/lib")
   set_languages("c11")
   set_toolset("cc", "/usr/local/bin/clang")
@@ -39,3 +61,30 @@ target("dlx-glue")
 
 target_end()
 
+target("dylinx-top")
+  set_kind("binary")
+  add_files("src/top/dylinx-top.c")
+  add_includedirs("src/glue")
+  set_targetdir("build/bin")
+  set_languages("c11")
+  add_links("rt")
+target_end()
+
+-- Behaviour tests and benchmarks of the glue, each builds the glue into
+-- itself, see test/dlx-test.h. `xmake build -g test && xmake test`, or
+-- `make -C test test bench` without xmake.
+for _, file in ipairs(os.files("test/*.c")) do
+  target(path.basename(file))
+    set_kind("binary")
+    set_group("test")
+    set_default(false)
+    add_files(file)
+    add_includedirs("src/glue", "src/glue/lock")
+    set_targetdir("build/test")
+    set_languages("gnu11")
+    add_links("pthread", "dl", "atomic", "rt", "m")
+    if path.basename(file):startswith("test-") then
+      add_tests("default")
+    end
+  target_end()
+end